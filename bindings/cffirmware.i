@@ -25,6 +25,8 @@
 #include "outlierFilterTdoa.h"
 #include "kalman_core.h"
 #include "mm_tdoa.h"
+#include "mm_tdoa_robust.h"
+#include "sitl.h"
 %}
 
 %include "math3d.h"
@@ -42,6 +44,12 @@
 %include "outlierFilterTdoa.h"
 %include "kalman_core.h"
 %include "mm_tdoa.h"
+%include "mm_tdoa_robust.h"
+
+// The raw pointer versions can not be called from python, see the array versions below
+%ignore sitlBatchReset;
+%ignore sitlBatchStep;
+%include "sitl.h"
 
 
 %inline %{
@@ -100,6 +108,62 @@ void collisionAvoidanceUpdateSetpointWrap(
     free(workspace);
 }
 
+// Get a writable, C contiguous float32 buffer (numpy array, array.array, ...) with at least rows x columns elements
+static int sitlGetBuffer(PyObject *obj, Py_buffer *view, const char *name, int rows, int columns)
+{
+    if (PyObject_GetBuffer(obj, view, PyBUF_WRITABLE | PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0) {
+        return -1;
+    }
+    if (view->itemsize != sizeof(float) || view->format == NULL || strcmp(view->format, "f") != 0) {
+        PyErr_Format(PyExc_TypeError, "%s must be a float32 array", name);
+        PyBuffer_Release(view);
+        return -1;
+    }
+    if (view->len < (Py_ssize_t)(rows * columns * sizeof(float))) {
+        PyErr_Format(PyExc_ValueError, "%s must have shape (%d, %d)", name, rows, columns);
+        PyBuffer_Release(view);
+        return -1;
+    }
+    return 0;
+}
+
+PyObject* sitlBatchResetArrays(sitlBatch_t *batch, PyObject *states)
+{
+    Py_buffer statesView;
+    if (sitlGetBuffer(states, &statesView, "states", sitlBatchCount(batch), SITL_STATE_SIZE) != 0) {
+        return NULL;
+    }
+    sitlBatchReset(batch, statesView.buf);
+    PyBuffer_Release(&statesView);
+    Py_RETURN_NONE;
+}
+
+PyObject* sitlBatchStepArrays(sitlBatch_t *batch, int steps, PyObject *states, PyObject *setpoints, PyObject *motors)
+{
+    const int count = sitlBatchCount(batch);
+    Py_buffer statesView, setpointsView, motorsView;
+    if (sitlGetBuffer(states, &statesView, "states", count, SITL_STATE_SIZE) != 0) {
+        return NULL;
+    }
+    if (sitlGetBuffer(setpoints, &setpointsView, "setpoints", count, SITL_SETPOINT_SIZE) != 0) {
+        PyBuffer_Release(&statesView);
+        return NULL;
+    }
+    if (sitlGetBuffer(motors, &motorsView, "motors", count, SITL_MOTOR_COUNT) != 0) {
+        PyBuffer_Release(&statesView);
+        PyBuffer_Release(&setpointsView);
+        return NULL;
+    }
+
+    // The GIL is kept, the power distribution and the kalman core use static scratch memory
+    sitlBatchStep(batch, steps, statesView.buf, setpointsView.buf, motorsView.buf);
+
+    PyBuffer_Release(&statesView);
+    PyBuffer_Release(&setpointsView);
+    PyBuffer_Release(&motorsView);
+    Py_RETURN_NONE;
+}
+
 void assertFail(char *exp, char *file, int line) {
     char buf[150];
     sprintf(buf, "%s in File: \"%s\", line %d\n", exp, file, line);
@@ -110,6 +174,58 @@ void assertFail(char *exp, char *file, int line) {
 
 %pythoncode %{
 import numpy as np
+
+
+class SitlBatch:
+    """Simulates a batch of vehicles in the loop with the firmware controllers.
+
+    The states (N x 13: position, velocity, quaternion x y z w, body rates),
+    setpoints (N x 4: position, yaw in degrees) and motors (N x 4) are numpy
+    arrays that are shared with the simulation without copying. Modify the
+    setpoints between calls to step() to fly a trajectory.
+    """
+
+    def __init__(self, count, controller=sitlControllerMellinger, estimator=sitlEstimatorGroundTruth,
+                 gyro_noise=0.0, acc_noise=0.0, position_noise=0.0, seed=0):
+        config = sitlConfig_t()
+        sitlDefaultConfig(config)
+        config.controller = controller
+        config.estimator = estimator
+        config.gyroNoise = gyro_noise
+        config.accNoise = acc_noise
+        config.positionNoise = position_noise
+        config.seed = seed
+
+        self._batch = sitlBatchCreate(config, count)
+        if self._batch is None:
+            raise MemoryError("Could not allocate the simulation")
+
+        self.states = np.zeros((count, SITL_STATE_SIZE), dtype=np.float32)
+        self.setpoints = np.zeros((count, SITL_SETPOINT_SIZE), dtype=np.float32)
+        self.motors = np.zeros((count, SITL_MOTOR_COUNT), dtype=np.float32)
+        self.reset()
+
+    def __len__(self):
+        return self.states.shape[0]
+
+    def __del__(self):
+        if getattr(self, "_batch", None) is not None:
+            sitlBatchFree(self._batch)
+            self._batch = None
+
+    def reset(self, states=None):
+        """Reset the controllers and estimators, to hover at the origin if no states are given"""
+        if states is None:
+            self.states[:] = 0
+            self.states[:, SITL_STATE_QUAT + 3] = 1
+        else:
+            self.states[:] = states
+        sitlBatchResetArrays(self._batch, self.states)
+
+    def step(self, steps=1):
+        """Simulate all vehicles for a number of 1 ms steps"""
+        sitlBatchStepArrays(self._batch, steps, self.states, self.setpoints, self.motors)
+        return self.states
 %}
 
 #define COPY_CTOR(structname) \
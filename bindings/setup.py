@@ -5,6 +5,7 @@ from distutils.core import setup, Extension
 import os
 
 include = [
+    "bindings",
     "src/modules/interface",
     "src/modules/interface/controller",
     "src/modules/interface/kalman_core",
@@ -49,14 +50,19 @@ fw_sources = [
     # "src/modules/src/power_distribution_flapper.c",
     "src/modules/src/axis3fSubSampler.c",
     "src/modules/src/kalman_core/kalman_core.c",
+    "src/modules/src/kalman_core/kalman_core_covariance.c",
+    "src/modules/src/kalman_core/kalman_core_ud.c",
     "src/modules/src/kalman_core/mm_tdoa.c",
+    "src/modules/src/kalman_core/mm_tdoa_robust.c",
+    "src/modules/src/kalman_core/mm_robust_common.c",
+    "src/modules/src/kalman_core/mm_position.c",
     "src/modules/src/outlierfilter/outlierFilterTdoa.c",
 ]
 
 cffirmware = Extension(
     "_cffirmware",
     include_dirs=include,
-    sources=fw_sources + ["build/cffirmware_wrap.c"],
+    sources=fw_sources + ["bindings/sitl.c", "build/cffirmware_wrap.c"],
     extra_compile_args=[
         "-O3",
         # The following flags are also used for compiling the actual firmware
@@ -0,0 +1,367 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * sitl.c - Batched software in the loop simulation for the python bindings
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sitl.h"
+
+#include "stabilizer_types.h"
+#include "controller_mellinger.h"
+#include "controller_lee.h"
+#include "power_distribution.h"
+#include "axis3fSubSampler.h"
+#include "kalman_core.h"
+#include "mm_position.h"
+#include "physicalConstants.h"
+#include "platform_defaults.h"
+#include "cf_math.h"
+
+#define DT 0.001f
+#define PREDICTION_INTERVAL_MS 10
+#define POSITION_UPDATE_INTERVAL_MS 10
+
+// Time constant of the motor and propeller response (s)
+#define MOTOR_TIME_CONSTANT 0.02f
+
+// Inertia of the Crazyflie 2.x (kg m^2)
+#define INERTIA_XX 16.571710e-6f
+#define INERTIA_YY 16.655602e-6f
+#define INERTIA_ZZ 29.261652e-6f
+
+typedef struct {
+  controllerMellinger_t mellinger;
+  controllerLee_t lee;
+  control_t control;
+
+  kalmanCoreData_t kalman;
+  Axis3fSubSampler_t accSubSampler;
+  Axis3fSubSampler_t gyroSubSampler;
+  uint32_t nextPredictionMs;
+
+  state_t state;
+  sensorData_t sensors;
+  motors_thrust_pwm_t motors;
+  float motorForces[SITL_MOTOR_COUNT];
+  stabilizerStep_t step;
+  uint32_t random;
+} sitlVehicle_t;
+
+struct sitlBatch_s {
+  sitlConfig_t config;
+  kalmanCoreParams_t kalmanParams;
+  int count;
+  sitlVehicle_t* vehicles;
+};
+
+void sitlDefaultConfig(sitlConfig_t* config) {
+  memset(config, 0, sizeof(*config));
+  config->controller = sitlControllerMellinger;
+  config->estimator = sitlEstimatorGroundTruth;
+  config->positionNoise = 0.001f;
+}
+
+sitlBatch_t* sitlBatchCreate(const sitlConfig_t* config, const int count) {
+  if (count <= 0) {
+    return 0;
+  }
+
+  sitlBatch_t* batch = calloc(1, sizeof(sitlBatch_t));
+  if (!batch) {
+    return 0;
+  }
+
+  batch->vehicles = calloc(count, sizeof(sitlVehicle_t));
+  if (!batch->vehicles) {
+    free(batch);
+    return 0;
+  }
+
+  batch->config = *config;
+  batch->count = count;
+  kalmanCoreDefaultParams(&batch->kalmanParams);
+
+  return batch;
+}
+
+void sitlBatchFree(sitlBatch_t* batch) {
+  if (batch) {
+    free(batch->vehicles);
+    free(batch);
+  }
+}
+
+int sitlBatchCount(const sitlBatch_t* batch) {
+  return batch->count;
+}
+
+// xorshift32, one generator per vehicle to make results independent of the batch size
+static float randomUniform(sitlVehicle_t* vehicle) {
+  uint32_t x = vehicle->random;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  vehicle->random = x;
+  return (x >> 8) * (1.0f / 16777216.0f);
+}
+
+static float randomGaussian(sitlVehicle_t* vehicle, const float stdDev) {
+  if (stdDev <= 0.0f) {
+    return 0.0f;
+  }
+
+  // Box-Muller
+  const float u1 = randomUniform(vehicle) + 1e-7f;
+  const float u2 = randomUniform(vehicle);
+  return stdDev * sqrtf(-2.0f * logf(u1)) * cosf(2.0f * (float)M_PI * u2);
+}
+
+// Rotation matrix, body to world, from a quaternion (x, y, z, w)
+static void quatToRotation(const float* q, float R[3][3]) {
+  const float x = q[0], y = q[1], z = q[2], w = q[3];
+  R[0][0] = 1 - 2 * (y * y + z * z);
+  R[0][1] = 2 * (x * y - w * z);
+  R[0][2] = 2 * (x * z + w * y);
+  R[1][0] = 2 * (x * y + w * z);
+  R[1][1] = 1 - 2 * (x * x + z * z);
+  R[1][2] = 2 * (y * z - w * x);
+  R[2][0] = 2 * (x * z - w * y);
+  R[2][1] = 2 * (y * z + w * x);
+  R[2][2] = 1 - 2 * (x * x + y * y);
+}
+
+static void groundTruthState(const float* s, const float R[3][3], const Axis3f* acc, state_t* state) {
+  state->position = (point_t){.x = s[SITL_STATE_POS], .y = s[SITL_STATE_POS + 1], .z = s[SITL_STATE_POS + 2]};
+  state->velocity = (velocity_t){.x = s[SITL_STATE_VEL], .y = s[SITL_STATE_VEL + 1], .z = s[SITL_STATE_VEL + 2]};
+
+  const float* q = &s[SITL_STATE_QUAT];
+  state->attitudeQuaternion = (quaternion_t){.x = q[0], .y = q[1], .z = q[2], .w = q[3]};
+
+  // Same conventions as kalmanCoreExternalizeState()
+  const float yaw = atan2f(R[1][0], R[0][0]);
+  const float pitch = asinf(-R[2][0]);
+  const float roll = atan2f(R[2][1], R[2][2]);
+  state->attitude = (attitude_t){.roll = roll * RAD_TO_DEG, .pitch = -pitch * RAD_TO_DEG, .yaw = yaw * RAD_TO_DEG};
+
+  state->acc = (acc_t){
+    .x = R[0][0] * acc->x + R[0][1] * acc->y + R[0][2] * acc->z,
+    .y = R[1][0] * acc->x + R[1][1] * acc->y + R[1][2] * acc->z,
+    .z = R[2][0] * acc->x + R[2][1] * acc->y + R[2][2] * acc->z - 1,
+  };
+}
+
+static void resetVehicle(sitlBatch_t* batch, const int index, const float* s) {
+  sitlVehicle_t* vehicle = &batch->vehicles[index];
+  memset(vehicle, 0, sizeof(*vehicle));
+
+  vehicle->random = batch->config.seed + index;
+  if (vehicle->random == 0) {
+    vehicle->random = 0x9e3779b9;
+  }
+
+  controllerMellingerInit(&vehicle->mellinger);
+  controllerLeeInit(&vehicle->lee);
+
+  float R[3][3];
+  quatToRotation(&s[SITL_STATE_QUAT], R);
+
+  kalmanCoreParams_t params = batch->kalmanParams;
+  params.initialX = s[SITL_STATE_POS];
+  params.initialY = s[SITL_STATE_POS + 1];
+  params.initialZ = s[SITL_STATE_POS + 2];
+  params.initialYaw = atan2f(R[1][0], R[0][0]);
+  kalmanCoreInit(&vehicle->kalman, &params, 0);
+  axis3fSubSamplerInit(&vehicle->accSubSampler, GRAVITY_MAGNITUDE);
+  axis3fSubSamplerInit(&vehicle->gyroSubSampler, DEG_TO_RAD);
+
+  const Axis3f oneG = {.z = 1.0f};
+  groundTruthState(s, R, &oneG, &vehicle->state);
+}
+
+void sitlBatchReset(sitlBatch_t* batch, const float* states) {
+  for (int i = 0; i < batch->count; i++) {
+    resetVehicle(batch, i, &states[i * SITL_STATE_SIZE]);
+  }
+}
+
+static void updateKalman(const sitlBatch_t* batch, sitlVehicle_t* vehicle, const float* s, const bool isFlying) {
+  const uint32_t nowMs = vehicle->step;
+  kalmanCoreData_t* kalman = &vehicle->kalman;
+
+  axis3fSubSamplerAccumulate(&vehicle->accSubSampler, &vehicle->sensors.acc);
+  axis3fSubSamplerAccumulate(&vehicle->gyroSubSampler, &vehicle->sensors.gyro);
+
+  if (nowMs >= vehicle->nextPredictionMs) {
+    axis3fSubSamplerFinalize(&vehicle->accSubSampler);
+    axis3fSubSamplerFinalize(&vehicle->gyroSubSampler);
+    kalmanCorePredict(kalman, &batch->kalmanParams, &vehicle->accSubSampler.subSample, &vehicle->gyroSubSampler.subSample, nowMs, isFlying);
+    vehicle->nextPredictionMs = nowMs + PREDICTION_INTERVAL_MS;
+  }
+
+  kalmanCoreAddProcessNoise(kalman, &batch->kalmanParams, nowMs);
+
+  if (nowMs % POSITION_UPDATE_INTERVAL_MS == 0) {
+    positionMeasurement_t position = {
+      .x = s[SITL_STATE_POS] + randomGaussian(vehicle, batch->config.positionNoise),
+      .y = s[SITL_STATE_POS + 1] + randomGaussian(vehicle, batch->config.positionNoise),
+      .z = s[SITL_STATE_POS + 2] + randomGaussian(vehicle, batch->config.positionNoise),
+      .stdDev = batch->config.positionNoise > 0.0f ? batch->config.positionNoise : 0.001f,
+    };
+    kalmanCoreUpdateWithPosition(kalman, &position);
+  }
+
+  kalmanCoreFinalize(kalman);
+  kalmanCoreExternalizeState(kalman, &vehicle->state, &vehicle->sensors.acc);
+}
+
+static void integrate(float* s, const float R[3][3], const float forces[SITL_MOTOR_COUNT], Axis3f* specificForce) {
+  const float arm = 0.707106781f * ARM_LENGTH;
+  const float thrust = forces[0] + forces[1] + forces[2] + forces[3];
+  // Same motor layout as the force/torque mode of the quadrotor power distribution
+  const float torqueX = arm * (-forces[0] - forces[1] + forces[2] + forces[3]);
+  const float torqueY = arm * (-forces[0] + forces[1] + forces[2] - forces[3]);
+  const float torqueZ = THRUST2TORQUE * (-forces[0] + forces[1] - forces[2] + forces[3]);
+
+  float* pos = &s[SITL_STATE_POS];
+  float* vel = &s[SITL_STATE_VEL];
+  float* q = &s[SITL_STATE_QUAT];
+  float* w = &s[SITL_STATE_OMEGA];
+
+  // Translation, semi implicit Euler
+  const float thrustAcc = thrust / CF_MASS;
+  vel[0] += R[0][2] * thrustAcc * DT;
+  vel[1] += R[1][2] * thrustAcc * DT;
+  vel[2] += (R[2][2] * thrustAcc - GRAVITY_MAGNITUDE) * DT;
+  pos[0] += vel[0] * DT;
+  pos[1] += vel[1] * DT;
+  pos[2] += vel[2] * DT;
+
+  // Rotation, J * dw/dt = torque - w x (J * w)
+  const float wx = w[0], wy = w[1], wz = w[2];
+  w[0] += (torqueX - (INERTIA_ZZ - INERTIA_YY) * wy * wz) / INERTIA_XX * DT;
+  w[1] += (torqueY - (INERTIA_XX - INERTIA_ZZ) * wz * wx) / INERTIA_YY * DT;
+  w[2] += (torqueZ - (INERTIA_YY - INERTIA_XX) * wx * wy) / INERTIA_ZZ * DT;
+
+  // dq/dt = 0.5 * q * (w, 0)
+  const float qx = q[0], qy = q[1], qz = q[2], qw = q[3];
+  const float h = 0.5f * DT;
+  q[0] += h * (qw * w[0] + qy * w[2] - qz * w[1]);
+  q[1] += h * (qw * w[1] + qz * w[0] - qx * w[2]);
+  q[2] += h * (qw * w[2] + qx * w[1] - qy * w[0]);
+  q[3] += h * (-qx * w[0] - qy * w[1] - qz * w[2]);
+  const float norm = sqrtf(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+  for (int i = 0; i < 4; i++) {
+    q[i] /= norm;
+  }
+
+  // The ground, the vehicle rests on it until the thrust lifts it but can turn around the vertical axis
+  if (pos[2] <= 0.0f) {
+    pos[2] = 0.0f;
+    if (vel[2] < 0.0f) {
+      memset(vel, 0, 3 * sizeof(float));
+      w[0] = 0.0f;
+      w[1] = 0.0f;
+    }
+    *specificForce = (Axis3f){.x = R[2][0], .y = R[2][1], .z = R[2][2]};
+  } else {
+    *specificForce = (Axis3f){.z = thrustAcc / GRAVITY_MAGNITUDE};
+  }
+}
+
+static void stepVehicle(const sitlBatch_t* batch, sitlVehicle_t* vehicle, float* s, const float* sp) {
+  const sitlConfig_t* config = &batch->config;
+
+  float R[3][3];
+  quatToRotation(&s[SITL_STATE_QUAT], R);
+
+  // Sensors, the accelerometer from the previous step
+  const float* w = &s[SITL_STATE_OMEGA];
+  vehicle->sensors.gyro = (Axis3f){
+    .x = w[0] * RAD_TO_DEG + randomGaussian(vehicle, config->gyroNoise),
+    .y = w[1] * RAD_TO_DEG + randomGaussian(vehicle, config->gyroNoise),
+    .z = w[2] * RAD_TO_DEG + randomGaussian(vehicle, config->gyroNoise),
+  };
+
+  const bool isFlying = s[SITL_STATE_POS + 2] > 0.0f;
+  if (config->estimator == sitlEstimatorKalman) {
+    updateKalman(batch, vehicle, s, isFlying);
+  } else {
+    groundTruthState(s, R, &vehicle->sensors.acc, &vehicle->state);
+  }
+
+  setpoint_t setpoint = {
+    .position = {.x = sp[0], .y = sp[1], .z = sp[2]},
+    .attitude = {.yaw = sp[3]},
+    .mode = {.x = modeAbs, .y = modeAbs, .z = modeAbs, .yaw = modeAbs},
+  };
+
+  if (config->controller == sitlControllerLee) {
+    controllerLee(&vehicle->lee, &vehicle->control, &setpoint, &vehicle->sensors, &vehicle->state, vehicle->step);
+  } else {
+    controllerMellinger(&vehicle->mellinger, &vehicle->control, &setpoint, &vehicle->sensors, &vehicle->state, vehicle->step);
+  }
+
+  motors_thrust_uncapped_t motorThrustUncapped;
+  powerDistribution(&vehicle->control, &motorThrustUncapped);
+  powerDistributionCap(&motorThrustUncapped, &vehicle->motors);
+
+  // First order motor response, the motor command is proportional to the thrust in the power distribution
+  const float alpha = DT / (MOTOR_TIME_CONSTANT + DT);
+  for (int i = 0; i < SITL_MOTOR_COUNT; i++) {
+    const float commandedForce = vehicle->motors.list[i] * (THRUST_MAX / UINT16_MAX);
+    vehicle->motorForces[i] += alpha * (commandedForce - vehicle->motorForces[i]);
+  }
+
+  Axis3f specificForce;
+  integrate(s, R, vehicle->motorForces, &specificForce);
+  vehicle->sensors.acc = (Axis3f){
+    .x = specificForce.x + randomGaussian(vehicle, config->accNoise),
+    .y = specificForce.y + randomGaussian(vehicle, config->accNoise),
+    .z = specificForce.z + randomGaussian(vehicle, config->accNoise),
+  };
+
+  vehicle->step++;
+}
+
+void sitlBatchStep(sitlBatch_t* batch, const int steps, float* states, const float* setpoints, float* motors) {
+  // Vehicle by vehicle rather than step by step, keeps the data of one vehicle in the cache
+  for (int i = 0; i < batch->count; i++) {
+    sitlVehicle_t* vehicle = &batch->vehicles[i];
+    float* s = &states[i * SITL_STATE_SIZE];
+    const float* sp = &setpoints[i * SITL_SETPOINT_SIZE];
+
+    for (int k = 0; k < steps; k++) {
+      stepVehicle(batch, vehicle, s, sp);
+    }
+
+    if (motors) {
+      for (int m = 0; m < SITL_MOTOR_COUNT; m++) {
+        motors[i * SITL_MOTOR_COUNT + m] = vehicle->motors.list[m];
+      }
+    }
+  }
+}
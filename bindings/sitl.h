@@ -0,0 +1,107 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * sitl.h - Batched software in the loop simulation for the python bindings
+ */
+
+/**
+ * Simulates N independent quadrotors, each with its own estimator,
+ * controller and rigid body dynamics, for K stabilizer steps (1 kHz) in one
+ * call. The simulated vehicle uses the platform defaults of the build (mass,
+ * arm length, max thrust).
+ *
+ * The vehicle states are stored in a caller provided array, N rows of
+ * SITL_STATE_SIZE floats, that is updated in place. This makes it possible
+ * to use numpy arrays without copying, see SitlBatch in the python bindings.
+ *
+ * Only controllers that keep their state in an instance struct can be used,
+ * the PID controller uses global state and is not supported.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// Per vehicle state: position (m), velocity (m/s), attitude quaternion (x, y, z, w), angular velocity (rad/s, body)
+#define SITL_STATE_SIZE 13
+#define SITL_STATE_POS 0
+#define SITL_STATE_VEL 3
+#define SITL_STATE_QUAT 6
+#define SITL_STATE_OMEGA 10
+
+// Per vehicle setpoint: position (m), yaw (deg)
+#define SITL_SETPOINT_SIZE 4
+
+// Per vehicle output: motor commands (0 - 65535)
+#define SITL_MOTOR_COUNT 4
+
+typedef enum {
+  sitlControllerMellinger = 0,
+  sitlControllerLee = 1,
+} sitlControllerType_t;
+
+typedef enum {
+  sitlEstimatorGroundTruth = 0,
+  sitlEstimatorKalman = 1,
+} sitlEstimatorType_t;
+
+typedef struct {
+  sitlControllerType_t controller;
+  sitlEstimatorType_t estimator;
+  float gyroNoise;       // Standard deviation of the gyro noise (deg/s)
+  float accNoise;        // Standard deviation of the accelerometer noise (G)
+  float positionNoise;   // Standard deviation of the position measurements fed to the kalman filter at 100 Hz (m)
+  uint32_t seed;         // Seed of the noise generators, vehicle i uses seed + i
+} sitlConfig_t;
+
+typedef struct sitlBatch_s sitlBatch_t;
+
+/**
+ * @brief Default configuration, mellinger controller and ground truth estimator without noise
+ */
+void sitlDefaultConfig(sitlConfig_t* config);
+
+/**
+ * @brief Allocate a batch of vehicles
+ *
+ * @return The batch, or 0 if the allocation failed
+ */
+sitlBatch_t* sitlBatchCreate(const sitlConfig_t* config, const int count);
+void sitlBatchFree(sitlBatch_t* batch);
+int sitlBatchCount(const sitlBatch_t* batch);
+
+/**
+ * @brief Reset the controllers and estimators of all vehicles to the given states
+ *
+ * @param states count x SITL_STATE_SIZE floats
+ */
+void sitlBatchReset(sitlBatch_t* batch, const float* states);
+
+/**
+ * @brief Simulate all vehicles for a number of 1 ms steps
+ *
+ * @param states count x SITL_STATE_SIZE floats, updated in place
+ * @param setpoints count x SITL_SETPOINT_SIZE floats
+ * @param motors count x SITL_MOTOR_COUNT floats, the motor commands of the last step, may be 0
+ */
+void sitlBatchStep(sitlBatch_t* batch, const int steps, float* states, const float* setpoints, float* motors);
@@ -18,8 +18,10 @@ class EstimatorKalmanEmulator:
     how they are connected.
 
     """
-    def __init__(self, anchor_positions) -> None:
+    def __init__(self, anchor_positions, ud_factorization=False, robust_tdoa=False) -> None:
         self.anchor_positions = anchor_positions
+        self.ud_factorization = ud_factorization
+        self.robust_tdoa = robust_tdoa
         self.accSubSampler = cffirmware.Axis3fSubSampler_t()
         self.gyroSubSampler = cffirmware.Axis3fSubSampler_t()
         self.coreData = cffirmware.kalmanCoreData_t()
@@ -89,6 +91,7 @@ class EstimatorKalmanEmulator:
         # Note: If the emulator is used with data from a deck that uses roll/pitch/yaw zero reversion, this should be
         # set to a non-zero value to behave like the CF. See estimatorKalmanInit() in estimator_kalman.c
         # self.coreParams.AttitudeReversion = 0.001
+        self.coreParams.udFactorization = self.ud_factorization
 
         cffirmware.outlierFilterTdoaReset(self.outlierFilterState)
         cffirmware.kalmanCoreInit(self.coreData, self.coreParams, self.now_ms)
@@ -118,7 +121,10 @@ class EstimatorKalmanEmulator:
             tdoa.distanceDiff = float(tdoa_data['distanceDiff'])
             tdoa.stdDev = self.TDOA_ENGINE_MEASUREMENT_NOISE_STD
 
-            cffirmware.kalmanCoreUpdateWithTdoa(self.coreData, tdoa, now_ms, self.outlierFilterState)
+            if self.robust_tdoa:
+                cffirmware.kalmanCoreRobustUpdateWithTdoa(self.coreData, tdoa, self.outlierFilterState)
+            else:
+                cffirmware.kalmanCoreUpdateWithTdoa(self.coreData, tdoa, now_ms, self.outlierFilterState)
 
         if sample[0] == 'estAcceleration':
             acc_data = sample[1]
@@ -101,6 +101,8 @@
 #define UART2_TASK_PRI            3
 #define CRTP_SRV_TASK_PRI         0
 #define PLATFORM_SRV_TASK_PRI     0
+#define GYRO_SPECTRUM_TASK_PRI    0
+#define CONSOLE_TASK_PRI          0
 
 // Not compiled
 #if 0
@@ -160,6 +162,10 @@
 #define CPX_TASK_NAME             "CPX"
 #define APP_TASK_NAME             "APP"
 #define FLAPPERDECK_TASK_NAME     "FLAPPERDECK"
+#define GYRO_SPECTRUM_TASK_NAME   "GYROSPEC"
+#define CONSOLE_TASK_NAME         "CONSOLE"
+#define DECK_INIT_TASK_NAME       "DECKINIT"
+#define BOOT_TASK_NAME            "BOOT"
 
 
 //Task stack sizes
@@ -207,6 +213,10 @@
 #define KALMAN_TASK_STACKSIZE           (3 * configMINIMAL_STACK_SIZE)
 #define FLAPPERDECK_TASK_STACKSIZE      (2 * configMINIMAL_STACK_SIZE)
 #define ERROR_UKF_TASK_STACKSIZE        (4 * configMINIMAL_STACK_SIZE)
+#define GYRO_SPECTRUM_TASK_STACKSIZE    (2 * configMINIMAL_STACK_SIZE)
+#define CONSOLE_TASK_STACKSIZE          configMINIMAL_STACK_SIZE
+#define DECK_INIT_TASK_STACKSIZE        SYSTEM_TASK_STACKSIZE
+#define BOOT_TASK_STACKSIZE             SYSTEM_TASK_STACKSIZE
 
 //The radio channel. From 0 to 125
 #define RADIO_CHANNEL 80
@@ -27,8 +27,15 @@
 #ifndef __TRACE_H__
 #define __TRACE_H__
 
+#include "autoconf.h"
+
 #define configUSE_TRACE_FACILITY	1
 
+#include "sysload.h"
+
+// Measure how long tasks run before being switched out
+#define traceTASK_SWITCHED_OUT() sysLoadTaskSwitchedOut(pxCurrentTCB->uxTCBNumber)
+
 // ITM useful macros
 #ifndef ITM_NO_OVERFLOW
 #define ITM_SEND(CH, DATA) ((uint32_t*)0xE0000000)[CH] = DATA
@@ -37,8 +44,16 @@
                            ((uint32_t*)0xE0000000)[CH] = DATA
 #endif
 
+#ifdef CONFIG_DEBUG_EVENT_TRACE
+#include "event_trace.h"
+
+// Record task switches and blocking queue operations in the event trace
+#define traceTASK_CREATE(pxNewTCB) eventTraceTaskCreated(pxNewTCB->uxTCBNumber, pxNewTCB->pcTaskName)
+#define traceTASK_SWITCHED_IN() eventTraceRecord(EVENT_TRACE_TASK_SWITCHED_IN, pxCurrentTCB->uxTCBNumber)
+#else
 // Send 4 first characters of task name to ITM port 1
 #define traceTASK_SWITCHED_IN() ITM_SEND(1, *((uint32_t*)pxCurrentTCB->pcTaskName))
+#endif
 
 // Systick value on port 2
 #define traceTASK_INCREMENT_TICK(xTickCount) ITM_SEND(2, xTickCount)
@@ -51,7 +66,12 @@
 
 #define traceQUEUE_SEND(xQueue) ITM_SEND(3, ITM_QUEUE_SEND | ((xQUEUE *) xQueue)->uxQueueNumber)
 #define traceQUEUE_SEND_FAILED(xQueue) ITM_SEND(3, ITM_QUEUE_FAILED | ((xQUEUE *) xQueue)->uxQueueNumber)
+#ifdef CONFIG_DEBUG_EVENT_TRACE
+#define traceBLOCKING_ON_QUEUE_RECEIVE(xQueue) eventTraceRecord(EVENT_TRACE_QUEUE_BLOCK_RECEIVE, EVENT_TRACE_QUEUE_ID(xQueue))
+#define traceBLOCKING_ON_QUEUE_SEND(xQueue) eventTraceRecord(EVENT_TRACE_QUEUE_BLOCK_SEND, EVENT_TRACE_QUEUE_ID(xQueue))
+#else
 #define traceBLOCKING_ON_QUEUE_RECEIVE(xQueue) ITM_SEND(3, ITM_BLOCKING_ON_QUEUE_RECEIVE | ((xQUEUE *) xQueue)->uxQueueNumber)
 #define traceBLOCKING_ON_QUEUE_SEND(xQueue) ITM_SEND(3, ITM_BLOCKING_ON_QUEUE_SEND | ((xQUEUE *) xQueue)->uxQueueNumber)
+#endif
 
 #endif
@@ -27,6 +27,8 @@
 #include "deck.h"
 
 #include "stm32fxxx.h"
+#include "FreeRTOS.h"
+#include "task.h"
 
 static  uint32_t  stregResolution;
 static  uint32_t  adcRange;
@@ -48,8 +50,10 @@ void adcInit(void)
   ADC_StructInit(&ADC_InitStructure);
   ADC_CommonStructInit(&ADC_CommonInitStructure);
 
-  /* enable ADC clock */
+  /* enable ADC clock, the clock enable register is shared */
+  taskENTER_CRITICAL();
   RCC_APB2PeriphClockCmd(RCC_APB2Periph_ADC2, ENABLE);
+  taskEXIT_CRITICAL();
 
   /* init ADCs in independent mode, div clock by two */
   ADC_CommonInitStructure.ADC_Mode = ADC_Mode_Independent;
@@ -86,9 +90,6 @@ uint16_t analogRead(const deckPin_t pin)
 
   /* Now set the GPIO pin to analog mode. */
 
-  /* Enable clock for the peripheral of the pin.*/
-  RCC_AHB1PeriphClockCmd(deckGPIOMapping[pin.id].periph, ENABLE);
-
   /* Populate structure with RESET values. */
   GPIO_InitTypeDef GPIO_InitStructure;
   GPIO_StructInit(&GPIO_InitStructure);
@@ -99,8 +100,12 @@ uint16_t analogRead(const deckPin_t pin)
   GPIO_InitStructure.GPIO_Speed = GPIO_Speed_25MHz;
   GPIO_InitStructure.GPIO_PuPd  = GPIO_PuPd_NOPULL;
 
+  /* Enable clock for the peripheral of the pin and set the mode. The registers are shared with other pins. */
   /* TODO: Any settling time before we can do ADC after init on the GPIO pin? */
+  taskENTER_CRITICAL();
+  RCC_AHB1PeriphClockCmd(deckGPIOMapping[pin.id].periph, ENABLE);
   GPIO_Init(deckGPIOMapping[pin.id].port, &GPIO_InitStructure);
+  taskEXIT_CRITICAL();
 
   /* Read the appropriate ADC channel. */
   return analogReadChannel((uint8_t)deckGPIOMapping[pin.id].adcCh);
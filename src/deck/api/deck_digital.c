@@ -27,11 +27,11 @@
 #include "deck.h"
 
 #include "stm32fxxx.h"
+#include "FreeRTOS.h"
+#include "task.h"
 
 void pinMode(const deckPin_t pin, const uint32_t mode)
 {
-  RCC_AHB1PeriphClockCmd(deckGPIOMapping[pin.id].periph, ENABLE);
-
   GPIO_InitTypeDef GPIO_InitStructure = {0};
 
   GPIO_InitStructure.GPIO_Pin = deckGPIOMapping[pin.id].pin;
@@ -40,7 +40,12 @@ void pinMode(const deckPin_t pin, const uint32_t mode)
   if (mode == INPUT_PULLUP) GPIO_InitStructure.GPIO_PuPd = GPIO_PuPd_UP;
   if (mode == INPUT_PULLDOWN) GPIO_InitStructure.GPIO_PuPd = GPIO_PuPd_DOWN;
   GPIO_InitStructure.GPIO_Speed = GPIO_Speed_25MHz;
+
+  // The clock enable and port registers are shared with other pins, decks may be initialized in parallel
+  taskENTER_CRITICAL();
+  RCC_AHB1PeriphClockCmd(deckGPIOMapping[pin.id].periph, ENABLE);
   GPIO_Init(deckGPIOMapping[pin.id].port, &GPIO_InitStructure);
+  taskEXIT_CRITICAL();
 }
 
 void digitalWrite(const deckPin_t pin, const uint32_t val)
@@ -32,6 +32,7 @@
 
 #include "FreeRTOS.h"
 #include "semphr.h"
+#include "task.h"
 
 #include "cfassert.h"
 #include "config.h"
@@ -101,6 +102,9 @@ void spiBegin(void)
   rxComplete = xSemaphoreCreateBinary();
   spiMutex = xSemaphoreCreateMutex();
 
+  // The clock enable and gpio port registers are shared, decks may be initialized in parallel
+  taskENTER_CRITICAL();
+
   /*!< Enable the SPI clock */
   SPI_CLK_INIT(SPI_CLK, ENABLE);
 
@@ -139,6 +143,8 @@ void spiBegin(void)
   GPIO_InitStructure.GPIO_Pin =  SPI_MISO_PIN;
   GPIO_Init(SPI_MISO_GPIO_PORT, &GPIO_InitStructure);
 
+  taskEXIT_CRITICAL();
+
   /*!< SPI DMA Initialization */
   spiDMAInit();
 
@@ -33,6 +33,7 @@
 
 #include "FreeRTOS.h"
 #include "semphr.h"
+#include "task.h"
 
 #include "autoconf.h"
 #include "cfassert.h"
@@ -103,6 +104,9 @@ void spi3Begin(void)
   rxComplete = xSemaphoreCreateBinary();
   spiMutex = xSemaphoreCreateMutex();
 
+  // The clock enable and gpio port registers are shared, decks may be initialized in parallel
+  taskENTER_CRITICAL();
+
   /*!< Enable the SPI clock */
   SPI_CLK_INIT(SPI_CLK, ENABLE);
 
@@ -137,6 +141,8 @@ void spi3Begin(void)
   GPIO_InitStructure.GPIO_Pin =  SPI_MISO_PIN;
   GPIO_Init(SPI_MISO_GPIO_PORT, &GPIO_InitStructure);
 
+  taskEXIT_CRITICAL();
+
   /*!< SPI DMA Initialization */
   spi3DMAInit();
 
@@ -28,9 +28,19 @@
 
 #include <string.h>
 
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
 #include "deck.h"
+#include "deck_init_plan.h"
 #include "deck_memory.h"
+#include "config.h"
 #include "debug.h"
+#include "static_mem.h"
+#include "usec_time.h"
+
+#include "autoconf.h"
 
 #ifdef CONFIG_DEBUG
   #define DECK_CORE_DBG_PRINT(fmt, ...)  DEBUG_PRINT(fmt, ## __VA_ARGS__)
@@ -40,54 +50,147 @@
 
 extern void deckInfoInit();
 
+// Queue of each deck, decks in different queues are initialized and tested in parallel
+static uint8_t deckQueue[DECK_MAX_COUNT];
+static int queueCount;
+static bool testPassed[DECK_MAX_COUNT];
+
+typedef enum {
+  deckPhaseInit,
+  deckPhaseTest,
+} DeckPhase;
+
+static void initDeck(int i)
+{
+  DeckInfo *deck = deckInfo(i);
+
+  if (deck->driver->init) {
+    if (deck->driver->name) {
+      DEBUG_PRINT("Calling INIT on driver %s for deck %i\n", deck->driver->name, i);
+    } else {
+      DEBUG_PRINT("Calling INIT for deck %i\n", i);
+    }
+
+    deck->driver->init(deck);
+  }
+}
+
+static void testDeck(int i)
+{
+  DeckInfo *deck = deckInfo(i);
+
+  testPassed[i] = true;
+  if (deck->driver->test) {
+    if (deck->driver->test()) {
+      DEBUG_PRINT("Deck %i test [OK].\n", i);
+    } else {
+      DEBUG_PRINT("Deck %i test [FAIL].\n", i);
+      testPassed[i] = false;
+    }
+  }
+}
+
+static void runQueue(const DeckPhase phase, const int queue)
+{
+  const int nDecks = deckCount();
+
+  for (int i = 0; i < nDecks; i++) {
+    if (deckQueue[i] == queue) {
+      if (phase == deckPhaseInit) {
+        initDeck(i);
+      } else {
+        testDeck(i);
+      }
+    }
+  }
+}
+
+#ifdef CONFIG_DECK_PARALLEL_INIT
+#define DECK_INIT_QUEUES 2
+
+static DeckPhase workerPhase;
+static TaskHandle_t workerHandle;
+static SemaphoreHandle_t workerDone;
+static StaticSemaphore_t workerDoneBuffer;
+
+static void deckInitTask(void *param);
+STATIC_MEM_TASK_ALLOC(deckInitTask, DECK_INIT_TASK_STACKSIZE);
+
+// Runs the second queue while the system task runs the first one. The stack is
+// statically allocated, the task is kept after the start and waits forever.
+static void deckInitTask(void *param)
+{
+  while (true) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    runQueue(workerPhase, 1);
+    xSemaphoreGive(workerDone);
+  }
+}
+
+static void runPhase(const DeckPhase phase)
+{
+  if (queueCount > 1) {
+    workerPhase = phase;
+    xTaskNotifyGive(workerHandle);
+    runQueue(phase, 0);
+    xSemaphoreTake(workerDone, portMAX_DELAY);
+  } else {
+    runQueue(phase, 0);
+  }
+}
+#else
+#define DECK_INIT_QUEUES 1
+
+static void runPhase(const DeckPhase phase)
+{
+  runQueue(phase, 0);
+}
+#endif
+
 void deckInit()
 {
+  const uint64_t start = usecTimestamp();
+
   deckDriverCount();
   deckInfoInit();
   deckMemoryInit();
 
-  int nDecks;
-  int i;
+  const uint64_t enumerated = usecTimestamp();
 
-  nDecks = deckCount();
+  int nDecks = deckCount();
 
   DEBUG_PRINT("%d deck(s) found\n", nDecks);
 
-  for (i=0; i<nDecks; i++) {
-    DeckInfo *deck = deckInfo(i);
-
-    if (deck->driver->init) {
-      if (deck->driver->name) {
-        DEBUG_PRINT("Calling INIT on driver %s for deck %i\n", deck->driver->name, i);
-      } else {
-        DEBUG_PRINT("Calling INIT for deck %i\n", i);
-      }
+  queueCount = deckInitPlan(deckInfo(0), nDecks, DECK_INIT_QUEUES, deckQueue);
 
-      deck->driver->init(deck);
-    }
+#ifdef CONFIG_DECK_PARALLEL_INIT
+  if (queueCount > 1) {
+    workerDone = xSemaphoreCreateBinaryStatic(&workerDoneBuffer);
+    workerHandle = STATIC_MEM_TASK_CREATE(deckInitTask, deckInitTask, DECK_INIT_TASK_NAME, NULL, SYSTEM_TASK_PRI);
+    DECK_CORE_DBG_PRINT("Initializing decks in %d queues\n", queueCount);
   }
+#endif
+
+  runPhase(deckPhaseInit);
+
+  const uint64_t initialized = usecTimestamp();
+  DEBUG_PRINT("Enumeration %u us, init %u us\n", (unsigned int)(enumerated - start),
+              (unsigned int)(initialized - enumerated));
 }
 
 bool deckTest()
 {
   bool pass = true;
-  int nDecks;
-  int i;
-
-  nDecks = deckCount();
+  const uint64_t start = usecTimestamp();
 
-  for (i=0; i<nDecks; i++) {
-    DeckInfo *deck = deckInfo(i);
+  runPhase(deckPhaseTest);
 
-    if (deck->driver->test) {
-      if (deck->driver->test()) {
-        DEBUG_PRINT("Deck %i test [OK].\n", i);
-      } else {
-        DEBUG_PRINT("Deck %i test [FAIL].\n", i);
-        pass = false;
-      }
-    }
+  const int nDecks = deckCount();
+  for (int i = 0; i < nDecks; i++) {
+    pass &= testPassed[i];
   }
 
+  DEBUG_PRINT("Test %u us\n", (unsigned int)(usecTimestamp() - start));
+
   return pass;
 }
@@ -45,6 +45,35 @@ extern const struct deck_driver * _deckDriver_stop;
 static const struct deck_driver ** drivers;
 static int driversLen;
 
+// Drivers sorted on VID:PID, in link order for equal VID:PID, to find a driver with a binary search.
+// Drivers that do not fit in the index are searched linearly.
+#define DRIVER_INDEX_MAX_LEN 64
+static struct {
+  uint16_t vidPid;
+  uint8_t driver;
+} driverIndex[DRIVER_INDEX_MAX_LEN];
+static int driverIndexLen;
+
+static uint16_t vidPid(uint8_t vid, uint8_t pid) {
+  return (vid << 8) | pid;
+}
+
+static void buildDriverIndex() {
+  driverIndexLen = driversLen < DRIVER_INDEX_MAX_LEN ? driversLen : DRIVER_INDEX_MAX_LEN;
+
+  // Insertion sort, it is stable and there are only a few drivers
+  for (int i = 0; i < driverIndexLen; i++) {
+    const uint16_t key = vidPid(drivers[i]->vid, drivers[i]->pid);
+    int j = i;
+    while (j > 0 && driverIndex[j - 1].vidPid > key) {
+      driverIndex[j] = driverIndex[j - 1];
+      j--;
+    }
+    driverIndex[j].vidPid = key;
+    driverIndex[j].driver = i;
+  }
+}
+
 // Init the toc access variables. Lazy initialisation: it is going to be done
 // the first time any api function is called.
 static void deckdriversInit() {
@@ -54,6 +83,7 @@ static void deckdriversInit() {
 
     drivers = &_deckDriver_start;
     driversLen = &_deckDriver_stop - &_deckDriver_start;
+    buildDriverIndex();
     init = true;
 
     DECK_DRV_DBG_PRINT("Found %d drivers\n", driversLen);
@@ -88,7 +118,23 @@ const DeckDriver* deckFindDriverByVidPid(uint8_t vid, uint8_t pid) {
 
   deckdriversInit();
 
-  for (i=0; i<driversLen; i++) {
+  // First entry with a VID:PID that is not less than the searched one
+  const uint16_t key = vidPid(vid, pid);
+  int low = 0;
+  int high = driverIndexLen;
+  while (low < high) {
+    const int mid = (low + high) / 2;
+    if (driverIndex[mid].vidPid < key) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  if (low < driverIndexLen && driverIndex[low].vidPid == key) {
+    return drivers[driverIndex[low].driver];
+  }
+
+  for (i=driverIndexLen; i<driversLen; i++) {
     if ((vid == drivers[i]->vid) && (pid == drivers[i]->pid)) {
       return drivers[i];
     }
@@ -36,6 +36,7 @@
 #include "crc32.h"
 #include "debug.h"
 #include "static_mem.h"
+#include "storage.h"
 
 #include "autoconf.h"
 
@@ -135,6 +136,12 @@ void printDeckInfo(DeckInfo *info)
 }
 
 #ifndef CONFIG_DEBUG_DECK_IGNORE_OWS
+static void setTlv(DeckInfo * info)
+{
+  info->tlv.data = &info->raw[DECK_INFO_TLV_DATA_POS];
+  info->tlv.length = info->raw[DECK_INFO_TLV_LENGTH_POS];
+}
+
 static bool infoDecode(DeckInfo * info)
 {
   uint8_t crcHeader;
@@ -163,13 +170,81 @@ static bool infoDecode(DeckInfo * info)
     return false;
   }
 
-  info->tlv.data = &info->raw[DECK_INFO_TLV_DATA_POS];
-  info->tlv.length = info->raw[DECK_INFO_TLV_LENGTH_POS];
+  setTlv(info);
 
   return true;
 }
 #endif
 
+#if !defined(CONFIG_DEBUG_DECK_IGNORE_OWS) && defined(CONFIG_DECK_INFO_CACHE)
+#define DECK_INFO_CACHE_KEY "deck/infoCache"
+#define DECK_INFO_CACHE_VERSION 1
+
+typedef struct {
+  uint8_t version;
+  uint8_t count;
+  OwSerialNum serials[DECK_MAX_COUNT];
+  uint8_t raw[DECK_MAX_COUNT][sizeof(deckInfos[0].raw)];
+} __attribute__((packed)) DeckInfoCache;
+
+NO_DMA_CCM_SAFE_ZERO_INIT static DeckInfoCache cache;
+
+/**
+ * Read the serial numbers of the deck memories and use the cached memories if they are
+ * the same as at the last start. The cached memories have been verified before they were stored.
+ */
+static bool loadFromCache(uint8_t nDecks)
+{
+  OwSerialNum serials[DECK_MAX_COUNT];
+
+  if (nDecks == 0 || nDecks > DECK_MAX_COUNT) {
+    return false;
+  }
+
+  for (int i = 0; i < nDecks; i++) {
+    if (!owGetinfo(i, &serials[i])) {
+      return false;
+    }
+  }
+
+  const bool isCached = storageFetch(DECK_INFO_CACHE_KEY, &cache, sizeof(cache)) == sizeof(cache) &&
+                        cache.version == DECK_INFO_CACHE_VERSION &&
+                        cache.count == nDecks &&
+                        memcmp(cache.serials, serials, nDecks * sizeof(OwSerialNum)) == 0;
+
+  if (isCached) {
+    for (int i = 0; i < nDecks; i++) {
+      memcpy(deckInfos[i].raw, cache.raw[i], sizeof(deckInfos[i].raw));
+      setTlv(&deckInfos[i]);
+    }
+  } else {
+    // Kept to store the memories when they have been read
+    memset(&cache, 0, sizeof(cache));
+    cache.version = DECK_INFO_CACHE_VERSION;
+    cache.count = nDecks;
+    memcpy(cache.serials, serials, nDecks * sizeof(OwSerialNum));
+  }
+
+  return isCached;
+}
+
+static void storeToCache(uint8_t nDecks)
+{
+  if (cache.version != DECK_INFO_CACHE_VERSION || cache.count != nDecks) {
+    // The serial numbers could not be read
+    return;
+  }
+
+  for (int i = 0; i < nDecks; i++) {
+    memcpy(cache.raw[i], deckInfos[i].raw, sizeof(deckInfos[i].raw));
+  }
+
+  if (!storageStore(DECK_INFO_CACHE_KEY, &cache, sizeof(cache))) {
+    DEBUG_PRINT("Failed to store the deck memories in the cache\n");
+  }
+}
+#endif
+
 static void enumerateDecks(void)
 {
   uint8_t nDecks = 0;
@@ -187,16 +262,32 @@ static void enumerateDecks(void)
   }
 
 #ifndef CONFIG_DEBUG_DECK_IGNORE_OWS
+#ifdef CONFIG_DECK_INFO_CACHE
+  const bool isCached = loadFromCache(nDecks);
+  if (isCached) {
+    DECK_INFO_DBG_PRINT("Using cached deck memories\n");
+  }
+#else
+  const bool isCached = false;
+#endif
+  bool allDecoded = true;
+
   for (int i = 0; i < nDecks; i++)
   {
     DECK_INFO_DBG_PRINT("Enumerating deck %i\n", i);
-    if (owRead(i, 0, sizeof(deckInfos[0].raw), (uint8_t *)&deckInfos[i]))
+    if (isCached)
+    {
+      deckInfos[i].driver = findDriver(&deckInfos[i]);
+      printDeckInfo(&deckInfos[i]);
+    }
+    else if (owRead(i, 0, sizeof(deckInfos[0].raw), (uint8_t *)&deckInfos[i]))
     {
       if (infoDecode(&deckInfos[i]))
       {
         deckInfos[i].driver = findDriver(&deckInfos[i]);
         printDeckInfo(&deckInfos[i]);
       } else {
+        allDecoded = false;
 #ifdef CONFIG_DEBUG
         DEBUG_PRINT("Deck %i has corrupt OW memory. "
                     "Ignoring the deck in DEBUG mode.\n", i);
@@ -213,8 +304,17 @@ static void enumerateDecks(void)
       DEBUG_PRINT("Reading deck nr:%d [FAILED]. "
                   "No driver will be initialized!\n", i);
       noError = false;
+      allDecoded = false;
     }
   }
+
+#ifdef CONFIG_DECK_INFO_CACHE
+  if (!isCached && allDecoded) {
+    storeToCache(nDecks);
+  }
+#else
+  (void)allDecoded;
+#endif
 #else
   DEBUG_PRINT("Ignoring all OW decks because of compile flag.\n");
   nDecks = 0;
@@ -0,0 +1,74 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * deck_init_plan.c - Groups decks that can be initialized in parallel
+ */
+
+#include "deck_init_plan.h"
+
+static bool isDeclaringResources(const DeckDriver* driver) {
+  return (driver->usedPeriph != 0) || (driver->usedGpio != 0);
+}
+
+// A deck that does not declare its resources may use anything and is treated as sharing with all other decks
+static bool isSharingResources(const DeckDriver* a, const DeckDriver* b) {
+  if (!isDeclaringResources(a) || !isDeclaringResources(b)) {
+    return true;
+  }
+
+  return ((a->usedPeriph & b->usedPeriph) != 0) || ((a->usedGpio & b->usedGpio) != 0);
+}
+
+int deckInitPlan(const DeckInfo* decks, const int count, const int maxQueues, uint8_t* queue) {
+  // Group of each deck, a group is identified by its first deck
+  int group[DECK_MAX_COUNT];
+
+  for (int i = 0; i < count; i++) {
+    group[i] = i;
+    for (int j = 0; j < i; j++) {
+      if (isSharingResources(decks[i].driver, decks[j].driver)) {
+        // Merge the groups, keeping the lowest id
+        const int from = group[i] > group[j] ? group[i] : group[j];
+        const int to = group[i] > group[j] ? group[j] : group[i];
+        for (int k = 0; k <= i; k++) {
+          if (group[k] == from) {
+            group[k] = to;
+          }
+        }
+      }
+    }
+  }
+
+  // Number the groups in enumeration order and assign them to the queues
+  int groupCount = 0;
+  for (int i = 0; i < count; i++) {
+    if (group[i] == i) {
+      queue[i] = groupCount % maxQueues;
+      groupCount++;
+    } else {
+      queue[i] = queue[group[i]];
+    }
+  }
+
+  return groupCount < maxQueues ? groupCount : maxQueues;
+}
@@ -0,0 +1,45 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * rpm.h - Deck that measure the motor RPM using QRD1114 IR reflector-sensor.
+ */
+#ifndef _RPM_H_
+#define _RPM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Check if the rpm deck is used
+ */
+bool rpmIsActive(void);
+
+/**
+ * @brief Get the latest measured speed of a motor
+ *
+ * @param motor Motor index, 0 - 3
+ * @return The speed in rpm, 0 if the motor is not rotating
+ */
+uint16_t rpmGetMotorRpm(uint8_t motor);
+
+#endif /* _RPM_H_ */
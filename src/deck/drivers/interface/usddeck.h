@@ -30,4 +30,11 @@ uint32_t usddeckFileSize(void);
 // Only works if logging is stopped
 bool usddeckRead(uint32_t offset, uint8_t* buffer, uint16_t length);
 
+// Reads "length" bytes at "offset" of the data to write to a file
+typedef bool (*usddeckFileDataReader_t)(const uint32_t offset, const uint8_t length, uint8_t* buffer);
+
+// Write "size" bytes to the file "filename", replacing any existing file.
+// The data is fetched in chunks with "reader". Only works if logging is stopped
+bool usddeckWriteFile(const char* filename, const uint32_t size, usddeckFileDataReader_t reader);
+
 #endif //__USDDECK_H__
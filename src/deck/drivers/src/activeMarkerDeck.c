@@ -206,6 +206,8 @@ static const DeckDriver deck_info = {
   .name = "bcActiveM",
   .requiredKalmanEstimatorAttitudeReversionOff = true,
 
+  .usedPeriph = DECK_USING_I2C,
+
   .init = activeMarkerDeckInit,
   .test = activeMarkerDeckTest,
 };
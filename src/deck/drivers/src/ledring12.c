@@ -34,6 +34,7 @@
 #include "deck.h"
 
 #include "FreeRTOS.h"
+#include "task.h"
 #include "timers.h"
 
 #include "ws2812.h"
@@ -1081,7 +1082,9 @@ static void ledring12Init(DeckInfo *info)
   GPIO_InitStructure.GPIO_OType = GPIO_OType_PP;
   GPIO_InitStructure.GPIO_PuPd  = GPIO_PuPd_NOPULL;
   GPIO_InitStructure.GPIO_Pin = GPIO_Pin_4;
+  taskENTER_CRITICAL();
   GPIO_Init(GPIOB, &GPIO_InitStructure);
+  taskEXIT_CRITICAL();
 
   memoryRegisterHandler(&ledringmemDef);
   memoryRegisterHandler(&timingmemDef);
@@ -34,6 +34,7 @@
 #include <stdlib.h>
 #include "stm32fxxx.h"
 #include "FreeRTOS.h"
+#include "task.h"
 #include "timers.h"
 
 
@@ -91,6 +92,8 @@ static void setUpHwTimer(){
   TIM_TimeBaseInitTypeDef  TIM_TimeBaseStructure;
   TIM_OCInitTypeDef  TIM_OCInitStructure;
 
+  // The clock enable and gpio port registers are shared, decks may be initialized in parallel
+  taskENTER_CRITICAL();
   //Clock the gpio and the timers
   RCC_AHB1PeriphClockCmd(GPIO_POS_PERIF, ENABLE);
   RCC_APB1PeriphClockCmd(TIM_PERIF, ENABLE);
@@ -105,6 +108,7 @@ static void setUpHwTimer(){
 
   //Map timers to alternate functions
   GPIO_PinAFConfig(GPIO_POS_PORT, GPIO_AF_POS_PIN, GPIO_AF_POS);
+  taskEXIT_CRITICAL();
 
   //Timer configuration
   TIM_TimeBaseStructure.TIM_Period = PERIOD - 1;
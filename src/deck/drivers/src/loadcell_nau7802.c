@@ -30,6 +30,7 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include "nvicconf.h"
+#include "exti.h"
 #include "stm32fxxx.h"
 
 #include "FreeRTOS.h"
@@ -387,17 +388,7 @@ static void setupDataReadyInterrupt(void)
   dataReady = xSemaphoreCreateBinaryStatic(&dataReadyBuffer);
 
   // TODO: EXTI_PortSourceGPIOB and EXTI_PinSource8 should be part of deckGPIOMapping!
-  SYSCFG_EXTILineConfig(EXTI_PortSourceGPIOB, EXTI_PinSource8);
-
-  EXTI_InitTypeDef EXTI_InitStructure;
-  EXTI_InitStructure.EXTI_Line = EXTI_Line8;
-  EXTI_InitStructure.EXTI_Mode = EXTI_Mode_Interrupt;
-  EXTI_InitStructure.EXTI_Trigger = EXTI_Trigger_Rising;
-  EXTI_InitStructure.EXTI_LineCmd = ENABLE;
-  // portDISABLE_INTERRUPTS();
-  EXTI_Init(&EXTI_InitStructure);
-  // EXTI_ClearITPendingBit(EXTI_Line15);
-  // portENABLE_INTERRUPTS();
+  extiConfigureLine(EXTI_PortSourceGPIOB, EXTI_PinSource8, EXTI_Trigger_Rising);
 }
 
 void __attribute__((used)) EXTI8_Callback(void)
@@ -541,6 +532,7 @@ static const DeckDriver loadcell_deck = {
     .pid = 0x00,
     .name = "bcLoadcell",
 
+    .usedPeriph = DECK_USING_I2C,
     .usedGpio = DECK_USING_IO_1,
 
     .init = loadcellInit,
@@ -48,6 +48,7 @@
 #include "log.h"
 #include "param.h"
 #include "nvicconf.h"
+#include "exti.h"
 #include "estimator.h"
 #include "statsCnt.h"
 #include "mem.h"
@@ -73,13 +74,11 @@
 
   #define EXTI_PortSource EXTI_PortSourceGPIOB
   #define EXTI_PinSource  EXTI_PinSource5
-  #define EXTI_LineN      EXTI_Line5
 #else
   #define GPIO_PIN_IRQ    DECK_GPIO_RX1
   #define GPIO_PIN_RESET  DECK_GPIO_TX1
   #define EXTI_PortSource EXTI_PortSourceGPIOC
   #define EXTI_PinSource  EXTI_PinSource11
-  #define EXTI_LineN      EXTI_Line11
 #endif
 
 
@@ -473,18 +472,10 @@ static dwOps_t dwOps = {
 
 static void dwm1000Init(DeckInfo *info)
 {
-  EXTI_InitTypeDef EXTI_InitStructure;
-
   spiBegin();
 
   // Set up interrupt
-  SYSCFG_EXTILineConfig(EXTI_PortSource, EXTI_PinSource);
-
-  EXTI_InitStructure.EXTI_Line = EXTI_LineN;
-  EXTI_InitStructure.EXTI_Mode = EXTI_Mode_Interrupt;
-  EXTI_InitStructure.EXTI_Trigger = EXTI_Trigger_Rising;
-  EXTI_InitStructure.EXTI_LineCmd = ENABLE;
-  EXTI_Init(&EXTI_InitStructure);
+  extiConfigureLine(EXTI_PortSource, EXTI_PinSource, EXTI_Trigger_Rising);
 
   // Init pins
   pinMode(CS_PIN, OUTPUT);
@@ -58,6 +58,7 @@ for improved position estimation.
 
 #include "lpsTdoa3Tag.h"
 #include "tdoaEngineInstance.h"
+#include "tdoa3RxBatch.h"
 #include "tdoaStats.h"
 #include "estimator.h"
 
@@ -80,8 +81,6 @@ for improved position estimation.
 #define LPS_TDOA3_TYPE 0
 #define LPS_TDOA3_SEND_LPP_PAYLOAD 1
 
-#define PACKET_TYPE_TDOA3 0x30
-
 #define TDOA3_RECEIVE_TIMEOUT 50000
 
 #ifdef CONFIG_DECK_LOCO_TDOA3_HYBRID_MODE
@@ -125,31 +124,6 @@ typedef enum {
 } TxOwnPosition;
 #endif
 
-typedef struct {
-  uint8_t type;
-  uint8_t seq;
-  uint32_t txTimeStamp;
-  uint8_t remoteCount;
-} __attribute__((packed)) rangePacketHeader3_t;
-
-typedef struct {
-  uint8_t id;
-  uint8_t seq;
-  uint32_t rxTimeStamp;
-  uint16_t distance;
-} __attribute__((packed)) remoteAnchorDataFull_t;
-
-typedef struct {
-  uint8_t id;
-  uint8_t seq;
-  uint32_t rxTimeStamp;
-} __attribute__((packed)) remoteAnchorDataShort_t;
-
-typedef struct {
-  rangePacketHeader3_t header;
-  uint8_t remoteAnchorData;
-} __attribute__((packed)) rangePacket3_t;
-
 static struct {
   float tdoaStdDev;
   bool isReceivingPackets;
@@ -159,6 +133,13 @@ static struct {
 
   bool isTdoaActive;
 
+  // Received packets waiting to be processed
+  tdoa3RxBatch_t rxBatch;
+
+  // TDoA measurements from the latest processed batch, sent to the estimator after the batch
+  tdoaMeasurement_t tdoaMeasurements[TDOA3_RX_BATCH_SIZE];
+  uint8_t tdoaMeasurementCount;
+
 #ifdef CONFIG_DECK_LOCO_TDOA3_HYBRID_MODE
 
   // Hybrid mode transmission information
@@ -202,46 +183,6 @@ static struct {
 #endif
 } ctx;
 
-static bool isValidTimeStamp(const int64_t anchorRxTime) {
-  return anchorRxTime != 0;
-}
-
-static int updateRemoteData(tdoaAnchorContext_t* anchorCtx, const void* payload) {
-  const rangePacket3_t* packet = (rangePacket3_t*)payload;
-  const void* anchorDataPtr = &packet->remoteAnchorData;
-  for (uint8_t i = 0; i < packet->header.remoteCount; i++) {
-    remoteAnchorDataFull_t* anchorData = (remoteAnchorDataFull_t*)anchorDataPtr;
-
-    uint8_t remoteId = anchorData->id;
-    int64_t remoteRxTime = anchorData->rxTimeStamp;
-    uint8_t remoteSeqNr = anchorData->seq & 0x7f;
-
-    if (isValidTimeStamp(remoteRxTime)) {
-      tdoaStorageSetRemoteRxTime(anchorCtx, remoteId, remoteRxTime, remoteSeqNr);
-    }
-
-    bool hasDistance = ((anchorData->seq & 0x80) != 0);
-    if (hasDistance) {
-      int64_t tof = anchorData->distance;
-      if (isValidTimeStamp(tof)) {
-        tdoaStorageSetRemoteTimeOfFlight(anchorCtx, remoteId, tof);
-
-        uint8_t anchorId = tdoaStorageGetId(anchorCtx);
-        tdoaStats_t* stats = &tdoaEngineState.stats;
-        if (anchorId == stats->anchorId && remoteId == stats->remoteAnchorId) {
-          stats->tof = (uint16_t)tof;
-        }
-      }
-
-      anchorDataPtr += sizeof(remoteAnchorDataFull_t);
-    } else {
-      anchorDataPtr += sizeof(remoteAnchorDataShort_t);
-    }
-  }
-
-  return (uint8_t*)anchorDataPtr - (uint8_t*)packet;
-}
-
 static void handleLppShortPacket(tdoaAnchorContext_t* anchorCtx, const uint8_t *data, const int length) {
   uint8_t type = data[0];
 
@@ -251,21 +192,66 @@ static void handleLppShortPacket(tdoaAnchorContext_t* anchorCtx, const uint8_t *
   }
 }
 
-static void handleLppPacket(const int dataLength, int rangePacketLength, const packet_t* rxPacket, tdoaAnchorContext_t* anchorCtx) {
-  const int32_t payloadLength = dataLength - MAC802154_HEADER_LENGTH;
+static void handleLppPacket(const int32_t payloadLength, int rangePacketLength, const uint8_t* payload, tdoaAnchorContext_t* anchorCtx) {
   const int32_t startOfLppDataInPayload = rangePacketLength;
   const int32_t lppDataLength = payloadLength - startOfLppDataInPayload;
   const int32_t lppTypeInPayload = startOfLppDataInPayload + 1;
 
   if (lppDataLength > 0) {
-    const uint8_t lppPacketHeader = rxPacket->payload[startOfLppDataInPayload];
+    const uint8_t lppPacketHeader = payload[startOfLppDataInPayload];
     if (lppPacketHeader == LPP_HEADER_SHORT_PACKET) {
       const int32_t lppTypeAndPayloadLength = lppDataLength - 1;
-      handleLppShortPacket(anchorCtx, &rxPacket->payload[lppTypeInPayload], lppTypeAndPayloadLength);
+      handleLppShortPacket(anchorCtx, &payload[lppTypeInPayload], lppTypeAndPayloadLength);
+    }
+  }
+}
+
+// Called for each packet when a batch is processed
+static void handleProcessedPacket(tdoaAnchorContext_t* anchorCtx, const tdoa3RxPacket_t* packet, const int rangeDataLength, const bool timeIsGood) {
+  handleLppPacket(packet->payloadLength, rangeDataLength, packet->payload, anchorCtx);
+
+#ifdef CONFIG_DECK_LOCO_TDOA3_HYBRID_MODE
+  if (ctx.isTwrActive) {
+    if (timeIsGood) {
+      const rangePacket3_t* rangePacket = (const rangePacket3_t*)packet->payload;
+      processTwoWayRanging(anchorCtx, packet->rxTime_ms, rangePacket->header.txTimeStamp, packet->rxTime);
     }
   }
+#endif
+}
+
+static void processRxBatch() {
+  if (ctx.rxBatch.count == 0) {
+    return;
+  }
+
+#ifdef CONFIG_DECK_LOCO_TDOA3_HYBRID_MODE
+  const bool doExcludeId = ctx.isTwrActive;
+  const uint8_t excludedId = ctx.anchorId;
+#else
+  const bool doExcludeId = false;
+  const uint8_t excludedId = 0;
+#endif
+
+  ctx.tdoaMeasurementCount = 0;
+  tdoa3RxBatchProcess(&ctx.rxBatch, &tdoaEngineState, doExcludeId, excludedId, handleProcessedPacket);
+
+  for (int i = 0; i < ctx.tdoaMeasurementCount; i++) {
+    estimatorEnqueueTDOA(&ctx.tdoaMeasurements[i]);
+
+    #ifdef CONFIG_DECK_LOCO_2D_POSITION
+    heightMeasurement_t heightData;
+    heightData.timestamp = xTaskGetTickCount();
+    heightData.height = DECK_LOCO_2D_POSITION_HEIGHT;
+    heightData.stdDev = 0.0001;
+    estimatorEnqueueAbsoluteHeight(&heightData);
+    #endif
+  }
+
+  ctx.isReceivingPackets = true;
 }
 
+// Radio event path, only copies the packet to the batch. The batch is processed when the radio is receiving again.
 static void rxcallback(dwDevice_t *dev) {
   tdoaStats_t* stats = &tdoaEngineState.stats;
   STATS_CNT_RATE_EVENT(&stats->packetsReceived);
@@ -284,38 +270,15 @@ static void rxcallback(dwDevice_t *dev) {
   dwGetReceiveTimestamp(dev, &arrival);
   const int64_t rxAn_by_T_in_cl_T = arrival.full;
 
-  const rangePacket3_t* packet = (rangePacket3_t*)rxPacket.payload;
-  if (packet->header.type == PACKET_TYPE_TDOA3) {
-    const int64_t txAn_in_cl_An = packet->header.txTimeStamp;
-    const uint8_t seqNr = packet->header.seq & 0x7f;
-
-    uint32_t now_ms = T2M(xTaskGetTickCount());
-    tdoaAnchorContext_t anchorCtx;
-    tdoaEngineGetAnchorCtxForPacketProcessing(&tdoaEngineState, anchorId, now_ms, &anchorCtx);
-    int rangeDataLength = updateRemoteData(&anchorCtx, packet);
-
-#ifdef CONFIG_DECK_LOCO_TDOA3_HYBRID_MODE
-    const bool doExcludeId = ctx.isTwrActive;
-    const uint8_t excludedId = ctx.anchorId;
-    const bool timeIsGood = tdoaEngineProcessPacketFiltered(&tdoaEngineState, &anchorCtx, txAn_in_cl_An, rxAn_by_T_in_cl_T, doExcludeId, excludedId);
-#else
-    const bool doExcludeId = false;
-    const uint8_t excludedId = 0;
-    tdoaEngineProcessPacketFiltered(&tdoaEngineState, &anchorCtx, txAn_in_cl_An, rxAn_by_T_in_cl_T, doExcludeId, excludedId);
-#endif
-
-    tdoaStorageSetRxTxData(&anchorCtx, rxAn_by_T_in_cl_T, txAn_in_cl_An, seqNr);
-    handleLppPacket(dataLength, rangeDataLength, &rxPacket, &anchorCtx);
-
-#ifdef CONFIG_DECK_LOCO_TDOA3_HYBRID_MODE
-    if (ctx.isTwrActive) {
-      if (timeIsGood) {
-        processTwoWayRanging(&anchorCtx, now_ms, txAn_in_cl_An, rxAn_by_T_in_cl_T);
-      }
+  if (rxPacket.payload[0] == PACKET_TYPE_TDOA3) {
+    if (ctx.rxBatch.count >= TDOA3_RX_BATCH_SIZE) {
+      // Should not happen as the batch is processed when it is full, but make room anyway
+      processRxBatch();
     }
-#endif
 
-    ctx.isReceivingPackets = true;
+    uint32_t now_ms = T2M(xTaskGetTickCount());
+    const int payloadLength = dataLength - MAC802154_HEADER_LENGTH;
+    tdoa3RxBatchAdd(&ctx.rxBatch, anchorId, rxPacket.payload, payloadLength, rxAn_by_T_in_cl_T, now_ms);
   }
 }
 
@@ -570,6 +533,8 @@ static uint32_t startNextEvent(dwDevice_t *dev, const uint32_t now) {
     if (!isTxPending) {
       if (ctx.nextTxTick < now) {
         const uint32_t now_ms = T2M(now);
+        // The transmitted packet and the TWR processing need the storage to be up to date
+        processRxBatch();
         setupTx(dev, now_ms);
         isTxPending = true;
         ctx.latestTransmissionTime_ms = now_ms;
@@ -612,23 +577,24 @@ static uint32_t onEvent(dwDevice_t *dev, uwbEvent_t event) {
   tdoaStatsUpdate(&tdoaEngineState.stats, T2M(now));
 
   uint32_t timeout = startNextEvent(dev, now);
+
+  // Process received packets while the radio is receiving the next one
+  uint32_t timeToDeadline = tdoa3RxBatchTimeToDeadline(&ctx.rxBatch, T2M(now));
+  if (timeToDeadline == 0) {
+    processRxBatch();
+  } else if (timeToDeadline < timeout) {
+    timeout = timeToDeadline;
+  }
+
   return timeout;
 }
 
 static void sendTdoaToEstimatorCallback(tdoaMeasurement_t* tdoaMeasurement) {
-  if (ctx.isTdoaActive) {
+  // At most one measurement per packet, sent to the estimator when the batch has been processed
+  if (ctx.isTdoaActive && ctx.tdoaMeasurementCount < TDOA3_RX_BATCH_SIZE) {
     // Override the default standard deviation set by the TDoA engine.
     tdoaMeasurement->stdDev = ctx.tdoaStdDev;
-
-    estimatorEnqueueTDOA(tdoaMeasurement);
-
-    #ifdef CONFIG_DECK_LOCO_2D_POSITION
-    heightMeasurement_t heightData;
-    heightData.timestamp = xTaskGetTickCount();
-    heightData.height = DECK_LOCO_2D_POSITION_HEIGHT;
-    heightData.stdDev = 0.0001;
-    estimatorEnqueueAbsoluteHeight(&heightData);
-    #endif
+    ctx.tdoaMeasurements[ctx.tdoaMeasurementCount++] = *tdoaMeasurement;
   }
 }
 
@@ -669,6 +635,8 @@ static void Initialize(dwDevice_t *dev) {
   ctx.tdoaStdDev = TDOA_ENGINE_MEASUREMENT_NOISE_STD;
   ctx.isTdoaActive = true;
   ctx.isReceivingPackets = false;
+  tdoa3RxBatchInit(&ctx.rxBatch);
+  ctx.tdoaMeasurementCount = 0;
 
 #ifdef CONFIG_DECK_LOCO_TDOA3_HYBRID_MODE
   ctx.anchorId = 254;
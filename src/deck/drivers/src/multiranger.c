@@ -33,6 +33,8 @@
 #include "vl53l1x.h"
 #include "range.h"
 #include "static_mem.h"
+#include "statsCnt.h"
+#include "autoconf.h"
 
 #include "i2cdev.h"
 
@@ -58,6 +60,50 @@ NO_DMA_CCM_SAFE_ZERO_INIT static VL53L1_Dev_t devUp;
 NO_DMA_CCM_SAFE_ZERO_INIT static VL53L1_Dev_t devLeft;
 NO_DMA_CCM_SAFE_ZERO_INIT static VL53L1_Dev_t devRight;
 
+#ifndef CONFIG_DECK_MULTIRANGER_TIMING_BUDGET_MS
+#define CONFIG_DECK_MULTIRANGER_TIMING_BUDGET_MS 33
+#endif
+
+// The long distance mode needs a longer minimum timing budget than the short mode
+#ifdef CONFIG_DECK_MULTIRANGER_SHORT_DISTANCE_MODE
+#define MR_DISTANCE_MODE VL53L1_DISTANCEMODE_SHORT
+#define MR_MIN_TIMING_BUDGET_MS 20
+#else
+#define MR_DISTANCE_MODE VL53L1_DISTANCEMODE_LONG
+#define MR_MIN_TIMING_BUDGET_MS 33
+#endif
+
+#define ONE_SECOND 1000
+
+static uint16_t timingBudgetMs = CONFIG_DECK_MULTIRANGER_TIMING_BUDGET_MS;
+
+static STATS_CNT_RATE_DEFINE(rateFront, ONE_SECOND);
+static STATS_CNT_RATE_DEFINE(rateBack, ONE_SECOND);
+static STATS_CNT_RATE_DEFINE(rateUp, ONE_SECOND);
+static STATS_CNT_RATE_DEFINE(rateLeft, ONE_SECOND);
+static STATS_CNT_RATE_DEFINE(rateRight, ONE_SECOND);
+
+typedef struct {
+    VL53L1_Dev_t *dev;
+    rangeDirection_t direction;
+    statsCntRateLogger_t *rate;
+    // Time when the current measurement is expected to be ready
+    uint32_t dueMs;
+    // Time when the sensor should be polled next
+    uint32_t nextPollMs;
+    // Time from when the latest measurement was due until it was read
+    uint16_t latencyMs;
+} mrSensor_t;
+
+static mrSensor_t sensors[] = {
+    {.dev = &devFront, .direction = rangeFront, .rate = &rateFront},
+    {.dev = &devBack, .direction = rangeBack, .rate = &rateBack},
+    {.dev = &devUp, .direction = rangeUp, .rate = &rateUp},
+    {.dev = &devLeft, .direction = rangeLeft, .rate = &rateLeft},
+    {.dev = &devRight, .direction = rangeRight, .rate = &rateRight},
+};
+#define MR_SENSOR_COUNT (sizeof(sensors) / sizeof(sensors[0]))
+
 static bool mrInitSensor(VL53L1_Dev_t *pdev, uint32_t pca95pin, char *name)
 {
     bool status;
@@ -81,20 +127,12 @@ static bool mrInitSensor(VL53L1_Dev_t *pdev, uint32_t pca95pin, char *name)
     return status;
 }
 
-static uint16_t mrGetMeasurementAndRestart(VL53L1_Dev_t *dev)
+static uint16_t mrGetMeasurementAndContinue(VL53L1_Dev_t *dev)
 {
-    VL53L1_Error status = VL53L1_ERROR_NONE;
     VL53L1_RangingMeasurementData_t rangingData;
-    uint8_t dataReady = 0;
     uint16_t range;
 
-    while (dataReady == 0)
-    {
-        status = VL53L1_GetMeasurementDataReady(dev, &dataReady);
-        vTaskDelay(M2T(1));
-    }
-
-    status = VL53L1_GetRangingMeasurementData(dev, &rangingData);
+    VL53L1_GetRangingMeasurementData(dev, &rangingData);
 
     if (filterMask & (1 << rangingData.RangeStatus))
     {
@@ -105,42 +143,92 @@ static uint16_t mrGetMeasurementAndRestart(VL53L1_Dev_t *dev)
         range = 32767;
     }
 
-    VL53L1_StopMeasurement(dev);
-    status = VL53L1_StartMeasurement(dev);
-    status = status;
+    // The sensor is ranging back-to-back, clearing the interrupt releases the next measurement
+    VL53L1_ClearInterruptAndStartMeasurement(dev);
 
     return range;
 }
 
-static void mrTask(void *param)
+static void mrStartSensors(const uint32_t nowMs)
 {
-    VL53L1_Error status = VL53L1_ERROR_NONE;
+    for (unsigned int i = 0; i < MR_SENSOR_COUNT; i++)
+    {
+        VL53L1_Dev_t *dev = sensors[i].dev;
+        VL53L1_StopMeasurement(dev);
+        VL53L1_SetDistanceMode(dev, MR_DISTANCE_MODE);
+        VL53L1_SetMeasurementTimingBudgetMicroSeconds(dev, timingBudgetMs * 1000);
+        VL53L1_StartMeasurement(dev);
+        sensors[i].dueMs = nowMs + timingBudgetMs;
+        sensors[i].nextPollMs = sensors[i].dueMs;
+    }
+}
 
+// Time comparison that handles wrap around of the tick counter
+static bool mrIsDue(const uint32_t timeMs, const uint32_t nowMs)
+{
+    return (int32_t)(nowMs - timeMs) >= 0;
+}
+
+static void mrTask(void *param)
+{
     systemWaitStart();
 
-    // Restart all sensors
-    status = VL53L1_StopMeasurement(&devFront);
-    status = VL53L1_StartMeasurement(&devFront);
-    status = VL53L1_StopMeasurement(&devBack);
-    status = VL53L1_StartMeasurement(&devBack);
-    status = VL53L1_StopMeasurement(&devUp);
-    status = VL53L1_StartMeasurement(&devUp);
-    status = VL53L1_StopMeasurement(&devLeft);
-    status = VL53L1_StartMeasurement(&devLeft);
-    status = VL53L1_StopMeasurement(&devRight);
-    status = VL53L1_StartMeasurement(&devRight);
-    status = status;
-
-    TickType_t lastWakeTime = xTaskGetTickCount();
+    if (timingBudgetMs < MR_MIN_TIMING_BUDGET_MS)
+    {
+        timingBudgetMs = MR_MIN_TIMING_BUDGET_MS;
+    }
+
+    uint32_t nowMs = T2M(xTaskGetTickCount());
+    uint16_t activeTimingBudgetMs = timingBudgetMs;
+    mrStartSensors(nowMs);
 
     while (1)
     {
-        vTaskDelayUntil(&lastWakeTime, M2T(100));
-        rangeSet(rangeFront, mrGetMeasurementAndRestart(&devFront) / 1000.0f);
-        rangeSet(rangeBack, mrGetMeasurementAndRestart(&devBack) / 1000.0f);
-        rangeSet(rangeUp, mrGetMeasurementAndRestart(&devUp) / 1000.0f);
-        rangeSet(rangeLeft, mrGetMeasurementAndRestart(&devLeft) / 1000.0f);
-        rangeSet(rangeRight, mrGetMeasurementAndRestart(&devRight) / 1000.0f);
+        nowMs = T2M(xTaskGetTickCount());
+
+        if (timingBudgetMs != activeTimingBudgetMs)
+        {
+            if (timingBudgetMs < MR_MIN_TIMING_BUDGET_MS)
+            {
+                timingBudgetMs = MR_MIN_TIMING_BUDGET_MS;
+            }
+            activeTimingBudgetMs = timingBudgetMs;
+            mrStartSensors(nowMs);
+        }
+
+        // Only sensors that should have a measurement ready are polled, to save bus time
+        uint32_t nextWakeMs = nowMs + activeTimingBudgetMs;
+        for (unsigned int i = 0; i < MR_SENSOR_COUNT; i++)
+        {
+            mrSensor_t *sensor = &sensors[i];
+
+            if (mrIsDue(sensor->nextPollMs, nowMs))
+            {
+                uint8_t dataReady = 0;
+                VL53L1_GetMeasurementDataReady(sensor->dev, &dataReady);
+                if (dataReady)
+                {
+                    uint16_t range = mrGetMeasurementAndContinue(sensor->dev);
+                    rangeSetWithTimestamp(sensor->direction, range / 1000.0f, nowMs);
+
+                    sensor->latencyMs = nowMs - sensor->dueMs;
+                    sensor->dueMs = nowMs + activeTimingBudgetMs;
+                    sensor->nextPollMs = sensor->dueMs;
+                    STATS_CNT_RATE_EVENT(sensor->rate);
+                }
+                else
+                {
+                    sensor->nextPollMs = nowMs + 1;
+                }
+            }
+
+            if (!mrIsDue(nextWakeMs, sensor->nextPollMs))
+            {
+                nextWakeMs = sensor->nextPollMs;
+            }
+        }
+
+        vTaskDelay(M2T(nextWakeMs - nowMs));
     }
 }
 
@@ -222,4 +310,55 @@ PARAM_GROUP_START(multiranger)
  */
 PARAM_ADD(PARAM_UINT16, filterMask, &filterMask)
 
+/**
+ * @brief Timing budget (ms) of each range measurement, all sensors are restarted when changed
+ *
+ * The measurement rate in each direction is roughly 1000 / budget Hz. Minimum 33 ms in the long distance mode and
+ * 20 ms in the short distance mode.
+ */
+PARAM_ADD(PARAM_UINT16, budget, &timingBudgetMs)
+
 PARAM_GROUP_STOP(multiranger)
+
+LOG_GROUP_START(multiranger)
+/**
+ * @brief Measurement rate of the front sensor [Hz]
+ */
+STATS_CNT_RATE_LOG_ADD(rtFront, &rateFront)
+/**
+ * @brief Measurement rate of the back sensor [Hz]
+ */
+STATS_CNT_RATE_LOG_ADD(rtBack, &rateBack)
+/**
+ * @brief Measurement rate of the up sensor [Hz]
+ */
+STATS_CNT_RATE_LOG_ADD(rtUp, &rateUp)
+/**
+ * @brief Measurement rate of the left sensor [Hz]
+ */
+STATS_CNT_RATE_LOG_ADD(rtLeft, &rateLeft)
+/**
+ * @brief Measurement rate of the right sensor [Hz]
+ */
+STATS_CNT_RATE_LOG_ADD(rtRight, &rateRight)
+/**
+ * @brief Time from when the latest front measurement was due until it was read [ms]
+ */
+LOG_ADD(LOG_UINT16, latFront, &sensors[0].latencyMs)
+/**
+ * @brief Time from when the latest back measurement was due until it was read [ms]
+ */
+LOG_ADD(LOG_UINT16, latBack, &sensors[1].latencyMs)
+/**
+ * @brief Time from when the latest up measurement was due until it was read [ms]
+ */
+LOG_ADD(LOG_UINT16, latUp, &sensors[2].latencyMs)
+/**
+ * @brief Time from when the latest left measurement was due until it was read [ms]
+ */
+LOG_ADD(LOG_UINT16, latLeft, &sensors[3].latencyMs)
+/**
+ * @brief Time from when the latest right measurement was due until it was read [ms]
+ */
+LOG_ADD(LOG_UINT16, latRight, &sensors[4].latencyMs)
+LOG_GROUP_STOP(multiranger)
@@ -30,9 +30,12 @@
 
 #include "stm32fxxx.h"
 #include "config.h"
+#include "FreeRTOS.h"
+#include "task.h"
 #include "deck.h"
 #include "debug.h"
 #include "log.h"
+#include "rpm.h"
 
 //Hardware configuration
 #define ET_GPIO_PERIF   (RCC_AHB1Periph_GPIOA | RCC_AHB1Periph_GPIOB | RCC_AHB1Periph_GPIOC)
@@ -91,6 +94,8 @@ static void rpmTestInit(DeckInfo *info)
   TIM_ICInitTypeDef  TIM_ICInitStructure;
   NVIC_InitTypeDef NVIC_InitStructure;
 
+  // The clock enable and gpio port registers are shared, decks may be initialized in parallel
+  taskENTER_CRITICAL();
   // Enable Clocks
   RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_GPIOA | RCC_AHB1Periph_GPIOB, ENABLE);
   RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM3 | RCC_APB1Periph_TIM5, ENABLE);
@@ -111,6 +116,7 @@ static void rpmTestInit(DeckInfo *info)
   GPIO_PinAFConfig(GPIOA, GPIO_PinSource3, GPIO_AF_TIM5);
   GPIO_PinAFConfig(GPIOB, GPIO_PinSource5, GPIO_AF_TIM3);
   GPIO_PinAFConfig(GPIOB, GPIO_PinSource4, GPIO_AF_TIM3);
+  taskEXIT_CRITICAL();
 
   /* Time base configuration */
   TIM_TimeBaseStructure.TIM_Period = 0xFFFF;
@@ -306,6 +312,23 @@ void __attribute__((used)) TIM3_IRQHandler(void)
   }
 }
 
+bool rpmIsActive(void)
+{
+  return isInit;
+}
+
+uint16_t rpmGetMotorRpm(uint8_t motor)
+{
+  switch (motor)
+  {
+    case 0: return m1rpm;
+    case 1: return m2rpm;
+    case 2: return m3rpm;
+    case 3: return m4rpm;
+    default: return 0;
+  }
+}
+
 static const DeckDriver rpm_deck = {
   .vid = 0x00,
   .pid = 0x00,
@@ -72,6 +72,8 @@ void servoMapInit(const MotorPerifDef* servoMapSelect)
   TIM_TimeBaseInitTypeDef  TIM_TimeBaseStructure;
   TIM_OCInitTypeDef  TIM_OCInitStructure;
 
+  // The clock enable and gpio port registers are shared, decks may be initialized in parallel
+  taskENTER_CRITICAL();
   //clock the servo pin and the timers
   RCC_AHB1PeriphClockCmd(servoMap->gpioPerif, ENABLE);
   RCC_APB1PeriphClockCmd(servoMap->timPerif, ENABLE);
@@ -86,6 +88,7 @@ void servoMapInit(const MotorPerifDef* servoMapSelect)
 
   //map timer to alternate function
   GPIO_PinAFConfig(servoMap->gpioPort, servoMap->gpioPinSource, servoMap->gpioAF);
+  taskEXIT_CRITICAL();
 
   //Timer configuration
   TIM_TimeBaseStructure.TIM_Period = SERVO_PWM_PERIOD;
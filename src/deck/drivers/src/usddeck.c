@@ -506,19 +506,22 @@ static void usddeckWriteEventData(const usdLogEventConfig_t* cfg, const uint8_t*
 
     for (int i = 0; i < cfg->numVars; ++i) {
       logVarId_t varid = cfg->varIds[i];
+      // Variables may be acquired by a function, get the value instead of reading the address
+      uint32_t value;
+      logGetValue(varid, &value);
       switch (logGetType(varid)) {
       case LOG_UINT8:
       case LOG_INT8:
-        ringBuffer_push(&logBuffer, logGetAddress(varid), sizeof(uint8_t));
+        ringBuffer_push(&logBuffer, &value, sizeof(uint8_t));
         break;
       case LOG_UINT16:
       case LOG_INT16:
-        ringBuffer_push(&logBuffer, logGetAddress(varid), sizeof(uint16_t));
+        ringBuffer_push(&logBuffer, &value, sizeof(uint16_t));
         break;
       case LOG_UINT32:
       case LOG_INT32:
       case LOG_FLOAT:
-        ringBuffer_push(&logBuffer, logGetAddress(varid), sizeof(uint32_t));
+        ringBuffer_push(&logBuffer, &value, sizeof(uint32_t));
         break;
       default:
         ASSERT(false);
@@ -793,6 +796,31 @@ bool usddeckRead(uint32_t offset, uint8_t* buffer, uint16_t length)
   return result;
 }
 
+bool usddeckWriteFile(const char* filename, const uint32_t size, usddeckFileDataReader_t reader)
+{
+  bool result = false;
+  if (initSuccess && xSemaphoreTake(logFileMutex, 0) == pdTRUE) {
+    if (f_open(&logFile, filename, FA_CREATE_ALWAYS | FA_WRITE) == FR_OK) {
+      uint8_t chunk[64];
+      uint32_t offset = 0;
+      result = true;
+      while (result && offset < size) {
+        const uint8_t length = (size - offset) < sizeof(chunk) ? (size - offset) : sizeof(chunk);
+        UINT bytesWritten;
+        result = reader(offset, length, chunk) &&
+                 f_write(&logFile, chunk, length, &bytesWritten) == FR_OK &&
+                 bytesWritten == length;
+        offset += length;
+      }
+      if (f_close(&logFile) != FR_OK) {
+        result = false;
+      }
+    }
+    xSemaphoreGive(logFileMutex);
+  }
+  return result;
+}
+
 static bool handleMemRead(const uint32_t memAddr, const uint8_t readLen, uint8_t* buffer) {
   bool result = false;
 
@@ -0,0 +1,46 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * deck_init_plan.h - Groups decks that can be initialized in parallel
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "deck_core.h"
+
+/**
+ * @brief Assign decks to init queues. Decks are initialized in enumeration order within a queue and the queues are
+ * initialized in parallel. Decks that share a peripheral, including the I2C and SPI buses, or a gpio are put in the
+ * same queue. A deck that does not declare any resources is put in the same queue as all other decks, that is all
+ * decks are initialized in sequence in queue 0. If there are more independent groups of decks than queues, several
+ * groups share a queue.
+ *
+ * @param decks The decks, with a driver
+ * @param count Number of decks
+ * @param maxQueues Max number of queues
+ * @param queue Output, the queue of each deck
+ * @return The number of queues that are used
+ */
+int deckInitPlan(const DeckInfo* decks, const int count, const int maxQueues, uint8_t* queue);
@@ -185,6 +185,24 @@ int8_t bmp3_get_op_mode(uint8_t *op_mode, const struct bmp3_dev *dev);
  */
 int8_t bmp3_get_sensor_data(uint8_t sensor_comp, struct bmp3_data *data, struct bmp3_dev *dev);
 
+/*!
+ * @brief This API compensates the pressure, temperature or both data that
+ * was read from the BMP3_P_T_DATA_LEN data registers at BMP3_DATA_ADDR by
+ * the user, for instance asynchronously, and stores it in the bmp3_data
+ * structure instance passed by the user.
+ *
+ * @param[in] sensor_comp : Variable which selects which data to be
+ * compensated, see bmp3_get_sensor_data.
+ * @param[in] reg_data : The data registers read from the sensor.
+ * @param[out] data : Structure instance of bmp3_data.
+ * @param[in] dev : Structure instance of bmp3_dev.
+ *
+ * @return Result of API execution status
+ * @retval zero -> Success / +ve value -> Warning / -ve value -> Error
+ */
+int8_t bmp3_compensate_sensor_data(uint8_t sensor_comp, const uint8_t *reg_data, struct bmp3_data *data,
+				struct bmp3_dev *dev);
+
 /*!
  * @brief This API writes the given data to the register address
  * of the sensor.
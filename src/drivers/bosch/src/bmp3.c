@@ -1218,7 +1218,6 @@ int8_t bmp3_get_sensor_data(uint8_t sensor_comp, struct bmp3_data *comp_data, st
 	/* Array to store the pressure and temperature data read from
 	the sensor */
 	uint8_t reg_data[BMP3_P_T_DATA_LEN] = {0};
-	struct bmp3_uncomp_data uncomp_data = {0};
 
 	/* Check for null pointer in the device structure*/
 	rslt = null_ptr_check(dev);
@@ -1228,11 +1227,7 @@ int8_t bmp3_get_sensor_data(uint8_t sensor_comp, struct bmp3_data *comp_data, st
 		rslt = bmp3_get_regs(BMP3_DATA_ADDR, reg_data, BMP3_P_T_DATA_LEN, dev);
 
 		if (rslt == BMP3_OK) {
-			/* Parse the read data from the sensor */
-			parse_sensor_data(reg_data, &uncomp_data);
-			/* Compensate the pressure/temperature/both data read
-			   from the sensor */
-			rslt = compensate_data(sensor_comp, &uncomp_data, comp_data, &dev->calib_data);
+			rslt = bmp3_compensate_sensor_data(sensor_comp, reg_data, comp_data, dev);
 		}
 	} else {
 		rslt = BMP3_E_NULL_PTR;
@@ -1241,6 +1236,25 @@ int8_t bmp3_get_sensor_data(uint8_t sensor_comp, struct bmp3_data *comp_data, st
 	return rslt;
 }
 
+/*!
+ * @brief This API compensates the pressure, temperature or both data that
+ * was read from the data registers by the user.
+ */
+int8_t bmp3_compensate_sensor_data(uint8_t sensor_comp, const uint8_t *reg_data, struct bmp3_data *comp_data,
+				struct bmp3_dev *dev)
+{
+	struct bmp3_uncomp_data uncomp_data = {0};
+
+	if ((reg_data == NULL) || (comp_data == NULL) || (dev == NULL))
+		return BMP3_E_NULL_PTR;
+
+	/* Parse the read data from the sensor */
+	parse_sensor_data(reg_data, &uncomp_data);
+	/* Compensate the pressure/temperature/both data read
+	   from the sensor */
+	return compensate_data(sensor_comp, &uncomp_data, comp_data, &dev->calib_data);
+}
+
 /****************** Static Function Definitions *******************************/
 /*!
  * @brief This internal API converts the no. of frames required by the user to
@@ -27,10 +27,25 @@
 #ifndef __EXTI_H__
 #define __EXTI_H__
 #include <stdbool.h>
+#include <stdint.h>
+
+#include "stm32fxxx.h"
 
 void extiInit();
 bool extiTest();
 
+/**
+ * @brief Route a gpio pin to its EXTI line and enable the line as an interrupt
+ *
+ * The SYSCFG and EXTI registers are shared by all lines and are updated in a
+ * critical section, drivers may be initialized from several tasks in parallel.
+ *
+ * @param portSource The port of the pin, EXTI_PortSourceGPIOx
+ * @param pinSource The pin number, EXTI_PinSourceN. The pin is routed to EXTI line N.
+ * @param trigger The edge(s) that trigger the interrupt
+ */
+void extiConfigureLine(const uint8_t portSource, const uint8_t pinSource, const EXTITrigger_TypeDef trigger);
+
 void EXTI0_Callback(void);
 void EXTI1_Callback(void);
 void EXTI2_Callback(void);
@@ -7,36 +7,22 @@
 /* ST includes */
 #include "stm32fxxx.h"
 
-#define I2C_NO_INTERNAL_ADDRESS   0xFFFF
+#include "i2c_queue.h"
 
-typedef enum
-{
-  i2cAck,
-  i2cNack
-} I2cStatus;
+#define I2C_NO_INTERNAL_ADDRESS   0xFFFF
 
-typedef enum
-{
-  i2cWrite,
-  i2cRead
-} I2cDirection;
+// Number of clients (slave addresses) that the bus time is accounted for, per bus
+#define I2C_MAX_CLIENTS           6
+// Client address used for the bus time of all clients that did not fit in the table
+#define I2C_CLIENT_OTHER          0xFF
 
-/**
- * Structure used to capture the I2C message details.  The structure is then
- * queued for processing by the I2C ISR.
- */
-typedef struct _I2cMessage
+// Bus time used by one client, identified by the slave address
+typedef struct
 {
-	uint32_t         messageLength;		  //< How many bytes of data to send or received.
-	uint8_t          slaveAddress;		  //< The slave address of the device on the I2C bus.
-  uint8_t          nbrOfRetries;      //< The slave address of the device on the I2C bus.
-	I2cDirection     direction;         //< Direction of message
-  I2cStatus        status;            //< i2c status
-  xQueueHandle     clientQueue;       //< Queue to send received messages to.
-  bool             isInternal16bit;   //< Is internal address 16 bit. If false 8 bit.
-  uint16_t         internalAddress;   //< Internal address of device.
-  uint8_t          *buffer;           //< Pointer to the buffer from where data will be read for transmission, or into which received data will be placed.
-} I2cMessage;
+  uint8_t  slaveAddress;
+  uint32_t busTimeUs;
+  uint32_t nbrOfMessages;
+} I2cClientStats;
 
 typedef struct
 {
@@ -69,10 +55,9 @@ typedef struct
   I2cMessage txMessage;                 //< The I2C send message
   uint32_t messageIndex;                //< Index of bytes sent/received
   uint32_t nbrOfretries;                //< Retries done
-  SemaphoreHandle_t isBusFreeSemaphore; //< Semaphore to block during transaction.
-  StaticSemaphore_t isBusFreeSemaphoreBuffer;
-  SemaphoreHandle_t isBusFreeMutex;     //< Mutex to protect bus
-  StaticSemaphore_t isBusFreeMutexBuffer;
+  I2cQueue queue;                       //< Transactions of the bus
+  uint64_t messageStartUs;              //< Time stamp of the start of the message in progress
+  I2cClientStats clients[I2C_MAX_CLIENTS]; //< Bus time per client
   DMA_InitTypeDef DMAStruct;            //< DMA configuration structure used during transfer setup.
 } I2cDrv;
 
@@ -88,7 +73,8 @@ void i2cdrvInit(I2cDrv* i2c);
 /**
  * Send or receive a message over the I2C bus.
  *
- * The message is synchrony by semapthore and uses interrupts to transfer the message.
+ * The message is queued behind the transactions already submitted to the bus
+ * and the caller is blocked until it is done.
  *
  * @param i2c      i2c bus to use.
  * @param message	 An I2cMessage struct containing all the i2c message
@@ -97,6 +83,57 @@ void i2cdrvInit(I2cDrv* i2c);
  */
 bool i2cdrvMessageTransfer(I2cDrv* i2c, I2cMessage* message);
 
+/**
+ * Transfer a chain of messages and block until it is done.
+ *
+ * The doneSemaphore of the transaction is replaced by an internal semaphore.
+ *
+ * @param i2c          i2c bus to use.
+ * @param transaction  The transaction, created with i2cdrvCreateTransaction().
+ * @return             true if all messages were acked, false otherwise.
+ */
+bool i2cdrvTransactionTransfer(I2cDrv* i2c, I2cTransaction* transaction);
+
+/**
+ * Create a transaction of one or more messages.
+ *
+ * @param transaction    pointer to transaction struct that will be filled in.
+ * @param messages       The messages, transferred in order.
+ * @param nbrOfMessages  Number of messages.
+ * @param callback       Called from the ISR when the transaction is done, may be NULL.
+ * @param callbackArg    Stored in the transaction for the callback.
+ */
+void i2cdrvCreateTransaction(I2cTransaction* transaction,
+                             I2cMessage* messages,
+                             uint8_t nbrOfMessages,
+                             I2cTransactionCallback callback,
+                             void* callbackArg);
+
+/**
+ * Queue a transaction on the bus without waiting for it. The transfer starts
+ * directly if the bus is free, otherwise when the transactions in front of it
+ * are done. Completion is signaled by the callback and/or the doneSemaphore
+ * of the transaction.
+ *
+ * Must not be called from an ISR.
+ *
+ * @param i2c          i2c bus to use.
+ * @param transaction  The transaction, must not already be queued.
+ * @return             false if the transaction was already queued.
+ */
+bool i2cdrvSubmitTransaction(I2cDrv* i2c, I2cTransaction* transaction);
+
+/**
+ * Remove a transaction from the bus queue, for instance after a timeout. If
+ * the transaction is in progress it is aborted and the bus is restarted.
+ * The callback is not called for a cancelled transaction.
+ *
+ * @param i2c          i2c bus to use.
+ * @param transaction  The transaction to cancel.
+ * @return             true if the transaction was cancelled, false if it was not queued (done already).
+ */
+bool i2cdrvCancelTransaction(I2cDrv* i2c, I2cTransaction* transaction);
+
 
 /**
  * Create a message to transfer
@@ -0,0 +1,170 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * i2c_queue.h - Transaction queue of an i2c bus, without the hardware
+ */
+#ifndef I2C_QUEUE_H
+#define I2C_QUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "queue.h"
+
+typedef enum
+{
+  i2cAck,
+  i2cNack
+} I2cStatus;
+
+typedef enum
+{
+  i2cWrite,
+  i2cRead
+} I2cDirection;
+
+/**
+ * Structure used to capture the I2C message details.  The structure is then
+ * queued for processing by the I2C ISR.
+ */
+typedef struct _I2cMessage
+{
+	uint32_t         messageLength;		  //< How many bytes of data to send or received.
+	uint8_t          slaveAddress;		  //< The slave address of the device on the I2C bus.
+  uint8_t          nbrOfRetries;      //< The slave address of the device on the I2C bus.
+	I2cDirection     direction;         //< Direction of message
+  I2cStatus        status;            //< i2c status
+  xQueueHandle     clientQueue;       //< Queue to send received messages to.
+  bool             isInternal16bit;   //< Is internal address 16 bit. If false 8 bit.
+  uint16_t         internalAddress;   //< Internal address of device.
+  uint8_t          *buffer;           //< Pointer to the buffer from where data will be read for transmission, or into which received data will be placed.
+} I2cMessage;
+
+typedef enum
+{
+  i2cTransactionIdle,
+  i2cTransactionQueued,
+  i2cTransactionDone,
+  i2cTransactionFailed
+} I2cTransactionState;
+
+struct _I2cTransaction;
+
+/**
+ * Completion callback of a transaction. Called from the I2C interrupt, must
+ * only use FromISR functions and set *higherPriorityTaskWoken if a task was
+ * woken. The transaction must not be submitted again from the callback.
+ */
+typedef void (*I2cTransactionCallback)(struct _I2cTransaction* transaction, BaseType_t* higherPriorityTaskWoken);
+
+/**
+ * A chain of messages that are transferred back to back, without other
+ * transactions on the bus in between. The transaction and the messages are
+ * owned by the client and must stay valid until the transaction is done.
+ */
+typedef struct _I2cTransaction
+{
+  I2cMessage*             messages;          //< The messages to transfer, in order.
+  uint8_t                 nbrOfMessages;     //< Number of messages in the chain.
+  I2cTransactionCallback  callback;          //< Called from the ISR when the transaction is done, may be NULL.
+  void*                   callbackArg;       //< Free for use by the callback.
+  SemaphoreHandle_t       doneSemaphore;     //< Given from the ISR when the transaction is done, may be NULL.
+  volatile I2cTransactionState state;        //< Done if all messages were acked, failed otherwise.
+  uint8_t                 messageIndex;      //< Index of the message in progress.
+  struct _I2cTransaction* next;              //< Next transaction in the bus queue.
+} I2cTransaction;
+
+/**
+ * The transactions of one bus and the state of the bus. The functions only
+ * update the queue and tell the driver what to do with the bus, they must be
+ * called from the bus ISR or with the bus ISR masked.
+ */
+typedef struct
+{
+  I2cTransaction* head;                 //< Transaction in progress, first in the queue
+  I2cTransaction* tail;                 //< Last transaction in the queue
+  bool isBusy;                          //< A transaction is in progress, starting or the bus is restarting
+  bool isStarting;                      //< The first message waits for the stop condition of the last transfer
+  bool isRestarting;                    //< The bus is restarted after a cancelled transfer
+} I2cQueue;
+
+/**
+ * Add a transaction to the end of the queue.
+ *
+ * @param queue        The queue.
+ * @param transaction  The transaction, must not already be queued.
+ * @param isBusFree    Set to true if the bus was idle. The driver waits for
+ *                     the bus to be free and calls i2cQueueStart().
+ * @return             false if the transaction was already queued.
+ */
+bool i2cQueueSubmit(I2cQueue* queue, I2cTransaction* transaction, bool* isBusFree);
+
+/**
+ * Start the transfer after i2cQueueSubmit() found the bus idle.
+ *
+ * @return  The message to start, NULL if the queue was emptied in between
+ *          and the bus is idle.
+ */
+I2cMessage* i2cQueueStart(I2cQueue* queue);
+
+/**
+ * True if a message is transferred, that is if the bus interrupts belong to
+ * the transaction at the head of the queue.
+ */
+bool i2cQueueIsTransferring(const I2cQueue* queue);
+
+/**
+ * End the message in progress. The next message of the transaction, or the
+ * first message of the next transaction, follows directly.
+ *
+ * @param queue            The queue.
+ * @param status           Status of the message.
+ * @param doneTransaction  Set to the transaction that was completed by the
+ *                         message, NULL if the transaction continues.
+ * @return                 The message to start with a repeated start, NULL if
+ *                         the queue is empty and the bus must be stopped.
+ */
+I2cMessage* i2cQueueMessageDone(I2cQueue* queue, const I2cStatus status, I2cTransaction** doneTransaction);
+
+/**
+ * Remove a transaction from the queue and mark it as failed.
+ *
+ * @param queue            The queue.
+ * @param transaction      The transaction to cancel.
+ * @param isRestartNeeded  Set to true if the transaction was transferred. The
+ *                         driver aborts the transfer, restarts the bus and
+ *                         calls i2cQueueRestartDone().
+ * @return                 false if the transaction was not queued.
+ */
+bool i2cQueueCancel(I2cQueue* queue, I2cTransaction* transaction, bool* isRestartNeeded);
+
+/**
+ * Resume the queue after the bus was restarted.
+ *
+ * @return  The message to start, NULL if the queue is empty and the bus is idle.
+ */
+I2cMessage* i2cQueueRestartDone(I2cQueue* queue);
+
+#endif
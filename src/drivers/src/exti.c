@@ -26,10 +26,13 @@
 #include <stdbool.h>
 
 #include "stm32fxxx.h"
+#include "FreeRTOS.h"
+#include "task.h"
 
 #include "exti.h"
 #include "nvicconf.h"
 #include "nrf24l01.h"
+#include "isr_monitor.h"
 
 static bool isInit;
 
@@ -89,43 +92,69 @@ bool extiTest(void)
   return isInit;
 }
 
+void extiConfigureLine(const uint8_t portSource, const uint8_t pinSource, const EXTITrigger_TypeDef trigger)
+{
+  EXTI_InitTypeDef EXTI_InitStructure;
+
+  EXTI_InitStructure.EXTI_Line = 1 << pinSource;
+  EXTI_InitStructure.EXTI_Mode = EXTI_Mode_Interrupt;
+  EXTI_InitStructure.EXTI_Trigger = trigger;
+  EXTI_InitStructure.EXTI_LineCmd = ENABLE;
+
+  taskENTER_CRITICAL();
+  SYSCFG_EXTILineConfig(portSource, pinSource);
+  EXTI_Init(&EXTI_InitStructure);
+  taskEXIT_CRITICAL();
+}
+
 void __attribute__((used)) EXTI0_IRQHandler(void)
 {
+  ISR_MONITOR_ENTER();
   NVIC_ClearPendingIRQ(EXTI0_IRQn);
   EXTI_ClearITPendingBit(EXTI_Line0);
   EXTI0_Callback();
+  ISR_MONITOR_EXIT();
 }
 
 void __attribute__((used)) EXTI1_IRQHandler(void)
 {
+  ISR_MONITOR_ENTER();
   NVIC_ClearPendingIRQ(EXTI1_IRQn);
   EXTI_ClearITPendingBit(EXTI_Line1);
   EXTI1_Callback();
+  ISR_MONITOR_EXIT();
 }
 
 void __attribute__((used)) EXTI2_IRQHandler(void)
 {
+  ISR_MONITOR_ENTER();
   NVIC_ClearPendingIRQ(EXTI2_IRQn);
   EXTI_ClearITPendingBit(EXTI_Line2);
   EXTI2_Callback();
+  ISR_MONITOR_EXIT();
 }
 
 void __attribute__((used)) EXTI3_IRQHandler(void)
 {
+  ISR_MONITOR_ENTER();
   NVIC_ClearPendingIRQ(EXTI3_IRQn);
   EXTI_ClearITPendingBit(EXTI_Line3);
   EXTI3_Callback();
+  ISR_MONITOR_EXIT();
 }
 
 void __attribute__((used)) EXTI4_IRQHandler(void)
 {
+  ISR_MONITOR_ENTER();
   NVIC_ClearPendingIRQ(EXTI4_IRQn);
   EXTI_ClearITPendingBit(EXTI_Line4);
   EXTI4_Callback();
+  ISR_MONITOR_EXIT();
 }
 
 void __attribute__((used)) EXTI9_5_IRQHandler(void)
 {
+  ISR_MONITOR_ENTER();
   NVIC_ClearPendingIRQ(EXTI9_5_IRQn);
   if (EXTI_GetITStatus(EXTI_Line5) == SET) {
     EXTI_ClearITPendingBit(EXTI_Line5);
@@ -151,10 +180,12 @@ void __attribute__((used)) EXTI9_5_IRQHandler(void)
     EXTI_ClearITPendingBit(EXTI_Line9);
     EXTI9_Callback();
   }
+  ISR_MONITOR_EXIT();
 }
 
 void __attribute__((used)) EXTI15_10_IRQHandler(void)
 {
+  ISR_MONITOR_ENTER();
   NVIC_ClearPendingIRQ(EXTI15_10_IRQn);
   if (EXTI_GetITStatus(EXTI_Line10) == SET) {
     EXTI_ClearITPendingBit(EXTI_Line10);
@@ -185,6 +216,7 @@ void __attribute__((used)) EXTI15_10_IRQHandler(void)
     EXTI_ClearITPendingBit(EXTI_Line15);
     EXTI15_Callback();
   }
+  ISR_MONITOR_EXIT();
 }
 
 void __attribute__((weak)) EXTI0_Callback(void) { }
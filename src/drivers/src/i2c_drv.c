@@ -50,11 +50,9 @@
 #include "sleepus.h"
 
 #include "autoconf.h"
-
-//DEBUG
-#ifdef I2CDRV_DEBUG_LOG_EVENTS
+#include "isr_monitor.h"
 #include "usec_time.h"
-#endif
+#include "log.h"
 
 // Definitions of sensors I2C bus
 #define I2C_DEFAULT_SENSORS_CLOCK_SPEED             400000
@@ -67,6 +65,8 @@
 #define I2C_SLAVE_ADDRESS7      0x30
 #define I2C_MAX_RETRIES         2
 #define I2C_MESSAGE_TIMEOUT     M2T(1000)
+// Max time to wait for the stop condition before starting the next message
+#define I2C_STOP_TIMEOUT_US     100
 
 // Helpers to unlock bus
 #define I2CDEV_CLK_TS (10)
@@ -98,6 +98,18 @@ static void i2cdrvDmaSetupBus(I2cDrv* i2c);
  * Start the i2c transfer
  */
 static void i2cdrvStartTransfer(I2cDrv *i2c);
+/**
+ * Start the transfer of a message, from the ISR or with the ISR masked
+ */
+static void i2cdrvStartMessage(I2cDrv *i2c, const I2cMessage* message);
+/**
+ * Wait for the stop condition of the last transfer to be sent
+ */
+static void i2cdrvWaitForStop(I2cDrv *i2c);
+/**
+ * Finish the message in progress and start the next one, if any
+ */
+static void i2cdrvMessageDone(I2cDrv *i2c);
 /**
  * Try to restart a hanged buss
  */
@@ -208,17 +220,82 @@ static void i2cdrvStartTransfer(I2cDrv *i2c)
   i2c->def->i2cPort->CR1 = (I2C_CR1_START | I2C_CR1_PE);
 }
 
-static void i2cTryNextMessage(I2cDrv* i2c)
+static void i2cdrvStartMessage(I2cDrv *i2c, const I2cMessage* message)
 {
-  i2c->def->i2cPort->CR1 = (I2C_CR1_STOP | I2C_CR1_PE);
-  I2C_ITConfig(i2c->def->i2cPort, I2C_IT_EVT | I2C_IT_BUF, DISABLE);
+  memcpy((char*)&i2c->txMessage, (char*)message, sizeof(I2cMessage));
+  i2c->messageStartUs = usecTimestamp();
+  i2cdrvStartTransfer(i2c);
+}
+
+static void i2cdrvWaitForStop(I2cDrv *i2c)
+{
+  // Writing CR1 while the stop is pending would cancel it
+  uint64_t start = usecTimestamp();
+  while ((i2c->def->i2cPort->CR1 & I2C_CR1_STOP) && usecTimestamp() - start <= I2C_STOP_TIMEOUT_US)
+  {
+  }
 }
 
-static void i2cNotifyClient(I2cDrv* i2c)
+static void i2cdrvAccountBusTime(I2cDrv* i2c, uint8_t slaveAddress, uint32_t busTimeUs)
 {
-  portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
-  xSemaphoreGiveFromISR(i2c->isBusFreeSemaphore, &xHigherPriorityTaskWoken);
-  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+  // When the table is full, the last entry is shared by the remaining clients
+  I2cClientStats* client = &i2c->clients[I2C_MAX_CLIENTS - 1];
+  for (int i = 0; i < I2C_MAX_CLIENTS; i++)
+  {
+    if (i2c->clients[i].nbrOfMessages == 0 || i2c->clients[i].slaveAddress == slaveAddress)
+    {
+      client = &i2c->clients[i];
+      break;
+    }
+  }
+
+  if (client->nbrOfMessages != 0 && client->slaveAddress != slaveAddress)
+  {
+    slaveAddress = I2C_CLIENT_OTHER;
+  }
+  client->slaveAddress = slaveAddress;
+  client->busTimeUs += busTimeUs;
+  client->nbrOfMessages++;
+}
+
+static void i2cdrvMessageDone(I2cDrv* i2c)
+{
+  I2C_ITConfig(i2c->def->i2cPort, I2C_IT_EVT | I2C_IT_BUF, DISABLE);
+
+  // The bus is restarted, or starting, by a task, the queue is not ours to update
+  if (!i2cQueueIsTransferring(&i2c->queue))
+  {
+    return;
+  }
+
+  i2cdrvAccountBusTime(i2c, i2c->txMessage.slaveAddress, (uint32_t)(usecTimestamp() - i2c->messageStartUs));
+
+  I2cTransaction* transaction;
+  I2cMessage* next = i2cQueueMessageDone(&i2c->queue, i2c->txMessage.status, &transaction);
+  if (next)
+  {
+    // Next message of the chain or next transaction, with a repeated start.
+    // The bus is not released and there is no stop condition to wait for.
+    i2cdrvStartMessage(i2c, next);
+  }
+  else
+  {
+    i2c->def->i2cPort->CR1 = (I2C_CR1_STOP | I2C_CR1_PE);
+  }
+
+  if (transaction)
+  {
+    portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+    if (transaction->callback)
+    {
+      transaction->callback(transaction, &xHigherPriorityTaskWoken);
+    }
+    if (transaction->doneSemaphore)
+    {
+      xSemaphoreGiveFromISR(transaction->doneSemaphore, &xHigherPriorityTaskWoken);
+    }
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+  }
 }
 
 static void i2cdrvTryToRestartBus(I2cDrv* i2c)
@@ -314,9 +391,6 @@ static void i2cdrvDmaSetupBus(I2cDrv* i2c)
 static void i2cdrvInitBus(I2cDrv* i2c)
 {
   i2cdrvTryToRestartBus(i2c);
-
-  i2c->isBusFreeSemaphore = xSemaphoreCreateBinaryStatic(&i2c->isBusFreeSemaphoreBuffer);
-  i2c->isBusFreeMutex = xSemaphoreCreateMutexStatic(&i2c->isBusFreeMutexBuffer);
 }
 
 static void i2cdrvdevUnlockBus(GPIO_TypeDef* portSCL, GPIO_TypeDef* portSDA, uint16_t pinSCL, uint16_t pinSDA)
@@ -399,32 +473,110 @@ void i2cdrvCreateMessageIntAddr(I2cMessage *message,
   message->nbrOfRetries = I2C_MAX_RETRIES;
 }
 
-bool i2cdrvMessageTransfer(I2cDrv* i2c, I2cMessage* message)
+void i2cdrvCreateTransaction(I2cTransaction* transaction,
+                             I2cMessage* messages,
+                             uint8_t nbrOfMessages,
+                             I2cTransactionCallback callback,
+                             void* callbackArg)
 {
-  bool status = false;
+  ASSERT(nbrOfMessages > 0);
+
+  transaction->messages = messages;
+  transaction->nbrOfMessages = nbrOfMessages;
+  transaction->callback = callback;
+  transaction->callbackArg = callbackArg;
+  transaction->doneSemaphore = 0;
+  transaction->state = i2cTransactionIdle;
+  transaction->messageIndex = 0;
+  transaction->next = 0;
+}
 
-  xSemaphoreTake(i2c->isBusFreeMutex, portMAX_DELAY); // Protect message data
-  // Copy message
-  memcpy((char*)&i2c->txMessage, (char*)message, sizeof(I2cMessage));
-  // We can now start the ISR sending this message.
-  i2cdrvStartTransfer(i2c);
-  // Wait for transaction to be done
-  if (xSemaphoreTake(i2c->isBusFreeSemaphore, I2C_MESSAGE_TIMEOUT) == pdTRUE)
+bool i2cdrvSubmitTransaction(I2cDrv* i2c, I2cTransaction* transaction)
+{
+  bool isBusFree;
+
+  taskENTER_CRITICAL();
+  const bool isSubmitted = i2cQueueSubmit(&i2c->queue, transaction, &isBusFree);
+  taskEXIT_CRITICAL();
+
+  if (isBusFree)
   {
-    if (i2c->txMessage.status == i2cAck)
+    // The stop condition of the last transfer may still be pending. Wait for
+    // it here, with the interrupts enabled. Transactions submitted meanwhile
+    // are queued behind this one.
+    i2cdrvWaitForStop(i2c);
+
+    taskENTER_CRITICAL();
+    I2cMessage* message = i2cQueueStart(&i2c->queue);
+    if (message)
     {
-      status = true;
+      i2cdrvStartMessage(i2c, message);
     }
+    taskEXIT_CRITICAL();
   }
-  else
+
+  return isSubmitted;
+}
+
+bool i2cdrvCancelTransaction(I2cDrv* i2c, I2cTransaction* transaction)
+{
+  bool isRestartNeeded;
+
+  taskENTER_CRITICAL();
+  const bool isCancelled = i2cQueueCancel(&i2c->queue, transaction, &isRestartNeeded);
+  if (isRestartNeeded)
   {
+    // Make sure the ISRs do not touch the bus or the queue until it is restarted
+    I2C_ITConfig(i2c->def->i2cPort, I2C_IT_EVT | I2C_IT_BUF | I2C_IT_ERR, DISABLE);
     i2cdrvClearDMA(i2c);
+  }
+  taskEXIT_CRITICAL();
+
+  if (isRestartNeeded)
+  {
     i2cdrvTryToRestartBus(i2c);
     //TODO: If bus is really hanged... fail safe
+
+    // Transactions that were queued during the restart. The peripheral was
+    // reset, there is no stop condition to wait for.
+    taskENTER_CRITICAL();
+    I2cMessage* message = i2cQueueRestartDone(&i2c->queue);
+    if (message)
+    {
+      i2cdrvStartMessage(i2c, message);
+    }
+    taskEXIT_CRITICAL();
+  }
+
+  return isCancelled;
+}
+
+bool i2cdrvTransactionTransfer(I2cDrv* i2c, I2cTransaction* transaction)
+{
+  StaticSemaphore_t doneSemaphoreBuffer;
+  transaction->doneSemaphore = xSemaphoreCreateBinaryStatic(&doneSemaphoreBuffer);
+
+  if (!i2cdrvSubmitTransaction(i2c, transaction))
+  {
+    transaction->doneSemaphore = 0;
+    return false;
   }
-  xSemaphoreGive(i2c->isBusFreeMutex);
+  // Wait for transaction to be done
+  if (xSemaphoreTake(transaction->doneSemaphore, I2C_MESSAGE_TIMEOUT) != pdTRUE)
+  {
+    i2cdrvCancelTransaction(i2c, transaction);
+  }
+  transaction->doneSemaphore = 0;
+
+  return transaction->state == i2cTransactionDone;
+}
 
-  return status;
+bool i2cdrvMessageTransfer(I2cDrv* i2c, I2cMessage* message)
+{
+  I2cTransaction transaction;
+  i2cdrvCreateTransaction(&transaction, message, 1, 0, 0);
+
+  return i2cdrvTransactionTransfer(i2c, &transaction);
 }
 
 
@@ -525,9 +677,8 @@ static void i2cdrvEventIsrHandler(I2cDrv* i2c)
       }
       else
       {
-        i2cNotifyClient(i2c);
-        // Are there any other messages to transact? If so stop else repeated start.
-        i2cTryNextMessage(i2c);
+        // Are there any other messages to transact?
+        i2cdrvMessageDone(i2c);
       }
     }
     else // Reading. Shouldn't happen since we use DMA for reading.
@@ -536,9 +687,8 @@ static void i2cdrvEventIsrHandler(I2cDrv* i2c)
       i2c->txMessage.buffer[i2c->messageIndex++] = I2C_ReceiveData(i2c->def->i2cPort);
       if(i2c->messageIndex == i2c->txMessage.messageLength)
       {
-        i2cNotifyClient(i2c);
         // Are there any other messages to transact?
-        i2cTryNextMessage(i2c);
+        i2cdrvMessageDone(i2c);
       }
     }
     // A second BTF interrupt might occur if we don't wait for it to clear.
@@ -582,6 +732,13 @@ static void i2cdrvEventIsrHandler(I2cDrv* i2c)
 
 static void i2cdrvErrorIsrHandler(I2cDrv* i2c)
 {
+  // Errors while the bus is restarted do not belong to any transaction
+  if (!i2cQueueIsTransferring(&i2c->queue))
+  {
+    I2C_ClearFlag(i2c->def->i2cPort, I2C_FLAG_AF | I2C_FLAG_BERR | I2C_FLAG_OVR | I2C_FLAG_ARLO);
+    return;
+  }
+
   if (I2C_GetFlagStatus(i2c->def->i2cPort, I2C_FLAG_AF))
   {
     if(i2c->txMessage.nbrOfRetries-- > 0)
@@ -593,8 +750,7 @@ static void i2cdrvErrorIsrHandler(I2cDrv* i2c)
     {
       // Failed so notify client and try next message if any.
       i2c->txMessage.status = i2cNack;
-      i2cNotifyClient(i2c);
-      i2cTryNextMessage(i2c);
+      i2cdrvMessageDone(i2c);
     }
     I2C_ClearFlag(i2c->def->i2cPort, I2C_FLAG_AF);
   }
@@ -634,20 +790,23 @@ static void i2cdrvDmaIsrHandler(I2cDrv* i2c)
     i2c->txMessage.status = i2cAck;
   }
   i2cdrvClearDMA(i2c);
-  i2cNotifyClient(i2c);
   // Are there any other messages to transact?
-  i2cTryNextMessage(i2c);
+  i2cdrvMessageDone(i2c);
 }
 
 
 void __attribute__((used)) I2C1_ER_IRQHandler(void)
 {
+  ISR_MONITOR_ENTER();
   i2cdrvErrorIsrHandler(&deckBus);
+  ISR_MONITOR_EXIT();
 }
 
 void __attribute__((used)) I2C1_EV_IRQHandler(void)
 {
+  ISR_MONITOR_ENTER();
   i2cdrvEventIsrHandler(&deckBus);
+  ISR_MONITOR_EXIT();
 }
 
 #ifdef CONFIG_DECK_USD_USE_ALT_PINS_AND_SPI
@@ -656,20 +815,140 @@ void __attribute__((used)) DMA1_Stream5_IRQHandler(void)
 void __attribute__((used)) DMA1_Stream0_IRQHandler(void)
 #endif
 {
+  ISR_MONITOR_ENTER();
   i2cdrvDmaIsrHandler(&deckBus);
+  ISR_MONITOR_EXIT();
 }
 
 void __attribute__((used)) I2C3_ER_IRQHandler(void)
 {
+  ISR_MONITOR_ENTER();
   i2cdrvErrorIsrHandler(&sensorsBus);
+  ISR_MONITOR_EXIT();
 }
 
 void __attribute__((used)) I2C3_EV_IRQHandler(void)
 {
+  ISR_MONITOR_ENTER();
   i2cdrvEventIsrHandler(&sensorsBus);
+  ISR_MONITOR_EXIT();
 }
 
 void __attribute__((used)) DMA1_Stream2_IRQHandler(void)
 {
+  ISR_MONITOR_ENTER();
   i2cdrvDmaIsrHandler(&sensorsBus);
+  ISR_MONITOR_EXIT();
 }
+
+/**
+ * Bus time per client of the deck I2C bus (EEPROMs and expansion decks). A client is identified by
+ * its slave address, 0xFF is the sum of the clients that did not fit in the
+ * table.
+ */
+LOG_GROUP_START(i2cDeck)
+/**
+ * @brief Slave address of client 0
+ */
+LOG_ADD(LOG_UINT8, addr0, &deckBus.clients[0].slaveAddress)
+/**
+ * @brief Accumulated bus time of client 0 [us]
+ */
+LOG_ADD(LOG_UINT32, us0, &deckBus.clients[0].busTimeUs)
+/**
+ * @brief Slave address of client 1
+ */
+LOG_ADD(LOG_UINT8, addr1, &deckBus.clients[1].slaveAddress)
+/**
+ * @brief Accumulated bus time of client 1 [us]
+ */
+LOG_ADD(LOG_UINT32, us1, &deckBus.clients[1].busTimeUs)
+/**
+ * @brief Slave address of client 2
+ */
+LOG_ADD(LOG_UINT8, addr2, &deckBus.clients[2].slaveAddress)
+/**
+ * @brief Accumulated bus time of client 2 [us]
+ */
+LOG_ADD(LOG_UINT32, us2, &deckBus.clients[2].busTimeUs)
+/**
+ * @brief Slave address of client 3
+ */
+LOG_ADD(LOG_UINT8, addr3, &deckBus.clients[3].slaveAddress)
+/**
+ * @brief Accumulated bus time of client 3 [us]
+ */
+LOG_ADD(LOG_UINT32, us3, &deckBus.clients[3].busTimeUs)
+/**
+ * @brief Slave address of client 4
+ */
+LOG_ADD(LOG_UINT8, addr4, &deckBus.clients[4].slaveAddress)
+/**
+ * @brief Accumulated bus time of client 4 [us]
+ */
+LOG_ADD(LOG_UINT32, us4, &deckBus.clients[4].busTimeUs)
+/**
+ * @brief Slave address of client 5
+ */
+LOG_ADD(LOG_UINT8, addr5, &deckBus.clients[5].slaveAddress)
+/**
+ * @brief Accumulated bus time of client 5 [us]
+ */
+LOG_ADD(LOG_UINT32, us5, &deckBus.clients[5].busTimeUs)
+LOG_GROUP_STOP(i2cDeck)
+
+/**
+ * Bus time per client of the sensor I2C bus. A client is identified by
+ * its slave address, 0xFF is the sum of the clients that did not fit in the
+ * table.
+ */
+LOG_GROUP_START(i2cSensors)
+/**
+ * @brief Slave address of client 0
+ */
+LOG_ADD(LOG_UINT8, addr0, &sensorsBus.clients[0].slaveAddress)
+/**
+ * @brief Accumulated bus time of client 0 [us]
+ */
+LOG_ADD(LOG_UINT32, us0, &sensorsBus.clients[0].busTimeUs)
+/**
+ * @brief Slave address of client 1
+ */
+LOG_ADD(LOG_UINT8, addr1, &sensorsBus.clients[1].slaveAddress)
+/**
+ * @brief Accumulated bus time of client 1 [us]
+ */
+LOG_ADD(LOG_UINT32, us1, &sensorsBus.clients[1].busTimeUs)
+/**
+ * @brief Slave address of client 2
+ */
+LOG_ADD(LOG_UINT8, addr2, &sensorsBus.clients[2].slaveAddress)
+/**
+ * @brief Accumulated bus time of client 2 [us]
+ */
+LOG_ADD(LOG_UINT32, us2, &sensorsBus.clients[2].busTimeUs)
+/**
+ * @brief Slave address of client 3
+ */
+LOG_ADD(LOG_UINT8, addr3, &sensorsBus.clients[3].slaveAddress)
+/**
+ * @brief Accumulated bus time of client 3 [us]
+ */
+LOG_ADD(LOG_UINT32, us3, &sensorsBus.clients[3].busTimeUs)
+/**
+ * @brief Slave address of client 4
+ */
+LOG_ADD(LOG_UINT8, addr4, &sensorsBus.clients[4].slaveAddress)
+/**
+ * @brief Accumulated bus time of client 4 [us]
+ */
+LOG_ADD(LOG_UINT32, us4, &sensorsBus.clients[4].busTimeUs)
+/**
+ * @brief Slave address of client 5
+ */
+LOG_ADD(LOG_UINT8, addr5, &sensorsBus.clients[5].slaveAddress)
+/**
+ * @brief Accumulated bus time of client 5 [us]
+ */
+LOG_ADD(LOG_UINT32, us5, &sensorsBus.clients[5].busTimeUs)
+LOG_GROUP_STOP(i2cSensors)
@@ -0,0 +1,162 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * i2c_queue.c - Transaction queue of an i2c bus, without the hardware
+ */
+
+#include "i2c_queue.h"
+
+static I2cMessage* firstMessageOrIdle(I2cQueue* queue)
+{
+  if (queue->head)
+  {
+    queue->head->messageIndex = 0;
+    return &queue->head->messages[0];
+  }
+
+  queue->isBusy = false;
+  return 0;
+}
+
+bool i2cQueueSubmit(I2cQueue* queue, I2cTransaction* transaction, bool* isBusFree)
+{
+  *isBusFree = false;
+
+  if (transaction->state == i2cTransactionQueued)
+  {
+    return false;
+  }
+
+  transaction->state = i2cTransactionQueued;
+  transaction->messageIndex = 0;
+  transaction->next = 0;
+
+  if (queue->tail)
+  {
+    queue->tail->next = transaction;
+  }
+  else
+  {
+    queue->head = transaction;
+  }
+  queue->tail = transaction;
+
+  if (!queue->isBusy)
+  {
+    queue->isBusy = true;
+    queue->isStarting = true;
+    *isBusFree = true;
+  }
+
+  return true;
+}
+
+I2cMessage* i2cQueueStart(I2cQueue* queue)
+{
+  queue->isStarting = false;
+  return firstMessageOrIdle(queue);
+}
+
+bool i2cQueueIsTransferring(const I2cQueue* queue)
+{
+  return queue->head != 0 && queue->isBusy && !queue->isStarting && !queue->isRestarting;
+}
+
+I2cMessage* i2cQueueMessageDone(I2cQueue* queue, const I2cStatus status, I2cTransaction** doneTransaction)
+{
+  *doneTransaction = 0;
+
+  if (!i2cQueueIsTransferring(queue))
+  {
+    return 0;
+  }
+
+  I2cTransaction* transaction = queue->head;
+  transaction->messages[transaction->messageIndex].status = status;
+
+  // Next message in the chain, the bus is not released in between
+  if (status == i2cAck && transaction->messageIndex + 1 < transaction->nbrOfMessages)
+  {
+    transaction->messageIndex++;
+    return &transaction->messages[transaction->messageIndex];
+  }
+
+  queue->head = transaction->next;
+  if (queue->head == 0)
+  {
+    queue->tail = 0;
+  }
+  transaction->next = 0;
+  transaction->state = (status == i2cAck) ? i2cTransactionDone : i2cTransactionFailed;
+  *doneTransaction = transaction;
+
+  return firstMessageOrIdle(queue);
+}
+
+bool i2cQueueCancel(I2cQueue* queue, I2cTransaction* transaction, bool* isRestartNeeded)
+{
+  *isRestartNeeded = false;
+
+  if (transaction->state != i2cTransactionQueued)
+  {
+    return false;
+  }
+
+  if (queue->head == transaction && i2cQueueIsTransferring(queue))
+  {
+    *isRestartNeeded = true;
+    queue->isRestarting = true;
+  }
+
+  I2cTransaction* previous = 0;
+  for (I2cTransaction* t = queue->head; t != 0; previous = t, t = t->next)
+  {
+    if (t == transaction)
+    {
+      if (previous)
+      {
+        previous->next = t->next;
+      }
+      else
+      {
+        queue->head = t->next;
+      }
+      if (queue->tail == t)
+      {
+        queue->tail = previous;
+      }
+      break;
+    }
+  }
+
+  transaction->next = 0;
+  transaction->state = i2cTransactionFailed;
+
+  return true;
+}
+
+I2cMessage* i2cQueueRestartDone(I2cQueue* queue)
+{
+  queue->isRestarting = false;
+  return firstMessageOrIdle(queue);
+}
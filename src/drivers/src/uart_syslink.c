@@ -44,6 +44,7 @@
 #include "config.h"
 #include "queuemonitor.h"
 #include "static_mem.h"
+#include "isr_monitor.h"
 
 #define DEBUG_MODULE "U-SLK"
 #include "debug.h"
@@ -624,18 +625,24 @@ void __attribute__((used)) EXTI4_Callback(void)
 
 void __attribute__((used)) USART6_IRQHandler(void)
 {
+  ISR_MONITOR_ENTER();
   uartslkIsr();
+  ISR_MONITOR_EXIT();
 }
 
 void __attribute__((used)) DMA2_Stream7_IRQHandler(void)
 {
+  ISR_MONITOR_ENTER();
   uartslkDmaTXIsr();
+  ISR_MONITOR_EXIT();
 }
 
 #ifdef CONFIG_SYSLINK_RX_DMA
 void __attribute__((used)) DMA2_Stream1_IRQHandler(void)
 {
+  ISR_MONITOR_ENTER();
   uartslkDmaRXIsr();
+  ISR_MONITOR_EXIT();
 }
 #endif
 
@@ -34,6 +34,7 @@
 
 #include "FreeRTOS.h"
 #include "semphr.h"
+#include "task.h"
 
 #include "autoconf.h"
 
@@ -68,6 +69,8 @@ void ws2812Init(void)
 {
 	uint16_t PrescalerValue;
 
+  // The clock enable and gpio port registers are shared, decks may be initialized in parallel
+  taskENTER_CRITICAL();
   RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_GPIOB, ENABLE);
   RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM3, ENABLE);
 	/* GPIOB Configuration: TIM3 Channel 1 as alternate function push-pull */
@@ -86,6 +89,7 @@ void ws2812Init(void)
 
   //Map timer to alternate functions
   GPIO_PinAFConfig(GPIOB, GPIO_PinSource5, GPIO_AF_TIM3);
+  taskEXIT_CRITICAL();
 
 	/* Compute the prescaler value */
 	PrescalerValue = 0;
@@ -225,16 +225,20 @@ static graceful_shutdown_callback_t graceful_shutdown_callbacks[GRACEFUL_SHUTDOW
  */
 bool pmRegisterGracefulShutdownCallback(graceful_shutdown_callback_t cb)
 {
+  bool isRegistered = false;
+
+  // Decks may be initialized in parallel
+  taskENTER_CRITICAL();
   // To many registered already! Increase limit if you think you are important
   // enough!
-  if (graceful_shutdown_callbacks_index >= GRACEFUL_SHUTDOWN_MAX_CALLBACKS) {
-    return false;
+  if (graceful_shutdown_callbacks_index < GRACEFUL_SHUTDOWN_MAX_CALLBACKS) {
+    graceful_shutdown_callbacks[graceful_shutdown_callbacks_index] = cb;
+    graceful_shutdown_callbacks_index += 1;
+    isRegistered = true;
   }
+  taskEXIT_CRITICAL();
 
-  graceful_shutdown_callbacks[graceful_shutdown_callbacks_index] = cb;
-  graceful_shutdown_callbacks_index += 1;
-
-  return true;
+  return isRegistered;
 }
 
 /*
@@ -43,9 +43,11 @@
 #include "log.h"
 #include "debug.h"
 #include "nvicconf.h"
+#include "exti.h"
 #include "ledseq.h"
 #include "sound.h"
 #include "filter.h"
+#include "cycle_counter.h"
 #include "i2cdev.h"
 #include "bmi088.h"
 #include "bmp3.h"
@@ -56,6 +58,17 @@
 #include "sensors_bmi088_common.h"
 #include "platform_defaults.h"
 
+#ifdef CONFIG_SENSORS_GYRO_SPECTRUM
+#include "gyro_spectrum.h"
+#endif
+
+#ifdef CONFIG_SENSORS_GYRO_DYN_NOTCH
+#include "motors.h"
+#ifdef CONFIG_DECK_RPM
+#include "rpm.h"
+#endif
+#endif
+
 #define GYRO_ADD_RAW_AND_VARIANCE_LOG_VALUES
 
 #define SENSORS_READ_RATE_HZ            1000
@@ -65,6 +78,19 @@
 #define SENSORS_DELAY_BARO              (SENSORS_READ_RATE_HZ/SENSORS_READ_BARO_HZ)
 #define SENSORS_DELAY_MAG               (SENSORS_READ_RATE_HZ/SENSORS_READ_MAG_HZ)
 
+#ifdef CONFIG_SENSORS_BMI088_GYRO_FIFO
+// The gyro runs at 2 kHz and the samples of CONFIG_SENSORS_BMI088_GYRO_FIFO_LOOPS_PER_READ stabilizer
+// loops are read from the FIFO per interrupt. The stabilizer is released once per loop of samples.
+#define SENSORS_GYRO_RATE_HZ            2000
+#define GYRO_FIFO_SAMPLE_PERIOD_US      (1000000 / SENSORS_GYRO_RATE_HZ)
+#define GYRO_FIFO_SAMPLES_PER_LOOP      (SENSORS_GYRO_RATE_HZ / SENSORS_READ_RATE_HZ)
+#define GYRO_FIFO_WATERMARK             (GYRO_FIFO_SAMPLES_PER_LOOP * CONFIG_SENSORS_BMI088_GYRO_FIFO_LOOPS_PER_READ)
+_Static_assert(GYRO_FIFO_WATERMARK < SENSORS_BMI088_GYRO_FIFO_MAX_FRAMES, "The gyro FIFO watermark must leave room for late samples");
+#else
+#define SENSORS_GYRO_RATE_HZ            SENSORS_READ_RATE_HZ
+#endif
+#define SENSORS_ACC_RATE_HZ             SENSORS_READ_RATE_HZ
+
 #define SENSORS_BMI088_GYRO_FS_CFG      BMI088_GYRO_RANGE_2000_DPS
 #define SENSORS_BMI088_DEG_PER_LSB_CFG  (2.0f *2000.0f) / 65536.0f
 
@@ -126,6 +152,12 @@ static volatile uint64_t imuIntTimestamp;
 
 static Axis3i16 gyroRaw;
 static Axis3i16 accelRaw;
+#ifdef CONFIG_SENSORS_BMI088_GYRO_FIFO
+static Axis3i16 gyroFifoRaw[SENSORS_BMI088_GYRO_FIFO_MAX_FRAMES];
+static uint32_t gyroFifoSampleCount = 0;
+static uint32_t gyroFifoOverrunCount = 0;
+static uint8_t gyroFifoMaxFrames = 0;
+#endif
 NO_DMA_CCM_SAFE_ZERO_INIT static BiasObj gyroBiasRunning;
 static Axis3f gyroBias;
 #if defined(SENSORS_GYRO_BIAS_CALCULATE_STDDEV) && defined (GYRO_BIAS_LIGHT_WEIGHT)
@@ -138,14 +170,33 @@ static bool accScaleFound = false;
 static uint32_t accScaleSumCount = 0;
 
 // Low Pass filtering
+#ifdef CONFIG_SENSORS_GYRO_LPF_CUTOFF_HZ
+#define GYRO_LPF_CUTOFF_FREQ  CONFIG_SENSORS_GYRO_LPF_CUTOFF_HZ
+#else
 #define GYRO_LPF_CUTOFF_FREQ  80
+#endif
 #define ACCEL_LPF_CUTOFF_FREQ 30
-static lpf2pData accLpf[3];
-static lpf2pData gyroLpf[3];
-static void applyAxis3fLpf(lpf2pData *data, Axis3f* in);
+static biquadNData accLpf;
+static biquadNData gyroLpf;
+// Cycles spent in the last call to the filters
+static uint32_t gyroFilterCycles;
+static uint32_t accFilterCycles;
+
+#ifdef CONFIG_SENSORS_GYRO_DYN_NOTCH
+// Notch filters following the motor speeds
+static dynNotchData gyroNotch;
+static float gyroNotchQ = 3.0f;
+static float gyroNotchMinHz = 60.0f;
+// Motor rotation frequency at full motor command, used to estimate the motor speeds without the rpm deck
+static float gyroNotchFullThrottleHz = 400.0f;
+static void updateGyroNotch(void);
+#endif
 
 static bool isBarometerPresent = false;
 static uint8_t baroMeasDelayMin = SENSORS_DELAY_BARO;
+static I2cMessage baroMessage;
+static I2cTransaction baroTransaction;
+static uint8_t baroData[BMP3_P_T_DATA_LEN];
 
 // IMU alignment Euler angles
 static float imuPhi = IMU_PHI;
@@ -242,6 +293,86 @@ static uint16_t sensorsGyroGet(Axis3i16* dataOut)
   return bmi088_get_gyro_data((struct bmi088_sensor_data*)dataOut, &bmi088Dev);
 }
 
+#ifdef CONFIG_SENSORS_BMI088_GYRO_FIFO
+/**
+ * Reads frames from the gyro FIFO in one burst, the caller knows they are available.
+ * The FIFO holds x, y, z as little endian int16 in the same layout as Axis3i16.
+ *
+ * @return The number of frames read
+ */
+static uint32_t sensorsGyroFifoRead(Axis3i16* dataOut, uint32_t frames)
+{
+  if (bmi088_get_gyro_regs(BMI088_GYRO_FIFO_DATA_REG, (uint8_t*)dataOut, frames * sizeof(Axis3i16), &bmi088Dev) != BMI088_OK)
+  {
+    return 0;
+  }
+
+  return frames;
+}
+
+/**
+ * Reads all frames available in the gyro FIFO (up to maxFrames) in one burst.
+ *
+ * @return The number of frames read
+ */
+static uint32_t sensorsGyroFifoGet(Axis3i16* dataOut, uint32_t maxFrames)
+{
+  uint8_t status = 0;
+  if (bmi088_get_gyro_regs(BMI088_GYRO_FIFO_STAT_REG, &status, 1, &bmi088Dev) != BMI088_OK)
+  {
+    return 0;
+  }
+
+  if (status & BMI088_GYRO_FIFO_OVERRUN_MASK)
+  {
+    gyroFifoOverrunCount++;
+  }
+
+  uint32_t frames = status & BMI088_GYRO_FIFO_COUNTER_MASK;
+  if (frames > gyroFifoMaxFrames)
+  {
+    gyroFifoMaxFrames = frames;
+  }
+  if (frames > maxFrames)
+  {
+    frames = maxFrames;
+  }
+
+  if (frames > 0)
+  {
+    frames = sensorsGyroFifoRead(dataOut, frames);
+  }
+
+  return frames;
+}
+
+/**
+ * Sets up the gyro FIFO in stream mode with an interrupt on INT3 when the
+ * watermark is reached. Replaces the data ready interrupt.
+ */
+static uint16_t sensorsGyroFifoInit(void)
+{
+  uint16_t rslt;
+  uint8_t data;
+  struct bmi088_int_cfg intConfig;
+
+  rslt = bmi088_set_gyro_fifo_mode(BMI088_GYRO_STREAM_OP_MODE, &bmi088Dev);
+  rslt |= bmi088_set_gyro_fifo_wm(GYRO_FIFO_WATERMARK, &bmi088Dev);
+
+  intConfig.gyro_int_channel = BMI088_INT_CHANNEL_3;
+  intConfig.gyro_int_pin_3_cfg.enable_int_pin = 1;
+  intConfig.gyro_int_pin_3_cfg.lvl = 1;
+  intConfig.gyro_int_pin_3_cfg.output_mode = 0;
+  rslt |= bmi088_set_gyro_fifo_wm_int(&intConfig, &bmi088Dev, 1);
+
+  // Enable the FIFO interrupt, with data ready disabled
+  data = BMI088_GYRO_FIFO_EN_MASK;
+  rslt |= bmi088_set_gyro_regs(BMI088_GYRO_INT_CTRL_REG, &data, 1, &bmi088Dev);
+
+  return rslt;
+}
+#endif
+
 static void sensorsAccelGet(Axis3i16* dataOut)
 {
   bmi088_get_accel_data((struct bmi088_sensor_data*)dataOut, &bmi088Dev);
@@ -290,14 +421,175 @@ bool sensorsBmi088Bmp3xxAreCalibrated()
   return gyroBiasFound;
 }
 
-static void sensorsTask(void *param)
+static void processGyroSample(const Axis3i16* raw)
 {
-  systemWaitStart();
-
   Axis3f gyroScaledIMU;
+
+  /* calibrate if necessary */
+#ifdef GYRO_BIAS_LIGHT_WEIGHT
+  gyroBiasFound = processGyroBiasNoBuffer(raw->x, raw->y, raw->z, &gyroBias);
+#else
+  gyroBiasFound = processGyroBias(raw->x, raw->y, raw->z, &gyroBias);
+#endif
+
+  gyroScaledIMU.x =  (raw->x - gyroBias.x) * SENSORS_BMI088_DEG_PER_LSB_CFG;
+  gyroScaledIMU.y =  (raw->y - gyroBias.y) * SENSORS_BMI088_DEG_PER_LSB_CFG;
+  gyroScaledIMU.z =  (raw->z - gyroBias.z) * SENSORS_BMI088_DEG_PER_LSB_CFG;
+  sensorsAlignToAirframe(&gyroScaledIMU, &sensorData.gyro);
+#ifdef CONFIG_SENSORS_GYRO_SPECTRUM
+  gyroSpectrumAddSample(&sensorData.gyro);
+#endif
+
+  const uint32_t filterStart = cycleCounterGet();
+#ifdef CONFIG_SENSORS_GYRO_DYN_NOTCH
+  dynNotchApply(&gyroNotch, sensorData.gyro.axis);
+#endif
+  biquadNApply(&gyroLpf, sensorData.gyro.axis);
+  gyroFilterCycles = cycleCounterGet() - filterStart;
+}
+
+#ifdef CONFIG_SENSORS_GYRO_DYN_NOTCH
+static void updateGyroNotch(void)
+{
+  gyroNotch.q = gyroNotchQ;
+  gyroNotch.minFreq = gyroNotchMinHz;
+
+  for (uint8_t i = 0; i < NBR_OF_MOTORS; i++)
+  {
+    float freq;
+#ifdef CONFIG_DECK_RPM
+    if (rpmIsActive())
+    {
+      freq = rpmGetMotorRpm(i) / 60.0f;
+    }
+    else
+#endif
+    {
+      freq = motorsGetRatio(i) * gyroNotchFullThrottleHz / UINT16_MAX;
+    }
+    dynNotchSetFreq(&gyroNotch, i, freq);
+  }
+}
+#endif
+
+static void processAccSample(const Axis3i16* raw)
+{
   Axis3f accScaledIMU;
   Axis3f accScaled;
-  measurement_t measurement;
+
+  if (gyroBiasFound)
+  {
+     processAccScale(raw->x, raw->y, raw->z);
+  }
+
+  accScaledIMU.x = raw->x * SENSORS_BMI088_G_PER_LSB_CFG / accScale;
+  accScaledIMU.y = raw->y * SENSORS_BMI088_G_PER_LSB_CFG / accScale;
+  accScaledIMU.z = raw->z * SENSORS_BMI088_G_PER_LSB_CFG / accScale;
+  sensorsAlignToAirframe(&accScaledIMU, &accScaled);
+  sensorsAccAlignToGravity(&accScaled, &sensorData.acc);
+  const uint32_t filterStart = cycleCounterGet();
+  biquadNApply(&accLpf, sensorData.acc.axis);
+  accFilterCycles = cycleCounterGet() - filterStart;
+}
+
+static void enqueueImuSample(const bool hasAcc)
+{
+  imuMeasurement_t imu;
+
+  imu.gyro = sensorData.gyro;
+  imu.acc = sensorData.acc;
+  imu.timestamp = sensorData.interruptTimestamp;
+  imu.hasAcc = hasAcc;
+  estimatorEnqueueImu(&imu);
+}
+
+#ifdef CONFIG_SENSORS_BMI088_GYRO_FIFO
+/**
+ * Processes one gyro FIFO frame. The frame reaching the watermark was sampled
+ * when the interrupt fired, the others are spaced by the output data rate.
+ */
+static void processGyroFifoFrame(const Axis3i16* raw, const uint64_t interruptTimestamp, const int32_t frameIndex)
+{
+  const int32_t offsetUs = (frameIndex - (GYRO_FIFO_WATERMARK - 1)) * GYRO_FIFO_SAMPLE_PERIOD_US;
+  sensorData.interruptTimestamp = interruptTimestamp + offsetUs;
+
+  gyroRaw = *raw;
+  processGyroSample(&gyroRaw);
+  gyroFifoSampleCount++;
+
+  // The accelerometer is read once per FIFO read, when the watermark was reached
+  enqueueImuSample(frameIndex == GYRO_FIFO_WATERMARK - 1);
+}
+#endif
+
+/**
+ * The barometer data registers are read with an asynchronous transaction on
+ * the sensor bus and the result is handled in a later loop, the IMU loop does
+ * not wait for the bus.
+ */
+static void readBarometer(void)
+{
+  static uint8_t baroMeasDelay = SENSORS_DELAY_BARO;
+
+  if (baroTransaction.state == i2cTransactionDone)
+  {
+    uint8_t sensor_comp = BMP3_PRESS | BMP3_TEMP;
+    struct bmp3_data data;
+    baro_t* baro388 = &sensorData.baro;
+    measurement_t measurement;
+
+    /* Temperature and Pressure data are compensated and stored in the bmp3_data instance */
+    bmp3_compensate_sensor_data(sensor_comp, baroData, &data, &bmp3xxDev);
+    sensorsScaleBaro(baro388, data.pressure, data.temperature);
+
+    measurement.type = MeasurementTypeBarometer;
+    measurement.data.barometer.baro = sensorData.baro;
+    estimatorEnqueue(&measurement);
+
+    baroTransaction.state = i2cTransactionIdle;
+  }
+
+  if (--baroMeasDelay == 0)
+  {
+    // A read that has not completed in a whole period is aborted, as a blocking read would time out
+    if (baroTransaction.state == i2cTransactionQueued)
+    {
+      i2cdrvCancelTransaction(I2C3_DEV, &baroTransaction);
+    }
+
+    i2cdrvCreateMessageIntAddr(&baroMessage, bmp3xxDev.dev_id, false, BMP3_DATA_ADDR,
+                               i2cRead, BMP3_P_T_DATA_LEN, baroData);
+    i2cdrvCreateTransaction(&baroTransaction, &baroMessage, 1, 0, 0);
+    i2cdrvSubmitTransaction(I2C3_DEV, &baroTransaction);
+
+    baroMeasDelay = baroMeasDelayMin;
+  }
+}
+
+/**
+ * Called once per stabilizer loop worth of IMU data. Handles the barometer and
+ * releases the stabilizer.
+ */
+static void publishSensorData(void)
+{
+  if (isBarometerPresent)
+  {
+    readBarometer();
+  }
+  xQueueOverwrite(accelerometerDataQueue, &sensorData.acc);
+  xQueueOverwrite(gyroDataQueue, &sensorData.gyro);
+  if (isBarometerPresent)
+  {
+    xQueueOverwrite(barometerDataQueue, &sensorData.baro);
+  }
+
+  xSemaphoreGive(dataReady);
+}
+
+static void sensorsTask(void *param)
+{
+  systemWaitStart();
+
   /* wait an additional second the keep bus free
    * this is only required by the z-ranger, since the
    * configuration will be done after system start-up */
@@ -306,74 +598,61 @@ static void sensorsTask(void *param)
   {
     if (pdTRUE == xSemaphoreTake(sensorsDataReady, portMAX_DELAY))
     {
-      sensorData.interruptTimestamp = imuIntTimestamp;
+#ifdef CONFIG_SENSORS_GYRO_DYN_NOTCH
+      updateGyroNotch();
+#endif
+#ifdef CONFIG_SENSORS_BMI088_GYRO_FIFO
+      const uint64_t interruptTimestamp = imuIntTimestamp;
+      TickType_t loopTick = xTaskGetTickCount();
 
-      /* get data from chosen sensors */
-      sensorsGyroGet(&gyroRaw);
+      /* One accelerometer sample per FIFO read */
       sensorsAccelGet(&accelRaw);
+      processAccSample(&accelRaw);
 
-      /* calibrate if necessary */
-#ifdef GYRO_BIAS_LIGHT_WEIGHT
-      gyroBiasFound = processGyroBiasNoBuffer(gyroRaw.x, gyroRaw.y, gyroRaw.z, &gyroBias);
-#else
-      gyroBiasFound = processGyroBias(gyroRaw.x, gyroRaw.y, gyroRaw.z, &gyroBias);
-#endif
-      if (gyroBiasFound)
+      /* The watermark is reached, the FIFO status does not have to be read first */
+      uint32_t frames = sensorsGyroFifoRead(gyroFifoRaw, GYRO_FIFO_WATERMARK);
+      for (uint32_t i = 0; i < frames; i++)
       {
-         processAccScale(accelRaw.x, accelRaw.y, accelRaw.z);
+        /* Release the stabilizer once per loop of samples, the loops of one
+         * read are paced by the system tick */
+        if (i > 0 && i % GYRO_FIFO_SAMPLES_PER_LOOP == 0)
+        {
+          vTaskDelayUntil(&loopTick, 1);
+        }
+        processGyroFifoFrame(&gyroFifoRaw[i], interruptTimestamp, i);
+        if ((i + 1) % GYRO_FIFO_SAMPLES_PER_LOOP == 0)
+        {
+          publishSensorData();
+        }
       }
 
-      /* Gyro */
-      gyroScaledIMU.x =  (gyroRaw.x - gyroBias.x) * SENSORS_BMI088_DEG_PER_LSB_CFG;
-      gyroScaledIMU.y =  (gyroRaw.y - gyroBias.y) * SENSORS_BMI088_DEG_PER_LSB_CFG;
-      gyroScaledIMU.z =  (gyroRaw.z - gyroBias.z) * SENSORS_BMI088_DEG_PER_LSB_CFG;
-      sensorsAlignToAirframe(&gyroScaledIMU, &sensorData.gyro);
-      applyAxis3fLpf((lpf2pData*)(&gyroLpf), &sensorData.gyro);
-
-      measurement.type = MeasurementTypeGyroscope;
-      measurement.data.gyroscope.gyro = sensorData.gyro;
-      estimatorEnqueue(&measurement);
-
-      /* Acelerometer */
-      accScaledIMU.x = accelRaw.x * SENSORS_BMI088_G_PER_LSB_CFG / accScale;
-      accScaledIMU.y = accelRaw.y * SENSORS_BMI088_G_PER_LSB_CFG / accScale;
-      accScaledIMU.z = accelRaw.z * SENSORS_BMI088_G_PER_LSB_CFG / accScale;
-      sensorsAlignToAirframe(&accScaledIMU, &accScaled);
-      sensorsAccAlignToGravity(&accScaled, &sensorData.acc);
-      applyAxis3fLpf((lpf2pData*)(&accLpf), &sensorData.acc);
-
-      measurement.type = MeasurementTypeAcceleration;
-      measurement.data.acceleration.acc = sensorData.acc;
-      estimatorEnqueue(&measurement);
-    }
-
-    if (isBarometerPresent)
-    {
-      static uint8_t baroMeasDelay = SENSORS_DELAY_BARO;
-      if (--baroMeasDelay == 0)
+      /* The watermark interrupt is level based, it is still active if the task
+       * was late. Read the rest to not miss the next rising edge, the samples
+       * are used by the estimator but the stabilizer does not run back-to-back
+       * to catch up. */
+      int32_t frameIndex = frames;
+      while (frames > 0 && GPIO_ReadInputDataBit(GPIOC, GPIO_Pin_14) == Bit_SET)
       {
-        uint8_t sensor_comp = BMP3_PRESS | BMP3_TEMP;
-        struct bmp3_data data;
-        baro_t* baro388 = &sensorData.baro;
-        /* Temperature and Pressure data are read and stored in the bmp3_data instance */
-        bmp3_get_sensor_data(sensor_comp, &data, &bmp3xxDev);
-        sensorsScaleBaro(baro388, data.pressure, data.temperature);
-
-        measurement.type = MeasurementTypeBarometer;
-        measurement.data.barometer.baro = sensorData.baro;
-        estimatorEnqueue(&measurement);
-
-        baroMeasDelay = baroMeasDelayMin;
+        frames = sensorsGyroFifoGet(gyroFifoRaw, SENSORS_BMI088_GYRO_FIFO_MAX_FRAMES);
+        for (uint32_t i = 0; i < frames; i++, frameIndex++)
+        {
+          processGyroFifoFrame(&gyroFifoRaw[i], interruptTimestamp, frameIndex);
+        }
       }
-    }
-    xQueueOverwrite(accelerometerDataQueue, &sensorData.acc);
-    xQueueOverwrite(gyroDataQueue, &sensorData.gyro);
-    if (isBarometerPresent)
-    {
-      xQueueOverwrite(barometerDataQueue, &sensorData.baro);
-    }
+#else
+      sensorData.interruptTimestamp = imuIntTimestamp;
 
-    xSemaphoreGive(dataReady);
+      /* get data from chosen sensors */
+      sensorsGyroGet(&gyroRaw);
+      sensorsAccelGet(&accelRaw);
+
+      processGyroSample(&gyroRaw);
+      processAccSample(&accelRaw);
+      enqueueImuSample(true);
+
+      publishSensorData();
+#endif
+    }
   }
 }
 
@@ -402,13 +681,24 @@ static void sensorsDeviceInit(void)
   rslt = bmi088_gyro_init(&bmi088Dev); // initialize the device
   if (rslt == BSTDR_OK)
   {
+#ifndef CONFIG_SENSORS_BMI088_GYRO_FIFO
     struct bmi088_int_cfg intConfig;
+#endif
 
     DEBUG_PRINT("BMI088 Gyro connection [OK].\n");
     /* set power mode of gyro */
     bmi088Dev.gyro_cfg.power = BMI088_GYRO_PM_NORMAL;
     rslt |= bmi088_set_gyro_power_mode(&bmi088Dev);
     /* set bandwidth and range of gyro */
+#ifdef CONFIG_SENSORS_BMI088_GYRO_FIFO
+    bmi088Dev.gyro_cfg.bw = BMI088_GYRO_BW_230_ODR_2000_HZ;
+    bmi088Dev.gyro_cfg.range = SENSORS_BMI088_GYRO_FS_CFG;
+    bmi088Dev.gyro_cfg.odr = BMI088_GYRO_BW_230_ODR_2000_HZ;
+    rslt |= bmi088_set_gyro_meas_conf(&bmi088Dev);
+
+    rslt |= sensorsGyroFifoInit();
+    DEBUG_PRINT("BMI088 Gyro FIFO, %d samples per read\n", GYRO_FIFO_WATERMARK);
+#else
     bmi088Dev.gyro_cfg.bw = BMI088_GYRO_BW_116_ODR_1000_HZ;
     bmi088Dev.gyro_cfg.range = SENSORS_BMI088_GYRO_FS_CFG;
     bmi088Dev.gyro_cfg.odr = BMI088_GYRO_BW_116_ODR_1000_HZ;
@@ -421,6 +711,7 @@ static void sensorsDeviceInit(void)
     intConfig.gyro_int_pin_3_cfg.output_mode = 0;
     /* Setting the interrupt configuration */
     rslt = bmi088_set_gyro_int_config(&intConfig, &bmi088Dev);
+#endif
 
     bmi088Dev.delay_ms(50);
     struct bmi088_sensor_data gyr;
@@ -542,11 +833,12 @@ static void sensorsDeviceInit(void)
   }
 
   // Init second order filer for accelerometer and gyro
-  for (uint8_t i = 0; i < 3; i++)
-  {
-    lpf2pInit(&gyroLpf[i], 1000, GYRO_LPF_CUTOFF_FREQ);
-    lpf2pInit(&accLpf[i],  1000, ACCEL_LPF_CUTOFF_FREQ);
-  }
+  biquadNInitLpf(&gyroLpf, 3, SENSORS_GYRO_RATE_HZ, GYRO_LPF_CUTOFF_FREQ);
+  biquadNInitLpf(&accLpf, 3, SENSORS_ACC_RATE_HZ, ACCEL_LPF_CUTOFF_FREQ);
+  cycleCounterInit();
+#ifdef CONFIG_SENSORS_GYRO_DYN_NOTCH
+  dynNotchInit(&gyroNotch, SENSORS_GYRO_RATE_HZ, gyroNotchQ, gyroNotchMinHz);
+#endif
 
   cosPitch = cosf(configblockGetCalibPitch() * (float) M_PI / 180);
   sinPitch = sinf(configblockGetCalibPitch() * (float) M_PI / 180);
@@ -564,12 +856,15 @@ static void sensorsTaskInit(void)
   barometerDataQueue = STATIC_MEM_QUEUE_CREATE(barometerDataQueue);
 
   STATIC_MEM_TASK_CREATE(sensorsTask, sensorsTask, SENSORS_TASK_NAME, NULL, SENSORS_TASK_PRI);
+
+#ifdef CONFIG_SENSORS_GYRO_SPECTRUM
+  gyroSpectrumInit(SENSORS_GYRO_RATE_HZ);
+#endif
 }
 
 static void sensorsInterruptInit(void)
 {
   GPIO_InitTypeDef GPIO_InitStructure;
-  EXTI_InitTypeDef EXTI_InitStructure;
 
   sensorsDataReady = xSemaphoreCreateBinaryStatic(&sensorsDataReadyBuffer);
   dataReady = xSemaphoreCreateBinaryStatic(&dataReadyBuffer);
@@ -578,18 +873,13 @@ static void sensorsInterruptInit(void)
   GPIO_InitStructure.GPIO_Pin = GPIO_Pin_14;
   GPIO_InitStructure.GPIO_Mode = GPIO_Mode_IN;
   GPIO_InitStructure.GPIO_PuPd = GPIO_PuPd_NOPULL; //GPIO_PuPd_DOWN;
+  // The gpio port registers are shared, decks may be initialized in parallel
+  taskENTER_CRITICAL();
   GPIO_Init(GPIOC, &GPIO_InitStructure);
+  taskEXIT_CRITICAL();
 
-  SYSCFG_EXTILineConfig(EXTI_PortSourceGPIOC, EXTI_PinSource14);
-
-  EXTI_InitStructure.EXTI_Line = EXTI_Line14;
-  EXTI_InitStructure.EXTI_Mode = EXTI_Mode_Interrupt;
-  EXTI_InitStructure.EXTI_Trigger = EXTI_Trigger_Rising;
-  EXTI_InitStructure.EXTI_LineCmd = ENABLE;
-  portDISABLE_INTERRUPTS();
-  EXTI_Init(&EXTI_InitStructure);
+  extiConfigureLine(EXTI_PortSourceGPIOC, EXTI_PinSource14, EXTI_Trigger_Rising);
   EXTI_ClearITPendingBit(EXTI_Line14);
-  portENABLE_INTERRUPTS();
 }
 
 static void sensorsBmi088Bmp3xxInit(void)
@@ -963,10 +1253,7 @@ void sensorsBmi088Bmp3xxSetAccMode(accModes accMode)
       {
         DEBUG_PRINT("ACC config [FAIL]\n");
       }
-      for (uint8_t i = 0; i < 3; i++)
-      {
-        lpf2pInit(&accLpf[i],  1000, 500);
-      }
+      biquadNInitLpf(&accLpf, 3, 1000, 500);
       break;
     case ACC_MODE_FLIGHT:
     default:
@@ -978,21 +1265,11 @@ void sensorsBmi088Bmp3xxSetAccMode(accModes accMode)
       {
         DEBUG_PRINT("ACC config [FAIL]\n");
       }
-      for (uint8_t i = 0; i < 3; i++)
-      {
-        lpf2pInit(&accLpf[i],  1000, ACCEL_LPF_CUTOFF_FREQ);
-      }
+      biquadNInitLpf(&accLpf, 3, 1000, ACCEL_LPF_CUTOFF_FREQ);
       break;
   }
 }
 
-static void applyAxis3fLpf(lpf2pData *data, Axis3f* in)
-{
-  for (uint8_t i = 0; i < 3; i++) {
-    in->axis[i] = lpf2pApply(&data[i], in->axis[i]);
-  }
-}
-
 void sensorsBmi088Bmp3xxDataAvailableCallback(void)
 {
   portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
@@ -1016,6 +1293,37 @@ LOG_ADD(LOG_FLOAT, zVariance, &gyroBiasRunning.variance.z)
 LOG_GROUP_STOP(gyro)
 #endif
 
+#ifdef CONFIG_SENSORS_BMI088_GYRO_FIFO
+LOG_GROUP_START(gyroFifo)
+/**
+ * @brief Number of gyro samples read from the FIFO since start up
+ */
+LOG_ADD(LOG_UINT32, samples, &gyroFifoSampleCount)
+/**
+ * @brief Number of FIFO reads where the FIFO had overflowed
+ */
+LOG_ADD(LOG_UINT32, overruns, &gyroFifoOverrunCount)
+/**
+ * @brief Max number of frames found in the FIFO in one read
+ */
+LOG_ADD(LOG_UINT8, maxFrames, &gyroFifoMaxFrames)
+LOG_GROUP_STOP(gyroFifo)
+#endif
+
+/**
+ * CPU cycles spent in the IMU filters, for the last sample
+ */
+LOG_GROUP_START(imuFilter)
+/**
+ * @brief Cycles in the gyro filter chain, notch and low pass filters included
+ */
+LOG_ADD(LOG_UINT32, gyroCycles, &gyroFilterCycles)
+/**
+ * @brief Cycles in the accelerometer low pass filter
+ */
+LOG_ADD(LOG_UINT32, accCycles, &accFilterCycles)
+LOG_GROUP_STOP(imuFilter)
+
 PARAM_GROUP_START(imu_sensors)
 
 /**
@@ -1039,3 +1347,43 @@ PARAM_ADD(PARAM_FLOAT | PARAM_PERSISTENT, imuTheta, &imuTheta)
 PARAM_ADD(PARAM_FLOAT | PARAM_PERSISTENT, imuPsi, &imuPsi)
 
 PARAM_GROUP_STOP(imu_sensors)
+
+#ifdef CONFIG_SENSORS_GYRO_DYN_NOTCH
+PARAM_GROUP_START(gyroNotch)
+
+/**
+ * @brief Quality factor of the gyro notch filters, higher is narrower
+ */
+PARAM_ADD(PARAM_FLOAT | PARAM_PERSISTENT, q, &gyroNotchQ)
+
+/**
+ * @brief Motor rotation frequency (Hz) below which the notch of the motor is turned off
+ */
+PARAM_ADD(PARAM_FLOAT | PARAM_PERSISTENT, minHz, &gyroNotchMinHz)
+
+/**
+ * @brief Motor rotation frequency (Hz) at full motor command, used when the motor speeds are not measured
+ */
+PARAM_ADD(PARAM_FLOAT | PARAM_PERSISTENT, fullThrHz, &gyroNotchFullThrottleHz)
+
+PARAM_GROUP_STOP(gyroNotch)
+
+LOG_GROUP_START(gyroNotch)
+/**
+ * @brief Notch center frequency for motor 1 [Hz], 0 when off
+ */
+LOG_ADD(LOG_FLOAT, m1, &gyroNotch.centerFreq[0])
+/**
+ * @brief Notch center frequency for motor 2 [Hz], 0 when off
+ */
+LOG_ADD(LOG_FLOAT, m2, &gyroNotch.centerFreq[1])
+/**
+ * @brief Notch center frequency for motor 3 [Hz], 0 when off
+ */
+LOG_ADD(LOG_FLOAT, m3, &gyroNotch.centerFreq[2])
+/**
+ * @brief Notch center frequency for motor 4 [Hz], 0 when off
+ */
+LOG_ADD(LOG_FLOAT, m4, &gyroNotch.centerFreq[3])
+LOG_GROUP_STOP(gyroNotch)
+#endif
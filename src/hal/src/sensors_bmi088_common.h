@@ -28,6 +28,9 @@
 #include <stdint.h>
 #include "bstdr_types.h"
 
+// Max number of gyro frames (6 bytes each) read from the FIFO in one burst
+#define SENSORS_BMI088_GYRO_FIFO_MAX_FRAMES 16
+
 void sensorsBmi088_I2C_deviceInit(struct bmi088_dev *device);
 void sensorsBmi088_SPI_deviceInit(struct bmi088_dev *device);
 
@@ -29,6 +29,9 @@
 
 #include "stm32fxxx.h"
 
+#include "FreeRTOS.h"
+#include "task.h"
+
 #include "bmi088.h"
 #include "i2cdev.h"
 #include "bstdr_types.h"
@@ -40,7 +43,12 @@
 
 /* Defines and buffers for full duplex SPI DMA transactions */
 /* The buffers must not be placed in CCM */
+#ifdef CONFIG_SENSORS_BMI088_GYRO_FIFO
+// Room for a full gyro FIFO burst
+#define SPI_MAX_DMA_TRANSACTION_SIZE    (SENSORS_BMI088_GYRO_FIFO_MAX_FRAMES * 6 + 1)
+#else
 #define SPI_MAX_DMA_TRANSACTION_SIZE    15
+#endif
 static uint8_t spiTxBuffer[SPI_MAX_DMA_TRANSACTION_SIZE + 1];
 static uint8_t spiRxBuffer[SPI_MAX_DMA_TRANSACTION_SIZE + 1];
 static xSemaphoreHandle spiTxDMAComplete;
@@ -258,6 +266,9 @@ static void spiInit(void)
 
   isInit = true;
 
+  // The clock enable and gpio port registers are shared, decks may be initialized in parallel
+  taskENTER_CRITICAL();
+
   /* Enable SPI and GPIO clocks */
   RCC_AHB1PeriphClockCmd(BMI088_GPIO_SPI_CLK | BMI088_ACC_GPIO_CS_PERIF, ENABLE);
   /* Enable SPI and GPIO clocks */
@@ -290,6 +301,8 @@ static void spiInit(void)
   GPIO_PinAFConfig(BMI088_GPIO_SPI_PORT, BMI088_GPIO_SPI_MISO_SRC, BMI088_SPI_AF);
   GPIO_PinAFConfig(BMI088_GPIO_SPI_PORT, BMI088_GPIO_SPI_MOSI_SRC, BMI088_SPI_AF);
 
+  taskEXIT_CRITICAL();
+
   /* disable the chip select */
   ACC_DIS_CS();
 
@@ -302,7 +315,9 @@ static void spiDMAInit(void)
   NVIC_InitTypeDef NVIC_InitStructure;
 
   /*!< Enable DMA Clocks */
+  taskENTER_CRITICAL();
   BMI088_SPI_DMA_CLK_INIT(BMI088_SPI_DMA_CLK, ENABLE);
+  taskEXIT_CRITICAL();
 
   /* Configure DMA Initialization Structure */
   DMA_InitStructure.DMA_FIFOMode = DMA_FIFOMode_Disable;
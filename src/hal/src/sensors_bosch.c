@@ -62,6 +62,7 @@
 #include "bstdr_comm_support.h"
 #include "static_mem.h"
 #include "estimator.h"
+#include "usec_time.h"
 
 #define SENSORS_READ_RATE_HZ            1000
 #define SENSORS_STARTUP_TIME_MS         1000
@@ -486,6 +487,7 @@ sensorsAccelCalibrate(BiasObj* accel, BiasObj* gyro, uint8_t type) {
 static void sensorsTask(void *param)
 {
   measurement_t measurement;
+  imuMeasurement_t imu;
 
   systemWaitStart();
 
@@ -656,14 +658,12 @@ static void sensorsTask(void *param)
             }
         }
 
-      measurement.type = MeasurementTypeAcceleration;
-      measurement.data.acceleration.acc = sensors.acc;
-      estimatorEnqueue(&measurement);
+      imu.gyro = sensors.gyro;
+      imu.acc = sensors.acc;
+      imu.timestamp = usecTimestamp();
+      imu.hasAcc = true;
+      estimatorEnqueueImu(&imu);
       xQueueOverwrite(accelPrimDataQueue, &sensors.acc);
-
-      measurement.type = MeasurementTypeGyroscope;
-      measurement.data.gyroscope.gyro = sensors.gyro;
-      estimatorEnqueue(&measurement);
       xQueueOverwrite(gyroPrimDataQueue, &sensors.gyro);
 
 #ifdef LOG_SEC_IMU
@@ -46,6 +46,7 @@
 #include "debug.h"
 #include "imu.h"
 #include "nvicconf.h"
+#include "exti.h"
 #include "ledseq.h"
 #include "sound.h"
 #include "filter.h"
@@ -132,9 +133,8 @@ static float accScale = 1;
 // Low Pass filtering
 #define GYRO_LPF_CUTOFF_FREQ  80
 #define ACCEL_LPF_CUTOFF_FREQ 30
-static lpf2pData accLpf[3];
-static lpf2pData gyroLpf[3];
-static void applyAxis3fLpf(lpf2pData *data, Axis3f* in);
+static biquadNData accLpf;
+static biquadNData gyroLpf;
 
 static bool isBarometerPresent = false;
 static bool isMagnetometerPresent = false;
@@ -216,6 +216,7 @@ bool sensorsMpu9250Lps25hAreCalibrated() {
 static void sensorsTask(void *param)
 {
   measurement_t measurement;
+  imuMeasurement_t imu;
 
   systemWaitStart();
 
@@ -244,14 +245,12 @@ static void sensorsTask(void *param)
                   SENSORS_MPU6500_BUFF_LEN + SENSORS_MAG_BUFF_LEN : SENSORS_MPU6500_BUFF_LEN]));
       }
 
-      measurement.type = MeasurementTypeAcceleration;
-      measurement.data.acceleration.acc = sensorData.acc;
-      estimatorEnqueue(&measurement);
+      imu.gyro = sensorData.gyro;
+      imu.acc = sensorData.acc;
+      imu.timestamp = sensorData.interruptTimestamp;
+      imu.hasAcc = true;
+      estimatorEnqueueImu(&imu);
       xQueueOverwrite(accelerometerDataQueue, &sensorData.acc);
-
-      measurement.type = MeasurementTypeGyroscope;
-      measurement.data.gyroscope.gyro = sensorData.gyro;
-      estimatorEnqueue(&measurement);
       xQueueOverwrite(gyroDataQueue, &sensorData.gyro);
       if (isMagnetometerPresent)
       {
@@ -336,14 +335,14 @@ void processAccGyroMeasurements(const uint8_t *buffer)
   gyroScaledIMU.y =  (gyroRaw.y - gyroBias.y) * SENSORS_DEG_PER_LSB_CFG;
   gyroScaledIMU.z =  (gyroRaw.z - gyroBias.z) * SENSORS_DEG_PER_LSB_CFG;
   sensorsAlignToAirframe(&gyroScaledIMU, &sensorData.gyro);
-  applyAxis3fLpf((lpf2pData*)(&gyroLpf), &sensorData.gyro);
+  biquadNApply(&gyroLpf, sensorData.gyro.axis);
 
   accScaledIMU.x = -(accelRaw.x) * SENSORS_G_PER_LSB_CFG / accScale;
   accScaledIMU.y =  (accelRaw.y) * SENSORS_G_PER_LSB_CFG / accScale;
   accScaledIMU.z =  (accelRaw.z) * SENSORS_G_PER_LSB_CFG / accScale;
   sensorsAlignToAirframe(&accScaledIMU, &accScaled);
   sensorsAccAlignToGravity(&accScaled, &sensorData.acc);
-  applyAxis3fLpf((lpf2pData*)(&accLpf), &sensorData.acc);
+  biquadNApply(&accLpf, sensorData.acc.axis);
 }
 
 static void sensorsDeviceInit(void)
@@ -395,11 +394,8 @@ static void sensorsDeviceInit(void)
   // Set digital low-pass bandwidth for gyro
   mpu6500SetDLPFMode(MPU6500_DLPF_BW_98);
   // Init second order filer for accelerometer
-  for (uint8_t i = 0; i < 3; i++)
-  {
-    lpf2pInit(&gyroLpf[i], 1000, GYRO_LPF_CUTOFF_FREQ);
-    lpf2pInit(&accLpf[i],  1000, ACCEL_LPF_CUTOFF_FREQ);
-  }
+  biquadNInitLpf(&gyroLpf, 3, 1000, GYRO_LPF_CUTOFF_FREQ);
+  biquadNInitLpf(&accLpf, 3, 1000, ACCEL_LPF_CUTOFF_FREQ);
 
 
 #ifdef SENSORS_ENABLE_MAG_AK8963
@@ -502,7 +498,6 @@ static void sensorsTaskInit(void)
 static void sensorsInterruptInit(void)
 {
   GPIO_InitTypeDef GPIO_InitStructure;
-  EXTI_InitTypeDef EXTI_InitStructure;
 
   sensorsDataReady = xSemaphoreCreateBinaryStatic(&sensorsDataReadyBuffer);
   dataReady = xSemaphoreCreateBinaryStatic(&dataReadyBuffer);
@@ -513,25 +508,22 @@ static void sensorsInterruptInit(void)
   GPIO_InitStructure.GPIO_PuPd = GPIO_PuPd_DOWN;
   GPIO_InitStructure.GPIO_OType = GPIO_OType_PP;
   GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+  // The gpio port registers are shared, decks may be initialized in parallel
+  taskENTER_CRITICAL();
   GPIO_Init(GPIOC, &GPIO_InitStructure);
+  taskEXIT_CRITICAL();
   GPIO_ResetBits(GPIOC, GPIO_Pin_14);
 
   // Enable the MPU6500 interrupt on PC13
   GPIO_InitStructure.GPIO_Pin = GPIO_Pin_13;
   GPIO_InitStructure.GPIO_Mode = GPIO_Mode_IN;
   GPIO_InitStructure.GPIO_PuPd = GPIO_PuPd_DOWN;
+  taskENTER_CRITICAL();
   GPIO_Init(GPIOC, &GPIO_InitStructure);
+  taskEXIT_CRITICAL();
 
-  SYSCFG_EXTILineConfig(EXTI_PortSourceGPIOC, EXTI_PinSource13);
-
-  EXTI_InitStructure.EXTI_Line = EXTI_Line13;
-  EXTI_InitStructure.EXTI_Mode = EXTI_Mode_Interrupt;
-  EXTI_InitStructure.EXTI_Trigger = EXTI_Trigger_Rising;
-  EXTI_InitStructure.EXTI_LineCmd = ENABLE;
-  portDISABLE_INTERRUPTS();
-  EXTI_Init(&EXTI_InitStructure);
+  extiConfigureLine(EXTI_PortSourceGPIOC, EXTI_PinSource13, EXTI_Trigger_Rising);
   EXTI_ClearITPendingBit(EXTI_Line13);
-  portENABLE_INTERRUPTS();
 }
 
 void sensorsMpu9250Lps25hInit(void)
@@ -927,29 +919,16 @@ void sensorsMpu9250Lps25hSetAccMode(accModes accMode)
   {
     case ACC_MODE_PROPTEST:
       mpu6500SetAccelDLPF(MPU6500_ACCEL_DLPF_BW_460);
-      for (uint8_t i = 0; i < 3; i++)
-      {
-        lpf2pInit(&accLpf[i],  1000, 500);
-      }
+      biquadNInitLpf(&accLpf, 3, 1000, 500);
       break;
     case ACC_MODE_FLIGHT:
     default:
       mpu6500SetAccelDLPF(MPU6500_ACCEL_DLPF_BW_41);
-      for (uint8_t i = 0; i < 3; i++)
-      {
-        lpf2pInit(&accLpf[i],  1000, ACCEL_LPF_CUTOFF_FREQ);
-      }
+      biquadNInitLpf(&accLpf, 3, 1000, ACCEL_LPF_CUTOFF_FREQ);
       break;
   }
 }
 
-static void applyAxis3fLpf(lpf2pData *data, Axis3f* in)
-{
-  for (uint8_t i = 0; i < 3; i++) {
-    in->axis[i] = lpf2pApply(&data[i], in->axis[i]);
-  }
-}
-
 #ifdef GYRO_ADD_RAW_AND_VARIANCE_LOG_VALUES
 LOG_GROUP_START(gyro)
 LOG_ADD(LOG_INT16, xRaw, &gyroRaw.x)
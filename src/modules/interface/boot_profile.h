@@ -0,0 +1,66 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * boot_profile.h - Time of the init and test phases of the system start
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * The init and test phases of the system start. Phases may run in parallel,
+ * see CONFIG_SYSTEM_PARALLEL_INIT.
+ */
+typedef enum {
+  bootPhaseSystemInit = 0,
+  bootPhaseCommInit,
+  bootPhaseCommanderInit,
+  bootPhaseEstimatorInit,
+  bootPhaseMemInit,
+  bootPhaseDeckInit,
+  bootPhaseSensorsInit,
+  bootPhaseStabilizerInit,
+  bootPhaseSoundInit,
+  bootPhaseStorageTest,
+  bootPhaseDeckTest,
+  bootPhaseTests,
+  bootPhaseCount,
+} bootPhase_t;
+
+/**
+ * @brief Record the start of a phase, time stamps are in microseconds since
+ * the usec timer was initialized
+ */
+void bootProfileBegin(const bootPhase_t phase);
+
+/**
+ * @brief Record the end of a phase
+ */
+void bootProfileEnd(const bootPhase_t phase);
+
+/**
+ * @brief Record the time when the system is ready to fly and print the boot
+ * report on the console
+ */
+void bootProfileReady(void);
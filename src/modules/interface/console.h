@@ -28,7 +28,12 @@
 #define CONSOLE_H_
 
 #include <stdbool.h>
+#include <stdint.h>
 #include "eprintf.h"
+#include "tokenize.h"
+
+#define CONSOLE_CHANNEL_TEXT 0
+#define CONSOLE_CHANNEL_TOKENIZED 1
 
 /**
  * Initialize the console
@@ -51,9 +56,10 @@ int consolePutchar(int ch);
  * @param ch character that shall be printed
  * @return The character casted to unsigned int or EOF in case of error
  *
- * @note This version can be called by interrup. In such case the internal
- * buffer is going to be used. If a task currently is printing or if the
- * interrupts prints too much the data will be ignored.
+ * @note This version can be called by interrupts. The character is written
+ * to a lock free staging buffer that is moved to the console by the console
+ * task. If the interrupts print too much the data is dropped and a "<F>"
+ * marker is printed.
  */
 int consolePutcharFromISR(int ch);
 
@@ -66,16 +72,46 @@ int consolePutcharFromISR(int ch);
 int consolePuts(const char *str);
 
 /**
- * Flush the console buffer
+ * Flush the console buffer, the text that has not been terminated by a new
+ * line is sent by the console task
  */
 void consoleFlush(void);
 
 /**
- * Macro implementing consolePrintf with eprintf
+ * Print a formatted message to the console. The console lock is taken once for
+ * the whole message.
  *
- * @param FMT String format
+ * @param fmt String format
  * @param ... Parameters to print
+ * @return the number of characters printed
+ */
+int consolePrintf(const char *fmt, ...) __attribute__ (( format(printf, 1, 2) ));
+
+/**
+ * Send a tokenized message, one message per packet on the tokenized channel.
+ * Use consoleTokenizedPrintf() instead of calling this function directly.
+ *
+ * @param token Token of the format string
+ * @param argTypes Argument types from TOKENIZE_ARG_TYPES()
+ * @param ... Parameters of the message
+ * @return the number of bytes sent, 0 if the message was dropped
+ */
+int consolePrintTokenized(const uint32_t token, const uint32_t argTypes, ...);
+
+static inline int __attribute__((format(printf, 1, 2))) consoleFormatCheck(const char* fmt, ...) {
+  (void)fmt;
+  return 0;
+}
+
+/**
+ * Macro implementing a printf where the format string is not stored in flash,
+ * only its token and the binary parameters are sent. The message is formatted
+ * on the host, see tokenize.h.
+ *
+ * @param FMT String format literal
+ * @param ... Parameters to print, at most TOKENIZE_MAX_ARGS
  */
-#define consolePrintf(FMT, ...) eprintf(consolePutchar, FMT, ## __VA_ARGS__)
+#define consoleTokenizedPrintf(FMT, ...) (0 ? consoleFormatCheck(FMT, ## __VA_ARGS__) : \
+  consolePrintTokenized(TOKENIZE_STRING(FMT), TOKENIZE_ARG_TYPES(__VA_ARGS__), ## __VA_ARGS__))
 
 #endif /*CONSOLE_H_*/
@@ -96,8 +96,11 @@ struct IndiVariables {
   struct FloatRates u_act_dyn;
   float rate_d[3];
 
-  Butterworth2LowPass u[3];
-  Butterworth2LowPass rate[3];
+  biquadNData u;
+  biquadNData rate;
+  float u_f[3];         // filtered actuator commands
+  float rate_f[3];      // filtered body rates
+  float rate_f_prev[3]; // filtered body rates, previous time step
   struct FloatRates g1;
   float g2;
 
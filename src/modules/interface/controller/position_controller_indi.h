@@ -55,9 +55,9 @@ struct Angles {
 
 struct IndiOuterVariables {
 
-  Butterworth2LowPass ddxi[3];
-  Butterworth2LowPass ang[3];
-  Butterworth2LowPass thr[3];
+  biquadNData ddxi;
+  biquadNData ang;
+  biquadNData thr;
 
   float filt_cutoff;
   float act_dyn_posINDI;
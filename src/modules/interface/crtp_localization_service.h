@@ -68,6 +68,10 @@ typedef enum
   LH_ANGLE_STREAM          = 10,
   LH_PERSIST_DATA          = 11,
   LH_MATCHED_ANGLE_STREAM    = 12,
+  EXT_POSE_PACKED_V2         = 13,
+  EXT_POSITION_PACKED_V2     = 14,
+  STATE_SNAPSHOT             = 15,
+  SETPOINT_SNAPSHOT          = 16,
 } locsrv_t;
 
 // Set up the callback for the CRTP_PORT_LOCALIZATION
@@ -88,6 +88,19 @@ const char* stateEstimatorGetName();
 // Support to incorporate additional sensors into the state estimate via the following functions
 void estimatorEnqueue(const measurement_t *measurement);
 
+/**
+ * @brief Add an IMU sample to the state estimate. IMU samples do not use the
+ * general measurement queue but a lock free ring buffer with one producer (the
+ * sensors task) and one consumer (the estimator).
+ *
+ * Estimators that do not call estimatorDequeueImu() will receive the samples
+ * as MeasurementTypeGyroscope and MeasurementTypeAcceleration measurements from
+ * estimatorDequeue().
+ *
+ * @param imu The IMU sample
+ */
+void estimatorEnqueueImu(const imuMeasurement_t *imu);
+
 // These helper functions simplify the caller code, but cause additional memory copies
 static inline void estimatorEnqueueTDOA(const tdoaMeasurement_t *tdoa)
 {
@@ -164,6 +177,15 @@ static inline void estimatorEnqueueSweepAngles(const sweepAngleMeasurement_t *sw
 // Helper function for state estimators
 bool estimatorDequeue(measurement_t *measurement);
 
+/**
+ * @brief Get the oldest IMU sample, if any. Used by estimators that handle IMU
+ * samples separately from other measurements.
+ *
+ * @param imu Pointer to store the sample in
+ * @return true if a sample was available
+ */
+bool estimatorDequeueImu(imuMeasurement_t *imu);
+
 #ifdef CONFIG_ESTIMATOR_OOT
 void estimatorOutOfTreeInit(void);
 bool estimatorOutOfTreeTest(void);
@@ -0,0 +1,96 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * event_trace.h - Event tracer recording to a RAM ring buffer
+ */
+
+/**
+ * The event tracer records task switches, interrupts, blocking queue
+ * operations and user defined spans in a ring buffer in RAM, with cycle
+ * counter time stamps. The buffer can be read through the
+ * MEM_TYPE_EVENT_TRACE memory or written to the uSD card, and converted to a
+ * timeline with tools/trace/decodeEventTrace.py.
+ *
+ * Events are recorded lock free and can be recorded from any task or
+ * interrupt. All macros compile to nothing when CONFIG_DEBUG_EVENT_TRACE is
+ * not set.
+ *
+ * This file is included by the FreeRTOS configuration and must not include
+ * any FreeRTOS headers.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "autoconf.h"
+
+typedef enum {
+  EVENT_TRACE_NONE = 0,
+  EVENT_TRACE_TASK_SWITCHED_IN = 1,   // arg: task number
+  EVENT_TRACE_ISR_ENTER = 2,          // arg: exception number
+  EVENT_TRACE_ISR_EXIT = 3,           // arg: exception number
+  EVENT_TRACE_QUEUE_BLOCK_RECEIVE = 4, // arg: queue id, semaphores and mutexes included
+  EVENT_TRACE_QUEUE_BLOCK_SEND = 5,   // arg: queue id
+  EVENT_TRACE_SPAN_BEGIN = 6,         // arg: span id
+  EVENT_TRACE_SPAN_END = 7,           // arg: span id
+} eventTraceType_t;
+
+typedef struct {
+  uint32_t timestamp; // CPU cycles
+  uint8_t type;
+  uint8_t reserved;
+  uint16_t arg;
+} eventTraceEvent_t;
+
+// Span ids used by the firmware, apps should use ids from EVENT_TRACE_SPAN_USER and up
+enum {
+  EVENT_TRACE_SPAN_STABILIZER = 0,
+  EVENT_TRACE_SPAN_KALMAN = 1,
+  EVENT_TRACE_SPAN_USER = 32,
+};
+
+#ifdef CONFIG_DEBUG_EVENT_TRACE
+
+void eventTraceInit(void);
+void eventTraceRecord(const uint8_t type, const uint16_t arg);
+void eventTraceIsrEnter(void);
+void eventTraceIsrExit(void);
+void eventTraceTaskCreated(const uint32_t taskNumber, const char* name);
+
+// Queues are identified by their address
+#define EVENT_TRACE_QUEUE_ID(xQueue) ((uint16_t)(((uint32_t)(xQueue)) >> 2))
+
+#define EVENT_TRACE_ISR_ENTER() eventTraceIsrEnter()
+#define EVENT_TRACE_ISR_EXIT() eventTraceIsrExit()
+#define EVENT_TRACE_SPAN_BEGIN(id) eventTraceRecord(EVENT_TRACE_SPAN_BEGIN, (id))
+#define EVENT_TRACE_SPAN_END(id) eventTraceRecord(EVENT_TRACE_SPAN_END, (id))
+
+#else
+
+#define EVENT_TRACE_ISR_ENTER()
+#define EVENT_TRACE_ISR_EXIT()
+#define EVENT_TRACE_SPAN_BEGIN(id)
+#define EVENT_TRACE_SPAN_END(id)
+
+#endif
@@ -0,0 +1,68 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * ext_pos_packed.h - Formats of packed external position/pose broadcasts
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// Version 1 packets, up to 4 position items or 2 pose items per CRTP packet
+
+typedef struct {
+  uint8_t id; // last 8 bit of the Crazyflie address
+  int16_t x; // mm
+  int16_t y; // mm
+  int16_t z; // mm
+} __attribute__((packed)) extPositionPackedItem;
+
+typedef struct {
+  uint8_t id; // last 8 bit of the Crazyflie address
+  int16_t x; // mm
+  int16_t y; // mm
+  int16_t z; // mm
+  uint32_t quat; // compressed quaternion, see quatcompress.h
+} __attribute__((packed)) extPosePackedItem;
+
+// Version 2 packets, a header followed by up to 3 position items or 2 pose items.
+// Items must be sorted by id in ascending order, to make it possible for a Crazyflie to find its own
+// item without looking at all of them.
+typedef struct {
+  uint8_t type; // locsrv_t
+  uint16_t ageMs; // time from capture to transmission, as measured by the sender
+} __attribute__((packed)) extPackedV2Header;
+
+/**
+ * @brief Find the first item with an id larger than or equal to a given id
+ *
+ * The id must be the first byte of each item and the items must be sorted by id.
+ *
+ * @param items Pointer to the first item
+ * @param count Number of items
+ * @param itemSize Size of one item in bytes
+ * @param id The id to search for
+ * @return Index of the item, count if all items have a lower id
+ */
+uint8_t extPackedLowerBound(const uint8_t* items, const uint8_t count, const uint8_t itemSize, const uint8_t id);
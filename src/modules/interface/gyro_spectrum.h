@@ -0,0 +1,54 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * gyro_spectrum.h - Vibration spectrum analyzer for the gyro
+ */
+
+#pragma once
+
+#include "imu_types.h"
+
+// Number of gyro samples per analysis window, must be a length supported by arm_rfft_fast_f32
+#define GYRO_SPECTRUM_WINDOW_SIZE 256
+// Number of bins of the decimated spectrum, per axis
+#define GYRO_SPECTRUM_DECIMATED_BINS 32
+// Number of peaks reported per axis
+#define GYRO_SPECTRUM_PEAKS 3
+
+/**
+ * @brief Initialize the spectrum analyzer and start its task
+ *
+ * @param sampleRateHz The rate at which gyroSpectrumAddSample() is called
+ */
+void gyroSpectrumInit(const float sampleRateHz);
+
+/**
+ * @brief Feed the analyzer with one gyro sample
+ *
+ * Called from the sensors task for every gyro sample, before any filtering.
+ * The sample is only stored while the analyzer is collecting a window, the
+ * function returns immediately otherwise.
+ *
+ * @param gyro The gyro sample (deg/s), aligned to the airframe
+ */
+void gyroSpectrumAddSample(const Axis3f* gyro);
@@ -0,0 +1,40 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * isr_monitor.h - Hooks for interrupt handlers
+ */
+
+/**
+ * Place ISR_MONITOR_ENTER() first and ISR_MONITOR_EXIT() last in an
+ * interrupt handler to include it in the interrupt time measured by the
+ * system load monitor, and in the event trace when the event tracer is
+ * enabled.
+ */
+
+#pragma once
+
+#include "sysload.h"
+#include "event_trace.h"
+
+#define ISR_MONITOR_ENTER() do { sysLoadIsrEnter(); EVENT_TRACE_ISR_ENTER(); } while (0)
+#define ISR_MONITOR_EXIT() do { EVENT_TRACE_ISR_EXIT(); sysLoadIsrExit(); } while (0)
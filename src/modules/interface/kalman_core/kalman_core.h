@@ -57,6 +57,7 @@
 
 #include "cf_math.h"
 #include "stabilizer_types.h"
+#include "mm_robust_common.h"
 
 // Indexes to access the quad's state, stored as a column vector
 typedef enum
@@ -65,6 +66,24 @@ typedef enum
 } kalmanCoreStateIdx_t;
 
 
+// Scratch space of the measurement updates. It does not hold any state between calls, but is part of each filter
+// instance to make it possible to run several filters side by side, from different threads on the host.
+typedef struct {
+  // The Kalman gain as a column vector
+  float K[KC_STATE_DIM];
+
+  // Temporary matrices for the covariance updates
+  __attribute__((aligned(4))) float tmpNN1[KC_STATE_DIM][KC_STATE_DIM];
+  __attribute__((aligned(4))) float tmpNN2[KC_STATE_DIM][KC_STATE_DIM];
+  __attribute__((aligned(4))) float tmpNN3[KC_STATE_DIM][KC_STATE_DIM];
+  __attribute__((aligned(4))) float HT[KC_STATE_DIM];
+  __attribute__((aligned(4))) float PHT[KC_STATE_DIM];
+
+  // The weighted covariance of the robust TDoA and TWR updates
+  robustCovariance_t robustCovariance;
+  __attribute__((aligned(4))) float robustP[KC_STATE_DIM][KC_STATE_DIM];
+} kalmanCoreWorkspace_t;
+
 // The data used by the kalman core implementation.
 typedef struct {
   /**
@@ -87,10 +106,18 @@ typedef struct {
   // The quad's attitude as a rotation matrix (used by the prediction, updated by the finalization)
   float R[3][3];
 
-  // The covariance matrix
+  // The covariance matrix. When the UD factorization is used, this is a copy of U * diag(D) * U' that is only
+  // rebuilt by kalmanCoreSyncCovariance(), see isCovarianceStale.
   __attribute__((aligned(4))) float P[KC_STATE_DIM][KC_STATE_DIM];
   arm_matrix_instance_f32 Pm;
 
+  // The UD factors of the covariance, only used if udFactorization is true, see kalman_core_ud.h
+  bool udFactorization;
+  float U[KC_STATE_DIM][KC_STATE_DIM];
+  float D[KC_STATE_DIM];
+  // The UD factors were changed since P was last rebuilt
+  bool isCovarianceStale;
+
   float baroReferenceHeight;
 
   // Quaternion used for initial orientation [w,x,y,z]
@@ -101,6 +128,12 @@ typedef struct {
 
   uint32_t lastPredictionMs;
   uint32_t lastProcessNoiseUpdateMs;
+
+  // Error states of the previous robust TDoA and TWR updates, used to reweight the covariance in the next update
+  float robustTdoaErr[KC_STATE_DIM];
+  float robustTwrErr[KC_STATE_DIM];
+
+  kalmanCoreWorkspace_t work;
 } kalmanCoreData_t;
 
 // The parameters used by the filter
@@ -133,6 +166,9 @@ typedef struct {
   float initialYaw;
 
   float attitudeReversion;
+
+  // Store the covariance as UD factors and use Bierman/Thornton updates instead of the conventional updates
+  bool udFactorization;
 } kalmanCoreParams_t;
 
 /*  - Load default parameters */
@@ -169,6 +205,14 @@ void kalmanCoreExternalizeState(const kalmanCoreData_t* this, state_t *state, co
 
 void kalmanCoreDecoupleXY(kalmanCoreData_t* this);
 
+/**
+ * @brief Rebuild the covariance matrix P from the UD factors, if they changed since the last rebuild. Called once per
+ * loop by the estimator, for the logs, and by the functions that read P. Does nothing without the UD factorization.
+ *
+ * @param this Core data
+ */
+void kalmanCoreSyncCovariance(kalmanCoreData_t* this);
+
 void kalmanCoreScalarUpdate(kalmanCoreData_t* this, arm_matrix_instance_f32 *Hm, float error, float stdMeasNoise);
 
 void kalmanCoreUpdateWithPKE(kalmanCoreData_t* this, arm_matrix_instance_f32 *Hm, arm_matrix_instance_f32 *Km, arm_matrix_instance_f32 *P_w_m, float error);
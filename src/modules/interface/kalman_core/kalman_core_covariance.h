@@ -0,0 +1,74 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * kalman_core_covariance.h - Block structured covariance propagation for the kalman core
+ */
+
+#pragma once
+
+// The error state of the kalman core: position, body frame velocity and attitude error, 3 elements each.
+// Must match KC_STATE_DIM in kalman_core.h
+#define KC_COVARIANCE_BLOCK 3
+#define KC_COVARIANCE_DIM (3 * KC_COVARIANCE_BLOCK)
+
+/**
+ * @brief The non trivial blocks of the linearized dynamics of the kalman core
+ *
+ * The full 9x9 jacobian is block upper triangular
+ *
+ *       | I  posVel  posAtt |
+ *   A = | 0  velVel  velAtt |
+ *       | 0  0       attAtt |
+ *
+ * where posVel is the rotation from body frame velocity to position, velVel
+ * contains the gyro cross product and attAtt the rotation of the attitude
+ * error.
+ */
+typedef struct {
+  float posVel[KC_COVARIANCE_BLOCK][KC_COVARIANCE_BLOCK];
+  float posAtt[KC_COVARIANCE_BLOCK][KC_COVARIANCE_BLOCK];
+  float velVel[KC_COVARIANCE_BLOCK][KC_COVARIANCE_BLOCK];
+  float velAtt[KC_COVARIANCE_BLOCK][KC_COVARIANCE_BLOCK];
+  float attAtt[KC_COVARIANCE_BLOCK][KC_COVARIANCE_BLOCK];
+} kalmanCoreJacobian_t;
+
+/**
+ * @brief Propagate the covariance through the linearized dynamics, P = A * P * A'
+ *
+ * Works on 3x3 blocks and skips the identity and zero blocks of A. Only the
+ * upper block triangle of P is computed, the lower triangle is mirrored.
+ *
+ * @param P The covariance matrix, must be symmetric. Updated in place.
+ * @param A The blocks of the jacobian
+ */
+void kalmanCoreCovariancePredict(float P[KC_COVARIANCE_DIM][KC_COVARIANCE_DIM], const kalmanCoreJacobian_t* A);
+
+/**
+ * @brief Rotate the attitude error covariance, P = A * P * A' with A = diag(I, I, attAtt)
+ *
+ * Used when the attitude error is moved into the attitude.
+ *
+ * @param P The covariance matrix, must be symmetric. Updated in place.
+ * @param attAtt The rotation of the attitude error
+ */
+void kalmanCoreCovarianceRotateAttitude(float P[KC_COVARIANCE_DIM][KC_COVARIANCE_DIM], const float attAtt[KC_COVARIANCE_BLOCK][KC_COVARIANCE_BLOCK]);
@@ -0,0 +1,135 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "autoconf.h"
+#include "kalman_core.h"
+
+/**
+ * Motion history for out-of-sequence measurements.
+ *
+ * External position and pose measurements (mocap, lighthouse, ...) typically
+ * reach the estimator 10-30 ms after they were captured. A ring of the
+ * position/attitude changes of the past predictions makes it possible to move
+ * a measurement by the motion the estimate has been predicted to make since
+ * the capture, the innovation is then computed against the state at capture
+ * time instead of the current state.
+ *
+ * Only the predictions are stored. Measurement corrections made after the
+ * capture are already part of the current state and are not moved into the
+ * measurement a second time.
+ *
+ * The correction is applied to the current state with the current covariance
+ * (innovation shifting). This is an approximation of a full re-propagation
+ * from the capture time, but costs only one walk of the ring per measurement.
+ */
+
+// Rate (Hz) at which predictions are added, the prediction rate of the kalman estimator
+#ifdef CONFIG_ESTIMATOR_KALMAN_PREDICT_RATE
+#define KALMAN_CORE_HISTORY_RATE CONFIG_ESTIMATOR_KALMAN_PREDICT_RATE
+#else
+#define KALMAN_CORE_HISTORY_RATE 100
+#endif
+
+// Longest measurement delay (ms) that is covered by the history
+#ifdef CONFIG_ESTIMATOR_KALMAN_HISTORY_MAX_DELAY_MS
+#define KALMAN_CORE_HISTORY_MAX_DELAY_MS CONFIG_ESTIMATOR_KALMAN_HISTORY_MAX_DELAY_MS
+#else
+#define KALMAN_CORE_HISTORY_MAX_DELAY_MS 100
+#endif
+
+#define KALMAN_CORE_HISTORY_LENGTH (KALMAN_CORE_HISTORY_MAX_DELAY_MS * KALMAN_CORE_HISTORY_RATE / 1000 + 1)
+
+typedef struct {
+  uint32_t timestampMs;
+  // Position, or position change
+  float pos[3];
+  // Attitude, or rotation, as a quaternion (w,x,y,z), same as in kalmanCoreData_t
+  float q[4];
+} kalmanCoreHistorySample_t;
+
+typedef struct {
+  // The motion of each prediction, from the time of the previous prediction to timestampMs
+  kalmanCoreHistorySample_t samples[KALMAN_CORE_HISTORY_LENGTH];
+  // Index of the next sample to write
+  uint16_t head;
+  uint16_t count;
+} kalmanCoreHistory_t;
+
+void kalmanCoreHistoryReset(kalmanCoreHistory_t* this);
+
+/**
+ * @brief Get the position and attitude of the current state
+ *
+ * @param coreData The kalman core data
+ * @param snapshot Set to the position and attitude of the state
+ */
+void kalmanCoreHistorySnapshot(const kalmanCoreData_t* coreData, kalmanCoreHistorySample_t* snapshot);
+
+/**
+ * @brief Store the motion of a prediction
+ *
+ * Must be called right after the prediction, before any measurement update.
+ *
+ * @param this The history
+ * @param before Snapshot of the state taken right before the prediction
+ * @param coreData The kalman core data, after the prediction
+ * @param nowMs The time of the prediction
+ */
+void kalmanCoreHistoryAddPrediction(kalmanCoreHistory_t* this, const kalmanCoreHistorySample_t* before, const kalmanCoreData_t* coreData, const uint32_t nowMs);
+
+/**
+ * @brief Get the motion that has been predicted since a point in time
+ *
+ * The prediction that spans timestampMs is only counted for the part after
+ * timestampMs.
+ *
+ * @param this The history
+ * @param timestampMs The time to get the motion from
+ * @param motion Set to the position change and rotation since timestampMs
+ * @return false if timestampMs is older than the history
+ */
+bool kalmanCoreHistoryGetMotion(const kalmanCoreHistory_t* this, const uint32_t timestampMs, kalmanCoreHistorySample_t* motion);
+
+/**
+ * @brief Move a position measured in the past to the current time
+ *
+ * The measured position is moved by the predicted motion since it was
+ * captured, the innovation is thus the same as if the measurement had been
+ * compared to the state at the time of capture.
+ *
+ * @param motion The motion since the measurement was captured
+ * @param pos The measured position, updated in place
+ */
+void kalmanCoreHistoryShiftPosition(const kalmanCoreHistorySample_t* motion, float pos[3]);
+
+/**
+ * @brief Rotate an attitude measured in the past to the current time
+ *
+ * @param motion The motion since the measurement was captured
+ * @param quat The measured attitude, updated in place
+ */
+void kalmanCoreHistoryShiftAttitude(const kalmanCoreHistorySample_t* motion, quaternion_t* quat);
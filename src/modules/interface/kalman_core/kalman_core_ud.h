@@ -0,0 +1,95 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * kalman_core_ud.h - UD factorized covariance for the kalman core
+ *
+ * The covariance is stored as P = U * diag(D) * U', where U is unit upper
+ * triangular and D is non negative. Measurement updates use Bierman's scalar
+ * update and the prediction uses Thornton's modified weighted Gram-Schmidt
+ * time update. Both work on the factors directly, P stays symmetric and
+ * positive semi definite by construction.
+ *
+ * Reference: G. J. Bierman, "Factorization Methods for Discrete Sequential
+ * Estimation", Academic Press, 1977
+ */
+
+#pragma once
+
+#include <stdbool.h>
+
+#include "kalman_core_covariance.h"
+
+/**
+ * @brief Factorize a covariance matrix, P = U * diag(D) * U'
+ *
+ * @param P The symmetric covariance matrix
+ * @param U The unit upper triangular factor
+ * @param D The diagonal factor
+ * @return false if P is not positive semi definite. The columns of U for the non positive pivots are then zero.
+ */
+bool kalmanCoreUdFactor(const float P[KC_COVARIANCE_DIM][KC_COVARIANCE_DIM], float U[KC_COVARIANCE_DIM][KC_COVARIANCE_DIM], float D[KC_COVARIANCE_DIM]);
+
+/**
+ * @brief Compute the covariance from its factors, P = U * diag(D) * U'
+ */
+void kalmanCoreUdToCovariance(const float U[KC_COVARIANCE_DIM][KC_COVARIANCE_DIM], const float D[KC_COVARIANCE_DIM], float P[KC_COVARIANCE_DIM][KC_COVARIANCE_DIM]);
+
+/**
+ * @brief Bierman scalar measurement update of the factors
+ *
+ * @param U The unit upper triangular factor, updated in place
+ * @param D The diagonal factor, updated in place
+ * @param h The measurement jacobian
+ * @param R The measurement variance, must be larger than zero
+ * @param K The kalman gain, to be used for the state update
+ */
+void kalmanCoreUdScalarUpdate(float U[KC_COVARIANCE_DIM][KC_COVARIANCE_DIM], float D[KC_COVARIANCE_DIM], const float h[KC_COVARIANCE_DIM], const float R, float K[KC_COVARIANCE_DIM]);
+
+/**
+ * @brief Thornton time update of the factors, P = A * P * A'
+ *
+ * @param U The unit upper triangular factor, updated in place
+ * @param D The diagonal factor, updated in place
+ * @param A The blocks of the jacobian
+ */
+void kalmanCoreUdPredict(float U[KC_COVARIANCE_DIM][KC_COVARIANCE_DIM], float D[KC_COVARIANCE_DIM], const kalmanCoreJacobian_t* A);
+
+/**
+ * @brief Thornton time update of the factors with A = diag(I, I, attAtt)
+ *
+ * @param U The unit upper triangular factor, updated in place
+ * @param D The diagonal factor, updated in place
+ * @param attAtt The rotation of the attitude error
+ */
+void kalmanCoreUdRotateAttitude(float U[KC_COVARIANCE_DIM][KC_COVARIANCE_DIM], float D[KC_COVARIANCE_DIM], const float attAtt[KC_COVARIANCE_BLOCK][KC_COVARIANCE_BLOCK]);
+
+/**
+ * @brief Add diagonal process noise to the factors, P = P + diag(q)
+ *
+ * Uses one rank one update (Agee-Turner) per non zero element of q.
+ *
+ * @param U The unit upper triangular factor, updated in place
+ * @param D The diagonal factor, updated in place
+ * @param q The variances to add
+ */
+void kalmanCoreUdAddDiagonal(float U[KC_COVARIANCE_DIM][KC_COVARIANCE_DIM], float D[KC_COVARIANCE_DIM], const float q[KC_COVARIANCE_DIM]);
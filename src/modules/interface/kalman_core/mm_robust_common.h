@@ -0,0 +1,88 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * mm_robust_common.h - Shared covariance handling of the robust M-estimation measurement models
+ */
+
+#pragma once
+
+#include "kalman_core_covariance.h"
+
+/**
+ * @brief The weighted prior covariance of a robust (M-estimation) update
+ *
+ * The robust TDoA and TWR updates reweight the prior covariance with a
+ * diagonal weight in each iteration, P_w = L * inv(W) * L', where L is the
+ * Cholesky factor of the current covariance. Since L * inv(W)^(1/2) is again
+ * lower triangular, it is the Cholesky factor of P_w. The prior is therefore
+ * factorized once and the iterations only update a column scaling.
+ */
+typedef struct {
+  // Cholesky factor of the prior covariance
+  float L[KC_COVARIANCE_DIM][KC_COVARIANCE_DIM];
+
+  // The weighted covariance is L * diag(scale)^2 * L'
+  float scale[KC_COVARIANCE_DIM];
+} robustCovariance_t;
+
+/**
+ * @brief Factorize the prior covariance and reset the weights
+ *
+ * @param this The weighted covariance
+ * @param P The prior covariance
+ */
+void robustCovarianceInit(robustCovariance_t* this, const float P[KC_COVARIANCE_DIM][KC_COVARIANCE_DIM]);
+
+/**
+ * @brief Reweight the covariance with the Geman-McClure weights of the normalized state error
+ *
+ * The normalized error is inv(L * diag(scale)) * xErr, computed with a forward substitution.
+ *
+ * @param this The weighted covariance
+ * @param xErr The error state of the previous iteration
+ * @param sigma The parameter of the Geman-McClure weight function
+ */
+void robustCovarianceReweight(robustCovariance_t* this, const float xErr[KC_COVARIANCE_DIM], const float sigma);
+
+/**
+ * @brief Kalman gain of a scalar measurement with the weighted covariance
+ *
+ * @param this The weighted covariance
+ * @param h The measurement jacobian
+ * @param R The (weighted) measurement variance
+ * @param K The kalman gain
+ */
+void robustCovarianceGain(const robustCovariance_t* this, const float h[KC_COVARIANCE_DIM], const float R, float K[KC_COVARIANCE_DIM]);
+
+/**
+ * @brief Get the weighted covariance, P = L * diag(scale)^2 * L'
+ */
+void robustCovarianceGet(const robustCovariance_t* this, float P[KC_COVARIANCE_DIM][KC_COVARIANCE_DIM]);
+
+/**
+ * @brief Geman-McClure weight function of the robust cost
+ *
+ * For a given error e, decreasing sigma gives a smaller weight to the error,
+ * that is a larger variance and less trust in the measurement.
+ */
+float robustWeightGM(const float e, const float sigma);
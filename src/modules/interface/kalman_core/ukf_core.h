@@ -0,0 +1,153 @@
+/**
+ *                                             __
+ *    __  __ ____      ____  __  __ __________/ /_  __   _____________
+ *   / /_/ / ___/____ / __ `/ / / /´__  / ___/ __ \/ /  / / ___/ __  /
+ *  / __  (__  )/___// /_/ / /_/ / /_/ (__  ) /_/ / /__/ / /  / /_/ /
+ * /_/ /_/____/      \__,_/_____/\__  /____/\____/______/_/   \__  /
+ *                              /____/                       /____/
+ * Crazyflie Project
+ *
+ * Copyright (C) 2019-2022 University of Applied Sciences Augsburg
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * ============================================================================
+ * Error-State Unscented Kalman Filter - math core
+ * ============================================================================
+ *
+ * The filter math of the error-state UKF (see estimator_ukf.c), without any
+ * dependencies on FreeRTOS or the sensor system. This makes it possible to
+ * unit test and benchmark the filter on the host.
+ *
+ * The filter uses the spherical simplex sigma point set, DIM + 2 points.
+ *
+ * Two representations of the covariance are supported:
+ * - Standard: the covariance P is stored and factorized (Cholesky) every time
+ *   new sigma points are needed.
+ * - Square root: the lower triangular Cholesky factor S (P = S * S') is
+ *   stored and propagated directly, using a QR decomposition in the
+ *   prediction and a rank one downdate in the scalar measurement update.
+ *   No factorization is needed to generate sigma points, and the covariance
+ *   stays positive definite by construction.
+ *
+ * ============================================================================
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Dimension of the error state: position, velocity, attitude error
+#define UKF_CORE_DIM 9
+#define UKF_CORE_SIGMA_POINTS (UKF_CORE_DIM + 2)
+
+// The data used by the UKF core implementation.
+typedef struct {
+  // The error state estimate
+  float x[UKF_CORE_DIM];
+
+  // The covariance matrix, only valid in standard mode. Use ukfCoreGetCovariance() to read it in both modes.
+  float P[UKF_CORE_DIM][UKF_CORE_DIM];
+
+  // Lower triangular Cholesky factor of the covariance, P = S * S'. Always valid in square root mode,
+  // valid after ukfCoreComputeSigmaPoints() in standard mode.
+  float S[UKF_CORE_DIM][UKF_CORE_DIM];
+
+  // Sigma points, one point per row to make it possible to pass a point to an output function
+  float sigmaPoints[UKF_CORE_SIGMA_POINTS][UKF_CORE_DIM];
+
+  // Sigma point template, normalized to mean 0 and covariance I
+  float sigmaPointsTempl[UKF_CORE_SIGMA_POINTS][UKF_CORE_DIM];
+  float weights[UKF_CORE_SIGMA_POINTS];
+
+  bool squareRoot;
+
+  // Number of times a square root downdate failed and the factor had to be recomputed from the covariance
+  uint32_t downdateFailures;
+} ukfCoreData_t;
+
+/**
+ * @brief Initialize the filter
+ *
+ * The error state is set to zero and the covariance to a diagonal matrix.
+ *
+ * @param this The filter data
+ * @param stdDevInitial Initial standard deviation of each error state
+ * @param weight0 Weight of the center sigma point, 0 < weight0 < 1
+ * @param squareRoot true to use the square root formulation
+ */
+void ukfCoreInit(ukfCoreData_t* this, const float stdDevInitial[UKF_CORE_DIM], const float weight0, const bool squareRoot);
+
+/**
+ * @brief Compute the sigma points from the current estimate and covariance
+ */
+void ukfCoreComputeSigmaPoints(ukfCoreData_t* this);
+
+/**
+ * @brief Prediction step with a linear error state transition
+ *
+ * The sigma points must be up to date when this function is called. They are
+ * recomputed before the function returns.
+ *
+ * @param this The filter data
+ * @param F Error state transition matrix
+ * @param Q Process noise covariance matrix
+ * @param sqrtQ Factor of the process noise with Q = sqrtQ * sqrtQ', only used in square root mode. Typically built in
+ *              closed form from the structure of Q, to avoid a factorization in every prediction.
+ */
+void ukfCorePredict(ukfCoreData_t* this, float F[UKF_CORE_DIM][UKF_CORE_DIM], float Q[UKF_CORE_DIM][UKF_CORE_DIM], float sqrtQ[UKF_CORE_DIM][UKF_CORE_DIM]);
+
+/**
+ * @brief Compute the mean, variance and state cross covariance of a scalar output
+ *
+ * @param this The filter data
+ * @param outputs The output function evaluated for each sigma point
+ * @param mean The weighted mean of the outputs
+ * @param Pyy The output variance, measurement noise not included
+ * @param Pxy The cross covariance between the error state and the output
+ */
+void ukfCoreOutputMoments(const ukfCoreData_t* this, const float outputs[UKF_CORE_SIGMA_POINTS], float* mean, float* Pyy, float Pxy[UKF_CORE_DIM]);
+
+/**
+ * @brief Scalar measurement update
+ *
+ * @param this The filter data
+ * @param Pxy The cross covariance between the error state and the output
+ * @param Pyy The innovation variance, measurement noise included
+ * @param innovation The measured value minus the predicted output
+ */
+void ukfCoreScalarUpdate(ukfCoreData_t* this, const float Pxy[UKF_CORE_DIM], const float Pyy, const float innovation);
+
+/**
+ * @brief Get the covariance matrix, in both standard and square root mode
+ */
+void ukfCoreGetCovariance(const ukfCoreData_t* this, float P[UKF_CORE_DIM][UKF_CORE_DIM]);
+
+/**
+ * @brief Cholesky factorization A = L * L', L lower triangular
+ *
+ * @return false if A is not positive definite
+ */
+bool ukfCoreCholesky(const float* A, float* L, const uint8_t n);
+
+/**
+ * @brief Rank one update of a Cholesky factor, L * L' + sign * v * v'
+ *
+ * @param L Lower triangular n x n factor, updated in place
+ * @param v Vector, used as work space and destroyed
+ * @param n Dimension
+ * @param downdate true to subtract v * v' instead of adding it
+ * @return false if the downdated matrix is not positive definite, L is then invalid
+ */
+bool ukfCoreCholeskyUpdate(float* L, float* v, const uint8_t n, const bool downdate);
@@ -94,6 +94,14 @@ void* logGetAddress(logVarId_t varid);
  */
 uint8_t logVarSize(int type);
 
+/** Copy the current value of a logging variable, also for variables
+ * acquired by a function (LOG_ADD_BY_FUNCTION)
+ *
+ * @param varid variable ID, returned by logGetVarId()
+ * @param value Buffer of logVarSize(logGetType(varid)) bytes
+ */
+void logGetValue(logVarId_t varid, void* value);
+
 /** Return float value of a logging variable
  *
  * @param varid variable ID, returned by logGetVarId()
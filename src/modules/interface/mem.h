@@ -42,6 +42,9 @@ typedef enum {
   MEM_TYPE_LEDMEM   = 0x17,
   MEM_TYPE_APP      = 0x18,
   MEM_TYPE_DECK_MEM = 0x19,
+  MEM_TYPE_GYRO_SPECTRUM = 0x1A,
+  MEM_TYPE_EVENT_TRACE = 0x1B,
+  MEM_TYPE_TASK_LOAD = 0x1C,
 } MemoryType_t;
 
 #define MEMORY_SERIAL_LENGTH 8
@@ -30,6 +30,11 @@ SOFTWARE.
 #include <stdint.h>
 #include <math.h>
 
+// Not defined in strict ISO C mode (unit tests)
+#ifndef M_SQRT1_2
+#define M_SQRT1_2 0.70710678118654752440
+#endif
+
 // assumes input quaternion is normalized. will fail if not.
 static inline uint32_t quatcompress(float const q[4])
 {
@@ -27,6 +27,8 @@
 
 #pragma once
 
+#include <stdint.h>
+
 typedef enum {
     rangeFront=0,
     rangeBack,
@@ -45,6 +47,15 @@ typedef enum {
  */
 void rangeSet(rangeDirection_t direction, float range_m);
 
+/**
+ * Set the range for a certain direction, together with the time it was sampled
+ *
+ * @param direction Direction of the range
+ * @param range_m Distance to an object in meter
+ * @param timestamp The time when the range was sampled (in ms)
+ */
+void rangeSetWithTimestamp(rangeDirection_t direction, float range_m, uint32_t timestamp);
+
 /**
  * Get the range for a certain direction
  *
@@ -53,6 +64,14 @@ void rangeSet(rangeDirection_t direction, float range_m);
  */
 float rangeGet(rangeDirection_t direction);
 
+/**
+ * Get the time when the range for a certain direction was sampled
+ *
+ * @param direction Direction of the range
+ * @return The time when the range was sampled (in ms), 0 if not known
+ */
+uint32_t rangeGetTimestamp(rangeDirection_t direction);
+
 /**
  * Enqueue a range measurement for distance to the ground in the current estimator.
  *
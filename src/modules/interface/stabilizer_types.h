@@ -127,6 +127,7 @@ typedef struct positionMeasurement_s {
   };
   float stdDev;
   measurementSource_t source;
+  uint32_t timestamp;       // ms, time of capture. 0 if unknown (the measurement is considered to be current)
 } positionMeasurement_t;
 
 typedef struct poseMeasurement_s {
@@ -141,6 +142,7 @@ typedef struct poseMeasurement_s {
   quaternion_t quat;
   float stdDevPos;
   float stdDevQuat;
+  uint32_t timestamp;       // ms, time of capture. 0 if unknown (the measurement is considered to be current)
 } poseMeasurement_t;
 
 typedef struct distanceMeasurement_s {
@@ -357,6 +359,15 @@ typedef struct
   baro_t baro; // for legacy reasons
 } barometerMeasurement_t;
 
+/** IMU sample, gyroscope and accelerometer measured at the same time */
+typedef struct
+{
+  Axis3f gyro; // deg/s, for legacy reasons
+  Axis3f acc; // Gs, for legacy reasons, only valid if hasAcc is set
+  uint64_t timestamp; // usec, time the sample was taken
+  bool hasAcc; // false for gyro samples taken between two accelerometer samples
+} imuMeasurement_t;
+
 
 // Frequencies to be used with the RATE_DO_EXECUTE_HZ macro. Do NOT use an arbitrary number.
 #define RATE_1000_HZ 1000
@@ -0,0 +1,110 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * state_stream.h - Compact state and setpoint snapshot stream
+ */
+
+/**
+ * Streams snapshots of the state estimate and the setpoint from the
+ * stabilizer loop, one CRTP packet per snapshot, on the generic
+ * localization channel. The packets are only computed on the ticks they are
+ * sent, and only when the stream is enabled with the stateStrm.enable
+ * parameter. The rate is set with the stateStrm.rate parameter, it must be a
+ * divisor of the stabilizer loop rate (1000 Hz) and other values are clamped
+ * down to the closest divisor.
+ *
+ * All snapshots taken on the same tick have the same sequence number, which
+ * makes it possible to pair state and setpoint packets and to detect lost
+ * packets.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "stabilizer_types.h"
+
+// Bits of the stateStrm.enable parameter
+#define STATE_STREAM_STATE    0x01
+#define STATE_STREAM_SETPOINT 0x02
+
+typedef struct {
+  uint8_t type;       // STATE_SNAPSHOT
+  uint16_t seq;
+  uint32_t timestamp; // ms, time of the sensor sample of the snapshot
+  // position - mm
+  int16_t x;
+  int16_t y;
+  int16_t z;
+  // velocity - mm / sec
+  int16_t vx;
+  int16_t vy;
+  int16_t vz;
+  // compressed quaternion, see quatcompress.h
+  uint32_t quat;
+  // angular velocity - milliradians / sec
+  int16_t rateRoll;
+  int16_t ratePitch;
+  int16_t rateYaw;
+} __attribute__((packed)) stateSnapshotPacket_t;
+
+typedef struct {
+  uint8_t type;       // SETPOINT_SNAPSHOT
+  uint16_t seq;
+  uint32_t timestamp; // ms, time of the sensor sample of the snapshot
+  // position - mm
+  int16_t x;
+  int16_t y;
+  int16_t z;
+  // velocity - mm / sec
+  int16_t vx;
+  int16_t vy;
+  int16_t vz;
+  // acceleration - mm / sec^2
+  int16_t ax;
+  int16_t ay;
+  int16_t az;
+  // yaw - centidegrees
+  int16_t yaw;
+} __attribute__((packed)) setpointSnapshotPacket_t;
+
+/**
+ * @brief Called from the stabilizer loop, sends the snapshots if the stream is enabled and it is time to send
+ */
+void stateStreamUpdate(const state_t* state, const setpoint_t* setpoint, const sensorData_t* sensorData, const stabilizerStep_t stabilizerStep);
+
+/**
+ * @brief The rate that is used for a requested rate, the largest divisor of the stabilizer loop rate that is not
+ * higher than the requested rate, exposed for testing
+ */
+uint16_t stateStreamClampRate(const uint16_t rate);
+
+/**
+ * @brief Pack a state snapshot, exposed for testing
+ */
+void stateStreamPackState(stateSnapshotPacket_t* packet, const uint32_t timestamp, const state_t* state, const sensorData_t* sensorData);
+
+/**
+ * @brief Pack a setpoint snapshot, exposed for testing
+ */
+void stateStreamPackSetpoint(setpointSnapshotPacket_t* packet, const uint32_t timestamp, const setpoint_t* setpoint);
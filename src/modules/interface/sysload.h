@@ -1,6 +1,31 @@
 #ifndef __SYSLOAD_H__
 #define __SYSLOAD_H__
 
+#include <stdint.h>
+
+/**
+ * The system load monitor measures the CPU load, the longest uninterrupted
+ * run and the stack headroom of every task, and the time spent in
+ * interrupts, once per second. The result is available in the sysload log
+ * group and the MEM_TYPE_TASK_LOAD memory.
+ *
+ * This file is included by the FreeRTOS configuration and must not include
+ * any FreeRTOS headers.
+ */
+
 void sysLoadInit();
 
-#endif
\ No newline at end of file
+/**
+ * @brief Called by the scheduler when a task is switched out, measures the
+ * length of the run
+ */
+void sysLoadTaskSwitchedOut(const uint32_t taskNumber);
+
+/**
+ * @brief Called at entry and exit of instrumented interrupt handlers to
+ * measure the time spent in interrupts. Handles nested interrupts.
+ */
+void sysLoadIsrEnter(void);
+void sysLoadIsrExit(void);
+
+#endif
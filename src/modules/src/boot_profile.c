@@ -0,0 +1,153 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * boot_profile.c - Time of the init and test phases of the system start
+ */
+
+#define DEBUG_MODULE "BOOT"
+
+#include <stdbool.h>
+
+#include "boot_profile.h"
+#include "debug.h"
+#include "log.h"
+#include "usec_time.h"
+
+static const char* const phaseNames[bootPhaseCount] = {
+  [bootPhaseSystemInit] = "systemInit",
+  [bootPhaseCommInit] = "commInit",
+  [bootPhaseCommanderInit] = "commanderInit",
+  [bootPhaseEstimatorInit] = "estimatorInit",
+  [bootPhaseMemInit] = "memInit",
+  [bootPhaseDeckInit] = "deckInit",
+  [bootPhaseSensorsInit] = "sensorsInit",
+  [bootPhaseStabilizerInit] = "stabilizerInit",
+  [bootPhaseSoundInit] = "soundInit",
+  [bootPhaseStorageTest] = "storageTest",
+  [bootPhaseDeckTest] = "deckTest",
+  [bootPhaseTests] = "tests",
+};
+
+// Start of each phase, us
+static uint32_t phaseStart[bootPhaseCount];
+// Duration of each phase, us
+static uint32_t phaseDuration[bootPhaseCount];
+// Time when the system was ready, us
+static uint32_t readyTime;
+
+void bootProfileBegin(const bootPhase_t phase)
+{
+  phaseStart[phase] = (uint32_t)usecTimestamp();
+}
+
+void bootProfileEnd(const bootPhase_t phase)
+{
+  phaseDuration[phase] = (uint32_t)usecTimestamp() - phaseStart[phase];
+}
+
+void bootProfileReady(void)
+{
+  readyTime = (uint32_t)usecTimestamp();
+
+  // eprintf() does not support field widths for %s and %u
+  DEBUG_PRINT("Boot report, start and duration in us:\n");
+  for (int i = 0; i < bootPhaseCount; i++) {
+    DEBUG_PRINT("%s %u %u\n", phaseNames[i], (unsigned int)phaseStart[i], (unsigned int)phaseDuration[i]);
+  }
+  DEBUG_PRINT("Ready after %u ms\n", (unsigned int)(readyTime / 1000));
+}
+
+/**
+ * Duration of the init and test phases of the system start, in microseconds.
+ * The phases are listed in the same order as they are started. With
+ * CONFIG_SYSTEM_PARALLEL_INIT, sensorsInit and storageTest run in parallel
+ * with the phases from commInit to deckInit.
+ */
+LOG_GROUP_START(boot)
+
+/**
+ * @brief Time when the system was ready to fly [us]
+ */
+LOG_ADD(LOG_UINT32, ready, &readyTime)
+
+/**
+ * @brief Duration of systemInit, including storage and config block init [us]
+ */
+LOG_ADD(LOG_UINT32, systemInit, &phaseDuration[bootPhaseSystemInit])
+
+/**
+ * @brief Duration of commInit, including restoring parameters from storage [us]
+ */
+LOG_ADD(LOG_UINT32, commInit, &phaseDuration[bootPhaseCommInit])
+
+/**
+ * @brief Duration of commanderInit [us]
+ */
+LOG_ADD(LOG_UINT32, commanderInit, &phaseDuration[bootPhaseCommanderInit])
+
+/**
+ * @brief Duration of the init of the estimator tasks [us]
+ */
+LOG_ADD(LOG_UINT32, estimatorInit, &phaseDuration[bootPhaseEstimatorInit])
+
+/**
+ * @brief Duration of memInit [us]
+ */
+LOG_ADD(LOG_UINT32, memInit, &phaseDuration[bootPhaseMemInit])
+
+/**
+ * @brief Duration of deck discovery and init [us]
+ */
+LOG_ADD(LOG_UINT32, deckInit, &phaseDuration[bootPhaseDeckInit])
+
+/**
+ * @brief Duration of sensorsInit, including the sensor startup time [us]
+ */
+LOG_ADD(LOG_UINT32, sensorsInit, &phaseDuration[bootPhaseSensorsInit])
+
+/**
+ * @brief Duration of stabilizerInit [us]
+ */
+LOG_ADD(LOG_UINT32, stabilizerInit, &phaseDuration[bootPhaseStabilizerInit])
+
+/**
+ * @brief Duration of soundInit [us]
+ */
+LOG_ADD(LOG_UINT32, soundInit, &phaseDuration[bootPhaseSoundInit])
+
+/**
+ * @brief Duration of the storage check [us]
+ */
+LOG_ADD(LOG_UINT32, storageTest, &phaseDuration[bootPhaseStorageTest])
+
+/**
+ * @brief Duration of the deck tests [us]
+ */
+LOG_ADD(LOG_UINT32, deckTest, &phaseDuration[bootPhaseDeckTest])
+
+/**
+ * @brief Duration of all tests, including the storage check and deck tests when they are run in sequence [us]
+ */
+LOG_ADD(LOG_UINT32, tests, &phaseDuration[bootPhaseTests])
+
+LOG_GROUP_STOP(boot)
@@ -24,14 +24,20 @@
  * console.c - Used to send console data to client
  */
 
+#include <assert.h>
+#include <stdarg.h>
 #include <string.h>
 
 /*FreeRtos includes*/
 #include "FreeRTOS.h"
+#include "task.h"
 #include "semphr.h"
 #include "console.h"
 
+#include "config.h"
 #include "crtp.h"
+#include "consoleBuffer.h"
+#include "static_mem.h"
 
 #ifdef STM32F40_41xxx
 #include "stm32f4xx.h"
@@ -42,33 +48,131 @@
 #endif
 #endif
 
-static CRTPPacket messageToPrint;
-static bool messageSendingIsPending = false;
-static xSemaphoreHandle synch = NULL;
+/*
+The console text is written to a ring of packets, taking the lock once per call
+and not once per character. The packets are sent by a low priority task.
+Interrupts write to a lock free staging buffer that is moved to the ring by the
+task. See consoleBuffer.h.
+*/
 
-static const char bufferFullMsg[] = "<F>\n";
+// Max time characters from interrupts stay in the staging buffer
+#define CONSOLE_FLUSH_PERIOD_MS 10
+
+static_assert(CONSOLE_BUFFER_PAYLOAD_SIZE == CRTP_MAX_DATA_SIZE, "Console packets must fit in a CRTP packet");
+
+static consoleBufferRing_t ring;
+static consoleBufferStaging_t staging;
+
+static SemaphoreHandle_t lock;
+static StaticSemaphore_t lockBuffer;
+
+// The console task is sending the oldest packet in the ring
+static bool isSending;
+
+static TaskHandle_t consoleTaskHandle;
 static bool isInit;
 
-static void addBufferFullMarker();
+// Number of tokenized messages that could not be sent, updated atomically by all tasks and interrupts
+static uint32_t tokenizedDropped;
+
+static void consoleTask(void *param);
+STATIC_MEM_TASK_ALLOC(consoleTask, CONSOLE_TASK_STACKSIZE);
+
+static bool isInInterrupt(void)
+{
+  return (SCB->ICSR & SCB_ICSR_VECTACTIVE_Msk) != 0;
+}
+
+/**
+ * Send closed packets directly, without blocking, when the ring is getting full. This happens
+ * when the console task does not get to run, for instance when other tasks print during
+ * system initialization. Must be called with the lock taken.
+ */
+static void sendWhenAlmostFull(void)
+{
+  static CRTPPacket packet;
+  const consoleBufferPacket_t* front;
 
+  while (!isSending && consoleBufferRingCount(&ring) >= CONSOLE_BUFFER_PACKETS / 2 &&
+         (front = consoleBufferRingFront(&ring)) != 0)
+  {
+    packet.header = CRTP_HEADER(CRTP_PORT_CONSOLE, CONSOLE_CHANNEL_TEXT);
+    packet.size = front->size;
+    memcpy(packet.data, front->data, front->size);
+    if (crtpSendPacket(&packet) != pdTRUE)
+    {
+      break;
+    }
+    consoleBufferRingPop(&ring);
+  }
+}
 
 /**
- * Send the data to the client
- * returns TRUE if successful otherwise FALSE
+ * Called after writing to the ring, with the lock taken
  */
-static bool consoleSendMessage(void)
+static void packetsWritten(const bool packetClosed)
 {
-  if (crtpSendPacket(&messageToPrint) == pdTRUE)
+  if (packetClosed)
   {
-    messageToPrint.size = 0;
-    messageSendingIsPending = false;
+    sendWhenAlmostFull();
   }
-  else
+  xSemaphoreGive(lock);
+
+  if (packetClosed)
   {
-    return false;
+    xTaskNotifyGive(consoleTaskHandle);
   }
+}
 
-  return true;
+/**
+ * eprintf() putc function, the lock must be taken
+ */
+static int putcharLocked(int ch)
+{
+  consoleBufferRingPutchar(&ring, (char)ch);
+  return (unsigned char)ch;
+}
+
+static void consoleTask(void *param)
+{
+  CRTPPacket packet;
+  packet.header = CRTP_HEADER(CRTP_PORT_CONSOLE, CONSOLE_CHANNEL_TEXT);
+
+  while (true)
+  {
+    ulTaskNotifyTake(pdTRUE, M2T(CONSOLE_FLUSH_PERIOD_MS));
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    consoleBufferStagingDrain(&staging, &ring);
+    xSemaphoreGive(lock);
+
+    while (true)
+    {
+      xSemaphoreTake(lock, portMAX_DELAY);
+      const consoleBufferPacket_t* front = consoleBufferRingFront(&ring);
+      if (front)
+      {
+        packet.size = front->size;
+        memcpy(packet.data, front->data, front->size);
+        isSending = true;
+      }
+      xSemaphoreGive(lock);
+
+      if (!front)
+      {
+        break;
+      }
+
+      // Writers never wait for the CRTP queue, only this task does. The packet stays in the ring
+      // while it is sent to keep the order if a writer sends directly.
+      crtpSendPacketBlock(&packet);
+
+      xSemaphoreTake(lock, portMAX_DELAY);
+      consoleBufferRingPop(&ring);
+      isSending = false;
+      xSemaphoreGive(lock);
+    }
+  }
 }
 
 void consoleInit()
@@ -76,10 +180,12 @@ void consoleInit()
   if (isInit)
     return;
 
-  messageToPrint.size = 0;
-  messageToPrint.header = CRTP_HEADER(CRTP_PORT_CONSOLE, 0);
-  vSemaphoreCreateBinary(synch);
-  messageSendingIsPending = false;
+  consoleBufferRingInit(&ring);
+  consoleBufferStagingInit(&staging);
+  lock = xSemaphoreCreateMutexStatic(&lockBuffer);
+  isSending = false;
+
+  consoleTaskHandle = STATIC_MEM_TASK_CREATE(consoleTask, consoleTask, CONSOLE_TASK_NAME, NULL, CONSOLE_TASK_PRI);
 
   isInit = true;
 }
@@ -91,106 +197,127 @@ bool consoleTest(void)
 
 int consolePutchar(int ch)
 {
-  bool isInInterrupt = (SCB->ICSR & SCB_ICSR_VECTACTIVE_Msk) != 0;
-
   if (!isInit) {
     return 0;
   }
 
-  if (isInInterrupt) {
+  if (isInInterrupt()) {
     return consolePutcharFromISR(ch);
   }
 
-  if (xSemaphoreTake(synch, portMAX_DELAY) == pdTRUE)
+  if (xSemaphoreTake(lock, portMAX_DELAY) == pdTRUE)
   {
-    // Try to send if we already have a pending message
-    if (messageSendingIsPending)
-    {
-      consoleSendMessage();
-    }
-
-    if (! messageSendingIsPending)
-    {
-      if (messageToPrint.size < CRTP_MAX_DATA_SIZE)
-      {
-        messageToPrint.data[messageToPrint.size] = (unsigned char)ch;
-        messageToPrint.size++;
-      }
-
-      if (ch == '\n' || messageToPrint.size >= CRTP_MAX_DATA_SIZE)
-      {
-        if (crtpGetFreeTxQueuePackets() == 1)
-        {
-          addBufferFullMarker();
-        }
-        messageSendingIsPending = true;
-        consoleSendMessage();
-      }
-    }
-    xSemaphoreGive(synch);
+    packetsWritten(consoleBufferRingPutchar(&ring, (char)ch));
   }
 
   return (unsigned char)ch;
 }
 
 int consolePutcharFromISR(int ch) {
-  BaseType_t higherPriorityTaskWoken;
+  if (!isInit) {
+    return 0;
+  }
 
-  if (xSemaphoreTakeFromISR(synch, &higherPriorityTaskWoken) == pdTRUE) {
-    if (messageToPrint.size < CRTP_MAX_DATA_SIZE)
-    {
-      messageToPrint.data[messageToPrint.size] = (unsigned char)ch;
-      messageToPrint.size++;
-    }
-    xSemaphoreGiveFromISR(synch, &higherPriorityTaskWoken);
+  consoleBufferStagingPut(&staging, (char)ch);
+
+  if (ch == '\n') {
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    vTaskNotifyGiveFromISR(consoleTaskHandle, &higherPriorityTaskWoken);
+    portYIELD_FROM_ISR(higherPriorityTaskWoken);
   }
 
-  return ch;
+  return (unsigned char)ch;
 }
 
 int consolePuts(const char *str)
 {
-  int ret = 0;
+  if (!isInit) {
+    return 0;
+  }
+
+  if (isInInterrupt()) {
+    int ret = 0;
+    while(*str)
+      ret |= consolePutcharFromISR(*str++);
+    return ret;
+  }
 
-  while(*str)
-    ret |= consolePutchar(*str++);
+  int ret = 0;
+  if (xSemaphoreTake(lock, portMAX_DELAY) == pdTRUE)
+  {
+    bool packetClosed = false;
+    while(*str)
+    {
+      ret |= (unsigned char)*str;
+      packetClosed |= consoleBufferRingPutchar(&ring, *str++);
+    }
+    packetsWritten(packetClosed);
+  }
 
   return ret;
 }
 
-void consoleFlush(void)
+int consolePrintf(const char *fmt, ...)
 {
-  if (xSemaphoreTake(synch, portMAX_DELAY) == pdTRUE)
-  {
-    consoleSendMessage();
-    xSemaphoreGive(synch);
+  va_list ap;
+  int len = 0;
+
+  if (!isInit) {
+    return 0;
   }
-}
 
+  va_start(ap, fmt);
+  if (isInInterrupt()) {
+    len = evprintf(consolePutcharFromISR, fmt, ap);
+  } else if (xSemaphoreTake(lock, portMAX_DELAY) == pdTRUE) {
+    const uint32_t head = ring.head;
+    len = evprintf(putcharLocked, fmt, ap);
+    packetsWritten(ring.head != head);
+  }
+  va_end(ap);
+
+  return len;
+}
 
-static int findMarkerStart()
+int consolePrintTokenized(const uint32_t token, const uint32_t argTypes, ...)
 {
-  int start = messageToPrint.size;
+  // The CRTP queue can not be used from interrupts, the drop is reported with the next message
+  if (!isInit || isInInterrupt()) {
+    __atomic_fetch_add(&tokenizedDropped, 1, __ATOMIC_RELAXED);
+    return 0;
+  }
 
-  // If last char is new line, rewind one char since the marker contains a new line.
-  if (start > 0 && messageToPrint.data[start - 1] == '\n')
-  {
-    start -= 1;
+  const unsigned int dropped = __atomic_exchange_n(&tokenizedDropped, 0, __ATOMIC_RELAXED);
+  if (dropped > 0) {
+    if (consoleTokenizedPrintf("<F> %u messages dropped\n", dropped) == 0) {
+      __atomic_fetch_add(&tokenizedDropped, dropped, __ATOMIC_RELAXED);
+    }
+  }
+
+  CRTPPacket packet;
+  packet.header = CRTP_HEADER(CRTP_PORT_CONSOLE, CONSOLE_CHANNEL_TOKENIZED);
+
+  va_list ap;
+  va_start(ap, argTypes);
+  packet.size = tokenizeEncode(packet.data, CRTP_MAX_DATA_SIZE, token, argTypes, ap);
+  va_end(ap);
+
+  if (crtpSendPacket(&packet) != pdTRUE) {
+    __atomic_fetch_add(&tokenizedDropped, 1, __ATOMIC_RELAXED);
+    return 0;
   }
 
-  return start;
+  return packet.size;
 }
 
-static void addBufferFullMarker()
+void consoleFlush(void)
 {
-  // Try to add the marker after the message if it fits in the buffer, otherwise overwrite the end of the message
-  int endMarker = findMarkerStart() + sizeof(bufferFullMsg);
-  if (endMarker >= (CRTP_MAX_DATA_SIZE))
-  {
-    endMarker = CRTP_MAX_DATA_SIZE;
+  if (!isInit || isInInterrupt()) {
+    return;
   }
 
-  int startMarker = endMarker - sizeof(bufferFullMsg);
-  memcpy(&messageToPrint.data[startMarker], bufferFullMsg, sizeof(bufferFullMsg));
-  messageToPrint.size = startMarker + sizeof(bufferFullMsg);
+  if (xSemaphoreTake(lock, portMAX_DELAY) == pdTRUE)
+  {
+    packetsWritten(consoleBufferRingClose(&ring));
+  }
 }
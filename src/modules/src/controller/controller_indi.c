@@ -60,42 +60,48 @@ static inline void float_rates_zero(struct FloatRates *fr) {
 
 void indi_init_filters(void)
 {
-	// tau = 1/(2*pi*Fc)
-	float tau = 1.0f / (2.0f * M_PI_F * indi.filt_cutoff);
-	float tau_r = 1.0f / (2.0f * M_PI_F * indi.filt_cutoff_r);
-	float tau_axis[3] = {tau, tau, tau_r};
-	float sample_time = 1.0f / ATTITUDE_RATE;
-	// Filtering of gyroscope and actuators
+	float sample_freq = ATTITUDE_RATE;
+	// Filtering of gyroscope and actuators, with a separate cutoff frequency for yaw
+	lpf2pData design_r;
+	lpf2pSetCutoffFreq(&design_r, sample_freq, indi.filt_cutoff_r);
+	biquadNInitLpf(&indi.u, 3, sample_freq, indi.filt_cutoff);
+	biquadNInitLpf(&indi.rate, 3, sample_freq, indi.filt_cutoff);
+	biquadNSetCoeffs(&indi.u, 2, &design_r);
+	biquadNSetCoeffs(&indi.rate, 2, &design_r);
+
 	for (int8_t i = 0; i < 3; i++) {
-		init_butterworth_2_low_pass(&indi.u[i], tau_axis[i], sample_time, 0.0f);
-		init_butterworth_2_low_pass(&indi.rate[i], tau_axis[i], sample_time, 0.0f);
+		indi.u_f[i] = 0.0f;
+		indi.rate_f[i] = 0.0f;
+		indi.rate_f_prev[i] = 0.0f;
 	}
 }
 
 /**
  * @brief Update butterworth filter for p, q and r of a FloatRates struct
  *
- * @param filter The filter array to use
+ * @param filter The filter to use, one channel per axis
  * @param new_values The new values
+ * @param output The filtered values
  */
-static inline void filter_pqr(Butterworth2LowPass *filter, struct FloatRates *new_values)
+static inline void filter_pqr(biquadNData *filter, struct FloatRates *new_values, float *output)
 {
-	update_butterworth_2_low_pass(&filter[0], new_values->p);
-	update_butterworth_2_low_pass(&filter[1], new_values->q);
-	update_butterworth_2_low_pass(&filter[2], new_values->r);
+	output[0] = new_values->p;
+	output[1] = new_values->q;
+	output[2] = new_values->r;
+	biquadNApply(filter, output);
 }
 
 /**
- * @brief Caclulate finite difference form a filter array
- * The filter already contains the previous values
+ * @brief Caclulate finite difference from the filtered values of two time steps
  *
  * @param output The output array
- * @param filter The filter array input
+ * @param values The filtered values
+ * @param prev_values The filtered values of the previous time step
  */
-static inline void finite_difference_from_filter(float *output, Butterworth2LowPass *filter)
+static inline void finite_difference_from_filter(float *output, float *values, float *prev_values)
 {
 	for (int8_t i = 0; i < 3; i++) {
-		output[i] = (filter[i].o[0] - filter[i].o[1]) * ATTITUDE_RATE;
+		output[i] = (values[i] - prev_values[i]) * ATTITUDE_RATE;
 	}
 }
 
@@ -240,18 +246,21 @@ void controllerINDI(control_t *control, const setpoint_t *setpoint,
 		body_rates.q = -radians(sensors->gyro.y); //Account for gyro measuring pitch rate in opposite direction relative to both the CF coords and INDI coords
 		body_rates.r = -radians(sensors->gyro.z); //Account for conversion of ENU -> NED
 
-		filter_pqr(indi.rate, &body_rates);
+		for (int8_t i = 0; i < 3; i++) {
+			indi.rate_f_prev[i] = indi.rate_f[i];
+		}
+		filter_pqr(&indi.rate, &body_rates, indi.rate_f);
 
 		/*
 		 * 2 - Calculate the derivative with finite difference.
 		 */
 
-		finite_difference_from_filter(indi.rate_d, indi.rate);
+		finite_difference_from_filter(indi.rate_d, indi.rate_f, indi.rate_f_prev);
 
 		/*
 		 * 3 - same filter on the actuators (or control_t values), using the commands from the previous timestep.
 		 */
-		filter_pqr(indi.u, &indi.u_act_dyn);
+		filter_pqr(&indi.u, &indi.u_act_dyn, indi.u_f);
 
 
 		/*
@@ -289,9 +298,9 @@ void controllerINDI(control_t *control, const setpoint_t *setpoint,
 		 * 6. Add delta_commands to commands and bound to allowable values
 		 */
 
-		indi.u_in.p = indi.u[0].o[0] + indi.du.p;
-		indi.u_in.q = indi.u[1].o[0] + indi.du.q;
-		indi.u_in.r = indi.u[2].o[0] + indi.du.r;
+		indi.u_in.p = indi.u_f[0] + indi.du.p;
+		indi.u_in.q = indi.u_f[1] + indi.du.q;
+		indi.u_in.r = indi.u_f[2] + indi.du.r;
 
 		//bound the total control input
 		indi.u_in.p = clamp(indi.u_in.p, -1.0f*bound_control_input, bound_control_input);
@@ -506,28 +515,28 @@ LOG_ADD(LOG_FLOAT, rate_d[2], &indi.rate_d[2])
 /**
  * @brief INDI filtered (8Hz low-pass) roll motor input from previous time step [motor units]
  */
-LOG_ADD(LOG_FLOAT, uf_p, &indi.u[0].o[0])
+LOG_ADD(LOG_FLOAT, uf_p, &indi.u_f[0])
 /**
  * @brief INDI filtered (8Hz low-pass) pitch motor input from previous time step [motor units]
  */
-LOG_ADD(LOG_FLOAT, uf_q, &indi.u[1].o[0])
+LOG_ADD(LOG_FLOAT, uf_q, &indi.u_f[1])
 /**
  * @brief INDI filtered (8Hz low-pass) yaw motor input from previous time step [motor units]
  */
-LOG_ADD(LOG_FLOAT, uf_r, &indi.u[2].o[0])
+LOG_ADD(LOG_FLOAT, uf_r, &indi.u_f[2])
 
 /**
  * @brief INDI filtered gyroscope measurement (8Hz low-pass), roll [rad/s]
  */
-LOG_ADD(LOG_FLOAT, Omega_f_p, &indi.rate[0].o[0])
+LOG_ADD(LOG_FLOAT, Omega_f_p, &indi.rate_f[0])
 /**
  * @brief INDI filtered gyroscope measurement (8Hz low-pass), pitch [rad/s]
  */
-LOG_ADD(LOG_FLOAT, Omega_f_q, &indi.rate[1].o[0])
+LOG_ADD(LOG_FLOAT, Omega_f_q, &indi.rate_f[1])
 /**
  * @brief INDI filtered gyroscope measurement (8Hz low-pass), yaw [rad/s]
  */
-LOG_ADD(LOG_FLOAT, Omega_f_r, &indi.rate[2].o[0])
+LOG_ADD(LOG_FLOAT, Omega_f_r, &indi.rate_f[2])
 
 /**
  * @brief INDI desired attitude angle from outer loop, roll [rad]
@@ -58,38 +58,38 @@ static struct IndiOuterVariables indiOuter = {
 
 void position_indi_init_filters(void)
 {
-	// tau = 1/(2*pi*Fc)
-	float tau = 1.0f / (2.0f * M_PI_F * indiOuter.filt_cutoff);
-	float tau_axis[3] = {tau, tau, tau};
-	float sample_time = 1.0f / ATTITUDE_RATE;
+	float sample_freq = ATTITUDE_RATE;
 	// Filtering of linear acceleration, attitude and thrust 
-	for (int8_t i = 0; i < 3; i++) {
-		init_butterworth_2_low_pass(&indiOuter.ddxi[i], tau_axis[i], sample_time, 0.0f);
-		init_butterworth_2_low_pass(&indiOuter.ang[i], tau_axis[i], sample_time, 0.0f);
-		init_butterworth_2_low_pass(&indiOuter.thr[i], tau_axis[i], sample_time, 0.0f);
-	}
+	biquadNInitLpf(&indiOuter.ddxi, 3, sample_freq, indiOuter.filt_cutoff);
+	biquadNInitLpf(&indiOuter.ang, 3, sample_freq, indiOuter.filt_cutoff);
+	biquadNInitLpf(&indiOuter.thr, 1, sample_freq, indiOuter.filt_cutoff);
 }
 
 // Linear acceleration filter
-static inline void filter_ddxi(Butterworth2LowPass *filter, struct Vectr *old_values, struct Vectr *new_values)
+static inline void filter_ddxi(biquadNData *filter, struct Vectr *old_values, struct Vectr *new_values)
 {
-	new_values->x = update_butterworth_2_low_pass(&filter[0], old_values->x);
-	new_values->y = update_butterworth_2_low_pass(&filter[1], old_values->y);
-	new_values->z = update_butterworth_2_low_pass(&filter[2], old_values->z);
+	float values[3] = {old_values->x, old_values->y, old_values->z};
+	biquadNApply(filter, values);
+	new_values->x = values[0];
+	new_values->y = values[1];
+	new_values->z = values[2];
 }
 
 // Attitude filter
-static inline void filter_ang(Butterworth2LowPass *filter, struct Angles *old_values, struct Angles *new_values)
+static inline void filter_ang(biquadNData *filter, struct Angles *old_values, struct Angles *new_values)
 {
-	new_values->phi = update_butterworth_2_low_pass(&filter[0], old_values->phi);
-	new_values->theta = update_butterworth_2_low_pass(&filter[1], old_values->theta);
-	new_values->psi = update_butterworth_2_low_pass(&filter[2], old_values->psi);
+	float values[3] = {old_values->phi, old_values->theta, old_values->psi};
+	biquadNApply(filter, values);
+	new_values->phi = values[0];
+	new_values->theta = values[1];
+	new_values->psi = values[2];
 }
 
 // Thrust filter
-static inline void filter_thrust(Butterworth2LowPass *filter, float *old_thrust, float *new_thrust) 
+static inline void filter_thrust(biquadNData *filter, float *old_thrust, float *new_thrust) 
 {
-	*new_thrust = update_butterworth_2_low_pass(&filter[0], *old_thrust);
+	*new_thrust = *old_thrust;
+	biquadNApply(filter, new_thrust);
 }
 
 
@@ -159,13 +159,13 @@ void positionControllerINDI(const sensorData_t *sensors,
 	indiOuter.linear_accel_s.z = (-sensors->acc.z)*9.81f;
 
 	// Filter lin. acceleration 
-	filter_ddxi(indiOuter.ddxi, &indiOuter.linear_accel_s, &indiOuter.linear_accel_f);
+	filter_ddxi(&indiOuter.ddxi, &indiOuter.linear_accel_s, &indiOuter.linear_accel_f);
 
 	// Obtain actual attitude values (in rad)
 	indiOuter.attitude_s.phi = radians(state->attitude.roll); 
 	indiOuter.attitude_s.theta = radians(state->attitude.pitch);
 	indiOuter.attitude_s.psi = -radians(state->attitude.yaw);
-	filter_ang(indiOuter.ang, &indiOuter.attitude_s, &indiOuter.attitude_f);
+	filter_ang(&indiOuter.ang, &indiOuter.attitude_s, &indiOuter.attitude_f);
 
 
 	// Actual attitude (in rad)
@@ -245,7 +245,7 @@ void positionControllerINDI(const sensorData_t *sensors,
 	indiOuter.T_tilde     = -(g31_inv*indiOuter.linear_accel_err.x + g32_inv*indiOuter.linear_accel_err.y + g33_inv*indiOuter.linear_accel_err.z)/K_thr; 	
 
 	// Filter thrust
-	filter_thrust(indiOuter.thr, &indiOuter.T_incremented, &indiOuter.T_inner_f);
+	filter_thrust(&indiOuter.thr, &indiOuter.T_incremented, &indiOuter.T_inner_f);
 
 	// Pass thrust through the model of the actuator dynamics
 	indiOuter.T_inner = indiOuter.T_inner + indiOuter.act_dyn_posINDI*(indiOuter.T_inner_f - indiOuter.T_inner); 
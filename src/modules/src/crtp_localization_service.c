@@ -48,6 +48,7 @@
 
 #include "estimator.h"
 #include "quatcompress.h"
+#include "ext_pos_packed.h"
 
 #include "peer_localization.h"
 
@@ -101,23 +102,6 @@ typedef struct {
   uint8_t group_id_and_bs_count; // 4 bits group id, 4 bits base station count
 } __attribute__((packed)) matchedAnglePacket;
 
-// up to 4 items per CRTP packet
-typedef struct {
-  uint8_t id; // last 8 bit of the Crazyflie address
-  int16_t x; // mm
-  int16_t y; // mm
-  int16_t z; // mm
-} __attribute__((packed)) extPositionPackedItem;
-
-// up to 2 items per CRTP packet
-typedef struct {
-  uint8_t id; // last 8 bit of the Crazyflie address
-  int16_t x; // mm
-  int16_t y; // mm
-  int16_t z; // mm
-  uint32_t quat; // compressed quaternion, see quatcompress.h
-} __attribute__((packed)) extPosePackedItem;
-
 // Struct for logging position information
 static positionMeasurement_t ext_pos;
 // Struct for logging pose information
@@ -148,6 +132,10 @@ static paramVarId_t enLhMtchStmParamId;
 
 static float extPosStdDev = 0.01;
 static float extQuatStdDev = 4.5e-3;
+static uint8_t extLatencyMs = 0;
+// Positions of other Crazyflies in packed broadcasts are only retained for ids in this range
+static uint8_t peerIdMin = 0;
+static uint8_t peerIdMax = 255;
 static bool isInit = false;
 static uint8_t my_id;
 static uint16_t tickOfLastPacket; // tick when last packet was received
@@ -156,6 +144,7 @@ static void locSrvCrtpCB(CRTPPacket* pk);
 static void extPositionHandler(CRTPPacket* pk);
 static void genericLocHandle(CRTPPacket* pk);
 static void extPositionPackedHandler(CRTPPacket* pk);
+static void extPositionPackedV2Handler(const CRTPPacket* pk);
 
 static bool isEmergencyStopRequested = false;
 static uint32_t emergencyStopWatchdogNotificationTick = 0;
@@ -193,6 +182,29 @@ static void locSrvCrtpCB(CRTPPacket* pk)
   }
 }
 
+// Time of capture for external measurements, based on the configured system latency
+static uint32_t extCaptureTimestamp()
+{
+  return T2M(xTaskGetTickCount()) - extLatencyMs;
+}
+
+static bool isPeerRetained(const uint8_t id)
+{
+  return id != my_id && id >= peerIdMin && id <= peerIdMax;
+}
+
+static void tellPeerPosition(const uint8_t id, const int16_t x, const int16_t y, const int16_t z)
+{
+  positionMeasurement_t peerPos = {
+    .x = x / 1000.0f,
+    .y = y / 1000.0f,
+    .z = z / 1000.0f,
+    .stdDev = extPosStdDev,
+    .source = MeasurementSourceLocationService,
+  };
+  peerLocalizationTellPosition(id, &peerPos);
+}
+
 static void updateLogFromExtPos()
 {
   ext_pose.x = ext_pos.x;
@@ -208,6 +220,7 @@ static void extPositionHandler(CRTPPacket* pk) {
   ext_pos.z = data->z;
   ext_pos.stdDev = extPosStdDev;
   ext_pos.source = MeasurementSourceLocationService;
+  ext_pos.timestamp = extCaptureTimestamp();
   updateLogFromExtPos();
 
   estimatorEnqueuePosition(&ext_pos);
@@ -226,30 +239,72 @@ static void extPoseHandler(const CRTPPacket* pk) {
   ext_pose.quat.w = data->qw;
   ext_pose.stdDevPos = extPosStdDev;
   ext_pose.stdDevQuat = extQuatStdDev;
+  ext_pose.timestamp = extCaptureTimestamp();
 
   estimatorEnqueuePose(&ext_pose);
   tickOfLastPacket = xTaskGetTickCount();
 }
 
+static void enqueuePackedPose(const extPosePackedItem* item, const uint32_t timestamp) {
+  ext_pose.x = item->x / 1000.0f;
+  ext_pose.y = item->y / 1000.0f;
+  ext_pose.z = item->z / 1000.0f;
+  quatdecompress(item->quat, (float *)&ext_pose.quat.q0);
+  ext_pose.stdDevPos = extPosStdDev;
+  ext_pose.stdDevQuat = extQuatStdDev;
+  ext_pose.timestamp = timestamp;
+  estimatorEnqueuePose(&ext_pose);
+  tickOfLastPacket = xTaskGetTickCount();
+}
+
 static void extPosePackedHandler(const CRTPPacket* pk) {
   uint8_t numItems = (pk->size - 1) / sizeof(extPosePackedItem);
   for (uint8_t i = 0; i < numItems; ++i) {
     const extPosePackedItem* item = (const extPosePackedItem*)&pk->data[1 + i * sizeof(extPosePackedItem)];
     if (item->id == my_id) {
-      ext_pose.x = item->x / 1000.0f;
-      ext_pose.y = item->y / 1000.0f;
-      ext_pose.z = item->z / 1000.0f;
-      quatdecompress(item->quat, (float *)&ext_pose.quat.q0);
-      ext_pose.stdDevPos = extPosStdDev;
-      ext_pose.stdDevQuat = extQuatStdDev;
-      estimatorEnqueuePose(&ext_pose);
-      tickOfLastPacket = xTaskGetTickCount();
-    } else {
-      ext_pos.x = item->x / 1000.0f;
-      ext_pos.y = item->y / 1000.0f;
-      ext_pos.z = item->z / 1000.0f;
-      ext_pos.stdDev = extPosStdDev;
-      peerLocalizationTellPosition(item->id, &ext_pos);
+      enqueuePackedPose(item, extCaptureTimestamp());
+    } else if (isPeerRetained(item->id)) {
+      tellPeerPosition(item->id, item->x, item->y, item->z);
+    }
+  }
+}
+
+// The items of version 2 packets are sorted by id. Only the items from the lowest to the highest id of interest, the
+// own id and the retained peers, are looked at, in one pass. Returns the index of the first item and sets lastId.
+static uint8_t packedV2FirstItem(const uint8_t* items, const uint8_t numItems, const uint8_t itemSize, uint8_t* lastId) {
+  uint8_t firstId = my_id;
+  *lastId = my_id;
+  if (peerIdMin <= peerIdMax) {
+    firstId = (peerIdMin < my_id) ? peerIdMin : my_id;
+    *lastId = (peerIdMax > my_id) ? peerIdMax : my_id;
+  }
+
+  if (firstId == 0) {
+    return 0;
+  }
+  return extPackedLowerBound(items, numItems, itemSize, firstId);
+}
+
+static void extPosePackedV2Handler(const CRTPPacket* pk) {
+  if (pk->size < sizeof(extPackedV2Header)) {
+    return;
+  }
+
+  const extPackedV2Header* header = (const extPackedV2Header*)pk->data;
+  const uint8_t* items = &pk->data[sizeof(extPackedV2Header)];
+  const uint8_t itemSize = sizeof(extPosePackedItem);
+  const uint8_t numItems = (pk->size - sizeof(extPackedV2Header)) / itemSize;
+
+  uint8_t lastId;
+  for (uint8_t i = packedV2FirstItem(items, numItems, itemSize, &lastId); i < numItems; i++) {
+    const extPosePackedItem* item = (const extPosePackedItem*)&items[i * itemSize];
+    if (item->id > lastId) {
+      break;
+    }
+    if (item->id == my_id) {
+      enqueuePackedPose(item, extCaptureTimestamp() - header->ageMs);
+    } else if (isPeerRetained(item->id)) {
+      tellPeerPosition(item->id, item->x, item->y, item->z);
     }
   }
 }
@@ -337,6 +392,12 @@ static void genericLocHandle(CRTPPacket* pk)
     case EXT_POSE_PACKED:
       extPosePackedHandler(pk);
       break;
+    case EXT_POSE_PACKED_V2:
+      extPosePackedV2Handler(pk);
+      break;
+    case EXT_POSITION_PACKED_V2:
+      extPositionPackedV2Handler(pk);
+      break;
     case LH_PERSIST_DATA:
       lhPersistDataHandler(pk);
       break;
@@ -346,23 +407,54 @@ static void genericLocHandle(CRTPPacket* pk)
   }
 }
 
+static void enqueuePackedPosition(const extPositionPackedItem* item, const uint32_t timestamp)
+{
+  ext_pos.x = item->x / 1000.0f;
+  ext_pos.y = item->y / 1000.0f;
+  ext_pos.z = item->z / 1000.0f;
+  ext_pos.stdDev = extPosStdDev;
+  ext_pos.source = MeasurementSourceLocationService;
+  ext_pos.timestamp = timestamp;
+  updateLogFromExtPos();
+  estimatorEnqueuePosition(&ext_pos);
+  tickOfLastPacket = xTaskGetTickCount();
+}
+
 static void extPositionPackedHandler(CRTPPacket* pk)
 {
   uint8_t numItems = pk->size / sizeof(extPositionPackedItem);
   for (uint8_t i = 0; i < numItems; ++i) {
     const extPositionPackedItem* item = (const extPositionPackedItem*)&pk->data[i * sizeof(extPositionPackedItem)];
-    ext_pos.x = item->x / 1000.0f;
-    ext_pos.y = item->y / 1000.0f;
-    ext_pos.z = item->z / 1000.0f;
-    ext_pos.stdDev = extPosStdDev;
-    ext_pos.source = MeasurementSourceLocationService;
     if (item->id == my_id) {
-      updateLogFromExtPos();
-      estimatorEnqueuePosition(&ext_pos);
-      tickOfLastPacket = xTaskGetTickCount();
+      enqueuePackedPosition(item, extCaptureTimestamp());
     }
-    else {
-      peerLocalizationTellPosition(item->id, &ext_pos);
+    else if (isPeerRetained(item->id)) {
+      tellPeerPosition(item->id, item->x, item->y, item->z);
+    }
+  }
+}
+
+static void extPositionPackedV2Handler(const CRTPPacket* pk)
+{
+  if (pk->size < sizeof(extPackedV2Header)) {
+    return;
+  }
+
+  const extPackedV2Header* header = (const extPackedV2Header*)pk->data;
+  const uint8_t* items = &pk->data[sizeof(extPackedV2Header)];
+  const uint8_t itemSize = sizeof(extPositionPackedItem);
+  const uint8_t numItems = (pk->size - sizeof(extPackedV2Header)) / itemSize;
+
+  uint8_t lastId;
+  for (uint8_t i = packedV2FirstItem(items, numItems, itemSize, &lastId); i < numItems; i++) {
+    const extPositionPackedItem* item = (const extPositionPackedItem*)&items[i * itemSize];
+    if (item->id > lastId) {
+      break;
+    }
+    if (item->id == my_id) {
+      enqueuePackedPosition(item, extCaptureTimestamp() - header->ageMs);
+    } else if (isPeerRetained(item->id)) {
+      tellPeerPosition(item->id, item->x, item->y, item->z);
     }
   }
 }
@@ -610,4 +702,23 @@ PARAM_GROUP_START(locSrv)
  * @brief Standard deviation of the quarternion data to kalman filter
  */
   PARAM_ADD_CORE(PARAM_FLOAT, extQuatStdDev, &extQuatStdDev)
+  /**
+ * @brief Latency (ms) from capture of an external position/pose until it is received, typically mocap processing and radio
+ *
+ * Used by the kalman estimator to compare the measurement with the estimated state at the time of capture. With 0 the
+ * capture time is the time of reception, the time from reception until the estimator uses the measurement is still
+ * compensated for.
+ */
+  PARAM_ADD(PARAM_UINT8, extLatency, &extLatencyMs)
+  /**
+ * @brief Lowest id of other Crazyflies to retain positions for from packed broadcasts (default: 0)
+ *
+ * Positions of other Crazyflies are used by peer localization, for instance for collision avoidance. Set peerIdMin
+ * larger than peerIdMax to ignore all other Crazyflies.
+ */
+  PARAM_ADD(PARAM_UINT8, peerIdMin, &peerIdMin)
+  /**
+ * @brief Highest id of other Crazyflies to retain positions for from packed broadcasts (default: 255)
+ */
+  PARAM_ADD(PARAM_UINT8, peerIdMax, &peerIdMax)
 PARAM_GROUP_STOP(locSrv)
@@ -24,10 +24,26 @@ static StateEstimatorType currentEstimator = StateEstimatorTypeAutoSelect;
 static xQueueHandle measurementsQueue;
 STATIC_MEM_QUEUE_ALLOC(measurementsQueue, MEASUREMENTS_QUEUE_SIZE, sizeof(measurement_t));
 
+// Lock free ring buffer for IMU samples, the sensors task is the only producer and
+// the estimator the only consumer. The indexes are free running, size must be a power of 2.
+#define IMU_RING_SIZE (16)
+#define IMU_RING_MASK (IMU_RING_SIZE - 1)
+static imuMeasurement_t imuRing[IMU_RING_SIZE];
+static uint32_t imuRingHead; // Written by the producer only
+static uint32_t imuRingTail; // Written by the consumer only
+
+// IMU sample partly delivered through estimatorDequeue()
+static imuMeasurement_t pendingImu;
+static bool isAccPending = false;
+
 // Statistics
 #define ONE_SECOND 1000
 static STATS_CNT_RATE_DEFINE(measurementAppendedCounter, ONE_SECOND);
 static STATS_CNT_RATE_DEFINE(measurementNotAppendedCounter, ONE_SECOND);
+static STATS_CNT_RATE_DEFINE(imuAppendedCounter, ONE_SECOND);
+static STATS_CNT_RATE_DEFINE(imuNotAppendedCounter, ONE_SECOND);
+static uint8_t measurementsQueueHighWater = 0;
+static uint8_t imuRingHighWater = 0;
 
 // events
 EVENTTRIGGER(estTDOA, uint8, idA, uint8, idB, float, distanceDiff)
@@ -188,6 +204,11 @@ void estimatorEnqueue(const measurement_t *measurement) {
 
   if (result == pdTRUE) {
     STATS_CNT_RATE_EVENT(&measurementAppendedCounter);
+
+    const UBaseType_t waiting = isInInterrupt ? uxQueueMessagesWaitingFromISR(measurementsQueue) : uxQueueMessagesWaiting(measurementsQueue);
+    if (waiting > measurementsQueueHighWater) {
+      measurementsQueueHighWater = waiting;
+    }
   } else {
     STATS_CNT_RATE_EVENT(&measurementNotAppendedCounter);
   }
@@ -255,11 +276,75 @@ void estimatorEnqueue(const measurement_t *measurement) {
   }
 }
 
+void estimatorEnqueueImu(const imuMeasurement_t *imu) {
+  const uint32_t head = imuRingHead;
+  const uint32_t tail = __atomic_load_n(&imuRingTail, __ATOMIC_ACQUIRE);
+  const uint32_t used = head - tail;
+
+  if (used >= IMU_RING_SIZE) {
+    STATS_CNT_RATE_EVENT(&imuNotAppendedCounter);
+    return;
+  }
+
+  imuRing[head & IMU_RING_MASK] = *imu;
+  __atomic_store_n(&imuRingHead, head + 1, __ATOMIC_RELEASE);
+
+  STATS_CNT_RATE_EVENT(&imuAppendedCounter);
+  if (used + 1 > imuRingHighWater) {
+    imuRingHighWater = used + 1;
+  }
+
+  // events, no payload needed, see gyro.{x,y,z} and acc.{x,y,z}
+  eventTrigger(&eventTrigger_estGyroscope);
+  if (imu->hasAcc) {
+    eventTrigger(&eventTrigger_estAcceleration);
+  }
+}
+
+bool estimatorDequeueImu(imuMeasurement_t *imu) {
+  const uint32_t tail = imuRingTail;
+  const uint32_t head = __atomic_load_n(&imuRingHead, __ATOMIC_ACQUIRE);
+
+  if (head == tail) {
+    return false;
+  }
+
+  *imu = imuRing[tail & IMU_RING_MASK];
+  __atomic_store_n(&imuRingTail, tail + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
 bool estimatorDequeue(measurement_t *measurement) {
+  // IMU samples are delivered as one gyro and, if sampled, one acc measurement to
+  // estimators that do not use estimatorDequeueImu()
+  if (isAccPending) {
+    measurement->type = MeasurementTypeAcceleration;
+    measurement->data.acceleration.acc = pendingImu.acc;
+    isAccPending = false;
+    return true;
+  }
+
+  if (estimatorDequeueImu(&pendingImu)) {
+    measurement->type = MeasurementTypeGyroscope;
+    measurement->data.gyroscope.gyro = pendingImu.gyro;
+    isAccPending = pendingImu.hasAcc;
+    return true;
+  }
+
   return pdTRUE == xQueueReceive(measurementsQueue, measurement, 0);
 }
 
 LOG_GROUP_START(estimator)
   STATS_CNT_RATE_LOG_ADD(rtApnd, &measurementAppendedCounter)
   STATS_CNT_RATE_LOG_ADD(rtRej, &measurementNotAppendedCounter)
+  STATS_CNT_RATE_LOG_ADD(rtImuApnd, &imuAppendedCounter)
+  STATS_CNT_RATE_LOG_ADD(rtImuRej, &imuNotAppendedCounter)
+  /**
+   * @brief Max number of measurements in the measurement queue since start up
+   */
+  LOG_ADD(LOG_UINT8, qHighWater, &measurementsQueueHighWater)
+  /**
+   * @brief Max number of samples in the IMU ring buffer since start up
+   */
+  LOG_ADD(LOG_UINT8, imuHighWater, &imuRingHighWater)
 LOG_GROUP_STOP(estimator)
@@ -59,6 +59,7 @@
  */
 
 #include "kalman_core.h"
+#include "kalman_core_history.h"
 #include "kalman_supervisor.h"
 
 #include "FreeRTOS.h"
@@ -67,6 +68,7 @@
 #include "semphr.h"
 #include "sensors.h"
 #include "static_mem.h"
+#include "autoconf.h"
 
 #include "estimator.h"
 #include "estimator_kalman.h"
@@ -80,6 +82,7 @@
 
 #include "statsCnt.h"
 #include "rateSupervisor.h"
+#include "event_trace.h"
 
 // Measurement models
 #include "mm_distance.h"
@@ -115,8 +118,14 @@ static StaticSemaphore_t dataMutexBuffer;
 /**
  * Tuning parameters
  */
+#ifdef CONFIG_ESTIMATOR_KALMAN_PREDICT_RATE
+#define PREDICT_RATE CONFIG_ESTIMATOR_KALMAN_PREDICT_RATE
+#else
 #define PREDICT_RATE RATE_100_HZ // this is slower than the IMU update rate of 1000Hz
+#endif
 const uint32_t PREDICTION_UPDATE_INTERVAL_MS = 1000 / PREDICT_RATE;
+_Static_assert(1000 % PREDICT_RATE == 0, "The kalman prediction rate must divide 1000");
+_Static_assert(PREDICT_RATE == KALMAN_CORE_HISTORY_RATE, "The state history must be sized for the prediction rate");
 
 // The bounds on the covariance, these shouldn't be hit, but sometimes are... why?
 #define MAX_COVARIANCE (100)
@@ -140,6 +149,9 @@ static bool robustTdoa = false;
 
 NO_DMA_CCM_SAFE_ZERO_INIT static kalmanCoreData_t coreData;
 
+// Past states, used to handle delayed external position and pose measurements
+NO_DMA_CCM_SAFE_ZERO_INIT static kalmanCoreHistory_t stateHistory;
+
 /**
  * Internal variables. Note that static declaration results in default initialization (to 0)
  */
@@ -168,11 +180,16 @@ static state_t taskEstimatorState; // The estimator state produced by the task,
 static STATS_CNT_RATE_DEFINE(updateCounter, ONE_SECOND);
 static STATS_CNT_RATE_DEFINE(predictionCounter, ONE_SECOND);
 static STATS_CNT_RATE_DEFINE(finalizeCounter, ONE_SECOND);
+static STATS_CNT_RATE_DEFINE(historyMissCounter, ONE_SECOND);
 // static STATS_CNT_RATE_DEFINE(measurementAppendedCounter, ONE_SECOND);
 // static STATS_CNT_RATE_DEFINE(measurementNotAppendedCounter, ONE_SECOND);
 
 static rateSupervisor_t rateSupervisorContext;
 
+// Delayed measurement statistics, for logging
+static uint16_t measurementDelayMs;
+static float measurementShift;
+
 #define WARNING_HOLD_BACK_TIME_MS 2000
 static uint32_t warningBlockTimeMs = 0;
 
@@ -221,6 +238,7 @@ static void kalmanTask(void* parameters) {
 
   while (true) {
     xSemaphoreTake(runTaskSemaphore, portMAX_DELAY);
+    EVENT_TRACE_SPAN_BEGIN(EVENT_TRACE_SPAN_KALMAN);
     nowMs = T2M(xTaskGetTickCount()); // would be nice if this had a precision higher than 1ms...
 
     if (resetEstimation) {
@@ -243,7 +261,10 @@ static void kalmanTask(void* parameters) {
       axis3fSubSamplerFinalize(&accSubSampler);
       axis3fSubSamplerFinalize(&gyroSubSampler);
 
+      kalmanCoreHistorySample_t beforePrediction;
+      kalmanCoreHistorySnapshot(&coreData, &beforePrediction);
       kalmanCorePredict(&coreData, &coreParams, &accSubSampler.subSample, &gyroSubSampler.subSample, nowMs, quadIsFlying);
+      kalmanCoreHistoryAddPrediction(&stateHistory, &beforePrediction, &coreData, nowMs);
       nextPredictionMs = nowMs + PREDICTION_UPDATE_INTERVAL_MS;
 
       STATS_CNT_RATE_EVENT(&predictionCounter);
@@ -263,6 +284,9 @@ static void kalmanTask(void* parameters) {
       STATS_CNT_RATE_EVENT(&finalizeCounter);
     }
 
+    // The covariance read by the var logs is rebuilt from the UD factors once per loop
+    kalmanCoreSyncCovariance(&coreData);
+
     if (! kalmanSupervisorIsStateWithinBounds(&coreData)) {
       resetEstimation = true;
 
@@ -281,6 +305,7 @@ static void kalmanTask(void* parameters) {
     xSemaphoreGive(dataMutex);
 
     STATS_CNT_RATE_EVENT(&updateCounter);
+    EVENT_TRACE_SPAN_END(EVENT_TRACE_SPAN_KALMAN);
   }
 }
 
@@ -296,12 +321,69 @@ void estimatorKalman(state_t *state, const stabilizerStep_t stabilizerStep) {
   xSemaphoreGive(runTaskSemaphore);
 }
 
+// Find the motion predicted since a measurement was captured. Returns false if the measurement should be used as
+// is, that is if it has no timestamp or is older than the history.
+static bool getMotionSinceCapture(const uint32_t nowMs, const uint32_t timestamp, kalmanCoreHistorySample_t* motion) {
+  if (timestamp == 0) {
+    return false;
+  }
+
+  measurementDelayMs = nowMs - timestamp;
+  if (!kalmanCoreHistoryGetMotion(&stateHistory, timestamp, motion)) {
+    STATS_CNT_RATE_EVENT(&historyMissCounter);
+    return false;
+  }
+
+  return true;
+}
+
+static void updateShiftLog(const float pos[3], const float shifted[3]) {
+  const float dx = shifted[0] - pos[0];
+  const float dy = shifted[1] - pos[1];
+  const float dz = shifted[2] - pos[2];
+  measurementShift = sqrtf(dx * dx + dy * dy + dz * dz);
+}
+
+static void updateWithDelayedPosition(const uint32_t nowMs, positionMeasurement_t* position) {
+  kalmanCoreHistorySample_t motion;
+  if (getMotionSinceCapture(nowMs, position->timestamp, &motion)) {
+    const float measured[3] = {position->x, position->y, position->z};
+    kalmanCoreHistoryShiftPosition(&motion, position->pos);
+    updateShiftLog(measured, position->pos);
+  }
+
+  kalmanCoreUpdateWithPosition(&coreData, position);
+}
+
+static void updateWithDelayedPose(const uint32_t nowMs, poseMeasurement_t* pose) {
+  kalmanCoreHistorySample_t motion;
+  if (getMotionSinceCapture(nowMs, pose->timestamp, &motion)) {
+    const float measured[3] = {pose->x, pose->y, pose->z};
+    kalmanCoreHistoryShiftPosition(&motion, pose->pos);
+    kalmanCoreHistoryShiftAttitude(&motion, &pose->quat);
+    updateShiftLog(measured, pose->pos);
+  }
+
+  kalmanCoreUpdateWithPose(&coreData, pose);
+}
+
 static void updateQueuedMeasurements(const uint32_t nowMs, const bool quadIsFlying) {
   /**
    * Sensor measurements can come in sporadically and faster than the stabilizer loop frequency,
    * we therefore consume all measurements since the last loop, rather than accumulating
    */
 
+  // IMU samples are accumulated directly from the IMU ring buffer
+  imuMeasurement_t imu;
+  while (estimatorDequeueImu(&imu)) {
+    axis3fSubSamplerAccumulate(&gyroSubSampler, &imu.gyro);
+    gyroLatest = imu.gyro;
+    if (imu.hasAcc) {
+      axis3fSubSamplerAccumulate(&accSubSampler, &imu.acc);
+      accLatest = imu.acc;
+    }
+  }
+
   // Pull the latest sensors values of interest; discard the rest
   measurement_t m;
   while (estimatorDequeue(&m)) {
@@ -316,10 +398,10 @@ static void updateQueuedMeasurements(const uint32_t nowMs, const bool quadIsFlyi
         }
         break;
       case MeasurementTypePosition:
-        kalmanCoreUpdateWithPosition(&coreData, &m.data.position);
+        updateWithDelayedPosition(nowMs, &m.data.position);
         break;
       case MeasurementTypePose:
-        kalmanCoreUpdateWithPose(&coreData, &m.data.pose);
+        updateWithDelayedPose(nowMs, &m.data.pose);
         break;
       case MeasurementTypeDistance:
         if(robustTwr){
@@ -385,6 +467,7 @@ void estimatorKalmanInit(void)
 
   uint32_t nowMs = T2M(xTaskGetTickCount());
   kalmanCoreInit(&coreData, &coreParams, nowMs);
+  kalmanCoreHistoryReset(&stateHistory);
 }
 
 bool estimatorKalmanTest(void)
@@ -518,6 +601,18 @@ LOG_GROUP_START(kalman)
   * @brief Statistics rate full estimation step
   */
   STATS_CNT_RATE_LOG_ADD(rtFinal, &finalizeCounter)
+  /**
+  * @brief Delay (ms) from capture to update of the latest timestamped external position/pose
+  */
+  LOG_ADD(LOG_UINT16, extDelay, &measurementDelayMs)
+  /**
+  * @brief Distance (m) the latest delayed external position was moved to compensate for the delay
+  */
+  LOG_ADD(LOG_FLOAT, extShift, &measurementShift)
+  /**
+  * @brief Rate of delayed external positions/poses that were older than the state history and used as is
+  */
+  STATS_CNT_RATE_LOG_ADD(rtExtMiss, &historyMissCounter)
 LOG_GROUP_STOP(kalman)
 
 LOG_GROUP_START(outlierf)
@@ -54,6 +54,7 @@
 
 #include "estimator_ukf.h"
 #include "estimator.h"
+#include "ukf_core.h"
 #include "kalman_supervisor.h"
 
 #include "stm32f4xx.h"
@@ -121,7 +122,7 @@ static STATS_CNT_RATE_DEFINE(measurementAppendedCounter, ONE_SECOND);
 static STATS_CNT_RATE_DEFINE(measurementNotAppendedCounter, ONE_SECOND);
 
 // for error filter version
-#define DIM_FILTER 9
+#define DIM_FILTER UKF_CORE_DIM
 #define DIM_STRAPDOWN 10
 
 static float weight0 = 0.6f;
@@ -137,12 +138,13 @@ static float procTime = 0.0f;
 //static float covRangeCF[NO_ANCHORS];
 static uint8_t receivedAnchor;
 
-static float covNavFilter[DIM_FILTER][DIM_FILTER];
+NO_DMA_CCM_SAFE_ZERO_INIT static ukfCoreData_t coreData;
 
-static float xEst[DIM_FILTER] = {0.0f};
-static float sigmaPointsTempl[DIM_FILTER][DIM_FILTER + 2] = {0};
-static float sigmaPoints[DIM_FILTER][DIM_FILTER + 2] = {0};
-static float weights[DIM_FILTER + 2] = {0.0f};
+#ifdef CONFIG_ESTIMATOR_UKF_SQUARE_ROOT
+#define UKF_SQUARE_ROOT true
+#else
+#define UKF_SQUARE_ROOT false
+#endif
 
 
 static float accNed[3];
@@ -211,6 +213,7 @@ static bool useNavigationFilter = true;
 static bool resetNavigation = true;
 
 static void navigationInit(void);
+static void initNavigationFilter(void);
 static void resetNavigationStates(void);
 
 static void updateStrapdownAlgorithm(float *stateNav, Axis3f* accAverage, Axis3f* gyroAverage, float dt);
@@ -227,8 +230,6 @@ static void computeOutputBaro(float *output, float *state);
 static void computeOutputSweep(float *output, float *state, sweepAngleMeasurement_t *sweepInfo, float *xy);
 
 static bool ukfUpdate(float *Pxy, float *Pyy, float innovation);
-static void computeSigmaPoints(void);
-static uint8_t cholesky(float *A, float *L, uint8_t n);
 static void quatToEuler(float *quat, float *eulerAngles);
 static void quatFromAtt(float *attVec, float *quat);
 static void directionCosineMatrix(float *quat, float *dcm);
@@ -266,7 +267,7 @@ static void errorUkfTask(void *parameters)
 {
   systemWaitStart();
 
-  uint32_t ii, jj;
+  uint32_t ii;
   uint32_t lastPrediction = xTaskGetTickCount();
   uint32_t nextPrediction = xTaskGetTickCount();
 
@@ -306,29 +307,7 @@ static void errorUkfTask(void *parameters)
       }
       stateNav[6] = 1.0f; // no rotation initially
 
-      // initialize covariance matrix of navigation Filter
-      for (ii = 0; ii < DIM_FILTER; ii++)
-      {
-        xEst[ii] = 0.0f;
-        for (jj = 0; jj < DIM_FILTER; jj++)
-        {
-          covNavFilter[ii][jj] = 0.0f;
-        }
-      }
-      flowActive = true;
-
-      // set initial parameters
-      covNavFilter[0][0] = stdDevInitialPosition_xy * stdDevInitialPosition_xy;
-      covNavFilter[1][1] = stdDevInitialPosition_xy * stdDevInitialPosition_xy;
-      covNavFilter[2][2] = stdDevInitialPosition_z * stdDevInitialPosition_z;
-
-      covNavFilter[3][3] = stdDevInitialVelocity * stdDevInitialVelocity;
-      covNavFilter[4][4] = stdDevInitialVelocity * stdDevInitialVelocity;
-      covNavFilter[5][5] = stdDevInitialVelocity * stdDevInitialVelocity;
-
-      covNavFilter[6][6] = stdDevInitialAtt * stdDevInitialAtt;
-      covNavFilter[7][7] = stdDevInitialAtt * stdDevInitialAtt;
-      covNavFilter[8][8] = stdDevInitialAtt * stdDevInitialAtt;
+      initNavigationFilter();
 
       lastPrediction = xTaskGetTickCount();
     }
@@ -580,7 +559,7 @@ static void updateStrapdownAlgorithm(float *stateNav, Axis3f *accAverage, Axis3f
 static void navigationInit(void)
 {
   // initialize state of strapdown navigation algorithm
-  uint32_t ii, jj;
+  uint32_t ii;
   for (ii = 0; ii < DIM_STRAPDOWN; ii++)
   {
     stateNav[ii] = 0.0f;
@@ -590,59 +569,31 @@ static void navigationInit(void)
   directionCosineMatrix(&stateNav[6], &dcm[0][0]);
   transposeMatrix(&dcm[0][0], &dcmTp[0][0]);
 
-  // initialize covariance matrix of navigation Filter
-  for (ii = 0; ii < DIM_FILTER; ii++)
-  {
-    xEst[ii] = 0.0f;
-    for (jj = 0; jj < DIM_FILTER; jj++)
-    {
-      covNavFilter[ii][jj] = 0.0f;
-    }
-  }
-  flowActive = true;
+  initNavigationFilter();
 
-  // set initial parameters
-  covNavFilter[0][0] = stdDevInitialPosition_xy * stdDevInitialPosition_xy;
-  covNavFilter[1][1] = stdDevInitialPosition_xy * stdDevInitialPosition_xy;
-  covNavFilter[2][2] = stdDevInitialPosition_z * stdDevInitialPosition_z;
-
-  covNavFilter[3][3] = stdDevInitialVelocity * stdDevInitialVelocity;
-  covNavFilter[4][4] = stdDevInitialVelocity * stdDevInitialVelocity;
-  covNavFilter[5][5] = stdDevInitialVelocity * stdDevInitialVelocity;
-
-  covNavFilter[6][6] = stdDevInitialAtt * stdDevInitialAtt;
-  covNavFilter[7][7] = stdDevInitialAtt * stdDevInitialAtt;
-  covNavFilter[8][8] = stdDevInitialAtt * stdDevInitialAtt;
-
-  //______________________________________________________________________
-  //compute weights
-  for (jj = 0; jj < (DIM_FILTER+2); jj++)	{
-    for (ii = 0; ii < DIM_FILTER; ii++){
-      sigmaPointsTempl[ii][jj] = 0.0f;
-    }
-  }
-
-  //compute template sigma points normalized to mean 0 and covariance I
-  float tmp;
-  float weight1 = (1.0f-weight0)/((float)DIM_FILTER+1.0f);
-  weights[0] = weight0;
-  for (ii = 1; ii < (DIM_FILTER + 2); ii++)
-  {
-    weights[ii] = weight1;
+  DEBUG_PRINT("Sigma Points chosen\n");
+}
 
-  }
+// reset error state and covariance of the navigation filter, also computes the weights and sigma points
+static void initNavigationFilter(void)
+{
+  const float stdDevInitial[DIM_FILTER] = {
+    stdDevInitialPosition_xy, stdDevInitialPosition_xy, stdDevInitialPosition_z,
+    stdDevInitialVelocity, stdDevInitialVelocity, stdDevInitialVelocity,
+    stdDevInitialAtt, stdDevInitialAtt, stdDevInitialAtt,
+  };
 
-  for (ii = 0; ii < DIM_FILTER; ii++)
-  {
-    tmp = 1.0f/sqrtf(((float)ii+1.0f)*((float)ii+2.0f)*weight1);
-    for (jj = 1; jj < (ii + 2); jj++)
-    {
-      sigmaPointsTempl[ii][jj] = -tmp;
-    }
-    sigmaPointsTempl[ii][(ii+2)] = tmp*((float)ii+1.0f);
-  }
+  ukfCoreInit(&coreData, stdDevInitial, weight0, UKF_SQUARE_ROOT);
+  flowActive = true;
+}
 
-  DEBUG_PRINT("Sigma Points chosen\n");
+// Cholesky factor of the 2x2 position/velocity block of the process noise, in closed form
+static void setProcNoiseFactorBlock(float L[DIM_FILTER][DIM_FILTER], float Q[DIM_FILTER][DIM_FILTER], const int pos, const int vel)
+{
+  const float lpp = sqrtf(Q[pos][pos]);
+  L[pos][pos] = lpp;
+  L[vel][pos] = (lpp > 0.0f) ? Q[vel][pos] / lpp : 0.0f;
+  L[vel][vel] = sqrtf(fmaxf(Q[vel][vel] - L[vel][pos] * L[vel][pos], 0.0f));
 }
 
 // prediction step of error Kalman Filter
@@ -650,22 +601,12 @@ static void predictNavigationFilter(float *stateNav, Axis3f *acc, Axis3f *gyro,
 {
   float accTs[3] = {acc->x * dt, acc->y * dt, acc->z * dt};
   float omegaTs[3] = {gyro->x * dt, gyro->y * dt, gyro->z * dt};
-  float covNew[DIM_FILTER][DIM_FILTER] = {0};
-  float errorTransMat[DIM_FILTER][DIM_FILTER] = {0};
-  float sigmaPointsTmp[DIM_FILTER][DIM_FILTER + 2] = {0};
-
-  // compute error State transition matrix
-  uint8_t ii, jj, kk;
-  for (ii = 0; ii < DIM_FILTER; ii++)
-  {
-    for (jj = 0; jj < DIM_FILTER; jj++)
-    {
-      errorTransMat[ii][jj] = 0.0f;
-    }
-  }
+  NO_DMA_CCM_SAFE_ZERO_INIT static float errorTransMat[DIM_FILTER][DIM_FILTER];
+  NO_DMA_CCM_SAFE_ZERO_INIT static float procNoise[DIM_FILTER][DIM_FILTER];
+  NO_DMA_CCM_SAFE_ZERO_INIT static float sqrtProcNoise[DIM_FILTER][DIM_FILTER];
 
   //_________________________________________________________
-  //Compute transition matrix for error state
+  //Compute transition matrix for error state, all other elements stay zero
   //_________________________________________________________
   // this is row [  I   I*Ts   0    ]
   errorTransMat[0][0] = 1.0f;
@@ -700,85 +641,43 @@ static void predictNavigationFilter(float *stateNav, Axis3f *acc, Axis3f *gyro,
   errorTransMat[8][7] = -omegaTs[0];
   errorTransMat[8][8] = 1.0f;
 
-  // compute sigma points of UKF
-  computeSigmaPoints();
+  // process noise covariance Qk, all other elements stay zero
+  procNoise[0][0] = procA_h * dt * dt * dt * 0.33f;
+  procNoise[1][1] = procA_h * dt * dt * dt * 0.33f;
+  procNoise[2][2] = procA_z * dt * dt * dt * 0.33f;
 
-  // Predict Sigma Points
-  for (jj = 0; jj < (DIM_FILTER + 2); jj++)
-  {
-    for (ii = 0; ii < DIM_FILTER; ii++)
-    {
-      sigmaPointsTmp[ii][jj] = 0.0f;
-      for (kk = 0; kk < DIM_FILTER; kk++)
-      {
-        sigmaPointsTmp[ii][jj] = sigmaPointsTmp[ii][jj] + errorTransMat[ii][kk] * sigmaPoints[kk][jj];
-      }
-    }
-  }
+  procNoise[0][3] = procA_h * dt * dt * 0.5f;
+  procNoise[3][0] = procA_h * dt * dt * 0.5f;
+  procNoise[1][4] = procA_h * dt * dt * 0.5f;
+  procNoise[4][1] = procA_h * dt * dt * 0.5f;
+  procNoise[2][5] = procA_z * dt * dt * 0.5f;
+  procNoise[5][2] = procA_z * dt * dt * 0.5f;
 
-  // copy results to sigma points
-  for (jj = 0; jj < (DIM_FILTER+2); jj++)
-  {
-    for (ii = 0; ii < DIM_FILTER; ii++)
-    {
-      sigmaPoints[ii][jj] = sigmaPointsTmp[ii][jj];
-    }
-  }
+  procNoise[3][3] = procA_h * dt;
+  procNoise[4][4] = procA_h * dt;
+  procNoise[5][5] = procA_z * dt;
 
-  for (ii = 0; ii < DIM_FILTER; ii++)
-  {
-    for (jj = 0; jj < DIM_FILTER; jj++)
-    {
-      covNew[ii][jj] = 0.0f;
-    }
-  }
-  // initial error state is zero and we have a linear transition operation, e.g. state0 and xEst are zero so
-  // diffsigma equals sigmapoints
-  for (kk = 0; kk < (DIM_FILTER + 2); kk++)
-  {
-    for (ii = 0; ii < DIM_FILTER; ii++)
-    {
-      for (jj = 0; jj < DIM_FILTER; jj++)
-      {
-        covNew[ii][jj] = covNew[ii][jj] + weights[kk] * (sigmaPoints[ii][kk] * sigmaPoints[jj][kk]);
-      }
-    }
-  }
-
-  // account for process noise covariance Qk
-  covNew[0][0] += procA_h * dt * dt * dt * 0.33f;
-  covNew[1][1] += procA_h * dt * dt * dt * 0.33f;
-  covNew[2][2] += procA_z * dt * dt * dt * 0.33f;
-
-  covNew[0][3] += procA_h * dt * dt * 0.5f;
-  covNew[3][0] += procA_h * dt * dt * 0.5f;
-  covNew[1][4] += procA_h * dt * dt * 0.5f;
-  covNew[4][1] += procA_h * dt * dt * 0.5f;
-  covNew[2][5] += procA_z * dt * dt * 0.5f;
-  covNew[5][2] += procA_z * dt * dt * 0.5f;
+  procNoise[6][6] = procRate_h * dt;
+  procNoise[7][7] = procRate_h * dt;
+  procNoise[8][8] = procRate_z * dt;
 
-  covNew[3][3] += procA_h * dt;
-  covNew[4][4] += procA_h * dt;
-  covNew[5][5] += procA_z * dt;
-
-  covNew[6][6] += procRate_h * dt;
-  covNew[7][7] += procRate_h * dt;
-  covNew[8][8] += procRate_z * dt;
-
-  for (ii = 0; ii < DIM_FILTER; ii++)
+  if (UKF_SQUARE_ROOT)
   {
-    for (jj = 0; jj < DIM_FILTER; jj++)
+    // factor of Qk for the square root formulation, built per block instead of a full factorization
+    for (int ii = 0; ii < 3; ii++)
     {
-      covNavFilter[ii][jj] = 0.5f * (covNew[ii][jj] + covNew[jj][ii]);
+      setProcNoiseFactorBlock(sqrtProcNoise, procNoise, ii, ii + 3);
+      sqrtProcNoise[ii + 6][ii + 6] = sqrtf(procNoise[ii + 6][ii + 6]);
     }
   }
 
-  computeSigmaPoints();
+  // propagate sigma points and covariance, the sigma points are recomputed for the coming updates
+  ukfCorePredict(&coreData, errorTransMat, procNoise, sqrtProcNoise);
 }
 
 static bool updateQueuedMeasurements(const uint32_t tick, Axis3f *gyroAverage)
 {
-  uint8_t ii, jj, kk;
+  uint8_t jj;
 
   float Pyy = 0.0f;
   float Pxy[DIM_FILTER] = {0};
@@ -786,7 +685,8 @@ static bool updateQueuedMeasurements(const uint32_t tick, Axis3f *gyroAverage)
   float xyz[3];
 
   float observation = 0.0f;
-  float outTmp, tmpSigmaVec[DIM_FILTER];
+  float outputs[UKF_CORE_SIGMA_POINTS];
+  float outTmp;
   float innovation, innoCheck;
   bool doneUpdate = false;
   float zeroState[DIM_FILTER] = {0};
@@ -829,40 +729,12 @@ static bool updateQueuedMeasurements(const uint32_t tick, Axis3f *gyroAverage)
           //_________________________________________________________________________________
           // UKF update - TDOA
           //_________________________________________________________________________________
-          // compute mean tdoa observation
-          observation = 0.0f;
-          for (jj = 0; jj < (DIM_FILTER + 2); jj++)
+          // evaluate the output for all sigma points, then mean, measurement and cross covariance
+          for (jj = 0; jj < UKF_CORE_SIGMA_POINTS; jj++)
           {
-            for (ii = 0; ii < DIM_FILTER; ii++)
-            {
-              tmpSigmaVec[ii] = sigmaPoints[ii][jj];
-            }
-            computeOutputTdoa(&outTmp, &tmpSigmaVec[0], &m.data.tdoa);
-            observation = observation + weights[jj] * outTmp;
-          }
-
-          // initialize measurement and cross covariance
-          Pyy = 0.0f;
-          for (jj = 0; jj < DIM_FILTER; jj++)
-          {
-            Pxy[jj] = 0.0f;
-          }
-
-          // loop over all sigma points
-          for (jj = 0; jj < (DIM_FILTER + 2); jj++)
-          {
-            for (ii = 0; ii < DIM_FILTER; ii++)
-            {
-              tmpSigmaVec[ii] = sigmaPoints[ii][jj];
-            }
-            computeOutputTdoa(&outTmp, &tmpSigmaVec[0], &m.data.tdoa);
-            Pyy = Pyy + weights[jj] * (outTmp - observation) * (outTmp - observation);
-
-            for (kk = 0; kk < DIM_FILTER; kk++)
-            {
-              Pxy[kk] = Pxy[kk] + weights[jj] * (tmpSigmaVec[kk] - xEst[kk]) * (outTmp - observation);
-            }
+            computeOutputTdoa(&outputs[jj], coreData.sigmaPoints[jj], &m.data.tdoa);
           }
+          ukfCoreOutputMoments(&coreData, outputs, &observation, &Pyy, Pxy);
 
           // Add TDOA Noise R
           Pyy = Pyy + m.data.tdoa.stdDev * m.data.tdoa.stdDev;
@@ -883,40 +755,11 @@ static bool updateQueuedMeasurements(const uint32_t tick, Axis3f *gyroAverage)
           //_________________________________________________________________________________
           if ((fabs(dcm[2][2]) > 0.1) && (dcm[2][2] > 0.0f))
           {
-            // compute mean tdoa observation
-            observation = 0.0f;
-            for (jj = 0; jj < (DIM_FILTER + 2); jj++)
-            {
-              for (ii = 0; ii < DIM_FILTER; ii++)
-              {
-                tmpSigmaVec[ii] = sigmaPoints[ii][jj];
-              }
-              computeOutputTof(&outTmp, &tmpSigmaVec[0]);
-              observation = observation + weights[jj] * outTmp;
-            }
-
-            // initialize measurement and cross covariance
-            Pyy = 0.0f;
-            for (jj = 0; jj < DIM_FILTER; jj++)
-            {
-              Pxy[jj] = 0.0f;
-            }
-
-            // loop over all sigma points
-            for (jj = 0; jj < (DIM_FILTER + 2); jj++)
+            for (jj = 0; jj < UKF_CORE_SIGMA_POINTS; jj++)
             {
-              for (ii = 0; ii < DIM_FILTER; ii++)
-              {
-                tmpSigmaVec[ii] = sigmaPoints[ii][jj];
-              }
-              computeOutputTof(&outTmp, &tmpSigmaVec[0]);
-              Pyy = Pyy + weights[jj] * (outTmp - observation) * (outTmp - observation);
-
-              for (kk = 0; kk < DIM_FILTER; kk++)
-              {
-                Pxy[kk] = Pxy[kk] + weights[jj] * (tmpSigmaVec[kk] - xEst[kk]) * (outTmp - observation);
-              }
+              computeOutputTof(&outputs[jj], coreData.sigmaPoints[jj]);
             }
+            ukfCoreOutputMoments(&coreData, outputs, &observation, &Pyy, Pxy);
 
             if (m.data.tof.distance < 0.03f)
             {
@@ -954,40 +797,11 @@ static bool updateQueuedMeasurements(const uint32_t tick, Axis3f *gyroAverage)
             //_________________________________________________________________________________
             // UKF update - Flow - body x
             //_________________________________________________________________________________
-            // compute mean tdoa observation
-            observation = 0.0f;
-            for (jj = 0; jj < (DIM_FILTER + 2); jj++)
-            {
-              for (ii = 0; ii < DIM_FILTER; ii++)
-              {
-                tmpSigmaVec[ii] = sigmaPoints[ii][jj];
-              }
-              computeOutputFlow_x(&outTmp, &tmpSigmaVec[0], &m.data.flow, gyroAverage);
-              observation = observation + weights[jj] * outTmp;
-            }
-
-            // initialize measurement and cross covariance
-            Pyy = 0.0f;
-            for (jj = 0; jj < DIM_FILTER; jj++)
+            for (jj = 0; jj < UKF_CORE_SIGMA_POINTS; jj++)
             {
-              Pxy[jj] = 0.0f;
-            }
-
-            // loop over all sigma points
-            for (jj = 0; jj < (DIM_FILTER + 2); jj++)
-            {
-              for (ii = 0; ii < DIM_FILTER; ii++)
-              {
-                tmpSigmaVec[ii] = sigmaPoints[ii][jj];
-              }
-              computeOutputFlow_x(&outTmp, &tmpSigmaVec[0], &m.data.flow, gyroAverage);
-              Pyy = Pyy + weights[jj] * (outTmp - observation) * (outTmp - observation);
-
-              for (kk = 0; kk < DIM_FILTER; kk++)
-              {
-                Pxy[kk] = Pxy[kk] + weights[jj] * (tmpSigmaVec[kk] - xEst[kk]) * (outTmp - observation);
-              }
+              computeOutputFlow_x(&outputs[jj], coreData.sigmaPoints[jj], &m.data.flow, gyroAverage);
             }
+            ukfCoreOutputMoments(&coreData, outputs, &observation, &Pyy, Pxy);
 
             Pyy = Pyy + (m.data.flow.stdDevX) * (m.data.flow.stdDevX);
 
@@ -995,48 +809,18 @@ static bool updateQueuedMeasurements(const uint32_t tick, Axis3f *gyroAverage)
             meas_NX = m.data.flow.dpixelx;
             pred_NX = observation;
 
+            // also recomputes the sigma points for the update in y direction
             ukfUpdate(&Pxy[0], &Pyy, innovation);
 
-            // compute sigma points of UKF after previous update in x Direction
-            computeSigmaPoints();
-
             //_________________________________________________________________________________
             // UKF update - Flow - body y
             //_________________________________________________________________________________
-            // compute mean tdoa observation
-            observation = 0.0f;
-            for (jj = 0; jj < (DIM_FILTER + 2); jj++)
-            {
-              for (ii = 0; ii < DIM_FILTER; ii++)
-              {
-                tmpSigmaVec[ii] = sigmaPoints[ii][jj];
-              }
-              computeOutputFlow_y(&outTmp, &tmpSigmaVec[0], &m.data.flow, gyroAverage);
-              observation = observation + weights[jj] * outTmp;
-            }
-
-            // initialize measurement and cross covariance
-            Pyy = 0.0f;
-            for (jj = 0; jj < DIM_FILTER; jj++)
+            for (jj = 0; jj < UKF_CORE_SIGMA_POINTS; jj++)
             {
-              Pxy[jj] = 0.0f;
+              computeOutputFlow_y(&outputs[jj], coreData.sigmaPoints[jj], &m.data.flow, gyroAverage);
             }
+            ukfCoreOutputMoments(&coreData, outputs, &observation, &Pyy, Pxy);
 
-            // loop over all sigma points
-            for (jj = 0; jj < (DIM_FILTER + 2); jj++)
-            {
-              for (ii = 0; ii < DIM_FILTER; ii++)
-              {
-                tmpSigmaVec[ii] = sigmaPoints[ii][jj];
-              }
-              computeOutputFlow_y(&outTmp, &tmpSigmaVec[0], &m.data.flow, gyroAverage);
-              Pyy = Pyy + weights[jj] * (outTmp - observation) * (outTmp - observation);
-
-              for (kk = 0; kk < DIM_FILTER; kk++)
-              {
-                Pxy[kk] = Pxy[kk] + weights[jj] * (tmpSigmaVec[kk] - xEst[kk]) * (outTmp - observation);
-              }
-            }
             // Add TOF Noise R
             Pyy = Pyy + (m.data.flow.stdDevY) * (m.data.flow.stdDevY);
 
@@ -1051,42 +835,13 @@ static bool updateQueuedMeasurements(const uint32_t tick, Axis3f *gyroAverage)
           //_________________________________________________________________________________
           // UKF update - Baro
           //_________________________________________________________________________________
-          // compute mean tdoa observation
           if (initializedNav)
           {
-            observation = 0.0f;
-            for (jj = 0; jj < (DIM_FILTER + 2); jj++)
+            for (jj = 0; jj < UKF_CORE_SIGMA_POINTS; jj++)
             {
-              for (ii = 0; ii < DIM_FILTER; ii++)
-              {
-                tmpSigmaVec[ii] = sigmaPoints[ii][jj];
-              }
-              computeOutputBaro(&outTmp, &tmpSigmaVec[0]);
-              observation = observation + weights[jj] * outTmp;
-            }
-
-            // initialize measurement and cross covariance
-            Pyy = 0.0f;
-            for (jj = 0; jj < DIM_FILTER; jj++)
-            {
-              Pxy[jj] = 0.0f;
-            }
-
-            // loop over all sigma points
-            for (jj = 0; jj < (DIM_FILTER + 2); jj++)
-            {
-              for (ii = 0; ii < DIM_FILTER; ii++)
-              {
-                tmpSigmaVec[ii] = sigmaPoints[ii][jj];
-              }
-              computeOutputBaro(&outTmp, &tmpSigmaVec[0]);
-              Pyy = Pyy + weights[jj] * (outTmp - observation) * (outTmp - observation);
-
-              for (kk = 0; kk < DIM_FILTER; kk++)
-              {
-                Pxy[kk] = Pxy[kk] + weights[jj] * (tmpSigmaVec[kk] - xEst[kk]) * (outTmp - observation);
-              }
+              computeOutputBaro(&outputs[jj], coreData.sigmaPoints[jj]);
             }
+            ukfCoreOutputMoments(&coreData, outputs, &observation, &Pyy, Pxy);
 
             // Add Baronoise R
             Pyy = Pyy + measNoiseBaro;
@@ -1113,40 +868,12 @@ static bool updateQueuedMeasurements(const uint32_t tick, Axis3f *gyroAverage)
           // Avoid singularity
           if (qNum > 0.0001f)
           {
-            // compute mean tdoa observation
-            observation = 0.0f;
-            for (jj = 0; jj < (DIM_FILTER + 2); jj++)
+            for (jj = 0; jj < UKF_CORE_SIGMA_POINTS; jj++)
             {
-              for (ii = 0; ii < DIM_FILTER; ii++)
-              {
-                tmpSigmaVec[ii] = sigmaPoints[ii][jj];
-              }
-              computeOutputSweep(&outTmp, &tmpSigmaVec[0], &m.data.sweepAngle, &xyz[0]);
-              observation = observation + weights[jj] * outTmp;
+              computeOutputSweep(&outputs[jj], coreData.sigmaPoints[jj], &m.data.sweepAngle, &xyz[0]);
             }
+            ukfCoreOutputMoments(&coreData, outputs, &observation, &Pyy, Pxy);
 
-            // initialize measurement and cross covariance
-            Pyy = 0.0f;
-            for (jj = 0; jj < DIM_FILTER; jj++)
-            {
-              Pxy[jj] = 0.0f;
-            }
-
-            // loop over all sigma points
-            for (jj = 0; jj < (DIM_FILTER + 2); jj++)
-            {
-              for (ii = 0; ii < DIM_FILTER; ii++)
-              {
-                tmpSigmaVec[ii] = sigmaPoints[ii][jj];
-              }
-              computeOutputSweep(&outTmp, &tmpSigmaVec[0], &m.data.sweepAngle, &xyz[0]);
-              Pyy = Pyy + weights[jj] * (outTmp - observation) * (outTmp - observation);
-
-              for (kk = 0; kk < DIM_FILTER; kk++)
-              {
-                Pxy[kk] = Pxy[kk] + weights[jj] * (tmpSigmaVec[kk] - xEst[kk]) * (outTmp - observation);
-              }
-            }
             // Add Sweep angle Noise R
             Pyy = Pyy + m.data.sweepAngle.stdDev * m.data.sweepAngle.stdDev;
             innovation = m.data.sweepAngle.measuredSweepAngle - observation;
@@ -1292,77 +1019,21 @@ static void computeOutputSweep(float *output, float *state, sweepAngleMeasuremen
   output[0] = base - (sweepInfo->calib->phase + compGib);
 }
 
-static void computeSigmaPoints(void)
-{
-  uint8_t ii, jj, kk;
-  float L[DIM_FILTER][DIM_FILTER] = {0};
-
-  cholesky(&covNavFilter[0][0], &L[0][0], DIM_FILTER);
-
-  for (jj = 0; jj < (DIM_FILTER + 2); jj++)
-  {
-    for (ii = 0; ii < DIM_FILTER; ii++)
-    {
-      sigmaPoints[ii][jj] = 0.0f;
-    }
-  }
-  // Compute actual sigma points taking into account current estimate and covariance
-  for (jj = 0; jj < (DIM_FILTER + 2); jj++)
-  {
-    for (ii = 0; ii < DIM_FILTER; ii++)
-    {
-
-      for (kk = 0; kk < DIM_FILTER; kk++)
-      {
-        sigmaPoints[ii][jj] = sigmaPoints[ii][jj] + L[ii][kk] * sigmaPointsTempl[kk][jj];
-      }
-      sigmaPoints[ii][jj] = sigmaPoints[ii][jj] + xEst[ii];
-    }
-  }
-}
-
 static bool ukfUpdate(float *Pxy, float *Pyy, float innovation)
 {
-  uint8_t ii, jj;
-  float Kk[DIM_FILTER] = {0};
-  float covNew[DIM_FILTER][DIM_FILTER] = {0};
-  float KkRKkTp[DIM_FILTER][DIM_FILTER] = {0};
   bool doneUpdate = false;
 
-  for (ii = 0; ii < DIM_FILTER; ii++)
-  {
-    for (jj = 0; jj < DIM_FILTER; jj++)
-    {
-      covNew[ii][jj] = covNavFilter[ii][jj];
-    }
-  }
-
-  for (ii = 0; ii < DIM_FILTER; ii++)
-  {
-    Kk[ii] = Pxy[ii] / Pyy[0];
-    xEst[ii] = xEst[ii] + Kk[ii] * innovation;
-  }
-  for (ii = 0; ii < DIM_FILTER; ii++)
-  {
-    for (jj = 0; jj < DIM_FILTER; jj++)
-    {
-      KkRKkTp[ii][jj] = Kk[ii] * Kk[jj] * Pyy[0];
-      covNew[ii][jj] = covNew[ii][jj] - KkRKkTp[ii][jj];
-    }
-  }
-  for (ii = 0; ii < DIM_FILTER; ii++)
-  {
-    for (jj = 0; jj < DIM_FILTER; jj++)
-    {
-      covNavFilter[ii][jj] = 0.5f * covNew[ii][jj] + 0.5f * covNew[jj][ii];
-    }
-  }
+  ukfCoreScalarUpdate(&coreData, Pxy, Pyy[0], innovation);
 
   if (useNavigationFilter)
   {
     resetNavigationStates();
     doneUpdate = true;
   }
+  else
+  {
+    ukfCoreComputeSigmaPoints(&coreData);
+  }
   return doneUpdate;
 }
 
@@ -1370,6 +1041,7 @@ static bool ukfUpdate(float *Pxy, float *Pyy, float innovation)
 static void resetNavigationStates()
 {
   uint8_t ii;
+  float *xEst = coreData.x;
 
   float attVec[3] = {xEst[6], xEst[7], xEst[8]};
   float quatNav[4] = {stateNav[6], stateNav[7], stateNav[8], stateNav[9]};
@@ -1381,10 +1053,8 @@ static void resetNavigationStates()
       (isnan(xEst[6])) || (isnan(xEst[7])) ||
       (isnan(xEst[8])))
   {
-    for (ii = 0; ii < DIM_FILTER; ii++)
-    {
-      xEst[ii] = 0.0f;
-    }
+    // the covariance is most likely corrupt as well, start over from the initial uncertainty
+    initNavigationFilter();
     nanCounterFilter++;
   }
   else
@@ -1410,23 +1080,8 @@ static void resetNavigationStates()
 
     directionCosineMatrix(&quatRes[0], &dcm[0][0]);
     transposeMatrix(&dcm[0][0], &dcmTp[0][0]);
-    computeSigmaPoints();
-  }
-}
-
-static uint8_t cholesky(float *A, float *L, uint8_t n)
-{
-  for (uint8_t i = 0; i < n; i++)
-  {
-    for (uint8_t j = 0; j < (i + 1); j++)
-    {
-      float s = 0.0f;
-      for (uint8_t k = 0; k < j; k++)
-        s += L[i * n + k] * L[j * n + k];
-      L[i * n + j] = (i == j) ? sqrtf(A[i * n + i] - s) : (1.0f / L[j * n + j] * (A[i * n + j] - s));
-    }
+    ukfCoreComputeSigmaPoints(&coreData);
   }
-  return 1;
 }
 
 static void transposeMatrix(float *mat, float *matTp)
@@ -0,0 +1,253 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * event_trace.c - Event tracer recording to a RAM ring buffer
+ */
+
+/**
+ * Events are written to a ring buffer that always holds the latest
+ * CONFIG_DEBUG_EVENT_TRACE_EVENTS events. A slot is reserved with an atomic
+ * increment of the write counter and then filled in, which makes it safe to
+ * record from tasks and interrupts of any priority without disabling
+ * interrupts. Events recorded by an interrupt between the reservation and
+ * the write of a slot end up slightly out of order, the decoder sorts
+ * events on the time stamp.
+ *
+ * Task names are stored when tasks are created, indexed by the FreeRTOS task
+ * number that is recorded at task switches.
+ *
+ * Memory layout of MEM_TYPE_EVENT_TRACE:
+ *   eventTraceHeader_t
+ *   char taskNames[EVENT_TRACE_MAX_TASKS][EVENT_TRACE_TASK_NAME_LEN]
+ *   eventTraceEvent_t events[CONFIG_DEBUG_EVENT_TRACE_EVENTS]
+ *
+ * Stop the recording (trace.enable = 0) before reading, events recorded
+ * during the read may otherwise overwrite events that have not been read.
+ */
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+
+#include "config.h"
+#include "static_mem.h"
+#include "mem.h"
+#include "param.h"
+#include "worker.h"
+#include "debug.h"
+#include "cycle_counter.h"
+#include "event_trace.h"
+
+#ifdef CONFIG_DECK_USD
+#include "usddeck.h"
+#endif
+
+#ifndef UNIT_TEST_MODE
+#include "stm32fxxx.h"
+#endif
+
+#define EVENT_TRACE_MAGIC 0x52544643 // "CFTR"
+#define EVENT_TRACE_VERSION 1
+#define EVENT_TRACE_MAX_TASKS 48
+#define EVENT_TRACE_TASK_NAME_LEN 12
+#define EVENT_TRACE_USD_FILENAME "trace.bin"
+
+#define EVENT_COUNT CONFIG_DEBUG_EVENT_TRACE_EVENTS
+#if (EVENT_COUNT & (EVENT_COUNT - 1)) != 0
+#error "CONFIG_DEBUG_EVENT_TRACE_EVENTS must be a power of two"
+#endif
+
+#if configMAX_TASK_NAME_LEN > EVENT_TRACE_TASK_NAME_LEN
+#error "Task names do not fit in the event trace task table"
+#endif
+
+typedef struct {
+  uint32_t magic;
+  uint8_t version;
+  uint8_t eventSize;
+  uint8_t maxTasks;
+  uint8_t taskNameLen;
+  uint32_t capacity;
+  uint32_t writeCount; // Total number of recorded events, the next event is written to writeCount % capacity
+  uint32_t cpuFreqHz;  // Time stamp frequency
+  uint8_t reserved[12];
+} eventTraceHeader_t;
+
+_Static_assert(sizeof(eventTraceHeader_t) == 32, "Unexpected event trace header size");
+_Static_assert(sizeof(eventTraceEvent_t) == 8, "Unexpected event size");
+
+#define TASK_NAMES_OFFSET sizeof(eventTraceHeader_t)
+#define EVENTS_OFFSET (TASK_NAMES_OFFSET + sizeof(taskNames))
+#define TRACE_MEM_SIZE (EVENTS_OFFSET + sizeof(events))
+
+static bool isInit = false;
+static volatile uint8_t isRecording = 0;
+static uint32_t writeCount = 0;
+
+static char taskNames[EVENT_TRACE_MAX_TASKS][EVENT_TRACE_TASK_NAME_LEN];
+NO_DMA_CCM_SAFE_ZERO_INIT static eventTraceEvent_t events[EVENT_COUNT];
+
+static uint8_t usdDump = 0;
+
+static uint32_t handleMemGetSize(void) { return TRACE_MEM_SIZE; }
+static bool handleMemRead(const uint32_t memAddr, const uint8_t readLen, uint8_t* buffer);
+static const MemoryHandlerDef_t memDef = {
+  .type = MEM_TYPE_EVENT_TRACE,
+  .getSize = handleMemGetSize,
+  .read = handleMemRead,
+  .write = 0, // Write is not supported
+};
+
+void eventTraceInit(void) {
+  if (isInit) {
+    return;
+  }
+
+  cycleCounterInit();
+  memoryRegisterHandler(&memDef);
+
+  isInit = true;
+  isRecording = 1;
+}
+
+void eventTraceRecord(const uint8_t type, const uint16_t arg) {
+  if (!isRecording) {
+    return;
+  }
+
+  const uint32_t index = __atomic_fetch_add(&writeCount, 1, __ATOMIC_RELAXED) & (EVENT_COUNT - 1);
+  eventTraceEvent_t* event = &events[index];
+  event->timestamp = cycleCounterGet();
+  event->type = type;
+  event->arg = arg;
+}
+
+static inline uint16_t currentException(void) {
+#ifndef UNIT_TEST_MODE
+  return __get_IPSR() & 0x1ff;
+#else
+  return 0;
+#endif
+}
+
+void eventTraceIsrEnter(void) {
+  eventTraceRecord(EVENT_TRACE_ISR_ENTER, currentException());
+}
+
+void eventTraceIsrExit(void) {
+  eventTraceRecord(EVENT_TRACE_ISR_EXIT, currentException());
+}
+
+void eventTraceTaskCreated(const uint32_t taskNumber, const char* name) {
+  // Called by FreeRTOS, also for tasks created before eventTraceInit()
+  if (taskNumber < EVENT_TRACE_MAX_TASKS) {
+    strncpy(taskNames[taskNumber], name, EVENT_TRACE_TASK_NAME_LEN - 1);
+  }
+}
+
+static void readTrace(uint32_t memAddr, const uint8_t readLen, uint8_t* buffer) {
+  eventTraceHeader_t header = {
+    .magic = EVENT_TRACE_MAGIC,
+    .version = EVENT_TRACE_VERSION,
+    .eventSize = sizeof(eventTraceEvent_t),
+    .maxTasks = EVENT_TRACE_MAX_TASKS,
+    .taskNameLen = EVENT_TRACE_TASK_NAME_LEN,
+    .capacity = EVENT_COUNT,
+    .writeCount = writeCount,
+    .cpuFreqHz = FREERTOS_MCU_CLOCK_HZ,
+  };
+
+  // The read may span more than one of the regions
+  const uint32_t end = memAddr + readLen;
+  while (memAddr < end) {
+    const uint8_t* source;
+    uint32_t regionEnd;
+    if (memAddr < TASK_NAMES_OFFSET) {
+      source = (const uint8_t*)&header + memAddr;
+      regionEnd = TASK_NAMES_OFFSET;
+    } else if (memAddr < EVENTS_OFFSET) {
+      source = (const uint8_t*)taskNames + (memAddr - TASK_NAMES_OFFSET);
+      regionEnd = EVENTS_OFFSET;
+    } else {
+      source = (const uint8_t*)events + (memAddr - EVENTS_OFFSET);
+      regionEnd = TRACE_MEM_SIZE;
+    }
+
+    const uint32_t length = (end < regionEnd ? end : regionEnd) - memAddr;
+    memcpy(buffer, source, length);
+    buffer += length;
+    memAddr += length;
+  }
+}
+
+static bool handleMemRead(const uint32_t memAddr, const uint8_t readLen, uint8_t* buffer) {
+  if (memAddr + readLen > TRACE_MEM_SIZE) {
+    return false;
+  }
+
+  readTrace(memAddr, readLen, buffer);
+  return true;
+}
+
+#ifdef CONFIG_DECK_USD
+static void dumpToUsd(void* arg) {
+  // Pause the recording to get a consistent dump
+  const uint8_t wasRecording = isRecording;
+  isRecording = 0;
+
+  if (usddeckWriteFile(EVENT_TRACE_USD_FILENAME, TRACE_MEM_SIZE, handleMemRead)) {
+    DEBUG_PRINT("Event trace written to %s\n", EVENT_TRACE_USD_FILENAME);
+  } else {
+    DEBUG_PRINT("Failed to write event trace to uSD, is logging active?\n");
+  }
+
+  isRecording = wasRecording;
+}
+#endif
+
+static void usdDumpCallback(void) {
+  if (usdDump) {
+#ifdef CONFIG_DECK_USD
+    workerSchedule(dumpToUsd, NULL);
+#else
+    DEBUG_PRINT("Event trace dump to uSD requires the uSD deck driver\n");
+#endif
+    usdDump = 0;
+  }
+}
+
+/**
+ * Event tracer, records task switches, interrupts, blocking queue operations
+ * and spans. Decode the trace with tools/trace/decodeEventTrace.py.
+ */
+PARAM_GROUP_START(trace)
+/**
+ * @brief Nonzero to record events, set to 0 before reading the trace (default: 1)
+ */
+PARAM_ADD(PARAM_UINT8, enable, &isRecording)
+/**
+ * @brief Set to nonzero to write the trace to trace.bin on the uSD card, logging to the card must be stopped
+ */
+PARAM_ADD_WITH_CALLBACK(PARAM_UINT8, usdDump, &usdDump, usdDumpCallback)
+PARAM_GROUP_STOP(trace)
@@ -0,0 +1,297 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * gyro_spectrum.c - Vibration spectrum analyzer for the gyro
+ */
+
+/**
+ * The analyzer collects a window of unfiltered gyro samples, computes the
+ * spectrum of each axis with the CMSIS DSP real FFT and publishes the
+ * largest peaks as log variables. A decimated spectrum of all three axes is
+ * available through the MEM_TYPE_GYRO_SPECTRUM memory.
+ *
+ * The CPU budget is fixed: the task runs at low priority, processes one axis
+ * per wake up and waits period / 3 ms between axes, regardless of the gyro
+ * sample rate. No new window is collected until all three axes of the
+ * previous window have been processed.
+ */
+
+#define DEBUG_MODULE "GYROSPEC"
+
+#include <math.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "task.h"
+
+#include "config.h"
+#include "system.h"
+#include "static_mem.h"
+#include "mem.h"
+#include "log.h"
+#include "param.h"
+#include "debug.h"
+#include "arm_math.h"
+
+#include "gyro_spectrum.h"
+#include "spectrum.h"
+
+#define BINS (GYRO_SPECTRUM_WINDOW_SIZE / 2)
+// Skip DC and the lowest bins, they contain the flight motion and not vibrations
+#define MIN_BIN 2
+#define DISABLED_POLL_MS 100
+#define MIN_PERIOD_MS 30
+
+// Memory layout of MEM_TYPE_GYRO_SPECTRUM, naturally aligned and without padding
+typedef struct {
+  // Incremented every time a new spectrum is published
+  uint32_t sequence;
+  // Width of one decimated bin, in Hz
+  float binWidth;
+  uint16_t binCount;
+  uint16_t reserved;
+  // Amplitude (deg/s) per axis and bin, the first bin is centered at 0 Hz
+  float spectrum[3][GYRO_SPECTRUM_DECIMATED_BINS];
+} gyroSpectrumMem_t;
+
+static bool isInit = false;
+static float sampleRate;
+
+static arm_rfft_fast_instance_f32 fftInstance;
+
+// The window is written by the sensors task while capturing is true, and only read by the analyzer task otherwise
+NO_DMA_CCM_SAFE_ZERO_INIT static float samples[3][GYRO_SPECTRUM_WINDOW_SIZE];
+static uint16_t sampleIndex;
+static volatile bool capturing = false;
+static SemaphoreHandle_t windowReady;
+static StaticSemaphore_t windowReadyBuffer;
+
+NO_DMA_CCM_SAFE_ZERO_INIT static float hannWindow[GYRO_SPECTRUM_WINDOW_SIZE];
+NO_DMA_CCM_SAFE_ZERO_INIT static float fftIn[GYRO_SPECTRUM_WINDOW_SIZE];
+NO_DMA_CCM_SAFE_ZERO_INIT static float fftOut[GYRO_SPECTRUM_WINDOW_SIZE];
+NO_DMA_CCM_SAFE_ZERO_INIT static float magnitude[BINS];
+NO_DMA_CCM_SAFE_ZERO_INIT static gyroSpectrumMem_t published;
+
+static float peakFreq[3][GYRO_SPECTRUM_PEAKS];
+static float peakAmplitude[3][GYRO_SPECTRUM_PEAKS];
+
+static uint8_t enable = 0;
+static uint16_t periodMs = 300;
+
+static uint32_t handleMemGetSize(void) { return sizeof(published); }
+static bool handleMemRead(const uint32_t memAddr, const uint8_t readLen, uint8_t* buffer);
+static const MemoryHandlerDef_t memDef = {
+  .type = MEM_TYPE_GYRO_SPECTRUM,
+  .getSize = handleMemGetSize,
+  .read = handleMemRead,
+  .write = 0, // Write is not supported
+};
+
+static void gyroSpectrumTask(void* param);
+STATIC_MEM_TASK_ALLOC(gyroSpectrumTask, GYRO_SPECTRUM_TASK_STACKSIZE);
+
+void gyroSpectrumInit(const float sampleRateHz) {
+  if (isInit) {
+    return;
+  }
+
+  sampleRate = sampleRateHz;
+  arm_rfft_fast_init_f32(&fftInstance, GYRO_SPECTRUM_WINDOW_SIZE);
+  spectrumHannWindow(hannWindow, GYRO_SPECTRUM_WINDOW_SIZE);
+
+  published.binWidth = sampleRate / GYRO_SPECTRUM_DECIMATED_BINS / 2.0f;
+  published.binCount = GYRO_SPECTRUM_DECIMATED_BINS;
+
+  windowReady = xSemaphoreCreateBinaryStatic(&windowReadyBuffer);
+  memoryRegisterHandler(&memDef);
+  STATIC_MEM_TASK_CREATE(gyroSpectrumTask, gyroSpectrumTask, GYRO_SPECTRUM_TASK_NAME, NULL, GYRO_SPECTRUM_TASK_PRI);
+
+  isInit = true;
+}
+
+void gyroSpectrumAddSample(const Axis3f* gyro) {
+  if (!capturing) {
+    return;
+  }
+
+  samples[0][sampleIndex] = gyro->x;
+  samples[1][sampleIndex] = gyro->y;
+  samples[2][sampleIndex] = gyro->z;
+  sampleIndex++;
+
+  if (sampleIndex >= GYRO_SPECTRUM_WINDOW_SIZE) {
+    capturing = false;
+    xSemaphoreGive(windowReady);
+  }
+}
+
+static void analyzeAxis(const int axis) {
+  arm_mult_f32(samples[axis], hannWindow, fftIn, GYRO_SPECTRUM_WINDOW_SIZE);
+  arm_rfft_fast_f32(&fftInstance, fftIn, fftOut, 0);
+
+  // The first complex pair holds the real valued DC and Nyquist components
+  arm_cmplx_mag_f32(fftOut, magnitude, BINS);
+  magnitude[0] = fabsf(fftOut[0]);
+
+  // Scale to the amplitude of a sine wave, in deg/s
+  arm_scale_f32(magnitude, 2.0f / GYRO_SPECTRUM_WINDOW_SIZE, magnitude, BINS);
+
+  spectrumPeak_t peaks[GYRO_SPECTRUM_PEAKS];
+  const uint8_t count = spectrumFindPeaks(magnitude, BINS, MIN_BIN, peaks, GYRO_SPECTRUM_PEAKS);
+  const float binWidth = sampleRate / GYRO_SPECTRUM_WINDOW_SIZE;
+  for (uint8_t i = 0; i < GYRO_SPECTRUM_PEAKS; i++) {
+    peakFreq[axis][i] = (i < count) ? peaks[i].bin * binWidth : 0.0f;
+    peakAmplitude[axis][i] = (i < count) ? peaks[i].magnitude : 0.0f;
+  }
+
+  spectrumDecimate(magnitude, BINS, published.spectrum[axis], GYRO_SPECTRUM_DECIMATED_BINS);
+}
+
+static void gyroSpectrumTask(void* param) {
+  systemWaitStart();
+
+  while (true) {
+    if (!enable) {
+      vTaskDelay(M2T(DISABLED_POLL_MS));
+      continue;
+    }
+
+    sampleIndex = 0;
+    capturing = true;
+    xSemaphoreTake(windowReady, portMAX_DELAY);
+
+    const uint16_t period = (periodMs > MIN_PERIOD_MS) ? periodMs : MIN_PERIOD_MS;
+    for (int axis = 0; axis < 3; axis++) {
+      analyzeAxis(axis);
+      vTaskDelay(M2T(period / 3));
+    }
+    published.sequence++;
+  }
+}
+
+static bool handleMemRead(const uint32_t memAddr, const uint8_t readLen, uint8_t* buffer) {
+  if (memAddr + readLen > sizeof(published)) {
+    return false;
+  }
+
+  memcpy(buffer, (uint8_t*)&published + memAddr, readLen);
+  return true;
+}
+
+/**
+ * Vibration spectrum of the unfiltered gyro. The three largest peaks per
+ * axis, sorted by amplitude. Only updated while gyroSpec.enable is set.
+ */
+LOG_GROUP_START(gyroSpec)
+/**
+ * @brief Frequency of the largest peak, x axis [Hz]
+ */
+LOG_ADD(LOG_FLOAT, x0Hz, &peakFreq[0][0])
+/**
+ * @brief Amplitude of the largest peak, x axis [deg/s]
+ */
+LOG_ADD(LOG_FLOAT, x0Amp, &peakAmplitude[0][0])
+/**
+ * @brief Frequency of the second peak, x axis [Hz]
+ */
+LOG_ADD(LOG_FLOAT, x1Hz, &peakFreq[0][1])
+/**
+ * @brief Amplitude of the second peak, x axis [deg/s]
+ */
+LOG_ADD(LOG_FLOAT, x1Amp, &peakAmplitude[0][1])
+/**
+ * @brief Frequency of the third peak, x axis [Hz]
+ */
+LOG_ADD(LOG_FLOAT, x2Hz, &peakFreq[0][2])
+/**
+ * @brief Amplitude of the third peak, x axis [deg/s]
+ */
+LOG_ADD(LOG_FLOAT, x2Amp, &peakAmplitude[0][2])
+/**
+ * @brief Frequency of the largest peak, y axis [Hz]
+ */
+LOG_ADD(LOG_FLOAT, y0Hz, &peakFreq[1][0])
+/**
+ * @brief Amplitude of the largest peak, y axis [deg/s]
+ */
+LOG_ADD(LOG_FLOAT, y0Amp, &peakAmplitude[1][0])
+/**
+ * @brief Frequency of the second peak, y axis [Hz]
+ */
+LOG_ADD(LOG_FLOAT, y1Hz, &peakFreq[1][1])
+/**
+ * @brief Amplitude of the second peak, y axis [deg/s]
+ */
+LOG_ADD(LOG_FLOAT, y1Amp, &peakAmplitude[1][1])
+/**
+ * @brief Frequency of the third peak, y axis [Hz]
+ */
+LOG_ADD(LOG_FLOAT, y2Hz, &peakFreq[1][2])
+/**
+ * @brief Amplitude of the third peak, y axis [deg/s]
+ */
+LOG_ADD(LOG_FLOAT, y2Amp, &peakAmplitude[1][2])
+/**
+ * @brief Frequency of the largest peak, z axis [Hz]
+ */
+LOG_ADD(LOG_FLOAT, z0Hz, &peakFreq[2][0])
+/**
+ * @brief Amplitude of the largest peak, z axis [deg/s]
+ */
+LOG_ADD(LOG_FLOAT, z0Amp, &peakAmplitude[2][0])
+/**
+ * @brief Frequency of the second peak, z axis [Hz]
+ */
+LOG_ADD(LOG_FLOAT, z1Hz, &peakFreq[2][1])
+/**
+ * @brief Amplitude of the second peak, z axis [deg/s]
+ */
+LOG_ADD(LOG_FLOAT, z1Amp, &peakAmplitude[2][1])
+/**
+ * @brief Frequency of the third peak, z axis [Hz]
+ */
+LOG_ADD(LOG_FLOAT, z2Hz, &peakFreq[2][2])
+/**
+ * @brief Amplitude of the third peak, z axis [deg/s]
+ */
+LOG_ADD(LOG_FLOAT, z2Amp, &peakAmplitude[2][2])
+/**
+ * @brief Incremented every time a new spectrum has been analyzed
+ */
+LOG_ADD(LOG_UINT32, seq, &published.sequence)
+LOG_GROUP_STOP(gyroSpec)
+
+/**
+ * Vibration spectrum analyzer for the gyro
+ */
+PARAM_GROUP_START(gyroSpec)
+/**
+ * @brief Nonzero to run the analyzer (default: 0)
+ */
+PARAM_ADD(PARAM_UINT8, enable, &enable)
+/**
+ * @brief Time spent on processing one window, one axis is processed per period / 3 [ms] (default: 300, min: 30)
+ */
+PARAM_ADD(PARAM_UINT16, period, &periodMs)
+PARAM_GROUP_STOP(gyroSpec)
@@ -57,14 +57,17 @@
  * 2019.04.12, Kristoffer Richardsson: Refactored, separated kalman implementation from OS related functionality
  */
 
+#include <string.h>
+
 #include "kalman_core.h"
+#include "kalman_core_covariance.h"
+#include "kalman_core_ud.h"
 #include "cfassert.h"
 #include "autoconf.h"
 
 #include "physicalConstants.h"
 
 #include "math3d.h"
-#include "static_mem.h"
 
 // #define DEBUG_STATE_CHECK
 
@@ -116,6 +119,8 @@ static void assertStateNotNaN(const kalmanCoreData_t* this)
 // Small number epsilon, to prevent dividing by zero
 #define EPS (1e-6f)
 
+_Static_assert(KC_STATE_DIM == KC_COVARIANCE_DIM, "The covariance blocks do not match the state");
+
 void kalmanCoreDefaultParams(kalmanCoreParams_t* params)
 {
   // Initial variances, uncertain of position, but know we're stationary and roughly flat
@@ -152,6 +157,12 @@ void kalmanCoreDefaultParams(kalmanCoreParams_t* params)
 
   // Roll/pitch/yaw zero reversion is on by default. Will be overridden by estimator_kalman.c if requested by the deck.
   params->attitudeReversion = 0.001f;
+
+  #ifdef CONFIG_ESTIMATOR_KALMAN_UD
+  params->udFactorization = true;
+  #else
+  params->udFactorization = false;
+  #endif
 }
 
 void kalmanCoreInit(kalmanCoreData_t *this, const kalmanCoreParams_t *params, const uint32_t nowMs)
@@ -204,6 +215,11 @@ void kalmanCoreInit(kalmanCoreData_t *this, const kalmanCoreParams_t *params, co
   this->Pm.numCols = KC_STATE_DIM;
   this->Pm.pData = (float*)this->P;
 
+  this->udFactorization = params->udFactorization;
+  if (this->udFactorization) {
+    kalmanCoreUdFactor(this->P, this->U, this->D);
+  }
+
   this->baroReferenceHeight = 0.0;
 
   this->isUpdated = false;
@@ -211,31 +227,45 @@ void kalmanCoreInit(kalmanCoreData_t *this, const kalmanCoreParams_t *params, co
   this->lastProcessNoiseUpdateMs = nowMs;
 }
 
-void kalmanCoreScalarUpdate(kalmanCoreData_t* this, arm_matrix_instance_f32 *Hm, float error, float stdMeasNoise)
+// Bierman update of the UD factors. The covariance is positive semi definite by construction, no bounding is needed.
+static void scalarUpdateUd(kalmanCoreData_t* this, const float h[KC_STATE_DIM], float error, float stdMeasNoise)
 {
-  // The Kalman gain as a column vector
-  NO_DMA_CCM_SAFE_ZERO_INIT static float K[KC_STATE_DIM];
-  static arm_matrix_instance_f32 Km = {KC_STATE_DIM, 1, (float *)K};
+  float K[KC_STATE_DIM];
+  kalmanCoreUdScalarUpdate(this->U, this->D, h, stdMeasNoise*stdMeasNoise, K);
 
-  // Temporary matrices for the covariance updates
-  NO_DMA_CCM_SAFE_ZERO_INIT __attribute__((aligned(4))) static float tmpNN1d[KC_STATE_DIM * KC_STATE_DIM];
-  static arm_matrix_instance_f32 tmpNN1m = {KC_STATE_DIM, KC_STATE_DIM, tmpNN1d};
+  for (int i=0; i<KC_STATE_DIM; i++) {
+    this->S[i] = this->S[i] + K[i] * error; // state update
+  }
+  this->isCovarianceStale = true;
+  assertStateNotNaN(this);
 
-  NO_DMA_CCM_SAFE_ZERO_INIT __attribute__((aligned(4))) static float tmpNN2d[KC_STATE_DIM * KC_STATE_DIM];
-  static arm_matrix_instance_f32 tmpNN2m = {KC_STATE_DIM, KC_STATE_DIM, tmpNN2d};
+  this->isUpdated = true;
+}
 
-  NO_DMA_CCM_SAFE_ZERO_INIT __attribute__((aligned(4))) static float tmpNN3d[KC_STATE_DIM * KC_STATE_DIM];
-  static arm_matrix_instance_f32 tmpNN3m = {KC_STATE_DIM, KC_STATE_DIM, tmpNN3d};
+void kalmanCoreScalarUpdate(kalmanCoreData_t* this, arm_matrix_instance_f32 *Hm, float error, float stdMeasNoise)
+{
+  // The Kalman gain as a column vector
+  float* K = this->work.K;
+  arm_matrix_instance_f32 Km = {KC_STATE_DIM, 1, K};
 
-  NO_DMA_CCM_SAFE_ZERO_INIT __attribute__((aligned(4))) static float HTd[KC_STATE_DIM * 1];
-  static arm_matrix_instance_f32 HTm = {KC_STATE_DIM, 1, HTd};
+  // Temporary matrices for the covariance updates
+  float* tmpNN1d = (float*)this->work.tmpNN1;
+  arm_matrix_instance_f32 tmpNN1m = {KC_STATE_DIM, KC_STATE_DIM, tmpNN1d};
+  arm_matrix_instance_f32 tmpNN2m = {KC_STATE_DIM, KC_STATE_DIM, (float*)this->work.tmpNN2};
+  arm_matrix_instance_f32 tmpNN3m = {KC_STATE_DIM, KC_STATE_DIM, (float*)this->work.tmpNN3};
 
-  NO_DMA_CCM_SAFE_ZERO_INIT __attribute__((aligned(4))) static float PHTd[KC_STATE_DIM * 1];
-  static arm_matrix_instance_f32 PHTm = {KC_STATE_DIM, 1, PHTd};
+  float* PHTd = this->work.PHT;
+  arm_matrix_instance_f32 HTm = {KC_STATE_DIM, 1, this->work.HT};
+  arm_matrix_instance_f32 PHTm = {KC_STATE_DIM, 1, PHTd};
 
   ASSERT(Hm->numRows == 1);
   ASSERT(Hm->numCols == KC_STATE_DIM);
 
+  if (this->udFactorization) {
+    scalarUpdateUd(this, Hm->pData, error, stdMeasNoise);
+    return;
+  }
+
   // ====== INNOVATION COVARIANCE ======
 
   mat_trans(Hm, &HTm);
@@ -286,20 +316,23 @@ void kalmanCoreScalarUpdate(kalmanCoreData_t* this, arm_matrix_instance_f32 *Hm,
 void kalmanCoreUpdateWithPKE(kalmanCoreData_t* this, arm_matrix_instance_f32 *Hm, arm_matrix_instance_f32 *Km, arm_matrix_instance_f32 *P_w_m, float error)
 {
     // kalman filter update with weighted covariance matrix P_w_m, kalman gain Km, and innovation error
-    // Temporary matrices for the covariance updates
-    static float tmpNN1d[KC_STATE_DIM][KC_STATE_DIM];
-    static arm_matrix_instance_f32 tmpNN1m = {KC_STATE_DIM, KC_STATE_DIM, (float *)tmpNN1d};
+    const float* P_w = P_w_m->pData;
     for (int i=0; i<KC_STATE_DIM; i++){
         this->S[i] = this->S[i] + Km->pData[i] * error;
     }
     // ====== COVARIANCE UPDATE ====== //
-    mat_mult(Km, Hm, &tmpNN1m);                 // KH,  the Kalman Gain and H are the updated Kalman Gain and H
-    mat_scale(&tmpNN1m, -1.0f, &tmpNN1m);       //  I-KH
-    for (int i=0; i<KC_STATE_DIM; i++) { tmpNN1d[i][i] = 1.0f + tmpNN1d[i][i]; }
-    float Ppo[KC_STATE_DIM][KC_STATE_DIM]={0};
-    arm_matrix_instance_f32 Ppom = {KC_STATE_DIM, KC_STATE_DIM, (float *)Ppo};
-    mat_mult(&tmpNN1m, P_w_m, &Ppom);          // Pm = (I-KH)*P_w_m
-    memcpy(this->P, Ppo, sizeof(this->P));
+    // The update is scalar, (I-KH)*P_w_m = P_w_m - K*(H*P_w_m) is a rank one correction of P_w_m
+    float HP[KC_STATE_DIM] = {0};
+    for (int k=0; k<KC_STATE_DIM; k++) {
+        for (int j=0; j<KC_STATE_DIM; j++) {
+            HP[j] += Hm->pData[k] * P_w[k * KC_STATE_DIM + j];
+        }
+    }
+    for (int i=0; i<KC_STATE_DIM; i++) {
+        for (int j=0; j<KC_STATE_DIM; j++) {
+            this->P[i][j] = P_w[i * KC_STATE_DIM + j] - Km->pData[i] * HP[j];
+        }
+    }
 
     assertStateNotNaN(this);
 
@@ -315,6 +348,10 @@ void kalmanCoreUpdateWithPKE(kalmanCoreData_t* this, arm_matrix_instance_f32 *Hm
             }
         }
     }
+    if (this->udFactorization) {
+        kalmanCoreUdFactor(this->P, this->U, this->D);
+        this->isCovarianceStale = false;
+    }
     assertStateNotNaN(this);
 
     this->isUpdated = true;
@@ -336,6 +373,23 @@ void kalmanCoreUpdateWithBaro(kalmanCoreData_t *this, const kalmanCoreParams_t *
   kalmanCoreScalarUpdate(this, &H, meas - this->S[KC_STATE_Z], params->measNoiseBaro);
 }
 
+// Second order approximation of the rotation of the attitude error covariance,
+// (I + [[-d]] + [[-d]]^2 / 2), where d is the attitude error as Rodrigues parameters
+static void attitudeErrorRotation(float A[3][3], const float d0, const float d1, const float d2)
+{
+  A[0][0] =  1 - d1*d1/2 - d2*d2/2;
+  A[0][1] =  d2 + d0*d1/2;
+  A[0][2] = -d1 + d0*d2/2;
+
+  A[1][0] = -d2 + d0*d1/2;
+  A[1][1] =  1 - d0*d0/2 - d2*d2/2;
+  A[1][2] =  d0 + d1*d2/2;
+
+  A[2][0] =  d1 + d0*d2/2;
+  A[2][1] = -d0 + d1*d2/2;
+  A[2][2] = 1 - d0*d0/2 - d1*d1/2;
+}
+
 static void predictDt(kalmanCoreData_t* this, const kalmanCoreParams_t *params, Axis3f *acc, Axis3f *gyro, float dt, bool quadIsFlying)
 {
   /* Here we discretize (euler forward) and linearise the quadrocopter dynamics in order
@@ -359,84 +413,51 @@ static void predictDt(kalmanCoreData_t* this, const kalmanCoreParams_t *params,
    * since error information is incorporated into R after each Kalman update.
    */
 
-  // The linearized update matrix
-  NO_DMA_CCM_SAFE_ZERO_INIT static float A[KC_STATE_DIM][KC_STATE_DIM];
-  static __attribute__((aligned(4))) arm_matrix_instance_f32 Am = { KC_STATE_DIM, KC_STATE_DIM, (float *)A}; // linearized dynamics for covariance update;
-
-  // Temporary matrices for the covariance updates
-  NO_DMA_CCM_SAFE_ZERO_INIT static float tmpNN1d[KC_STATE_DIM * KC_STATE_DIM];
-  static __attribute__((aligned(4))) arm_matrix_instance_f32 tmpNN1m = { KC_STATE_DIM, KC_STATE_DIM, tmpNN1d};
-
-  NO_DMA_CCM_SAFE_ZERO_INIT static float tmpNN2d[KC_STATE_DIM * KC_STATE_DIM];
-  static __attribute__((aligned(4))) arm_matrix_instance_f32 tmpNN2m = { KC_STATE_DIM, KC_STATE_DIM, tmpNN2d};
+  // The non trivial blocks of the linearized update matrix, see kalman_core_covariance.h
+  kalmanCoreJacobian_t A;
 
   float dt2 = dt*dt;
 
   // ====== DYNAMICS LINEARIZATION ======
-  // Initialize as the identity
-  A[KC_STATE_X][KC_STATE_X] = 1;
-  A[KC_STATE_Y][KC_STATE_Y] = 1;
-  A[KC_STATE_Z][KC_STATE_Z] = 1;
-
-  A[KC_STATE_PX][KC_STATE_PX] = 1;
-  A[KC_STATE_PY][KC_STATE_PY] = 1;
-  A[KC_STATE_PZ][KC_STATE_PZ] = 1;
-
-  A[KC_STATE_D0][KC_STATE_D0] = 1;
-  A[KC_STATE_D1][KC_STATE_D1] = 1;
-  A[KC_STATE_D2][KC_STATE_D2] = 1;
-
   // position from body-frame velocity
-  A[KC_STATE_X][KC_STATE_PX] = this->R[0][0]*dt;
-  A[KC_STATE_Y][KC_STATE_PX] = this->R[1][0]*dt;
-  A[KC_STATE_Z][KC_STATE_PX] = this->R[2][0]*dt;
-
-  A[KC_STATE_X][KC_STATE_PY] = this->R[0][1]*dt;
-  A[KC_STATE_Y][KC_STATE_PY] = this->R[1][1]*dt;
-  A[KC_STATE_Z][KC_STATE_PY] = this->R[2][1]*dt;
-
-  A[KC_STATE_X][KC_STATE_PZ] = this->R[0][2]*dt;
-  A[KC_STATE_Y][KC_STATE_PZ] = this->R[1][2]*dt;
-  A[KC_STATE_Z][KC_STATE_PZ] = this->R[2][2]*dt;
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) {
+      A.posVel[i][j] = this->R[i][j]*dt;
+    }
+  }
 
   // position from attitude error
-  A[KC_STATE_X][KC_STATE_D0] = (this->S[KC_STATE_PY]*this->R[0][2] - this->S[KC_STATE_PZ]*this->R[0][1])*dt;
-  A[KC_STATE_Y][KC_STATE_D0] = (this->S[KC_STATE_PY]*this->R[1][2] - this->S[KC_STATE_PZ]*this->R[1][1])*dt;
-  A[KC_STATE_Z][KC_STATE_D0] = (this->S[KC_STATE_PY]*this->R[2][2] - this->S[KC_STATE_PZ]*this->R[2][1])*dt;
-
-  A[KC_STATE_X][KC_STATE_D1] = (- this->S[KC_STATE_PX]*this->R[0][2] + this->S[KC_STATE_PZ]*this->R[0][0])*dt;
-  A[KC_STATE_Y][KC_STATE_D1] = (- this->S[KC_STATE_PX]*this->R[1][2] + this->S[KC_STATE_PZ]*this->R[1][0])*dt;
-  A[KC_STATE_Z][KC_STATE_D1] = (- this->S[KC_STATE_PX]*this->R[2][2] + this->S[KC_STATE_PZ]*this->R[2][0])*dt;
-
-  A[KC_STATE_X][KC_STATE_D2] = (this->S[KC_STATE_PX]*this->R[0][1] - this->S[KC_STATE_PY]*this->R[0][0])*dt;
-  A[KC_STATE_Y][KC_STATE_D2] = (this->S[KC_STATE_PX]*this->R[1][1] - this->S[KC_STATE_PY]*this->R[1][0])*dt;
-  A[KC_STATE_Z][KC_STATE_D2] = (this->S[KC_STATE_PX]*this->R[2][1] - this->S[KC_STATE_PY]*this->R[2][0])*dt;
+  for (int i = 0; i < 3; i++) {
+    A.posAtt[i][0] = (this->S[KC_STATE_PY]*this->R[i][2] - this->S[KC_STATE_PZ]*this->R[i][1])*dt;
+    A.posAtt[i][1] = (- this->S[KC_STATE_PX]*this->R[i][2] + this->S[KC_STATE_PZ]*this->R[i][0])*dt;
+    A.posAtt[i][2] = (this->S[KC_STATE_PX]*this->R[i][1] - this->S[KC_STATE_PY]*this->R[i][0])*dt;
+  }
 
   // body-frame velocity from body-frame velocity
-  A[KC_STATE_PX][KC_STATE_PX] = 1; //drag negligible
-  A[KC_STATE_PY][KC_STATE_PX] =-gyro->z*dt;
-  A[KC_STATE_PZ][KC_STATE_PX] = gyro->y*dt;
+  A.velVel[0][0] = 1; //drag negligible
+  A.velVel[1][0] =-gyro->z*dt;
+  A.velVel[2][0] = gyro->y*dt;
 
-  A[KC_STATE_PX][KC_STATE_PY] = gyro->z*dt;
-  A[KC_STATE_PY][KC_STATE_PY] = 1; //drag negligible
-  A[KC_STATE_PZ][KC_STATE_PY] =-gyro->x*dt;
+  A.velVel[0][1] = gyro->z*dt;
+  A.velVel[1][1] = 1; //drag negligible
+  A.velVel[2][1] =-gyro->x*dt;
 
-  A[KC_STATE_PX][KC_STATE_PZ] =-gyro->y*dt;
-  A[KC_STATE_PY][KC_STATE_PZ] = gyro->x*dt;
-  A[KC_STATE_PZ][KC_STATE_PZ] = 1; //drag negligible
+  A.velVel[0][2] =-gyro->y*dt;
+  A.velVel[1][2] = gyro->x*dt;
+  A.velVel[2][2] = 1; //drag negligible
 
   // body-frame velocity from attitude error
-  A[KC_STATE_PX][KC_STATE_D0] =  0;
-  A[KC_STATE_PY][KC_STATE_D0] = -GRAVITY_MAGNITUDE*this->R[2][2]*dt;
-  A[KC_STATE_PZ][KC_STATE_D0] =  GRAVITY_MAGNITUDE*this->R[2][1]*dt;
+  A.velAtt[0][0] =  0;
+  A.velAtt[1][0] = -GRAVITY_MAGNITUDE*this->R[2][2]*dt;
+  A.velAtt[2][0] =  GRAVITY_MAGNITUDE*this->R[2][1]*dt;
 
-  A[KC_STATE_PX][KC_STATE_D1] =  GRAVITY_MAGNITUDE*this->R[2][2]*dt;
-  A[KC_STATE_PY][KC_STATE_D1] =  0;
-  A[KC_STATE_PZ][KC_STATE_D1] = -GRAVITY_MAGNITUDE*this->R[2][0]*dt;
+  A.velAtt[0][1] =  GRAVITY_MAGNITUDE*this->R[2][2]*dt;
+  A.velAtt[1][1] =  0;
+  A.velAtt[2][1] = -GRAVITY_MAGNITUDE*this->R[2][0]*dt;
 
-  A[KC_STATE_PX][KC_STATE_D2] = -GRAVITY_MAGNITUDE*this->R[2][1]*dt;
-  A[KC_STATE_PY][KC_STATE_D2] =  GRAVITY_MAGNITUDE*this->R[2][0]*dt;
-  A[KC_STATE_PZ][KC_STATE_D2] =  0;
+  A.velAtt[0][2] = -GRAVITY_MAGNITUDE*this->R[2][1]*dt;
+  A.velAtt[1][2] =  GRAVITY_MAGNITUDE*this->R[2][0]*dt;
+  A.velAtt[2][2] =  0;
 
   // attitude error from attitude error
   /**
@@ -454,27 +475,16 @@ static void predictDt(kalmanCoreData_t* this, const kalmanCoreParams_t *params,
    * As derived in "Covariance Correction Step for Kalman Filtering with an Attitude"
    * http://arc.aiaa.org/doi/abs/10.2514/1.G000848
    */
-  float d0 = gyro->x*dt/2;
-  float d1 = gyro->y*dt/2;
-  float d2 = gyro->z*dt/2;
-
-  A[KC_STATE_D0][KC_STATE_D0] =  1 - d1*d1/2 - d2*d2/2;
-  A[KC_STATE_D0][KC_STATE_D1] =  d2 + d0*d1/2;
-  A[KC_STATE_D0][KC_STATE_D2] = -d1 + d0*d2/2;
-
-  A[KC_STATE_D1][KC_STATE_D0] = -d2 + d0*d1/2;
-  A[KC_STATE_D1][KC_STATE_D1] =  1 - d0*d0/2 - d2*d2/2;
-  A[KC_STATE_D1][KC_STATE_D2] =  d0 + d1*d2/2;
-
-  A[KC_STATE_D2][KC_STATE_D0] =  d1 + d0*d2/2;
-  A[KC_STATE_D2][KC_STATE_D1] = -d0 + d1*d2/2;
-  A[KC_STATE_D2][KC_STATE_D2] = 1 - d0*d0/2 - d1*d1/2;
+  attitudeErrorRotation(A.attAtt, gyro->x*dt/2, gyro->y*dt/2, gyro->z*dt/2);
 
 
   // ====== COVARIANCE UPDATE ======
-  mat_mult(&Am, &this->Pm, &tmpNN1m); // A P
-  mat_trans(&Am, &tmpNN2m); // A'
-  mat_mult(&tmpNN1m, &tmpNN2m, &this->Pm); // A P A'
+  if (this->udFactorization) {
+    kalmanCoreUdPredict(this->U, this->D, &A);
+    this->isCovarianceStale = true;
+  } else {
+    kalmanCoreCovariancePredict(this->P, &A); // A P A'
+  }
   // Process noise is added after the return from the prediction step
 
   // ====== PREDICTION STEP ======
@@ -582,17 +592,29 @@ void kalmanCorePredict(kalmanCoreData_t* this, const kalmanCoreParams_t *params,
 
 static void addProcessNoiseDt(kalmanCoreData_t *this, const kalmanCoreParams_t *params, float dt)
 {
-  this->P[KC_STATE_X][KC_STATE_X] += powf(params->procNoiseAcc_xy*dt*dt + params->procNoiseVel*dt + params->procNoisePos, 2);  // add process noise on position
-  this->P[KC_STATE_Y][KC_STATE_Y] += powf(params->procNoiseAcc_xy*dt*dt + params->procNoiseVel*dt + params->procNoisePos, 2);  // add process noise on position
-  this->P[KC_STATE_Z][KC_STATE_Z] += powf(params->procNoiseAcc_z*dt*dt + params->procNoiseVel*dt + params->procNoisePos, 2);  // add process noise on position
-
-  this->P[KC_STATE_PX][KC_STATE_PX] += powf(params->procNoiseAcc_xy*dt + params->procNoiseVel, 2); // add process noise on velocity
-  this->P[KC_STATE_PY][KC_STATE_PY] += powf(params->procNoiseAcc_xy*dt + params->procNoiseVel, 2); // add process noise on velocity
-  this->P[KC_STATE_PZ][KC_STATE_PZ] += powf(params->procNoiseAcc_z*dt + params->procNoiseVel, 2); // add process noise on velocity
+  float q[KC_STATE_DIM];
+  q[KC_STATE_X] = powf(params->procNoiseAcc_xy*dt*dt + params->procNoiseVel*dt + params->procNoisePos, 2);  // process noise on position
+  q[KC_STATE_Y] = powf(params->procNoiseAcc_xy*dt*dt + params->procNoiseVel*dt + params->procNoisePos, 2);  // process noise on position
+  q[KC_STATE_Z] = powf(params->procNoiseAcc_z*dt*dt + params->procNoiseVel*dt + params->procNoisePos, 2);  // process noise on position
+
+  q[KC_STATE_PX] = powf(params->procNoiseAcc_xy*dt + params->procNoiseVel, 2); // process noise on velocity
+  q[KC_STATE_PY] = powf(params->procNoiseAcc_xy*dt + params->procNoiseVel, 2); // process noise on velocity
+  q[KC_STATE_PZ] = powf(params->procNoiseAcc_z*dt + params->procNoiseVel, 2); // process noise on velocity
+
+  q[KC_STATE_D0] = powf(params->measNoiseGyro_rollpitch * dt + params->procNoiseAtt, 2);
+  q[KC_STATE_D1] = powf(params->measNoiseGyro_rollpitch * dt + params->procNoiseAtt, 2);
+  q[KC_STATE_D2] = powf(params->measNoiseGyro_yaw * dt + params->procNoiseAtt, 2);
+
+  if (this->udFactorization) {
+    kalmanCoreUdAddDiagonal(this->U, this->D, q);
+    this->isCovarianceStale = true;
+    assertStateNotNaN(this);
+    return;
+  }
 
-  this->P[KC_STATE_D0][KC_STATE_D0] += powf(params->measNoiseGyro_rollpitch * dt + params->procNoiseAtt, 2);
-  this->P[KC_STATE_D1][KC_STATE_D1] += powf(params->measNoiseGyro_rollpitch * dt + params->procNoiseAtt, 2);
-  this->P[KC_STATE_D2][KC_STATE_D2] += powf(params->measNoiseGyro_yaw * dt + params->procNoiseAtt, 2);
+  for (int i=0; i<KC_STATE_DIM; i++) {
+    this->P[i][i] += q[i];
+  }
 
   for (int i=0; i<KC_STATE_DIM; i++) {
     for (int j=i; j<KC_STATE_DIM; j++) {
@@ -626,17 +648,6 @@ bool kalmanCoreFinalize(kalmanCoreData_t* this)
   }
 
 
-  // Matrix to rotate the attitude covariances once updated
-  NO_DMA_CCM_SAFE_ZERO_INIT static float A[KC_STATE_DIM][KC_STATE_DIM];
-  static arm_matrix_instance_f32 Am = {KC_STATE_DIM, KC_STATE_DIM, (float *)A};
-
-  // Temporary matrices for the covariance updates
-  NO_DMA_CCM_SAFE_ZERO_INIT static float tmpNN1d[KC_STATE_DIM * KC_STATE_DIM];
-  static arm_matrix_instance_f32 tmpNN1m = {KC_STATE_DIM, KC_STATE_DIM, tmpNN1d};
-
-  NO_DMA_CCM_SAFE_ZERO_INIT static float tmpNN2d[KC_STATE_DIM * KC_STATE_DIM];
-  static arm_matrix_instance_f32 tmpNN2m = {KC_STATE_DIM, KC_STATE_DIM, tmpNN2d};
-
   // Incorporate the attitude error (Kalman filter state) with the attitude
   float v0 = this->S[KC_STATE_D0];
   float v1 = this->S[KC_STATE_D1];
@@ -674,33 +685,15 @@ bool kalmanCoreFinalize(kalmanCoreData_t* this)
      * http://arc.aiaa.org/doi/abs/10.2514/1.G000848
      */
 
-    float d0 = v0/2; // the attitude error vector (v0,v1,v2) is small,
-    float d1 = v1/2; // so we use a first order approximation to d0 = tan(|v0|/2)*v0/|v0|
-    float d2 = v2/2;
-
-    A[KC_STATE_X][KC_STATE_X] = 1;
-    A[KC_STATE_Y][KC_STATE_Y] = 1;
-    A[KC_STATE_Z][KC_STATE_Z] = 1;
-
-    A[KC_STATE_PX][KC_STATE_PX] = 1;
-    A[KC_STATE_PY][KC_STATE_PY] = 1;
-    A[KC_STATE_PZ][KC_STATE_PZ] = 1;
-
-    A[KC_STATE_D0][KC_STATE_D0] =  1 - d1*d1/2 - d2*d2/2;
-    A[KC_STATE_D0][KC_STATE_D1] =  d2 + d0*d1/2;
-    A[KC_STATE_D0][KC_STATE_D2] = -d1 + d0*d2/2;
-
-    A[KC_STATE_D1][KC_STATE_D0] = -d2 + d0*d1/2;
-    A[KC_STATE_D1][KC_STATE_D1] =  1 - d0*d0/2 - d2*d2/2;
-    A[KC_STATE_D1][KC_STATE_D2] =  d0 + d1*d2/2;
-
-    A[KC_STATE_D2][KC_STATE_D0] =  d1 + d0*d2/2;
-    A[KC_STATE_D2][KC_STATE_D1] = -d0 + d1*d2/2;
-    A[KC_STATE_D2][KC_STATE_D2] = 1 - d0*d0/2 - d1*d1/2;
-
-    mat_trans(&Am, &tmpNN1m); // A'
-    mat_mult(&Am, &this->Pm, &tmpNN2m); // AP
-    mat_mult(&tmpNN2m, &tmpNN1m, &this->Pm); //APA'
+    // the attitude error vector (v0,v1,v2) is small, so we use a first order approximation to d0 = tan(|v0|/2)*v0/|v0|
+    float attAtt[3][3];
+    attitudeErrorRotation(attAtt, v0/2, v1/2, v2/2);
+    if (this->udFactorization) {
+      kalmanCoreUdRotateAttitude(this->U, this->D, attAtt);
+      this->isCovarianceStale = true;
+    } else {
+      kalmanCoreCovarianceRotateAttitude(this->P, attAtt); // A P A'
+    }
   }
 
   // convert the new attitude to a rotation matrix, such that we can rotate body-frame velocity and acc
@@ -721,16 +714,19 @@ bool kalmanCoreFinalize(kalmanCoreData_t* this)
   this->S[KC_STATE_D1] = 0;
   this->S[KC_STATE_D2] = 0;
 
-  // enforce symmetry of the covariance matrix, and ensure the values stay bounded
-  for (int i=0; i<KC_STATE_DIM; i++) {
-    for (int j=i; j<KC_STATE_DIM; j++) {
-      float p = 0.5f*this->P[i][j] + 0.5f*this->P[j][i];
-      if (isnan(p) || p > MAX_COVARIANCE) {
-        this->P[i][j] = this->P[j][i] = MAX_COVARIANCE;
-      } else if ( i==j && p < MIN_COVARIANCE ) {
-        this->P[i][j] = this->P[j][i] = MIN_COVARIANCE;
-      } else {
-        this->P[i][j] = this->P[j][i] = p;
+  // enforce symmetry of the covariance matrix, and ensure the values stay bounded. Not needed for the UD
+  // factorization, where the covariance is symmetric and positive semi definite by construction.
+  if (!this->udFactorization) {
+    for (int i=0; i<KC_STATE_DIM; i++) {
+      for (int j=i; j<KC_STATE_DIM; j++) {
+        float p = 0.5f*this->P[i][j] + 0.5f*this->P[j][i];
+        if (isnan(p) || p > MAX_COVARIANCE) {
+          this->P[i][j] = this->P[j][i] = MAX_COVARIANCE;
+        } else if ( i==j && p < MIN_COVARIANCE ) {
+          this->P[i][j] = this->P[j][i] = MIN_COVARIANCE;
+        } else {
+          this->P[i][j] = this->P[j][i] = p;
+        }
       }
     }
   }
@@ -794,6 +790,8 @@ void kalmanCoreExternalizeState(const kalmanCoreData_t* this, state_t *state, co
 // If called often, this decouples the state to the rest of the filter
 static void decoupleState(kalmanCoreData_t* this, kalmanCoreStateIdx_t state)
 {
+  kalmanCoreSyncCovariance(this);
+
   // Set all covariance to 0
   for(int i=0; i<KC_STATE_DIM; i++) {
     this->P[state][i] = 0;
@@ -803,6 +801,20 @@ static void decoupleState(kalmanCoreData_t* this, kalmanCoreStateIdx_t state)
   this->P[state][state] = MAX_COVARIANCE;
   // set state to zero
   this->S[state] = 0;
+
+  if (this->udFactorization) {
+    kalmanCoreUdFactor(this->P, this->U, this->D);
+  }
+}
+
+void kalmanCoreSyncCovariance(kalmanCoreData_t* this)
+{
+  // The full reconstruction is O(n^3), it is done at most once per loop rather than after every update
+  if (this->udFactorization && this->isCovarianceStale) {
+    kalmanCoreUdToCovariance(this->U, this->D, this->P);
+    this->isCovarianceStale = false;
+    assertStateNotNaN(this);
+  }
 }
 
 void kalmanCoreDecoupleXY(kalmanCoreData_t* this)
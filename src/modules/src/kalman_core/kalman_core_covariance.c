@@ -0,0 +1,160 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * kalman_core_covariance.c - Block structured covariance propagation for the kalman core
+ *
+ * The jacobians of the prediction and of the attitude reset are block upper
+ * triangular with an identity block for the position. Doing A * P * A' on 3x3
+ * blocks and skipping the known zero and identity blocks needs 540 multiply
+ * accumulates for the prediction instead of 1458 for the dense product (and
+ * no transpose), and 135 for the attitude rotation.
+ */
+
+#include "kalman_core_covariance.h"
+
+#include <string.h>
+
+#define B KC_COVARIANCE_BLOCK
+
+// First row/column of each block in the state
+#define POS 0
+#define VEL B
+#define ATT (2 * B)
+
+// dst = block of P at (row, col)
+static void blockFromP(float dst[B][B], float P[KC_COVARIANCE_DIM][KC_COVARIANCE_DIM], const int row, const int col) {
+  for (int i = 0; i < B; i++) {
+    for (int j = 0; j < B; j++) {
+      dst[i][j] = P[row + i][col + j];
+    }
+  }
+}
+
+// dst += a * block of P at (row, col)
+static void blockMultAddP(float dst[B][B], const float a[B][B], float P[KC_COVARIANCE_DIM][KC_COVARIANCE_DIM], const int row, const int col) {
+  for (int i = 0; i < B; i++) {
+    for (int j = 0; j < B; j++) {
+      dst[i][j] += a[i][0] * P[row][col + j] + a[i][1] * P[row + 1][col + j] + a[i][2] * P[row + 2][col + j];
+    }
+  }
+}
+
+// dst += a * b'
+static void blockMultTransAdd(float dst[B][B], const float a[B][B], const float b[B][B]) {
+  for (int i = 0; i < B; i++) {
+    for (int j = 0; j < B; j++) {
+      dst[i][j] += a[i][0] * b[j][0] + a[i][1] * b[j][1] + a[i][2] * b[j][2];
+    }
+  }
+}
+
+// Store src as the block of P at (row, col) and its transpose at (col, row). Diagonal blocks are
+// mirrored from their upper triangle.
+static void blockToP(float P[KC_COVARIANCE_DIM][KC_COVARIANCE_DIM], const int row, const int col, const float src[B][B]) {
+  for (int i = 0; i < B; i++) {
+    for (int j = (row == col) ? i : 0; j < B; j++) {
+      P[row + i][col + j] = src[i][j];
+      P[col + j][row + i] = src[i][j];
+    }
+  }
+}
+
+void kalmanCoreCovariancePredict(float P[KC_COVARIANCE_DIM][KC_COVARIANCE_DIM], const kalmanCoreJacobian_t* A) {
+  // T = A * P, only the blocks that are needed for the upper block triangle of T * A'
+  float Tpp[B][B], Tpv[B][B], Tpd[B][B], Tvv[B][B], Tvd[B][B], Tdd[B][B];
+
+  blockFromP(Tpp, P, POS, POS);
+  blockMultAddP(Tpp, A->posVel, P, VEL, POS);
+  blockMultAddP(Tpp, A->posAtt, P, ATT, POS);
+
+  blockFromP(Tpv, P, POS, VEL);
+  blockMultAddP(Tpv, A->posVel, P, VEL, VEL);
+  blockMultAddP(Tpv, A->posAtt, P, ATT, VEL);
+
+  blockFromP(Tpd, P, POS, ATT);
+  blockMultAddP(Tpd, A->posVel, P, VEL, ATT);
+  blockMultAddP(Tpd, A->posAtt, P, ATT, ATT);
+
+  memset(Tvv, 0, sizeof(Tvv));
+  blockMultAddP(Tvv, A->velVel, P, VEL, VEL);
+  blockMultAddP(Tvv, A->velAtt, P, ATT, VEL);
+
+  memset(Tvd, 0, sizeof(Tvd));
+  blockMultAddP(Tvd, A->velVel, P, VEL, ATT);
+  blockMultAddP(Tvd, A->velAtt, P, ATT, ATT);
+
+  memset(Tdd, 0, sizeof(Tdd));
+  blockMultAddP(Tdd, A->attAtt, P, ATT, ATT);
+
+  // P = T * A', P is not read any more and can be overwritten
+  float out[B][B];
+
+  memcpy(out, Tpp, sizeof(out));
+  blockMultTransAdd(out, Tpv, A->posVel);
+  blockMultTransAdd(out, Tpd, A->posAtt);
+  blockToP(P, POS, POS, out);
+
+  memset(out, 0, sizeof(out));
+  blockMultTransAdd(out, Tpv, A->velVel);
+  blockMultTransAdd(out, Tpd, A->velAtt);
+  blockToP(P, POS, VEL, out);
+
+  memset(out, 0, sizeof(out));
+  blockMultTransAdd(out, Tpd, A->attAtt);
+  blockToP(P, POS, ATT, out);
+
+  memset(out, 0, sizeof(out));
+  blockMultTransAdd(out, Tvv, A->velVel);
+  blockMultTransAdd(out, Tvd, A->velAtt);
+  blockToP(P, VEL, VEL, out);
+
+  memset(out, 0, sizeof(out));
+  blockMultTransAdd(out, Tvd, A->attAtt);
+  blockToP(P, VEL, ATT, out);
+
+  memset(out, 0, sizeof(out));
+  blockMultTransAdd(out, Tdd, A->attAtt);
+  blockToP(P, ATT, ATT, out);
+}
+
+void kalmanCoreCovarianceRotateAttitude(float P[KC_COVARIANCE_DIM][KC_COVARIANCE_DIM], const float attAtt[KC_COVARIANCE_BLOCK][KC_COVARIANCE_BLOCK]) {
+  // The position and velocity blocks are not affected
+  float block[B][B];
+  float out[B][B];
+
+  blockFromP(block, P, POS, ATT);
+  memset(out, 0, sizeof(out));
+  blockMultTransAdd(out, block, attAtt);
+  blockToP(P, POS, ATT, out);
+
+  blockFromP(block, P, VEL, ATT);
+  memset(out, 0, sizeof(out));
+  blockMultTransAdd(out, block, attAtt);
+  blockToP(P, VEL, ATT, out);
+
+  memset(block, 0, sizeof(block));
+  blockMultAddP(block, attAtt, P, ATT, ATT);
+  memset(out, 0, sizeof(out));
+  blockMultTransAdd(out, block, attAtt);
+  blockToP(P, ATT, ATT, out);
+}
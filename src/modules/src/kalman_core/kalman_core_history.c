@@ -0,0 +1,144 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * kalman_core_history.c - State history for out-of-sequence measurements
+ */
+
+#include <string.h>
+
+#include "kalman_core_history.h"
+#include "math3d.h"
+
+static struct quat toQuat(const float q[4]) {
+  return mkquat(q[1], q[2], q[3], q[0]);
+}
+
+// Time comparison that handles wrap around of the tick counter
+static bool isBefore(const uint32_t a, const uint32_t b) {
+  return (int32_t)(a - b) < 0;
+}
+
+// Add a part of the motion of one prediction, the rotation is applied after the rotations of earlier predictions
+static void addMotion(const kalmanCoreHistorySample_t* step, const float part, float pos[3], struct quat* rotation) {
+  for (int i = 0; i < 3; i++) {
+    pos[i] += part * step->pos[i];
+  }
+
+  const struct quat q = qnlerp(qeye(), toQuat(step->q), part);
+  *rotation = qqmul(*rotation, q);
+}
+
+void kalmanCoreHistoryReset(kalmanCoreHistory_t* this) {
+  memset(this, 0, sizeof(kalmanCoreHistory_t));
+}
+
+void kalmanCoreHistorySnapshot(const kalmanCoreData_t* coreData, kalmanCoreHistorySample_t* snapshot) {
+  snapshot->timestampMs = 0;
+  snapshot->pos[0] = coreData->S[KC_STATE_X];
+  snapshot->pos[1] = coreData->S[KC_STATE_Y];
+  snapshot->pos[2] = coreData->S[KC_STATE_Z];
+  for (int i = 0; i < 4; i++) {
+    snapshot->q[i] = coreData->q[i];
+  }
+}
+
+void kalmanCoreHistoryAddPrediction(kalmanCoreHistory_t* this, const kalmanCoreHistorySample_t* before, const kalmanCoreData_t* coreData, const uint32_t nowMs) {
+  kalmanCoreHistorySample_t* step = &this->samples[this->head];
+
+  step->timestampMs = nowMs;
+  step->pos[0] = coreData->S[KC_STATE_X] - before->pos[0];
+  step->pos[1] = coreData->S[KC_STATE_Y] - before->pos[1];
+  step->pos[2] = coreData->S[KC_STATE_Z] - before->pos[2];
+
+  // The rotation of the prediction, in the world frame. Kept on the short path for the interpolation.
+  struct quat q = qnormalize(qqmul(toQuat(coreData->q), qinv(toQuat(before->q))));
+  if (q.w < 0.0f) {
+    q = qneg(q);
+  }
+  step->q[0] = q.w;
+  step->q[1] = q.x;
+  step->q[2] = q.y;
+  step->q[3] = q.z;
+
+  this->head = (this->head + 1) % KALMAN_CORE_HISTORY_LENGTH;
+  if (this->count < KALMAN_CORE_HISTORY_LENGTH) {
+    this->count++;
+  }
+}
+
+bool kalmanCoreHistoryGetMotion(const kalmanCoreHistory_t* this, const uint32_t timestampMs, kalmanCoreHistorySample_t* motion) {
+  float pos[3] = {0.0f, 0.0f, 0.0f};
+  struct quat rotation = qeye();
+
+  // Walk backwards from the newest prediction. The oldest sample only marks the start of the next one, the time its
+  // own motion started is unknown.
+  const kalmanCoreHistorySample_t* later = NULL;
+  for (int i = 1; i <= this->count; i++) {
+    const int index = (this->head + KALMAN_CORE_HISTORY_LENGTH - i) % KALMAN_CORE_HISTORY_LENGTH;
+    const kalmanCoreHistorySample_t* earlier = &this->samples[index];
+
+    if (!isBefore(timestampMs, earlier->timestampMs)) {
+      if (later) {
+        // Only the part of the prediction after timestampMs
+        const uint32_t span = later->timestampMs - earlier->timestampMs;
+        if (span > 0) {
+          addMotion(later, (float)(later->timestampMs - timestampMs) / (float)span, pos, &rotation);
+        }
+      }
+
+      motion->timestampMs = timestampMs;
+      for (int j = 0; j < 3; j++) {
+        motion->pos[j] = pos[j];
+      }
+      motion->q[0] = rotation.w;
+      motion->q[1] = rotation.x;
+      motion->q[2] = rotation.y;
+      motion->q[3] = rotation.z;
+      return true;
+    }
+
+    if (later) {
+      addMotion(later, 1.0f, pos, &rotation);
+    }
+    later = earlier;
+  }
+
+  return false;
+}
+
+void kalmanCoreHistoryShiftPosition(const kalmanCoreHistorySample_t* motion, float pos[3]) {
+  pos[0] += motion->pos[0];
+  pos[1] += motion->pos[1];
+  pos[2] += motion->pos[2];
+}
+
+void kalmanCoreHistoryShiftAttitude(const kalmanCoreHistorySample_t* motion, quaternion_t* quat) {
+  const struct quat qMeasured = mkquat(quat->x, quat->y, quat->z, quat->w);
+
+  // The rotation of the estimate since the measurement was taken, applied to the measurement
+  const struct quat q = qnormalize(qqmul(toQuat(motion->q), qMeasured));
+  quat->x = q.x;
+  quat->y = q.y;
+  quat->z = q.z;
+  quat->w = q.w;
+}
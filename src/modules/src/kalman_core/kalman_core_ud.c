@@ -0,0 +1,219 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * kalman_core_ud.c - UD factorized covariance for the kalman core
+ */
+
+#include "kalman_core_ud.h"
+
+#include <string.h>
+
+#define N KC_COVARIANCE_DIM
+#define B KC_COVARIANCE_BLOCK
+
+// First row of the attitude error block in the state
+#define ATT (2 * B)
+
+bool kalmanCoreUdFactor(const float P[N][N], float U[N][N], float D[N]) {
+  bool result = true;
+
+  memset(U, 0, sizeof(float) * N * N);
+  for (int j = N - 1; j >= 0; j--) {
+    float d = P[j][j];
+    for (int k = j + 1; k < N; k++) {
+      d -= D[k] * U[j][k] * U[j][k];
+    }
+    U[j][j] = 1.0f;
+
+    if (d <= 0.0f) {
+      D[j] = 0.0f;
+      result = false;
+      continue;
+    }
+    D[j] = d;
+
+    for (int i = 0; i < j; i++) {
+      float p = P[i][j];
+      for (int k = j + 1; k < N; k++) {
+        p -= D[k] * U[i][k] * U[j][k];
+      }
+      U[i][j] = p / d;
+    }
+  }
+
+  return result;
+}
+
+void kalmanCoreUdToCovariance(const float U[N][N], const float D[N], float P[N][N]) {
+  for (int j = 0; j < N; j++) {
+    for (int i = 0; i <= j; i++) {
+      // U[j][k] is zero for k < j and one for k == j
+      float p = U[i][j] * D[j];
+      for (int k = j + 1; k < N; k++) {
+        p += U[i][k] * D[k] * U[j][k];
+      }
+      P[i][j] = p;
+      P[j][i] = p;
+    }
+  }
+}
+
+void kalmanCoreUdScalarUpdate(float U[N][N], float D[N], const float h[N], const float R, float K[N]) {
+  // f = U' * h, v = D * f
+  float f[N];
+  float v[N];
+  for (int j = 0; j < N; j++) {
+    f[j] = h[j];
+    for (int i = 0; i < j; i++) {
+      f[j] += U[i][j] * h[i];
+    }
+    v[j] = D[j] * f[j];
+  }
+
+  // K accumulates the unscaled gain, U * v for the processed columns
+  float alpha = R;
+  for (int j = 0; j < N; j++) {
+    const float alphaPrevious = alpha;
+    alpha += f[j] * v[j];
+    D[j] *= alphaPrevious / alpha;
+
+    const float lambda = -f[j] / alphaPrevious;
+    for (int i = 0; i < j; i++) {
+      const float u = U[i][j];
+      U[i][j] = u + K[i] * lambda;
+      K[i] += u * v[j];
+    }
+    K[j] = v[j];
+  }
+
+  for (int i = 0; i < N; i++) {
+    K[i] /= alpha;
+  }
+}
+
+// Modified weighted Gram-Schmidt orthogonalization. Finds U and D such that U * diag(D) * U' = W * diag(Dw) * W'.
+// The rows of W are destroyed.
+static void thornton(float W[N][N], const float Dw[N], float U[N][N], float D[N]) {
+  memset(U, 0, sizeof(float) * N * N);
+  for (int j = N - 1; j >= 0; j--) {
+    float c[N];
+    float d = 0.0f;
+    for (int k = 0; k < N; k++) {
+      c[k] = Dw[k] * W[j][k];
+      d += W[j][k] * c[k];
+    }
+    U[j][j] = 1.0f;
+
+    if (d <= 0.0f) {
+      // The row is in the span of the already processed rows (rounding errors), the variance is zero
+      D[j] = 0.0f;
+      continue;
+    }
+    D[j] = d;
+
+    for (int i = 0; i < j; i++) {
+      float u = 0.0f;
+      for (int k = 0; k < N; k++) {
+        u += W[i][k] * c[k];
+      }
+      u /= d;
+      U[i][j] = u;
+
+      for (int k = 0; k < N; k++) {
+        W[i][k] -= u * W[j][k];
+      }
+    }
+  }
+}
+
+// W[row..row+2][:] += block * U[col..col+2][:]. Row col + k of U is zero before column col + k.
+static void blockRowsMultAdd(float W[N][N], const int row, const float block[B][B], float U[N][N], const int col) {
+  for (int i = 0; i < B; i++) {
+    for (int k = 0; k < B; k++) {
+      const float a = block[i][k];
+      for (int j = col + k; j < N; j++) {
+        W[row + i][j] += a * U[col + k][j];
+      }
+    }
+  }
+}
+
+void kalmanCoreUdPredict(float U[N][N], float D[N], const kalmanCoreJacobian_t* A) {
+  // W = A * U, the position rows of A start with an identity block
+  float W[N][N];
+  memcpy(W, U, B * sizeof(W[0]));
+  memset(W[B], 0, (N - B) * sizeof(W[0]));
+
+  blockRowsMultAdd(W, 0, A->posVel, U, B);
+  blockRowsMultAdd(W, 0, A->posAtt, U, ATT);
+  blockRowsMultAdd(W, B, A->velVel, U, B);
+  blockRowsMultAdd(W, B, A->velAtt, U, ATT);
+  blockRowsMultAdd(W, ATT, A->attAtt, U, ATT);
+
+  float Dw[N];
+  memcpy(Dw, D, sizeof(Dw));
+  thornton(W, Dw, U, D);
+}
+
+void kalmanCoreUdRotateAttitude(float U[N][N], float D[N], const float attAtt[B][B]) {
+  float W[N][N];
+  memcpy(W, U, ATT * sizeof(W[0]));
+  memset(W[ATT], 0, B * sizeof(W[0]));
+
+  blockRowsMultAdd(W, ATT, attAtt, U, ATT);
+
+  float Dw[N];
+  memcpy(Dw, D, sizeof(Dw));
+  thornton(W, Dw, U, D);
+}
+
+void kalmanCoreUdAddDiagonal(float U[N][N], float D[N], const float q[N]) {
+  for (int m = 0; m < N; m++) {
+    if (q[m] <= 0.0f) {
+      continue;
+    }
+
+    // Agee-Turner rank one update with v = e_m, the columns after m are not affected
+    float v[N];
+    memset(v, 0, sizeof(v));
+    v[m] = 1.0f;
+    float c = q[m];
+
+    for (int j = m; j >= 0 && c > 0.0f; j--) {
+      const float s = v[j];
+      const float d = D[j] + c * s * s;
+      if (d <= 0.0f) {
+        continue;
+      }
+
+      const float b = c * s / d;
+      c *= D[j] / d;
+      D[j] = d;
+
+      for (int i = 0; i < j; i++) {
+        v[i] -= s * U[i][j];
+        U[i][j] += b * v[i];
+      }
+    }
+  }
+}
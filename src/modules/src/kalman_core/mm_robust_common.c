@@ -0,0 +1,138 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * mm_robust_common.c - Shared covariance handling of the robust M-estimation measurement models
+ */
+
+#include "mm_robust_common.h"
+
+#include <math.h>
+
+#define N KC_COVARIANCE_DIM
+
+// Bounds of the elements of the Cholesky factor, for numerical stability
+#define UPPER_BOUND (100)
+#define LOWER_BOUND (-100)
+
+// Added to the diagonal of the Cholesky factor to avoid divisions by zero in the substitution
+#define DIAGONAL_EPS (1e-9f)
+
+void robustCovarianceInit(robustCovariance_t* this, const float P[N][N]) {
+  // Cholesky decomposition, P = L * L'
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j <= i; j++) {
+      float sum = 0.0f;
+      for (int k = 0; k < j; k++) {
+        sum += this->L[i][k] * this->L[j][k];
+      }
+
+      if (j == i) {
+        this->L[i][i] = sqrtf(P[i][i] - sum);
+      } else {
+        this->L[i][j] = (P[i][j] - sum) / this->L[j][j];
+      }
+    }
+
+    for (int j = i + 1; j < N; j++) {
+      this->L[i][j] = 0.0f;
+    }
+  }
+
+  // Make sure the factor is numerically stable
+  for (int col = 0; col < N; col++) {
+    for (int row = col; row < N; row++) {
+      if (isnan(this->L[row][col]) || this->L[row][col] > UPPER_BOUND) {
+        this->L[row][col] = UPPER_BOUND;
+      } else if (row != col && this->L[row][col] < LOWER_BOUND) {
+        this->L[row][col] = LOWER_BOUND;
+      } else if (row == col && this->L[row][col] < 0.0f) {
+        this->L[row][col] = 0.0f;
+      }
+    }
+    this->L[col][col] += DIAGONAL_EPS;
+    this->scale[col] = 1.0f;
+  }
+}
+
+void robustCovarianceReweight(robustCovariance_t* this, const float xErr[N], const float sigma) {
+  // Solve L * y = xErr, the normalized error is inv(diag(scale)) * y
+  float y[N];
+  for (int i = 0; i < N; i++) {
+    float sum = xErr[i];
+    for (int k = 0; k < i; k++) {
+      sum -= this->L[i][k] * y[k];
+    }
+    y[i] = sum / this->L[i][i];
+  }
+
+  // The weighted covariance is L * diag(scale) * inv(W) * diag(scale) * L'
+  for (int i = 0; i < N; i++) {
+    const float w = robustWeightGM(y[i] / this->scale[i], sigma);
+    this->scale[i] *= sqrtf(1.0f / w);
+  }
+}
+
+void robustCovarianceGain(const robustCovariance_t* this, const float h[N], const float R, float K[N]) {
+  // u = diag(scale)^2 * L' * h
+  float u[N];
+  for (int k = 0; k < N; k++) {
+    float sum = 0.0f;
+    for (int i = k; i < N; i++) {
+      sum += this->L[i][k] * h[i];
+    }
+    u[k] = sum * this->scale[k] * this->scale[k];
+  }
+
+  // K = L * u / (h' * L * u + R)
+  float HPHR = R;
+  for (int i = 0; i < N; i++) {
+    float sum = 0.0f;
+    for (int k = 0; k <= i; k++) {
+      sum += this->L[i][k] * u[k];
+    }
+    K[i] = sum;
+    HPHR += h[i] * sum;
+  }
+
+  for (int i = 0; i < N; i++) {
+    K[i] /= HPHR;
+  }
+}
+
+void robustCovarianceGet(const robustCovariance_t* this, float P[N][N]) {
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j <= i; j++) {
+      float sum = 0.0f;
+      for (int k = 0; k <= j; k++) {
+        sum += this->L[i][k] * this->scale[k] * this->scale[k] * this->L[j][k];
+      }
+      P[i][j] = sum;
+      P[j][i] = sum;
+    }
+  }
+}
+
+float robustWeightGM(const float e, const float sigma) {
+  const float GM_dn = sigma + e * e;
+  return (sigma * sigma) / (GM_dn * GM_dn);
+}
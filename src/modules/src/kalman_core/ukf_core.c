@@ -0,0 +1,455 @@
+/**
+ *                                             __
+ *    __  __ ____      ____  __  __ __________/ /_  __   _____________
+ *   / /_/ / ___/____ / __ `/ / / /´__  / ___/ __ \/ /  / / ___/ __  /
+ *  / __  (__  )/___// /_/ / /_/ / /_/ (__  ) /_/ / /__/ / /  / /_/ /
+ * /_/ /_/____/      \__,_/_____/\__  /____/\____/______/_/   \__  /
+ *                              /____/                       /____/
+ * Crazyflie Project
+ *
+ * Copyright (C) 2019-2022 University of Applied Sciences Augsburg
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * ============================================================================
+ * Error-State Unscented Kalman Filter - math core
+ * ============================================================================
+ *
+ * The square root formulation follows:
+ *
+ * \verbatim
+      @INPROCEEDINGS{940586,
+      author={Van der Merwe, R. and Wan, E.A.},
+      booktitle={2001 IEEE International Conference on Acoustics, Speech, and Signal Processing (ICASSP)},
+      title={The square-root unscented Kalman filter for state and parameter-estimation},
+      year={2001},
+      volume={6},
+      pages={3461-3464},
+      doi={10.1109/ICASSP.2001.940586}}
+ * \endverbatim
+ *
+ * ============================================================================
+ */
+
+#include "ukf_core.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "static_mem.h"
+
+// Rows of the compound matrix that is triangularized in the square root prediction:
+// all sigma point deviations except the center one, and the square root of the process noise
+#define COMPOUND_ROWS (UKF_CORE_SIGMA_POINTS - 1 + UKF_CORE_DIM)
+
+void ukfCoreInit(ukfCoreData_t* this, const float stdDevInitial[UKF_CORE_DIM], const float weight0, const bool squareRoot)
+{
+  memset(this, 0, sizeof(ukfCoreData_t));
+  this->squareRoot = squareRoot;
+
+  for (int ii = 0; ii < UKF_CORE_DIM; ii++)
+  {
+    this->P[ii][ii] = stdDevInitial[ii] * stdDevInitial[ii];
+    this->S[ii][ii] = stdDevInitial[ii];
+  }
+
+  // compute template sigma points normalized to mean 0 and covariance I
+  const float weight1 = (1.0f - weight0) / ((float)UKF_CORE_DIM + 1.0f);
+  this->weights[0] = weight0;
+  for (int jj = 1; jj < UKF_CORE_SIGMA_POINTS; jj++)
+  {
+    this->weights[jj] = weight1;
+  }
+
+  for (int ii = 0; ii < UKF_CORE_DIM; ii++)
+  {
+    const float tmp = 1.0f / sqrtf(((float)ii + 1.0f) * ((float)ii + 2.0f) * weight1);
+    for (int jj = 1; jj < (ii + 2); jj++)
+    {
+      this->sigmaPointsTempl[jj][ii] = -tmp;
+    }
+    this->sigmaPointsTempl[ii + 2][ii] = tmp * ((float)ii + 1.0f);
+  }
+
+  ukfCoreComputeSigmaPoints(this);
+}
+
+void ukfCoreComputeSigmaPoints(ukfCoreData_t* this)
+{
+  if (!this->squareRoot)
+  {
+    ukfCoreCholesky(&this->P[0][0], &this->S[0][0], UKF_CORE_DIM);
+  }
+
+  // S is lower triangular, only the lower part contributes
+  for (int jj = 0; jj < UKF_CORE_SIGMA_POINTS; jj++)
+  {
+    for (int ii = 0; ii < UKF_CORE_DIM; ii++)
+    {
+      float sum = this->x[ii];
+      for (int kk = 0; kk <= ii; kk++)
+      {
+        sum += this->S[ii][kk] * this->sigmaPointsTempl[jj][kk];
+      }
+      this->sigmaPoints[jj][ii] = sum;
+    }
+  }
+}
+
+// Weighted covariance of the sigma points around the mean, plus process noise
+static void covarianceFromSigmaPoints(const ukfCoreData_t* this, const float mean[UKF_CORE_DIM], float Q[UKF_CORE_DIM][UKF_CORE_DIM], float P[UKF_CORE_DIM][UKF_CORE_DIM])
+{
+  NO_DMA_CCM_SAFE_ZERO_INIT static float dev[UKF_CORE_SIGMA_POINTS][UKF_CORE_DIM];
+
+  for (int jj = 0; jj < UKF_CORE_SIGMA_POINTS; jj++)
+  {
+    for (int ii = 0; ii < UKF_CORE_DIM; ii++)
+    {
+      dev[jj][ii] = this->sigmaPoints[jj][ii] - mean[ii];
+    }
+  }
+
+  for (int ii = 0; ii < UKF_CORE_DIM; ii++)
+  {
+    for (int kk = ii; kk < UKF_CORE_DIM; kk++)
+    {
+      float sum = 0.0f;
+      for (int jj = 0; jj < UKF_CORE_SIGMA_POINTS; jj++)
+      {
+        sum += this->weights[jj] * dev[jj][ii] * dev[jj][kk];
+      }
+      const float value = sum + 0.5f * (Q[ii][kk] + Q[kk][ii]);
+      P[ii][kk] = value;
+      P[kk][ii] = value;
+    }
+  }
+}
+
+// Householder triangularization of a rows x cols matrix (rows >= cols), in place. The
+// upper triangular R ends up in the first cols rows, with a non-negative diagonal.
+static void triangularize(float* M, const uint8_t rows, const uint8_t cols)
+{
+  for (int kk = 0; kk < cols; kk++)
+  {
+    float norm2 = 0.0f;
+    for (int ii = kk; ii < rows; ii++)
+    {
+      norm2 += M[ii * cols + kk] * M[ii * cols + kk];
+    }
+    if (norm2 <= 0.0f)
+    {
+      continue;
+    }
+
+    const float diag = M[kk * cols + kk];
+    const float alpha = (diag > 0.0f) ? -sqrtf(norm2) : sqrtf(norm2);
+
+    // Householder vector v = M[kk:, kk] - alpha * e1, stored in place of the column
+    M[kk * cols + kk] = diag - alpha;
+    const float vNorm2 = norm2 - diag * diag + (diag - alpha) * (diag - alpha);
+
+    for (int jj = kk + 1; jj < cols; jj++)
+    {
+      float dot = 0.0f;
+      for (int ii = kk; ii < rows; ii++)
+      {
+        dot += M[ii * cols + kk] * M[ii * cols + jj];
+      }
+      const float f = 2.0f * dot / vNorm2;
+      for (int ii = kk; ii < rows; ii++)
+      {
+        M[ii * cols + jj] -= f * M[ii * cols + kk];
+      }
+    }
+
+    M[kk * cols + kk] = alpha;
+    for (int ii = kk + 1; ii < rows; ii++)
+    {
+      M[ii * cols + kk] = 0.0f;
+    }
+  }
+
+  // Flip the sign of rows with a negative diagonal, R' * R is not affected
+  for (int kk = 0; kk < cols; kk++)
+  {
+    if (M[kk * cols + kk] < 0.0f)
+    {
+      for (int jj = kk; jj < cols; jj++)
+      {
+        M[kk * cols + jj] = -M[kk * cols + jj];
+      }
+    }
+  }
+}
+
+static void predictSquareRoot(ukfCoreData_t* this, const float mean[UKF_CORE_DIM], float Q[UKF_CORE_DIM][UKF_CORE_DIM], float sqrtQ[UKF_CORE_DIM][UKF_CORE_DIM])
+{
+  NO_DMA_CCM_SAFE_ZERO_INIT static float compound[COMPOUND_ROWS][UKF_CORE_DIM];
+  float dev0[UKF_CORE_DIM];
+
+  // The compound matrix A' with A * A' = sum(w * dev * dev') + Q, center point excluded
+  const float sqrtWeight1 = sqrtf(this->weights[1]);
+  for (int jj = 1; jj < UKF_CORE_SIGMA_POINTS; jj++)
+  {
+    for (int ii = 0; ii < UKF_CORE_DIM; ii++)
+    {
+      compound[jj - 1][ii] = sqrtWeight1 * (this->sigmaPoints[jj][ii] - mean[ii]);
+    }
+  }
+  for (int kk = 0; kk < UKF_CORE_DIM; kk++)
+  {
+    for (int ii = 0; ii < UKF_CORE_DIM; ii++)
+    {
+      compound[UKF_CORE_SIGMA_POINTS - 1 + kk][ii] = sqrtQ[ii][kk];
+    }
+  }
+
+  // A' = Q * R gives A * A' = R' * R, that is S = R'
+  triangularize(&compound[0][0], COMPOUND_ROWS, UKF_CORE_DIM);
+  for (int ii = 0; ii < UKF_CORE_DIM; ii++)
+  {
+    for (int kk = 0; kk < UKF_CORE_DIM; kk++)
+    {
+      this->S[ii][kk] = (kk <= ii) ? compound[kk][ii] : 0.0f;
+    }
+  }
+
+  // Add the center point, it has a different weight that may be negative
+  const float weight0 = this->weights[0];
+  const float sqrtWeight0 = sqrtf(fabsf(weight0));
+  for (int ii = 0; ii < UKF_CORE_DIM; ii++)
+  {
+    dev0[ii] = sqrtWeight0 * (this->sigmaPoints[0][ii] - mean[ii]);
+  }
+  if (!ukfCoreCholeskyUpdate(&this->S[0][0], dev0, UKF_CORE_DIM, weight0 < 0.0f))
+  {
+    float P[UKF_CORE_DIM][UKF_CORE_DIM];
+    covarianceFromSigmaPoints(this, mean, Q, P);
+    ukfCoreCholesky(&P[0][0], &this->S[0][0], UKF_CORE_DIM);
+    this->downdateFailures++;
+  }
+}
+
+void ukfCorePredict(ukfCoreData_t* this, float F[UKF_CORE_DIM][UKF_CORE_DIM], float Q[UKF_CORE_DIM][UKF_CORE_DIM], float sqrtQ[UKF_CORE_DIM][UKF_CORE_DIM])
+{
+  float mean[UKF_CORE_DIM];
+  float point[UKF_CORE_DIM];
+
+  // Propagate the sigma points, the transition is linear so the mean is propagated the same way
+  for (int jj = 0; jj < UKF_CORE_SIGMA_POINTS; jj++)
+  {
+    memcpy(point, this->sigmaPoints[jj], sizeof(point));
+    for (int ii = 0; ii < UKF_CORE_DIM; ii++)
+    {
+      float sum = 0.0f;
+      for (int kk = 0; kk < UKF_CORE_DIM; kk++)
+      {
+        sum += F[ii][kk] * point[kk];
+      }
+      this->sigmaPoints[jj][ii] = sum;
+    }
+  }
+
+  for (int ii = 0; ii < UKF_CORE_DIM; ii++)
+  {
+    float sum = 0.0f;
+    for (int kk = 0; kk < UKF_CORE_DIM; kk++)
+    {
+      sum += F[ii][kk] * this->x[kk];
+    }
+    mean[ii] = sum;
+  }
+
+  if (this->squareRoot)
+  {
+    predictSquareRoot(this, mean, Q, sqrtQ);
+  }
+  else
+  {
+    covarianceFromSigmaPoints(this, mean, Q, this->P);
+  }
+
+  memcpy(this->x, mean, sizeof(mean));
+  ukfCoreComputeSigmaPoints(this);
+}
+
+void ukfCoreOutputMoments(const ukfCoreData_t* this, const float outputs[UKF_CORE_SIGMA_POINTS], float* mean, float* Pyy, float Pxy[UKF_CORE_DIM])
+{
+  float observation = 0.0f;
+  for (int jj = 0; jj < UKF_CORE_SIGMA_POINTS; jj++)
+  {
+    observation += this->weights[jj] * outputs[jj];
+  }
+
+  float variance = 0.0f;
+  for (int ii = 0; ii < UKF_CORE_DIM; ii++)
+  {
+    Pxy[ii] = 0.0f;
+  }
+  for (int jj = 0; jj < UKF_CORE_SIGMA_POINTS; jj++)
+  {
+    const float weightedDev = this->weights[jj] * (outputs[jj] - observation);
+    variance += weightedDev * (outputs[jj] - observation);
+    for (int ii = 0; ii < UKF_CORE_DIM; ii++)
+    {
+      Pxy[ii] += weightedDev * (this->sigmaPoints[jj][ii] - this->x[ii]);
+    }
+  }
+
+  *mean = observation;
+  *Pyy = variance;
+}
+
+void ukfCoreScalarUpdate(ukfCoreData_t* this, const float Pxy[UKF_CORE_DIM], const float Pyy, const float innovation)
+{
+  for (int ii = 0; ii < UKF_CORE_DIM; ii++)
+  {
+    this->x[ii] += Pxy[ii] / Pyy * innovation;
+  }
+
+  if (this->squareRoot)
+  {
+    // P - K * Pyy * K' = S * S' - u * u', with u = Pxy / sqrt(Pyy)
+    float Sprev[UKF_CORE_DIM][UKF_CORE_DIM];
+    float u[UKF_CORE_DIM];
+    const float scale = 1.0f / sqrtf(Pyy);
+    for (int ii = 0; ii < UKF_CORE_DIM; ii++)
+    {
+      u[ii] = Pxy[ii] * scale;
+    }
+    memcpy(Sprev, this->S, sizeof(Sprev));
+
+    if (!ukfCoreCholeskyUpdate(&this->S[0][0], u, UKF_CORE_DIM, true))
+    {
+      // The update removed more uncertainty than there was (numerically), fall back to the full covariance
+      float P[UKF_CORE_DIM][UKF_CORE_DIM];
+      memcpy(this->S, Sprev, sizeof(Sprev));
+      ukfCoreGetCovariance(this, P);
+      for (int ii = 0; ii < UKF_CORE_DIM; ii++)
+      {
+        for (int jj = 0; jj < UKF_CORE_DIM; jj++)
+        {
+          P[ii][jj] -= Pxy[ii] * Pxy[jj] / Pyy;
+        }
+      }
+      ukfCoreCholesky(&P[0][0], &this->S[0][0], UKF_CORE_DIM);
+      this->downdateFailures++;
+    }
+  }
+  else
+  {
+    for (int ii = 0; ii < UKF_CORE_DIM; ii++)
+    {
+      for (int jj = ii; jj < UKF_CORE_DIM; jj++)
+      {
+        const float value = 0.5f * (this->P[ii][jj] + this->P[jj][ii]) - Pxy[ii] * Pxy[jj] / Pyy;
+        this->P[ii][jj] = value;
+        this->P[jj][ii] = value;
+      }
+    }
+  }
+}
+
+void ukfCoreGetCovariance(const ukfCoreData_t* this, float P[UKF_CORE_DIM][UKF_CORE_DIM])
+{
+  if (!this->squareRoot)
+  {
+    memcpy(P, this->P, sizeof(this->P));
+    return;
+  }
+
+  for (int ii = 0; ii < UKF_CORE_DIM; ii++)
+  {
+    for (int jj = 0; jj <= ii; jj++)
+    {
+      float sum = 0.0f;
+      for (int kk = 0; kk <= jj; kk++)
+      {
+        sum += this->S[ii][kk] * this->S[jj][kk];
+      }
+      P[ii][jj] = sum;
+      P[jj][ii] = sum;
+    }
+  }
+}
+
+bool ukfCoreCholesky(const float* A, float* L, const uint8_t n)
+{
+  bool isPositiveDefinite = true;
+
+  for (int i = 0; i < n; i++)
+  {
+    for (int j = i + 1; j < n; j++)
+    {
+      L[i * n + j] = 0.0f;
+    }
+
+    for (int j = 0; j < (i + 1); j++)
+    {
+      float s = 0.0f;
+      for (int k = 0; k < j; k++)
+      {
+        s += L[i * n + k] * L[j * n + k];
+      }
+
+      if (i == j)
+      {
+        const float d = A[i * n + i] - s;
+        if (d > 0.0f)
+        {
+          L[i * n + i] = sqrtf(d);
+        }
+        else
+        {
+          // Not positive definite, drop the direction instead of producing NaN
+          L[i * n + i] = 0.0f;
+          isPositiveDefinite = false;
+        }
+      }
+      else
+      {
+        L[i * n + j] = (L[j * n + j] > 0.0f) ? (A[i * n + j] - s) / L[j * n + j] : 0.0f;
+      }
+    }
+  }
+
+  return isPositiveDefinite;
+}
+
+bool ukfCoreCholeskyUpdate(float* L, float* v, const uint8_t n, const bool downdate)
+{
+  const float sign = downdate ? -1.0f : 1.0f;
+
+  for (int k = 0; k < n; k++)
+  {
+    const float lkk = L[k * n + k];
+    const float r2 = lkk * lkk + sign * v[k] * v[k];
+    if (!(lkk > 0.0f) || !(r2 > 0.0f))
+    {
+      return false;
+    }
+
+    const float r = sqrtf(r2);
+    const float c = r / lkk;
+    const float s = v[k] / lkk;
+    L[k * n + k] = r;
+
+    for (int i = k + 1; i < n; i++)
+    {
+      L[i * n + k] = (L[i * n + k] + sign * s * v[i]) / c;
+      v[i] = c * v[i] - s * L[i * n + k];
+    }
+  }
+
+  return true;
+}
@@ -719,6 +719,107 @@ void logBlockTimed(xTimerHandle timer)
   workerSchedule(logRunBlock, pvTimerGetTimerID(timer));
 }
 
+/* A value of any storage type, aligned */
+typedef union {
+  uint8_t u8;
+  int8_t i8;
+  uint16_t u16;
+  int16_t i16;
+  uint32_t u32;
+  int32_t i32;
+  float f;
+} logValue_t;
+
+/*
+ * Copies a variable, or acquires it from its function, to value. Exactly the
+ * size of the storage type is written, value does not have to be aligned.
+ */
+static void acquireValue(const uint8_t storageType, const bool isByFunction, const void* variable,
+                         const uint32_t timestamp, void* value)
+{
+  if (!isByFunction) {
+    memcpy(value, variable, typeLength[storageType]);
+    return;
+  }
+
+  const logByFunction_t* logByFunction = (const logByFunction_t*)variable;
+  switch(storageType)
+  {
+    case LOG_UINT8:
+    {
+      ASSERT_LOG_FUNCTION_INITIALIZED(logByFunction->acquireUInt8);
+      const uint8_t v = logByFunction->acquireUInt8(timestamp, logByFunction->data);
+      memcpy(value, &v, sizeof(v));
+      break;
+    }
+    case LOG_INT8:
+    {
+      ASSERT_LOG_FUNCTION_INITIALIZED(logByFunction->acquireInt8);
+      const int8_t v = logByFunction->acquireInt8(timestamp, logByFunction->data);
+      memcpy(value, &v, sizeof(v));
+      break;
+    }
+    case LOG_UINT16:
+    {
+      ASSERT_LOG_FUNCTION_INITIALIZED(logByFunction->acquireUInt16);
+      const uint16_t v = logByFunction->acquireUInt16(timestamp, logByFunction->data);
+      memcpy(value, &v, sizeof(v));
+      break;
+    }
+    case LOG_INT16:
+    {
+      ASSERT_LOG_FUNCTION_INITIALIZED(logByFunction->acquireInt16);
+      const int16_t v = logByFunction->acquireInt16(timestamp, logByFunction->data);
+      memcpy(value, &v, sizeof(v));
+      break;
+    }
+    case LOG_UINT32:
+    {
+      ASSERT_LOG_FUNCTION_INITIALIZED(logByFunction->acquireUInt32);
+      const uint32_t v = logByFunction->acquireUInt32(timestamp, logByFunction->data);
+      memcpy(value, &v, sizeof(v));
+      break;
+    }
+    case LOG_INT32:
+    {
+      ASSERT_LOG_FUNCTION_INITIALIZED(logByFunction->acquireInt32);
+      const int32_t v = logByFunction->acquireInt32(timestamp, logByFunction->data);
+      memcpy(value, &v, sizeof(v));
+      break;
+    }
+    case LOG_FLOAT:
+    {
+      ASSERT_LOG_FUNCTION_INITIALIZED(logByFunction->aquireFloat);
+      const float v = logByFunction->aquireFloat(timestamp, logByFunction->data);
+      memcpy(value, &v, sizeof(v));
+      break;
+    }
+  }
+}
+
+static int valueToInt(const uint8_t storageType, const logValue_t* value)
+{
+  switch(storageType)
+  {
+    case LOG_UINT8:
+      return value->u8;
+    case LOG_INT8:
+      return value->i8;
+    case LOG_UINT16:
+      return value->u16;
+    case LOG_INT16:
+      return value->i16;
+    case LOG_UINT32:
+      return value->u32;
+    case LOG_INT32:
+      return value->i32;
+    case LOG_FLOAT:
+      return value->f;
+  }
+
+  return 0;
+}
+
 /* Appends data to a packet if space is available; returns false on failure. */
 static bool appendToPacket(CRTPPacket * pk, const void * data, size_t n) {
   if (pk->size <= CRTP_MAX_DATA_SIZE - n)
@@ -751,114 +852,15 @@ void logRunBlock(void * arg)
 
   while (ops)
   {
-    int valuei = 0;
-    float valuef = 0;
-
     // FPU instructions must run on aligned data.
-    // We first copy the data to an (aligned) local variable, before assigning it
-    switch(ops->storageType)
-    {
-      case LOG_UINT8:
-      {
-        uint8_t v;
-        if (ops->acquisitionType == acqType_function) {
-          logByFunction_t* logByFunction = (logByFunction_t*)ops->variable;
-          ASSERT_LOG_FUNCTION_INITIALIZED(logByFunction->acquireUInt8);
-          v = logByFunction->acquireUInt8(timestamp, logByFunction->data);
-        } else {
-          memcpy(&v, ops->variable, sizeof(v));
-        }
-        valuei = v;
-        break;
-      }
-      case LOG_INT8:
-      {
-        int8_t v;
-        if (ops->acquisitionType == acqType_function) {
-          logByFunction_t* logByFunction = (logByFunction_t*)ops->variable;
-          ASSERT_LOG_FUNCTION_INITIALIZED(logByFunction->acquireInt8);
-          v = logByFunction->acquireInt8(timestamp, logByFunction->data);
-        } else {
-          memcpy(&v, ops->variable, sizeof(v));
-        }
-        valuei = v;
-        break;
-      }
-      case LOG_UINT16:
-      {
-        uint16_t v;
-        if (ops->acquisitionType == acqType_function) {
-          logByFunction_t* logByFunction = (logByFunction_t*)ops->variable;
-          ASSERT_LOG_FUNCTION_INITIALIZED(logByFunction->acquireUInt16);
-          v = logByFunction->acquireUInt16(timestamp, logByFunction->data);
-        } else {
-          memcpy(&v, ops->variable, sizeof(v));
-        }
-        valuei = v;
-        break;
-      }
-      case LOG_INT16:
-      {
-        int16_t v;
-        if (ops->acquisitionType == acqType_function) {
-          logByFunction_t* logByFunction = (logByFunction_t*)ops->variable;
-          ASSERT_LOG_FUNCTION_INITIALIZED(logByFunction->acquireInt16);
-          v = logByFunction->acquireInt16(timestamp, logByFunction->data);
-        } else {
-          memcpy(&v, ops->variable, sizeof(v));
-        }
-        valuei = v;
-        break;
-      }
-      case LOG_UINT32:
-      {
-        uint32_t v;
-        if (ops->acquisitionType == acqType_function) {
-          logByFunction_t* logByFunction = (logByFunction_t*)ops->variable;
-          ASSERT_LOG_FUNCTION_INITIALIZED(logByFunction->acquireUInt32);
-          v = logByFunction->acquireUInt32(timestamp, logByFunction->data);
-        } else {
-          memcpy(&v, ops->variable, sizeof(v));
-        }
-        valuei = v;
-        break;
-      }
-      case LOG_INT32:
-      {
-        int32_t v;
-        if (ops->acquisitionType == acqType_function) {
-          logByFunction_t* logByFunction = (logByFunction_t*)ops->variable;
-          ASSERT_LOG_FUNCTION_INITIALIZED(logByFunction->acquireInt32);
-          v = logByFunction->acquireInt32(timestamp, logByFunction->data);
-        } else {
-          memcpy(&v, ops->variable, sizeof(v));
-        }
-        valuei = v;
-        break;
-      }
-      case LOG_FLOAT:
-      {
-        float v;
-        if (ops->acquisitionType == acqType_function) {
-          logByFunction_t* logByFunction = (logByFunction_t*)ops->variable;
-          ASSERT_LOG_FUNCTION_INITIALIZED(logByFunction->aquireFloat);
-          v = logByFunction->aquireFloat(timestamp, logByFunction->data);
-        } else {
-          memcpy(&v, ops->variable, sizeof(valuef));
-        }
-        valuei = v;
-        valuef = v;
-        break;
-      }
-    }
+    // We first copy the data to an (aligned) local variable, before converting it
+    logValue_t value;
+    acquireValue(ops->storageType, ops->acquisitionType == acqType_function, ops->variable, timestamp, &value);
+    int valuei = valueToInt(ops->storageType, &value);
+    float valuef = (ops->storageType == LOG_FLOAT) ? value.f : valuei;
 
     if (ops->logType == LOG_FLOAT || ops->logType == LOG_FP16)
     {
-      if (ops->storageType != LOG_FLOAT)
-      {
-        valuef = valuei;
-      }
-
       // Try to append the next item to the packet.  If we run out of space,
       // drop this and subsequent items.
       if (ops->logType == LOG_FLOAT)
@@ -1052,46 +1054,33 @@ uint8_t logVarSize(int type)
   return typeLength[type];
 }
 
-int logGetInt(logVarId_t varid)
+void logGetValue(logVarId_t varid, void* value)
 {
-  int valuei = 0;
+  ASSERT(logVarIdIsValid(varid));
 
+  const uint32_t timestamp = ((long long)xTaskGetTickCount())/portTICK_RATE_MS;
+  acquireValue(logGetType(varid), logs[varid].type & LOG_BY_FUNCTION, logs[varid].address, timestamp, value);
+}
+
+int logGetInt(logVarId_t varid)
+{
   ASSERT(logVarIdIsValid(varid));
 
-  switch(logGetType(varid))
-  {
-    case LOG_UINT8:
-      valuei = *(uint8_t *)logs[varid].address;
-      break;
-    case LOG_INT8:
-      valuei = *(int8_t *)logs[varid].address;
-      break;
-    case LOG_UINT16:
-      valuei = *(uint16_t *)logs[varid].address;
-      break;
-    case LOG_INT16:
-      valuei = *(int16_t *)logs[varid].address;
-      break;
-    case LOG_UINT32:
-      valuei = *(uint32_t *)logs[varid].address;
-      break;
-    case LOG_INT32:
-      valuei = *(int32_t *)logs[varid].address;
-      break;
-    case LOG_FLOAT:
-      valuei = *(float *)logs[varid].address;
-      break;
-  }
+  logValue_t value;
+  logGetValue(varid, &value);
 
-  return valuei;
+  return valueToInt(logGetType(varid), &value);
 }
 
 float logGetFloat(logVarId_t varid)
 {
   ASSERT(logVarIdIsValid(varid));
 
-  if (logGetType(varid) == LOG_FLOAT)
-    return *(float *)logs[varid].address;
+  if (logGetType(varid) == LOG_FLOAT) {
+    float value;
+    logGetValue(varid, &value);
+    return value;
+  }
 
   return logGetInt(varid);
 }
@@ -26,6 +26,9 @@
 
 #include "mem.h"
 
+#include "FreeRTOS.h"
+#include "task.h"
+
 #include "cfassert.h"
 #include "debug.h"
 #include "log.h"
@@ -90,7 +93,9 @@ void memReset() {
 }
 #endif
 
+// Handlers are registered by the decks and the system modules, that may be initialized in parallel
 void memoryRegisterHandler(const MemoryHandlerDef_t* handlerDef){
+  taskENTER_CRITICAL();
   for (int i = 0; i < nrOfHandlers; i++) {
     ASSERT(handlerDef->type != handlers[i]->type);
   }
@@ -98,14 +103,17 @@ void memoryRegisterHandler(const MemoryHandlerDef_t* handlerDef){
   ASSERT(registrationEnabled);
   handlers[nrOfHandlers] = handlerDef;
   nrOfHandlers++;
+  taskEXIT_CRITICAL();
 }
 
 void memoryRegisterOwHandler(const MemoryOwHandlerDef_t* handlerDef){
+  taskENTER_CRITICAL();
   ASSERT(owMemHandler == 0);
   ASSERT(registrationEnabled);
   owMemHandler = handlerDef;
 
   nrOfOwMems = handlerDef->nrOfMems;
+  taskEXIT_CRITICAL();
 }
 
 void memBlockHandlerRegistration() {
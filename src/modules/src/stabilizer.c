@@ -53,9 +53,11 @@
 #include "estimator.h"
 #include "usddeck.h"
 #include "quatcompress.h"
+#include "state_stream.h"
 #include "statsCnt.h"
 #include "static_mem.h"
 #include "rateSupervisor.h"
+#include "event_trace.h"
 
 static bool isInit;
 
@@ -82,42 +84,6 @@ static rateSupervisor_t rateSupervisorContext;
 static bool rateWarningDisplayed = false;
 SemaphoreHandle_t xRateSupervisorSemaphore;
 
-static struct {
-  // position - mm
-  int16_t x;
-  int16_t y;
-  int16_t z;
-  // velocity - mm / sec
-  int16_t vx;
-  int16_t vy;
-  int16_t vz;
-  // acceleration - mm / sec^2
-  int16_t ax;
-  int16_t ay;
-  int16_t az;
-  // compressed quaternion, see quatcompress.h
-  int32_t quat;
-  // angular velocity - milliradians / sec
-  int16_t rateRoll;
-  int16_t ratePitch;
-  int16_t rateYaw;
-} stateCompressed;
-
-static struct {
-  // position - mm
-  int16_t x;
-  int16_t y;
-  int16_t z;
-  // velocity - mm / sec
-  int16_t vx;
-  int16_t vy;
-  int16_t vz;
-  // acceleration - mm / sec^2
-  int16_t ax;
-  int16_t ay;
-  int16_t az;
-} setpointCompressed;
-
 STATIC_MEM_TASK_ALLOC(stabilizerTask, STABILIZER_TASK_STACKSIZE);
 STATIC_MEM_TASK_ALLOC(rateSupervisorTask, RATE_SUPERVISOR_TASK_STACKSIZE);
 
@@ -130,48 +96,68 @@ static void calcSensorToOutputLatency(const sensorData_t *sensorData)
   inToOutLatency = outTimestamp - sensorData->interruptTimestamp;
 }
 
-static void compressState()
+// The compressed log formats are computed when they are logged, not in every stabilizer loop
+static int16_t logMilli(uint32_t timestamp, void* data)
 {
-  stateCompressed.x = state.position.x * 1000.0f;
-  stateCompressed.y = state.position.y * 1000.0f;
-  stateCompressed.z = state.position.z * 1000.0f;
+  return *(float*)data * 1000.0f;
+}
 
-  stateCompressed.vx = state.velocity.x * 1000.0f;
-  stateCompressed.vy = state.velocity.y * 1000.0f;
-  stateCompressed.vz = state.velocity.z * 1000.0f;
+static int16_t logAccMilli(uint32_t timestamp, void* data)
+{
+  return *(float*)data * 9.81f * 1000.0f;
+}
 
-  stateCompressed.ax = state.acc.x * 9.81f * 1000.0f;
-  stateCompressed.ay = state.acc.y * 9.81f * 1000.0f;
-  stateCompressed.az = (state.acc.z + 1) * 9.81f * 1000.0f;
+static int16_t logAccZMilli(uint32_t timestamp, void* data)
+{
+  return (*(float*)data + 1) * 9.81f * 1000.0f;
+}
 
+static uint32_t logQuatCompressed(uint32_t timestamp, void* data)
+{
+  const quaternion_t* quaternion = data;
   float const q[4] = {
-    state.attitudeQuaternion.x,
-    state.attitudeQuaternion.y,
-    state.attitudeQuaternion.z,
-    state.attitudeQuaternion.w};
-  stateCompressed.quat = quatcompress(q);
+    quaternion->x,
+    quaternion->y,
+    quaternion->z,
+    quaternion->w};
+  return quatcompress(q);
+}
 
+static int16_t logRateMilliRad(uint32_t timestamp, void* data)
+{
   float const deg2millirad = ((float)M_PI * 1000.0f) / 180.0f;
-  stateCompressed.rateRoll = sensorData.gyro.x * deg2millirad;
-  stateCompressed.ratePitch = -sensorData.gyro.y * deg2millirad;
-  stateCompressed.rateYaw = sensorData.gyro.z * deg2millirad;
+  return *(float*)data * deg2millirad;
 }
 
-static void compressSetpoint()
+static int16_t logNegatedRateMilliRad(uint32_t timestamp, void* data)
 {
-  setpointCompressed.x = setpoint.position.x * 1000.0f;
-  setpointCompressed.y = setpoint.position.y * 1000.0f;
-  setpointCompressed.z = setpoint.position.z * 1000.0f;
-
-  setpointCompressed.vx = setpoint.velocity.x * 1000.0f;
-  setpointCompressed.vy = setpoint.velocity.y * 1000.0f;
-  setpointCompressed.vz = setpoint.velocity.z * 1000.0f;
-
-  setpointCompressed.ax = setpoint.acceleration.x * 1000.0f;
-  setpointCompressed.ay = setpoint.acceleration.y * 1000.0f;
-  setpointCompressed.az = setpoint.acceleration.z * 1000.0f;
+  return -logRateMilliRad(timestamp, data);
 }
 
+static logByFunction_t stateXLogger = {.acquireInt16 = logMilli, .data = &state.position.x};
+static logByFunction_t stateYLogger = {.acquireInt16 = logMilli, .data = &state.position.y};
+static logByFunction_t stateZLogger = {.acquireInt16 = logMilli, .data = &state.position.z};
+static logByFunction_t stateVxLogger = {.acquireInt16 = logMilli, .data = &state.velocity.x};
+static logByFunction_t stateVyLogger = {.acquireInt16 = logMilli, .data = &state.velocity.y};
+static logByFunction_t stateVzLogger = {.acquireInt16 = logMilli, .data = &state.velocity.z};
+static logByFunction_t stateAxLogger = {.acquireInt16 = logAccMilli, .data = &state.acc.x};
+static logByFunction_t stateAyLogger = {.acquireInt16 = logAccMilli, .data = &state.acc.y};
+static logByFunction_t stateAzLogger = {.acquireInt16 = logAccZMilli, .data = &state.acc.z};
+static logByFunction_t stateQuatLogger = {.acquireUInt32 = logQuatCompressed, .data = &state.attitudeQuaternion};
+static logByFunction_t rateRollLogger = {.acquireInt16 = logRateMilliRad, .data = &sensorData.gyro.x};
+static logByFunction_t ratePitchLogger = {.acquireInt16 = logNegatedRateMilliRad, .data = &sensorData.gyro.y};
+static logByFunction_t rateYawLogger = {.acquireInt16 = logRateMilliRad, .data = &sensorData.gyro.z};
+
+static logByFunction_t setpointXLogger = {.acquireInt16 = logMilli, .data = &setpoint.position.x};
+static logByFunction_t setpointYLogger = {.acquireInt16 = logMilli, .data = &setpoint.position.y};
+static logByFunction_t setpointZLogger = {.acquireInt16 = logMilli, .data = &setpoint.position.z};
+static logByFunction_t setpointVxLogger = {.acquireInt16 = logMilli, .data = &setpoint.velocity.x};
+static logByFunction_t setpointVyLogger = {.acquireInt16 = logMilli, .data = &setpoint.velocity.y};
+static logByFunction_t setpointVzLogger = {.acquireInt16 = logMilli, .data = &setpoint.velocity.z};
+static logByFunction_t setpointAxLogger = {.acquireInt16 = logMilli, .data = &setpoint.acceleration.x};
+static logByFunction_t setpointAyLogger = {.acquireInt16 = logMilli, .data = &setpoint.acceleration.y};
+static logByFunction_t setpointAzLogger = {.acquireInt16 = logMilli, .data = &setpoint.acceleration.z};
+
 void stabilizerInit(StateEstimatorType estimator)
 {
   if(isInit)
@@ -314,6 +300,7 @@ static void stabilizerTask(void* param)
   while(1) {
     // The sensor should unlock at 1kHz
     sensorsWaitDataReady();
+    EVENT_TRACE_SPAN_BEGIN(EVENT_TRACE_SPAN_STABILIZER);
 
     // update sensorData struct (for logging variables)
     sensorsAcquire(&sensorData);
@@ -356,9 +343,8 @@ static void stabilizerTask(void* param)
         motorsStop();
       }
 
-      // Compute compressed log formats
-      compressState();
-      compressSetpoint();
+      // Snapshot stream, only computed when enabled
+      stateStreamUpdate(&state, &setpoint, &sensorData, stabilizerStep);
 
 #ifdef CONFIG_DECK_USD
       // Log data to uSD card if configured
@@ -373,6 +359,7 @@ static void stabilizerTask(void* param)
       STATS_CNT_RATE_EVENT(&stabilizerRate);
     }
 
+    EVENT_TRACE_SPAN_END(EVENT_TRACE_SPAN_STABILIZER);
     xSemaphoreGive(xRateSupervisorSemaphore);
 
 #ifdef CONFIG_MOTORS_ESC_PROTOCOL_DSHOT
@@ -481,47 +468,47 @@ LOG_GROUP_START(ctrltargetZ)
 /**
  * @brief Desired position X [mm]
  */
-LOG_ADD(LOG_INT16, x, &setpointCompressed.x)
+LOG_ADD_BY_FUNCTION(LOG_INT16, x, &setpointXLogger)
 
 /**
  * @brief Desired position Y [mm]
  */
-LOG_ADD(LOG_INT16, y, &setpointCompressed.y)
+LOG_ADD_BY_FUNCTION(LOG_INT16, y, &setpointYLogger)
 
 /**
  * @brief Desired position Z [mm]
  */
-LOG_ADD(LOG_INT16, z, &setpointCompressed.z)
+LOG_ADD_BY_FUNCTION(LOG_INT16, z, &setpointZLogger)
 
 /**
  * @brief Desired velocity X [mm/s]
  */
-LOG_ADD(LOG_INT16, vx, &setpointCompressed.vx)
+LOG_ADD_BY_FUNCTION(LOG_INT16, vx, &setpointVxLogger)
 
 /**
  * @brief Desired velocity Y [mm/s]
  */
-LOG_ADD(LOG_INT16, vy, &setpointCompressed.vy)
+LOG_ADD_BY_FUNCTION(LOG_INT16, vy, &setpointVyLogger)
 
 /**
  * @brief Desired velocity Z [mm/s]
  */
-LOG_ADD(LOG_INT16, vz, &setpointCompressed.vz)
+LOG_ADD_BY_FUNCTION(LOG_INT16, vz, &setpointVzLogger)
 
 /**
  * @brief Desired acceleration X [mm/s^2]
  */
-LOG_ADD(LOG_INT16, ax, &setpointCompressed.ax)
+LOG_ADD_BY_FUNCTION(LOG_INT16, ax, &setpointAxLogger)
 
 /**
  * @brief Desired acceleration Y [mm/s^2]
  */
-LOG_ADD(LOG_INT16, ay, &setpointCompressed.ay)
+LOG_ADD_BY_FUNCTION(LOG_INT16, ay, &setpointAyLogger)
 
 /**
  * @brief Desired acceleration Z [mm/s^2]
  */
-LOG_ADD(LOG_INT16, az, &setpointCompressed.az)
+LOG_ADD_BY_FUNCTION(LOG_INT16, az, &setpointAzLogger)
 LOG_GROUP_STOP(ctrltargetZ)
 
 /**
@@ -778,67 +765,67 @@ LOG_GROUP_START(stateEstimateZ)
 /**
  * @brief The position of the Crazyflie in the global reference frame, X [mm]
  */
-LOG_ADD(LOG_INT16, x, &stateCompressed.x)
+LOG_ADD_BY_FUNCTION(LOG_INT16, x, &stateXLogger)
 
 /**
  * @brief The position of the Crazyflie in the global reference frame, Y [mm]
  */
-LOG_ADD(LOG_INT16, y, &stateCompressed.y)
+LOG_ADD_BY_FUNCTION(LOG_INT16, y, &stateYLogger)
 
 /**
  * @brief The position of the Crazyflie in the global reference frame, Z [mm]
  */
-LOG_ADD(LOG_INT16, z, &stateCompressed.z)
+LOG_ADD_BY_FUNCTION(LOG_INT16, z, &stateZLogger)
 
 /**
  * @brief The velocity of the Crazyflie in the global reference frame, X [mm/s]
  */
-LOG_ADD(LOG_INT16, vx, &stateCompressed.vx)
+LOG_ADD_BY_FUNCTION(LOG_INT16, vx, &stateVxLogger)
 
 /**
  * @brief The velocity of the Crazyflie in the global reference frame, Y [mm/s]
  */
-LOG_ADD(LOG_INT16, vy, &stateCompressed.vy)
+LOG_ADD_BY_FUNCTION(LOG_INT16, vy, &stateVyLogger)
 
 /**
  * @brief The velocity of the Crazyflie in the global reference frame, Z [mm/s]
  */
-LOG_ADD(LOG_INT16, vz, &stateCompressed.vz)
+LOG_ADD_BY_FUNCTION(LOG_INT16, vz, &stateVzLogger)
 
 /**
  * @brief The acceleration of the Crazyflie in the global reference frame, X [mm/s]
  */
-LOG_ADD(LOG_INT16, ax, &stateCompressed.ax)
+LOG_ADD_BY_FUNCTION(LOG_INT16, ax, &stateAxLogger)
 
 /**
  * @brief The acceleration of the Crazyflie in the global reference frame, Y [mm/s]
  */
-LOG_ADD(LOG_INT16, ay, &stateCompressed.ay)
+LOG_ADD_BY_FUNCTION(LOG_INT16, ay, &stateAyLogger)
 
 /**
  * @brief The acceleration of the Crazyflie in the global reference frame, including gravity, Z [mm/s]
  */
-LOG_ADD(LOG_INT16, az, &stateCompressed.az)
+LOG_ADD_BY_FUNCTION(LOG_INT16, az, &stateAzLogger)
 
 /**
  * @brief Attitude as a compressed quaternion, see see quatcompress.h for details
  */
-LOG_ADD(LOG_UINT32, quat, &stateCompressed.quat)
+LOG_ADD_BY_FUNCTION(LOG_UINT32, quat, &stateQuatLogger)
 
 /**
  * @brief Roll rate (angular velocity) [milliradians / sec]
  */
-LOG_ADD(LOG_INT16, rateRoll, &stateCompressed.rateRoll)
+LOG_ADD_BY_FUNCTION(LOG_INT16, rateRoll, &rateRollLogger)
 
 /**
  * @brief Pitch rate (angular velocity) [milliradians / sec]
  */
-LOG_ADD(LOG_INT16, ratePitch, &stateCompressed.ratePitch)
+LOG_ADD_BY_FUNCTION(LOG_INT16, ratePitch, &ratePitchLogger)
 
 /**
  * @brief Yaw rate (angular velocity) [milliradians / sec]
  */
-LOG_ADD(LOG_INT16, rateYaw, &stateCompressed.rateYaw)
+LOG_ADD_BY_FUNCTION(LOG_INT16, rateYaw, &rateYawLogger)
 LOG_GROUP_STOP(stateEstimateZ)
 
 
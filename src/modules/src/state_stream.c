@@ -0,0 +1,203 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * state_stream.c - Compact state and setpoint snapshot stream
+ */
+
+#include "state_stream.h"
+#include "crtp.h"
+#include "crtp_localization_service.h"
+#include "log.h"
+#include "math3d.h"
+#include "param.h"
+#include "quatcompress.h"
+
+// Same channel as the other streams of the localization service
+#define GENERIC_TYPE 1
+
+#define MAX_RATE_HZ RATE_MAIN_LOOP
+
+static uint8_t enable = 0;
+static uint16_t rateHz = 100;
+
+static uint16_t sequence;
+static uint32_t packetsSent;
+static uint32_t packetsDropped;
+
+static CRTPPacket packet;
+
+static int16_t saturateInt16(const float value) {
+  if (value > INT16_MAX) {
+    return INT16_MAX;
+  }
+  if (value < INT16_MIN) {
+    return INT16_MIN;
+  }
+  return (int16_t)value;
+}
+
+static int16_t toMilli(const float value) {
+  return saturateInt16(value * 1000.0f);
+}
+
+void stateStreamPackState(stateSnapshotPacket_t* snapshot, const uint32_t timestamp, const state_t* state, const sensorData_t* sensorData) {
+  snapshot->type = STATE_SNAPSHOT;
+  snapshot->timestamp = timestamp;
+
+  snapshot->x = toMilli(state->position.x);
+  snapshot->y = toMilli(state->position.y);
+  snapshot->z = toMilli(state->position.z);
+
+  snapshot->vx = toMilli(state->velocity.x);
+  snapshot->vy = toMilli(state->velocity.y);
+  snapshot->vz = toMilli(state->velocity.z);
+
+  float const q[4] = {
+    state->attitudeQuaternion.x,
+    state->attitudeQuaternion.y,
+    state->attitudeQuaternion.z,
+    state->attitudeQuaternion.w};
+  snapshot->quat = quatcompress(q);
+
+  snapshot->rateRoll = toMilli(radians(sensorData->gyro.x));
+  snapshot->ratePitch = toMilli(-radians(sensorData->gyro.y));
+  snapshot->rateYaw = toMilli(radians(sensorData->gyro.z));
+}
+
+void stateStreamPackSetpoint(setpointSnapshotPacket_t* snapshot, const uint32_t timestamp, const setpoint_t* setpoint) {
+  snapshot->type = SETPOINT_SNAPSHOT;
+  snapshot->timestamp = timestamp;
+
+  snapshot->x = toMilli(setpoint->position.x);
+  snapshot->y = toMilli(setpoint->position.y);
+  snapshot->z = toMilli(setpoint->position.z);
+
+  snapshot->vx = toMilli(setpoint->velocity.x);
+  snapshot->vy = toMilli(setpoint->velocity.y);
+  snapshot->vz = toMilli(setpoint->velocity.z);
+
+  snapshot->ax = toMilli(setpoint->acceleration.x);
+  snapshot->ay = toMilli(setpoint->acceleration.y);
+  snapshot->az = toMilli(setpoint->acceleration.z);
+
+  snapshot->yaw = saturateInt16(setpoint->attitude.yaw * 100.0f);
+}
+
+static void send(const uint8_t size) {
+  packet.port = CRTP_PORT_LOCALIZATION;
+  packet.channel = GENERIC_TYPE;
+  packet.size = size;
+  // Best effort, the stabilizer loop must not block
+  if (crtpSendPacket(&packet)) {
+    packetsSent++;
+  } else {
+    packetsDropped++;
+  }
+}
+
+uint16_t stateStreamClampRate(const uint16_t rate) {
+  if (rate == 0) {
+    return 0;
+  }
+  if (rate >= MAX_RATE_HZ) {
+    return MAX_RATE_HZ;
+  }
+
+  // The largest divisor of the loop rate that is not higher than the requested rate, 1 always divides
+  uint16_t clamped = rate;
+  while (RATE_MAIN_LOOP % clamped != 0) {
+    clamped--;
+  }
+  return clamped;
+}
+
+static void rateCallback(void) {
+  rateHz = stateStreamClampRate(rateHz);
+}
+
+void stateStreamUpdate(const state_t* state, const setpoint_t* setpoint, const sensorData_t* sensorData, const stabilizerStep_t stabilizerStep) {
+  if (enable == 0 || rateHz == 0) {
+    return;
+  }
+
+  // The rate is a divisor of the loop rate, see rateCallback()
+  if (stabilizerStep % (RATE_MAIN_LOOP / rateHz) != 0) {
+    return;
+  }
+
+  // The time of the sensor sample the state is based on, in both snapshots
+  const uint32_t timestamp = sensorData->interruptTimestamp / 1000;
+
+  // The snapshots are packed directly in the packet, on the ticks they are sent only
+  if (enable & STATE_STREAM_STATE) {
+    stateSnapshotPacket_t* snapshot = (stateSnapshotPacket_t*)packet.data;
+    stateStreamPackState(snapshot, timestamp, state, sensorData);
+    snapshot->seq = sequence;
+    send(sizeof(stateSnapshotPacket_t));
+  }
+
+  if (enable & STATE_STREAM_SETPOINT) {
+    setpointSnapshotPacket_t* snapshot = (setpointSnapshotPacket_t*)packet.data;
+    stateStreamPackSetpoint(snapshot, timestamp, setpoint);
+    snapshot->seq = sequence;
+    send(sizeof(setpointSnapshotPacket_t));
+  }
+
+  sequence++;
+}
+
+/**
+ * Compact snapshots of the state estimate and the setpoint, streamed from
+ * the stabilizer loop on the generic localization channel. One packet holds a
+ * full snapshot, which makes it possible to get the full state at high rate
+ * without spreading it over several log blocks.
+ */
+PARAM_GROUP_START(stateStrm)
+/**
+ * @brief Streams to send, bit 0: state (position, velocity, attitude, rates), bit 1: setpoint (Default: 0)
+ */
+PARAM_ADD(PARAM_UINT8, enable, &enable)
+/**
+ * @brief Snapshot rate [Hz], a divisor of 1000: 1, 2, 4, 5, 8, 10, 20, 25, 40, 50, 100, 125, 200, 250, 500 or 1000.
+ * Other values are clamped down to the closest divisor when set (Default: 100)
+ */
+PARAM_ADD_WITH_CALLBACK(PARAM_UINT16, rate, &rateHz, rateCallback)
+PARAM_GROUP_STOP(stateStrm)
+
+/**
+ * Statistics of the snapshot stream
+ */
+LOG_GROUP_START(stateStrm)
+/**
+ * @brief Sequence number of the next snapshot
+ */
+LOG_ADD(LOG_UINT16, seq, &sequence)
+/**
+ * @brief Number of packets sent
+ */
+LOG_ADD(LOG_UINT32, sent, &packetsSent)
+/**
+ * @brief Number of packets dropped since the CRTP queue was full
+ */
+LOG_ADD(LOG_UINT32, dropped, &packetsDropped)
+LOG_GROUP_STOP(stateStrm)
@@ -26,97 +26,387 @@
 
 #define DEBUG_MODULE "SYSLOAD"
 
+/**
+ * The runs of each task, from being switched in to being switched out, are
+ * measured with the cycle counter in the scheduler hook. Every period the
+ * load of each task is computed as the run time since the previous period
+ * divided by the length of the period. Time spent in interrupts is included
+ * in the load of the interrupted task. The time spent in the instrumented
+ * interrupt handlers (see isr_monitor.h) is also measured separately.
+ *
+ * The list of tasks, their names and stack headroom are taken from the
+ * FreeRTOS system state every STACK_SAMPLE_PERIODS periods. The stacks of all
+ * tasks are scanned with the scheduler suspended, which is too slow to do
+ * every period.
+ *
+ * The table is built in a private copy and copied to the published table
+ * in a critical section, readers copy entries out the same way.
+ *
+ * Per task data is indexed by the FreeRTOS task number, tasks with a
+ * number of TASK_NUMBER_MAX or higher are not reported.
+ *
+ * Memory layout of MEM_TYPE_TASK_LOAD, see sysLoadMem_t, task entries
+ * sorted on task number.
+ */
+
 #include <stdbool.h>
+#include <string.h>
 #include "FreeRTOS.h"
+#include "task.h"
 #include "timers.h"
+#include "config.h"
 #include "debug.h"
 #include "cfassert.h"
+#include "log.h"
 #include "param.h"
+#include "mem.h"
 #include "static_mem.h"
+#include "cycle_counter.h"
 
 #include "sysload.h"
 
-#define TIMER_PERIOD M2T(1000)
+#define TIMER_PERIOD_MS 1000
+#define TIMER_PERIOD M2T(TIMER_PERIOD_MS)
+#define STACK_SAMPLE_PERIODS 10
+
+#define TASK_MAX_COUNT 32
+#define TASK_NUMBER_MAX 64
+#define TASK_NAME_LEN 12
+#define CYCLES_PER_US (FREERTOS_MCU_CLOCK_HZ / 1000000)
+
+#define SYSLOAD_MEM_VERSION 1
 
 static void timerHandler(xTimerHandle timer);
 
 static bool initialized = false;
 static uint8_t triggerDump = 0;
+static uint16_t selectedTask = 0;
 
 typedef struct {
-  uint32_t ulRunTimeCounter;
-  uint32_t xTaskNumber;
-} taskData_t;
+  uint16_t taskNumber;
+  uint16_t load;          // CPU load in the last period, 0.1 %
+  uint16_t stackHeadroom; // Unused stack at the peak usage since start, bytes
+  uint16_t reserved;
+  uint32_t maxRun;        // Longest run in the last period, us
+  char name[TASK_NAME_LEN];
+} sysLoadTaskEntry_t;
 
-#define TASK_MAX_COUNT 32
-NO_DMA_CCM_SAFE_ZERO_INIT static taskData_t previousSnapshot[TASK_MAX_COUNT];
-static int taskTopIndex = 0;
-static uint32_t previousTotalRunTime = 0;
+// Memory layout of MEM_TYPE_TASK_LOAD, naturally aligned and without padding
+typedef struct {
+  uint8_t version;
+  uint8_t taskCount;
+  uint16_t isrLoad;    // Time in instrumented interrupts in the last period, 0.1 %
+  uint32_t sequence;   // Incremented every period
+  uint32_t periodMs;
+  sysLoadTaskEntry_t tasks[TASK_MAX_COUNT];
+} sysLoadMem_t;
+
+_Static_assert(sizeof(sysLoadTaskEntry_t) == 24, "Unexpected task entry size");
+
+// Total and longest run of each task in cycles, indexed by task number. The total is free running, the longest
+// run is for the current period.
+static volatile uint32_t runCycles[TASK_NUMBER_MAX];
+static volatile uint32_t maxRunCycles[TASK_NUMBER_MAX];
+NO_DMA_CCM_SAFE_ZERO_INIT static uint32_t previousRunCycles[TASK_NUMBER_MAX];
+static uint32_t lastSwitchCycles;
+
+// Tasks found in the latest scan of the system state, sorted on task number. Only used by the timer task.
+NO_DMA_CCM_SAFE_ZERO_INIT static TaskStatus_t taskStats[TASK_MAX_COUNT];
+NO_DMA_CCM_SAFE_ZERO_INIT static sysLoadTaskEntry_t tasks[TASK_MAX_COUNT];
+static uint8_t taskCount = 0;
+static uint32_t idleTaskNumber = TASK_NUMBER_MAX;
+static uint32_t periodCount = 0;
+static bool isTooManyTasksReported = false;
+
+static volatile uint32_t isrCycles;
+static uint32_t isrNesting;
+static uint32_t isrEnterCycles;
+static uint32_t previousIsrCycles;
+static uint32_t previousPeriodCycles;
+
+NO_DMA_CCM_SAFE_ZERO_INIT static sysLoadMem_t published;
+static uint16_t idleLoad;
+static uint16_t minStackHeadroom;
+static uint16_t minStackTask;
+
+static uint32_t handleMemGetSize(void) { return sizeof(published); }
+static bool handleMemRead(const uint32_t memAddr, const uint8_t readLen, uint8_t* buffer);
+static const MemoryHandlerDef_t memDef = {
+  .type = MEM_TYPE_TASK_LOAD,
+  .getSize = handleMemGetSize,
+  .read = handleMemRead,
+  .write = 0, // Write is not supported
+};
 
 static StaticTimer_t timerBuffer;
 
 void sysLoadInit() {
   ASSERT(!initialized);
 
+  cycleCounterInit();
+  lastSwitchCycles = cycleCounterGet();
+  previousPeriodCycles = lastSwitchCycles;
+
+  published.version = SYSLOAD_MEM_VERSION;
+  published.periodMs = TIMER_PERIOD_MS;
+  memoryRegisterHandler(&memDef);
+
   xTimerHandle timer = xTimerCreateStatic( "sysLoadMonitorTimer", TIMER_PERIOD, pdTRUE, NULL, timerHandler, &timerBuffer);
   xTimerStart(timer, 100);
 
   initialized = true;
 }
 
+void sysLoadTaskSwitchedOut(const uint32_t taskNumber) {
+  if (!initialized) {
+    return;
+  }
 
-static taskData_t* getPreviousTaskData(uint32_t xTaskNumber) {
-  // Try to find the task in the list of tasks
-  for (int i = 0; i < taskTopIndex; i++) {
-    if (previousSnapshot[i].xTaskNumber == xTaskNumber) {
-      return &previousSnapshot[i];
+  const uint32_t now = cycleCounterGet();
+  const uint32_t run = now - lastSwitchCycles;
+  lastSwitchCycles = now;
+
+  if (taskNumber < TASK_NUMBER_MAX) {
+    runCycles[taskNumber] += run;
+    if (run > maxRunCycles[taskNumber]) {
+      maxRunCycles[taskNumber] = run;
     }
   }
+}
 
-  // Allocate a new entry
-  ASSERT(taskTopIndex < TASK_MAX_COUNT);
-  taskData_t* result = &previousSnapshot[taskTopIndex];
-  result->xTaskNumber = xTaskNumber;
+void sysLoadIsrEnter(void) {
+  // A preempting interrupt always exits before the interrupt it preempts
+  // continues, the nesting count is consistent without locking
+  if (isrNesting++ == 0) {
+    isrEnterCycles = cycleCounterGet();
+  }
+}
 
-  taskTopIndex++;
+void sysLoadIsrExit(void) {
+  if (--isrNesting == 0) {
+    isrCycles += cycleCounterGet() - isrEnterCycles;
+  }
+}
 
-  return result;
+static uint16_t toPermille(const uint32_t part, const uint32_t total) {
+  if (total == 0) {
+    return 0;
+  }
+  return (uint16_t)(((uint64_t)part * 1000) / total);
 }
 
-static void timerHandler(xTimerHandle timer) {
-  if (triggerDump != 0) {
-    uint32_t totalRunTime;
+// Update the list of tasks with names and stack headroom
+static void scanTasks() {
+  // uxTaskGetSystemState() returns 0 if the tasks do not fit
+  if (uxTaskGetNumberOfTasks() > TASK_MAX_COUNT) {
+    if (!isTooManyTasksReported) {
+      DEBUG_PRINT("More than %d tasks, the task list is not updated\n", TASK_MAX_COUNT);
+      isTooManyTasksReported = true;
+    }
+    return;
+  }
 
-    TaskStatus_t taskStats[TASK_MAX_COUNT];
-    uint32_t taskCount = uxTaskGetSystemState(taskStats, TASK_MAX_COUNT, &totalRunTime);
-    ASSERT(taskCount < TASK_MAX_COUNT);
+  const uint32_t statsCount = uxTaskGetSystemState(taskStats, TASK_MAX_COUNT, NULL);
+  if (statsCount == 0) {
+    return;
+  }
 
-    uint32_t totalDelta = totalRunTime - previousTotalRunTime;
-    float f = 100.0 / totalDelta;
+  const TaskHandle_t idleTask = xTaskGetIdleTaskHandle();
+  uint16_t minHeadroom = UINT16_MAX;
+  uint16_t minHeadroomTask = 0;
+  uint8_t count = 0;
 
-    // Dumps the the CPU load and stack usage for all tasks
-    // CPU usage is since last dump in % compared to total time spent in tasks. Note that time spent in interrupts will be included in measured time.
-    // Stack usage is displayed as nr of unused bytes at peak stack usage.
+  for (uint32_t i = 0; i < statsCount; i++) {
+    const TaskStatus_t* stats = &taskStats[i];
+    const uint32_t number = stats->xTaskNumber;
+    if (number >= TASK_NUMBER_MAX) {
+      continue;
+    }
 
-    DEBUG_PRINT("Task dump\n");
-    DEBUG_PRINT("Load\tStack left\tName\n");
-    for (uint32_t i = 0; i < taskCount; i++) {
-      TaskStatus_t* stats = &taskStats[i];
-      taskData_t* previousTaskData = getPreviousTaskData(stats->xTaskNumber);
+    sysLoadTaskEntry_t entry = {
+      .taskNumber = number,
+      .stackHeadroom = stats->usStackHighWaterMark * sizeof(StackType_t),
+    };
+    strncpy(entry.name, stats->pcTaskName, TASK_NAME_LEN - 1);
 
-      uint32_t taskRunTime = stats->ulRunTimeCounter;
-      float load = f * (taskRunTime - previousTaskData->ulRunTimeCounter);
-      DEBUG_PRINT("%.2f \t%u \t%s\n", (double)load, stats->usStackHighWaterMark, stats->pcTaskName);
+    if (stats->xHandle == idleTask) {
+      idleTaskNumber = number;
+    }
+    if (entry.stackHeadroom < minHeadroom) {
+      minHeadroom = entry.stackHeadroom;
+      minHeadroomTask = number;
+    }
 
-      previousTaskData->ulRunTimeCounter = taskRunTime;
+    // Insertion sort on task number
+    int j = count;
+    while (j > 0 && tasks[j - 1].taskNumber > number) {
+      tasks[j] = tasks[j - 1];
+      j--;
     }
+    tasks[j] = entry;
+    count++;
+  }
+
+  taskCount = count;
+  minStackHeadroom = minHeadroom;
+  minStackTask = minHeadroomTask;
+}
+
+static void updateTaskLoad() {
+  if (periodCount++ % STACK_SAMPLE_PERIODS == 0) {
+    scanTasks();
+  }
+
+  const uint32_t nowCycles = cycleCounterGet();
+  const uint32_t periodCycles = nowCycles - previousPeriodCycles;
+  previousPeriodCycles = nowCycles;
+  const uint32_t isrNow = isrCycles;
+  const uint16_t isrLoad = toPermille(isrNow - previousIsrCycles, periodCycles);
+  previousIsrCycles = isrNow;
+
+  // All task numbers are stepped, tasks that are not in the list yet start from the right point when they are added
+  uint8_t t = 0;
+  for (uint32_t number = 0; number < TASK_NUMBER_MAX; number++) {
+    const uint32_t run = runCycles[number];
+    const uint32_t runDelta = run - previousRunCycles[number];
+    previousRunCycles[number] = run;
+    const uint32_t maxRun = maxRunCycles[number];
+    maxRunCycles[number] = 0;
+
+    if (t < taskCount && tasks[t].taskNumber == number) {
+      tasks[t].load = toPermille(runDelta, periodCycles);
+      tasks[t].maxRun = maxRun / CYCLES_PER_US;
+      if (number == idleTaskNumber) {
+        idleLoad = tasks[t].load;
+      }
+      t++;
+    }
+  }
 
-    previousTotalRunTime = totalRunTime;
+  taskENTER_CRITICAL();
+  memcpy(published.tasks, tasks, taskCount * sizeof(sysLoadTaskEntry_t));
+  published.taskCount = taskCount;
+  published.isrLoad = isrLoad;
+  published.sequence++;
+  taskEXIT_CRITICAL();
+}
+
+static void dumpTaskLoad() {
+  // CPU usage is in % of the last period. Note that time spent in interrupts is included in the task load.
+  // Max run is the longest time in us a task ran before being switched out in the last period.
+  // Stack usage is displayed as nr of unused bytes at peak stack usage.
+  DEBUG_PRINT("Task dump, %.1f%% in interrupts\n", (double)(published.isrLoad / 10.0f));
+  DEBUG_PRINT("Load\tMax run\tStack left\tName\n");
+  for (int i = 0; i < published.taskCount; i++) {
+    const sysLoadTaskEntry_t* entry = &published.tasks[i];
+    DEBUG_PRINT("%.1f \t%lu \t%u \t%s\n", (double)(entry->load / 10.0f), entry->maxRun, entry->stackHeadroom, entry->name);
+  }
+}
+
+static void timerHandler(xTimerHandle timer) {
+  updateTaskLoad();
 
+  if (triggerDump != 0) {
+    dumpTaskLoad();
     triggerDump = 0;
   }
 }
 
+static bool handleMemRead(const uint32_t memAddr, const uint8_t readLen, uint8_t* buffer) {
+  if (memAddr + readLen > sizeof(published)) {
+    return false;
+  }
+
+  taskENTER_CRITICAL();
+  memcpy(buffer, (uint8_t*)&published + memAddr, readLen);
+  taskEXIT_CRITICAL();
+  return true;
+}
+
+// Copy the entry of the selected task, all fields are zero if the task is not found
+static void getSelectedTask(sysLoadTaskEntry_t* entry) {
+  memset(entry, 0, sizeof(sysLoadTaskEntry_t));
+
+  taskENTER_CRITICAL();
+  for (int i = 0; i < published.taskCount; i++) {
+    if (published.tasks[i].taskNumber == selectedTask) {
+      *entry = published.tasks[i];
+      break;
+    }
+  }
+  taskEXIT_CRITICAL();
+}
+
+static uint16_t selectedTaskLoad(uint32_t timestamp, void* data) {
+  sysLoadTaskEntry_t entry;
+  getSelectedTask(&entry);
+  return entry.load;
+}
+
+static uint32_t selectedTaskMaxRun(uint32_t timestamp, void* data) {
+  sysLoadTaskEntry_t entry;
+  getSelectedTask(&entry);
+  return entry.maxRun;
+}
+
+static uint16_t selectedTaskStack(uint32_t timestamp, void* data) {
+  sysLoadTaskEntry_t entry;
+  getSelectedTask(&entry);
+  return entry.stackHeadroom;
+}
+
+static logByFunction_t taskLoadLogger = {.acquireUInt16 = selectedTaskLoad, .data = 0};
+static logByFunction_t taskMaxRunLogger = {.acquireUInt32 = selectedTaskMaxRun, .data = 0};
+static logByFunction_t taskStackLogger = {.acquireUInt16 = selectedTaskStack, .data = 0};
+
+/**
+ * System load, updated once per second. The load of all tasks is available
+ * in the MEM_TYPE_TASK_LOAD memory.
+ */
+LOG_GROUP_START(sysload)
+/**
+ * @brief Load of the idle task [0.1 %]
+ */
+LOG_ADD(LOG_UINT16, idle, &idleLoad)
+/**
+ * @brief Time spent in instrumented interrupts [0.1 %]
+ */
+LOG_ADD(LOG_UINT16, isr, &published.isrLoad)
+/**
+ * @brief Smallest stack headroom of all tasks, sampled every 10 s [bytes]
+ */
+LOG_ADD(LOG_UINT16, minStack, &minStackHeadroom)
+/**
+ * @brief Task number of the task with the smallest stack headroom
+ */
+LOG_ADD(LOG_UINT16, minStackTask, &minStackTask)
+/**
+ * @brief Load of the task selected with sysload.task [0.1 %]
+ */
+LOG_ADD_BY_FUNCTION(LOG_UINT16, taskLoad, &taskLoadLogger)
+/**
+ * @brief Longest run of the task selected with sysload.task [us]
+ */
+LOG_ADD_BY_FUNCTION(LOG_UINT32, taskMaxRun, &taskMaxRunLogger)
+/**
+ * @brief Stack headroom of the task selected with sysload.task [bytes]
+ */
+LOG_ADD_BY_FUNCTION(LOG_UINT16, taskStack, &taskStackLogger)
+/**
+ * @brief Incremented every time the load is updated
+ */
+LOG_ADD(LOG_UINT32, seq, &published.sequence)
+LOG_GROUP_STOP(sysload)
+
+/**
+ * System load
+ */
+PARAM_GROUP_START(sysload)
+/**
+ * @brief Task number of the task logged in sysload.taskLoad, taskMaxRun and taskStack
+ */
+PARAM_ADD(PARAM_UINT16, task, &selectedTask)
+PARAM_GROUP_STOP(sysload)
 
 PARAM_GROUP_START(system)
 
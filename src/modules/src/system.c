@@ -59,6 +59,7 @@
 #include "proximity.h"
 #include "watchdog.h"
 #include "queuemonitor.h"
+#include "event_trace.h"
 #include "buzzer.h"
 #include "sound.h"
 #include "sysload.h"
@@ -71,6 +72,8 @@
 #include "peer_localization.h"
 #include "cfassert.h"
 #include "i2cdev.h"
+#include "sensors.h"
+#include "boot_profile.h"
 #include "autoconf.h"
 #include "vcp_esc_passthrough.h"
 #if CONFIG_ENABLE_CPX
@@ -88,12 +91,24 @@ static uint8_t doAssert;
 
 STATIC_MEM_TASK_ALLOC(systemTask, SYSTEM_TASK_STACKSIZE);
 
+#ifdef CONFIG_SYSTEM_PARALLEL_INIT
+STATIC_MEM_TASK_ALLOC(bootTask, BOOT_TASK_STACKSIZE);
+static SemaphoreHandle_t sensorsReady;
+static StaticSemaphore_t sensorsReadyBuffer;
+static SemaphoreHandle_t storageChecked;
+static StaticSemaphore_t storageCheckedBuffer;
+#endif
+static bool storageTestPassed;
+
 /* System wide synchronisation */
 xSemaphoreHandle canStartMutex;
 static StaticSemaphore_t canStartMutexBuffer;
 
 /* Private functions */
 static void systemTask(void *arg);
+static void startBootTask(void);
+static void waitForSensors(void);
+static bool waitForStorageTest(void);
 
 /* Public functions */
 void systemLaunch(void)
@@ -174,6 +189,10 @@ void systemTask(void *arg)
   queueMonitorInit();
 #endif
 
+#ifdef CONFIG_DEBUG_EVENT_TRACE
+  eventTraceInit();
+#endif
+
 #ifdef CONFIG_DEBUG_PRINT_ON_UART1
   uart1Init(CONFIG_DEBUG_PRINT_ON_UART1_BAUDRATE);
 #endif
@@ -184,12 +203,24 @@ void systemTask(void *arg)
   passthroughInit();
 
   //Init the high-levels modules
+  bootProfileBegin(bootPhaseSystemInit);
   systemInit();
+  bootProfileEnd(bootPhaseSystemInit);
+
+  // The sensor init and the storage check only depend on systemInit, they run
+  // in parallel with the rest of the init with CONFIG_SYSTEM_PARALLEL_INIT
+  startBootTask();
+
+  bootProfileBegin(bootPhaseCommInit);
   commInit();
+  bootProfileEnd(bootPhaseCommInit);
+  bootProfileBegin(bootPhaseCommanderInit);
   commanderInit();
+  bootProfileEnd(bootPhaseCommanderInit);
 
   StateEstimatorType estimator = StateEstimatorTypeAutoSelect;
 
+  bootProfileBegin(bootPhaseEstimatorInit);
   #ifdef CONFIG_ESTIMATOR_KALMAN_ENABLE
   estimatorKalmanTaskInit();
   #endif
@@ -197,20 +228,30 @@ void systemTask(void *arg)
   #ifdef CONFIG_ESTIMATOR_UKF_ENABLE
   errorEstimatorUkfTaskInit();
   #endif
+  bootProfileEnd(bootPhaseEstimatorInit);
 
   // Enabling incoming syslink messages to be added to the queue.
   // This should probably be done later, but deckInit() takes a long time if this is done later.
   uartslkEnableIncoming();
 
+  bootProfileBegin(bootPhaseMemInit);
   memInit();
+  bootProfileEnd(bootPhaseMemInit);
+  bootProfileBegin(bootPhaseDeckInit);
   deckInit();
+  bootProfileEnd(bootPhaseDeckInit);
   estimator = deckGetRequiredEstimator();
+  waitForSensors();
+  bootProfileBegin(bootPhaseStabilizerInit);
   stabilizerInit(estimator);
+  bootProfileEnd(bootPhaseStabilizerInit);
   if (deckGetRequiredLowInterferenceRadioMode() && platformConfigPhysicalLayoutAntennasAreClose())
   {
     platformSetLowInterferenceRadioMode();
   }
+  bootProfileBegin(bootPhaseSoundInit);
   soundInit();
+  bootProfileEnd(bootPhaseSoundInit);
   crtpMemInit();
 
 #ifdef PROXIMITY_ENABLED
@@ -221,6 +262,7 @@ void systemTask(void *arg)
 
   //Test the modules
   DEBUG_PRINT("About to run tests in system.c.\n");
+  bootProfileBegin(bootPhaseTests);
   if (systemTest() == false) {
     pass = false;
     DEBUG_PRINT("system [FAIL]\n");
@@ -229,7 +271,7 @@ void systemTask(void *arg)
     pass = false;
     DEBUG_PRINT("configblock [FAIL]\n");
   }
-  if (storageTest() == false) {
+  if (waitForStorageTest() == false) {
     pass = false;
     DEBUG_PRINT("storage [FAIL]\n");
   }
@@ -260,10 +302,12 @@ void systemTask(void *arg)
   }
   #endif
 
+  bootProfileBegin(bootPhaseDeckTest);
   if (deckTest() == false) {
     pass = false;
     DEBUG_PRINT("deck [FAIL]\n");
   }
+  bootProfileEnd(bootPhaseDeckTest);
   if (soundTest() == false) {
     pass = false;
     DEBUG_PRINT("sound [FAIL]\n");
@@ -288,6 +332,7 @@ void systemTask(void *arg)
     pass = false;
     DEBUG_PRINT("peerLocalization [FAIL]\n");
   }
+  bootProfileEnd(bootPhaseTests);
 
   //Start the firmware
   if(pass)
@@ -295,6 +340,7 @@ void systemTask(void *arg)
     DEBUG_PRINT("Self test passed!\n");
     selftestPassed = 1;
     systemStart();
+    bootProfileReady();
     soundSetEffect(SND_STARTUP);
     ledseqRun(&seq_alive);
     ledseqRun(&seq_testPassed);
@@ -313,6 +359,7 @@ void systemTask(void *arg)
         {
 	        DEBUG_PRINT("Start forced.\n");
           systemStart();
+          bootProfileReady();
           break;
         }
       }
@@ -333,6 +380,71 @@ void systemTask(void *arg)
 }
 
 
+static void runSensorsInit(void)
+{
+  bootProfileBegin(bootPhaseSensorsInit);
+  sensorsInit();
+  bootProfileEnd(bootPhaseSensorsInit);
+}
+
+static void runStorageTest(void)
+{
+  bootProfileBegin(bootPhaseStorageTest);
+  storageTestPassed = storageTest();
+  bootProfileEnd(bootPhaseStorageTest);
+}
+
+#ifdef CONFIG_SYSTEM_PARALLEL_INIT
+static void bootTask(void *arg)
+{
+  // The sensor startup time is spent while the decks are enumerated and initialized.
+  // The buses are locked by the drivers, the clock enable, gpio and EXTI registers
+  // shared with the decks are updated in critical sections.
+  runSensorsInit();
+  xSemaphoreGive(sensorsReady);
+
+  runStorageTest();
+  xSemaphoreGive(storageChecked);
+
+  while(1)
+    vTaskDelay(portMAX_DELAY);
+}
+
+static void startBootTask(void)
+{
+  sensorsReady = xSemaphoreCreateBinaryStatic(&sensorsReadyBuffer);
+  storageChecked = xSemaphoreCreateBinaryStatic(&storageCheckedBuffer);
+  STATIC_MEM_TASK_CREATE(bootTask, bootTask, BOOT_TASK_NAME, NULL, SYSTEM_TASK_PRI);
+}
+
+// stabilizerInit() depends on the sensors
+static void waitForSensors(void)
+{
+  xSemaphoreTake(sensorsReady, portMAX_DELAY);
+}
+
+static bool waitForStorageTest(void)
+{
+  xSemaphoreTake(storageChecked, portMAX_DELAY);
+  return storageTestPassed;
+}
+#else
+static void startBootTask(void)
+{
+}
+
+static void waitForSensors(void)
+{
+  runSensorsInit();
+}
+
+static bool waitForStorageTest(void)
+{
+  runStorageTest();
+  return storageTestPassed;
+}
+#endif
+
 /* Global system variables */
 void systemStart()
 {
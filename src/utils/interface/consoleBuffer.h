@@ -0,0 +1,127 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * consoleBuffer.h - Buffers for the console, a ring of packets and a lock free staging buffer
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+Buffers used by the console.
+
+The console text is written to a ring of packet payloads. Characters are
+appended to the open packet, that is closed when a new line is written or when
+it is full. Closed packets are popped by the console task and sent. The ring is
+not thread safe, the console takes its lock once per call (a formatted message
+or a string) and not once per character.
+
+Interrupts can not take the lock, they write characters to a lock free staging
+buffer instead, that is moved to the ring by the console task. Several
+interrupts can write to the staging buffer at the same time, there is only one
+reader.
+*/
+
+// Max payload of a console packet, same as CRTP_MAX_DATA_SIZE
+#define CONSOLE_BUFFER_PAYLOAD_SIZE 30
+
+// Number of packets in the ring
+#define CONSOLE_BUFFER_PACKETS 8
+
+// Size of the staging buffer for interrupts, must be a power of 2
+#define CONSOLE_BUFFER_STAGING_SIZE 64
+
+typedef struct {
+  uint8_t size;
+  uint8_t data[CONSOLE_BUFFER_PAYLOAD_SIZE];
+} consoleBufferPacket_t;
+
+typedef struct {
+  consoleBufferPacket_t packets[CONSOLE_BUFFER_PACKETS];
+  // Closed packets are tail to head - 1, head is the open packet if there is room for it
+  uint32_t head;
+  uint32_t tail;
+  // Characters have been dropped since the last packet was closed
+  bool overflow;
+} consoleBufferRing_t;
+
+typedef struct {
+  // A character with CONSOLE_BUFFER_STAGING_VALID set, 0 if the cell is free
+  uint16_t cells[CONSOLE_BUFFER_STAGING_SIZE];
+  uint32_t head;
+  uint32_t tail;
+  uint32_t dropped;
+} consoleBufferStaging_t;
+
+void consoleBufferRingInit(consoleBufferRing_t* ring);
+
+/**
+ * @brief Append a character to the open packet. If the ring is full the character is dropped and a
+ * "<F>\n" marker is written when there is room again.
+ *
+ * @return true if a packet was closed
+ */
+bool consoleBufferRingPutchar(consoleBufferRing_t* ring, const char ch);
+
+/**
+ * @brief Close the open packet if it is not empty
+ *
+ * @return true if a packet was closed
+ */
+bool consoleBufferRingClose(consoleBufferRing_t* ring);
+
+/**
+ * @brief The oldest closed packet, it stays in the ring until consoleBufferRingPop() is called
+ *
+ * @return the packet, 0 if there is no closed packet
+ */
+const consoleBufferPacket_t* consoleBufferRingFront(const consoleBufferRing_t* ring);
+
+/**
+ * @brief Remove the oldest closed packet from the ring
+ */
+void consoleBufferRingPop(consoleBufferRing_t* ring);
+
+/**
+ * @brief Number of closed packets in the ring
+ */
+uint32_t consoleBufferRingCount(const consoleBufferRing_t* ring);
+
+void consoleBufferStagingInit(consoleBufferStaging_t* staging);
+
+/**
+ * @brief Write a character to the staging buffer, lock free and safe to call from any interrupt
+ *
+ * @return false if the buffer is full and the character was dropped
+ */
+bool consoleBufferStagingPut(consoleBufferStaging_t* staging, const char ch);
+
+/**
+ * @brief Move the characters in the staging buffer to the ring, from one reader only. A "<F>\n"
+ * marker is written if characters have been dropped.
+ *
+ * @return true if a packet was closed
+ */
+bool consoleBufferStagingDrain(consoleBufferStaging_t* staging, consoleBufferRing_t* ring);
@@ -62,6 +62,10 @@ void debugInit(void);
 #elif defined(DEBUG_PRINT_ON_SEGGER_RTT)
   #define DEBUG_PRINT(fmt, ...) SEGGER_RTT_printf(0, fmt, ## __VA_ARGS__)
   #define DEBUG_PRINT_OS(fmt, ...) SEGGER_RTT_printf(0, fmt, ## __VA_ARGS__)
+#elif defined(CONFIG_DEBUG_PRINT_TOKENIZED) && !defined(__cplusplus)
+  // Tokenized messages on the radio or USB, decoded by tools/utils/tokenizedConsole.py
+  #define DEBUG_PRINT(fmt, ...) consoleTokenizedPrintf(DEBUG_FMT(fmt), ##__VA_ARGS__)
+  #define DEBUG_PRINT_OS(fmt, ...) consoleTokenizedPrintf(DEBUG_FMT(fmt), ##__VA_ARGS__)
 #else // Debug using radio or USB
   #define DEBUG_PRINT(fmt, ...) consolePrintf(DEBUG_FMT(fmt), ##__VA_ARGS__)
   #define DEBUG_PRINT_OS(fmt, ...) consolePrintf(DEBUG_FMT(fmt), ##__VA_ARGS__)
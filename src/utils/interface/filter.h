@@ -25,6 +25,7 @@
  */
 #ifndef FILTER_H_
 #define FILTER_H_
+#include <stdbool.h>
 #include <stdint.h>
 #include "math.h"
 
@@ -47,6 +48,90 @@ void lpf2pSetCutoffFreq(lpf2pData* lpfData, float sample_freq, float cutoff_freq
 float lpf2pApply(lpf2pData* lpfData, float sample);
 float lpf2pReset(lpf2pData* lpfData, float sample);
 
+/**
+ * 2-Pole notch filter, uses the same data structure as the low pass filter and
+ * is applied with lpf2pApply().
+ *
+ * notch2pSetCenterFreq() keeps the filter state and can be called while the
+ * filter is running, to track a moving center frequency.
+ */
+void notch2pInit(lpf2pData* notchData, float sample_freq, float center_freq, float q);
+void notch2pSetCenterFreq(lpf2pData* notchData, float sample_freq, float center_freq, float q);
+
+/**
+ * Multi channel biquad filter. Filters one sample of each channel per call,
+ * in one pass over all channels. Each channel has its own coefficients, but
+ * the filters are typically designed with lpf2pSetCutoffFreq() or
+ * notch2pSetCenterFreq() and shared by all channels, for instance the three
+ * axes of the gyro.
+ *
+ * The filter uses the transposed direct form II. Coefficients and state are
+ * stored channel by channel for each term, which lets the compiler keep the
+ * channels in separate registers and interleave their multiply-accumulate
+ * chains in the FPU pipeline. The Cortex-M4 has no SIMD instructions for
+ * floats, so this is as vectorized as a float filter gets on the target.
+ */
+#define BIQUAD_N_MAX_CHANNELS 4
+
+typedef struct {
+  uint8_t channels;
+  float b0[BIQUAD_N_MAX_CHANNELS];
+  float b1[BIQUAD_N_MAX_CHANNELS];
+  float b2[BIQUAD_N_MAX_CHANNELS];
+  float a1[BIQUAD_N_MAX_CHANNELS];
+  float a2[BIQUAD_N_MAX_CHANNELS];
+  float s1[BIQUAD_N_MAX_CHANNELS];
+  float s2[BIQUAD_N_MAX_CHANNELS];
+} biquadNData;
+
+/**
+ * Initialize all channels to pass the signal through unfiltered, with zero state.
+ */
+void biquadNInit(biquadNData* data, uint8_t channels);
+/**
+ * Initialize all channels as the 2-pole low pass filter of lpf2pInit(), with zero state.
+ */
+void biquadNInitLpf(biquadNData* data, uint8_t channels, float sample_freq, float cutoff_freq);
+/**
+ * Copy the coefficients of a filter designed with the lpf2p/notch2p
+ * functions to one channel. The state of the channel is kept.
+ */
+void biquadNSetCoeffs(biquadNData* data, uint8_t channel, const lpf2pData* design);
+/**
+ * Set the state of one channel to the steady state for a constant output
+ * value. Assumes a filter with unity DC gain.
+ */
+void biquadNReset(biquadNData* data, uint8_t channel, float value);
+/**
+ * Filter one sample per channel, in place.
+ */
+void biquadNApply(biquadNData* data, float* values);
+
+/**
+ * Dynamic notch filter bank, one notch per motor and axis. The center
+ * frequencies follow the motor speeds to remove motor vibrations from for
+ * instance gyro data, without the phase lag of a low cutoff frequency.
+ */
+#define DYN_NOTCH_MAX_MOTORS  4
+#define DYN_NOTCH_AXES        3
+
+typedef struct {
+  biquadNData notch[DYN_NOTCH_MAX_MOTORS]; // one channel per axis
+  float centerFreq[DYN_NOTCH_MAX_MOTORS]; // Hz, 0 when the notch is inactive
+  bool isStarting[DYN_NOTCH_MAX_MOTORS];  // the filter state is initialized from the next sample
+  float sampleFreq;
+  float q;
+  float minFreq;
+} dynNotchData;
+
+void dynNotchInit(dynNotchData* notchData, float sample_freq, float q, float min_freq);
+/**
+ * Set the center frequency of the notch of one motor. The notch is
+ * inactive when the frequency is below the minimum frequency.
+ */
+void dynNotchSetFreq(dynNotchData* notchData, uint8_t motor, float freq);
+void dynNotchApply(dynNotchData* notchData, float values[DYN_NOTCH_AXES]);
+
 /** Second order low pass filter structure.
  *
  * using biquad filter with bilinear z transform
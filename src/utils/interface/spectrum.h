@@ -0,0 +1,74 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * spectrum.h - Helpers for analyzing magnitude spectra
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+typedef struct {
+  // Interpolated position of the peak, in bins
+  float bin;
+  float magnitude;
+} spectrumPeak_t;
+
+/**
+ * @brief Fill a Hann window, normalized to unity coherent gain
+ *
+ * With the normalization the magnitude of a windowed sine wave of amplitude A
+ * is A * n / 2 in its bin, the same as for the unwindowed signal.
+ *
+ * @param window The window to fill
+ * @param n Length of the window
+ */
+void spectrumHannWindow(float* window, const uint16_t n);
+
+/**
+ * @brief Find the largest local maxima of a magnitude spectrum
+ *
+ * The position of each peak is refined with a parabolic fit through the peak
+ * bin and its two neighbours. The peaks are sorted by magnitude, largest first.
+ *
+ * @param magnitude The magnitude spectrum
+ * @param bins Number of bins in the spectrum
+ * @param minBin Bins below this index are ignored, used to skip DC and slow motion
+ * @param peaks Output, the peaks found
+ * @param maxPeaks Max number of peaks to find
+ * @return The number of peaks found
+ */
+uint8_t spectrumFindPeaks(const float* magnitude, const uint16_t bins, const uint16_t minBin, spectrumPeak_t* peaks, const uint8_t maxPeaks);
+
+/**
+ * @brief Reduce the number of bins of a spectrum, keeping the max of each group of bins
+ *
+ * Keeping the max instead of the mean makes sure narrow peaks are not
+ * smeared out.
+ *
+ * @param magnitude The magnitude spectrum
+ * @param bins Number of bins in the spectrum, must be a multiple of outBins
+ * @param out The decimated spectrum
+ * @param outBins Number of bins in the decimated spectrum
+ */
+void spectrumDecimate(const float* magnitude, const uint16_t bins, float* out, const uint16_t outBins);
@@ -0,0 +1,126 @@
+#ifndef __TDOA3_RX_BATCH_H__
+#define __TDOA3_RX_BATCH_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "tdoaEngine.h"
+#include "autoconf.h"
+
+/*
+Batched processing of received TDoA3 packets.
+
+The radio event path only copies received packets into a small buffer
+(tdoa3RxBatchAdd()). The packets are processed later, a batch at a time, by
+tdoa3RxBatchProcess(): remote anchor data is written to the storage, the clock
+correction is updated and TDoA measurements are emitted through the engine.
+The packets are processed in the order they were received, with the system
+time of reception, which gives the same result as processing each packet
+directly when it is received.
+*/
+
+#define PACKET_TYPE_TDOA3 0x30
+
+// Max number of packets in a batch
+#ifdef CONFIG_DECK_LOCO_TDOA3_RX_BATCH
+#define TDOA3_RX_BATCH_SIZE CONFIG_DECK_LOCO_TDOA3_RX_BATCH
+#else
+#define TDOA3_RX_BATCH_SIZE 4
+#endif
+
+// Max time a packet is kept in the buffer before the batch is processed
+#define TDOA3_RX_BATCH_MAX_AGE_MS 5
+
+// Max payload length, same as in packet_t
+#define TDOA3_RX_MAX_PAYLOAD 128
+
+typedef struct {
+  uint8_t type;
+  uint8_t seq;
+  uint32_t txTimeStamp;
+  uint8_t remoteCount;
+} __attribute__((packed)) rangePacketHeader3_t;
+
+typedef struct {
+  uint8_t id;
+  uint8_t seq;
+  uint32_t rxTimeStamp;
+  uint16_t distance;
+} __attribute__((packed)) remoteAnchorDataFull_t;
+
+typedef struct {
+  uint8_t id;
+  uint8_t seq;
+  uint32_t rxTimeStamp;
+} __attribute__((packed)) remoteAnchorDataShort_t;
+
+typedef struct {
+  rangePacketHeader3_t header;
+  uint8_t remoteAnchorData;
+} __attribute__((packed)) rangePacket3_t;
+
+typedef struct {
+  int64_t rxTime; // Receive time of the packet, in local DWM clock
+  uint32_t rxTime_ms; // System time when the packet was received
+  uint8_t anchorId;
+  uint8_t payloadLength;
+  uint8_t payload[TDOA3_RX_MAX_PAYLOAD];
+} tdoa3RxPacket_t;
+
+typedef struct {
+  tdoa3RxPacket_t packets[TDOA3_RX_BATCH_SIZE];
+  uint8_t count;
+} tdoa3RxBatch_t;
+
+/**
+ * @brief Called for each processed packet, after the storage and the engine have been updated
+ *
+ * @param anchorCtx The context of the anchor that sent the packet
+ * @param packet The packet
+ * @param rangeDataLength Length of the range data in the payload, LPP data follows
+ * @param timeIsGood True if the clock correction of the anchor is reliable
+ */
+typedef void (*tdoa3RxPacketHandler_t)(tdoaAnchorContext_t* anchorCtx, const tdoa3RxPacket_t* packet, const int rangeDataLength, const bool timeIsGood);
+
+void tdoa3RxBatchInit(tdoa3RxBatch_t* batch);
+
+/**
+ * @brief Copy a received TDoA3 packet to the batch
+ *
+ * @param batch The batch
+ * @param anchorId Id of the sending anchor
+ * @param payload The payload, starting with the TDoA3 range packet header
+ * @param payloadLength Length of the payload
+ * @param rxTime Receive time, in local DWM clock
+ * @param rxTime_ms System time when the packet was received
+ * @return false if the packet was dropped, the batch is full or the payload is too long
+ */
+bool tdoa3RxBatchAdd(tdoa3RxBatch_t* batch, const uint8_t anchorId, const uint8_t* payload, const int payloadLength, const int64_t rxTime, const uint32_t rxTime_ms);
+
+/**
+ * @brief Time until the batch must be processed
+ *
+ * @return 0 if the batch is full or the oldest packet has reached the max age, UINT32_MAX if the batch is empty
+ */
+uint32_t tdoa3RxBatchTimeToDeadline(const tdoa3RxBatch_t* batch, const uint32_t now_ms);
+
+/**
+ * @brief Process all packets in the batch, in the order they were received, and empty it
+ *
+ * @param batch The batch
+ * @param engineState The TDoA engine, TDoA measurements are sent through its callback
+ * @param doExcludeId If true, remote data from excludedId is not used for TDoA measurements
+ * @param excludedId The id to exclude
+ * @param handler Called for each packet, may be 0
+ * @return the number of processed packets
+ */
+int tdoa3RxBatchProcess(tdoa3RxBatch_t* batch, tdoaEngineState_t* engineState, const bool doExcludeId, const uint8_t excludedId, tdoa3RxPacketHandler_t handler);
+
+/**
+ * @brief Process one packet directly
+ *
+ * @return the length of the range data in the payload
+ */
+int tdoa3RxProcessPacket(tdoaEngineState_t* engineState, const tdoa3RxPacket_t* packet, const bool doExcludeId, const uint8_t excludedId, tdoa3RxPacketHandler_t handler);
+
+#endif // __TDOA3_RX_BATCH_H__
@@ -0,0 +1,117 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * tokenize.h - Tokenized format strings with binary arguments
+ */
+
+/**
+ * A tokenized message is sent as the token of its format string followed by
+ * the raw arguments, instead of formatted text. The format strings are placed
+ * in the .console_tokens section, which is not loaded to flash. The token is
+ * the offset of the string in the section, a host tool reads the strings from
+ * the ELF file and formats the messages.
+ *
+ * Message encoding:
+ *   token                      unsigned varint
+ *   for each argument:
+ *     integer (32 or 64 bit)   zigzag encoded varint
+ *     float or double          32 bit float, little endian
+ *     string                   characters, 0 terminated
+ *
+ * The argument types are found at compile time and passed as a 32 bit word
+ * with 4 bits per argument, first argument in the lowest bits. A message can
+ * have at most TOKENIZE_MAX_ARGS arguments.
+ */
+
+#pragma once
+
+#include <stdarg.h>
+#include <stdint.h>
+
+#define TOKENIZE_SECTION ".console_tokens"
+#define TOKENIZE_MAX_ARGS 8
+
+#define TOKENIZE_ARG_END 0
+#define TOKENIZE_ARG_INT32 1
+#define TOKENIZE_ARG_INT64 2
+#define TOKENIZE_ARG_DOUBLE 3
+#define TOKENIZE_ARG_STRING 4
+
+/**
+ * @brief The token of a format string literal
+ *
+ * The string is placed in the non-loaded token section and the expression
+ * evaluates to its offset in the section.
+ */
+#define TOKENIZE_STRING(FMT) ({ \
+  static const char __attribute__((section(TOKENIZE_SECTION), used, aligned(1))) _tokenizedFmt[] = FMT; \
+  (uint32_t)(uintptr_t)_tokenizedFmt; })
+
+/**
+ * @brief The type of one argument, after the default argument promotions
+ */
+#define TOKENIZE_ARG_TYPE(ARG) _Generic((ARG), \
+  float: TOKENIZE_ARG_DOUBLE, \
+  double: TOKENIZE_ARG_DOUBLE, \
+  char*: TOKENIZE_ARG_STRING, \
+  const char*: TOKENIZE_ARG_STRING, \
+  default: (sizeof((ARG) + 0) > 4 ? TOKENIZE_ARG_INT64 : TOKENIZE_ARG_INT32))
+
+#define _TOKENIZE_ARG_COUNT(_0, _1, _2, _3, _4, _5, _6, _7, _8, N, ...) N
+#define _TOKENIZE_CONCAT(A, B) _TOKENIZE_CONCAT_(A, B)
+#define _TOKENIZE_CONCAT_(A, B) A ## B
+
+#define _TOKENIZE_T(ARG, I) ((uint32_t)TOKENIZE_ARG_TYPE(ARG) << (4 * (I)))
+#define _TOKENIZE_TYPES_0() 0
+#define _TOKENIZE_TYPES_1(a) _TOKENIZE_T(a, 0)
+#define _TOKENIZE_TYPES_2(a, b) (_TOKENIZE_TYPES_1(a) | _TOKENIZE_T(b, 1))
+#define _TOKENIZE_TYPES_3(a, b, c) (_TOKENIZE_TYPES_2(a, b) | _TOKENIZE_T(c, 2))
+#define _TOKENIZE_TYPES_4(a, b, c, d) (_TOKENIZE_TYPES_3(a, b, c) | _TOKENIZE_T(d, 3))
+#define _TOKENIZE_TYPES_5(a, b, c, d, e) (_TOKENIZE_TYPES_4(a, b, c, d) | _TOKENIZE_T(e, 4))
+#define _TOKENIZE_TYPES_6(a, b, c, d, e, f) (_TOKENIZE_TYPES_5(a, b, c, d, e) | _TOKENIZE_T(f, 5))
+#define _TOKENIZE_TYPES_7(a, b, c, d, e, f, g) (_TOKENIZE_TYPES_6(a, b, c, d, e, f) | _TOKENIZE_T(g, 6))
+#define _TOKENIZE_TYPES_8(a, b, c, d, e, f, g, h) (_TOKENIZE_TYPES_7(a, b, c, d, e, f, g) | _TOKENIZE_T(h, 7))
+
+/**
+ * @brief Number of arguments, 0 to TOKENIZE_MAX_ARGS
+ */
+#define TOKENIZE_ARG_COUNT(...) _TOKENIZE_ARG_COUNT(0 __VA_OPT__(,) __VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+
+/**
+ * @brief The types of the arguments as a compile time constant, 4 bits per argument
+ */
+#define TOKENIZE_ARG_TYPES(...) _TOKENIZE_CONCAT(_TOKENIZE_TYPES_, TOKENIZE_ARG_COUNT(__VA_ARGS__))(__VA_ARGS__)
+
+/**
+ * @brief Encode a message
+ *
+ * Arguments that do not fit in the buffer are left out, strings are truncated.
+ *
+ * @param buffer Output buffer
+ * @param size Size of the buffer
+ * @param token Token of the format string
+ * @param argTypes Argument types from TOKENIZE_ARG_TYPES()
+ * @param ap The arguments
+ * @return the length of the encoded message
+ */
+int tokenizeEncode(uint8_t* buffer, const int size, const uint32_t token, const uint32_t argTypes, va_list ap);
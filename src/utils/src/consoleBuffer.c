@@ -0,0 +1,168 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * consoleBuffer.c - Buffers for the console, a ring of packets and a lock free staging buffer
+ */
+
+#include <string.h>
+
+#include "consoleBuffer.h"
+
+#define CONSOLE_BUFFER_STAGING_VALID 0x100
+
+static const char bufferFullMsg[] = "<F>\n";
+
+static bool hasOpenPacket(const consoleBufferRing_t* ring) {
+  return (ring->head - ring->tail) < CONSOLE_BUFFER_PACKETS;
+}
+
+static consoleBufferPacket_t* openPacket(consoleBufferRing_t* ring) {
+  return &ring->packets[ring->head % CONSOLE_BUFFER_PACKETS];
+}
+
+static bool append(consoleBufferRing_t* ring, const char ch) {
+  consoleBufferPacket_t* packet = openPacket(ring);
+  packet->data[packet->size] = (uint8_t)ch;
+  packet->size++;
+
+  if (ch == '\n' || packet->size >= CONSOLE_BUFFER_PAYLOAD_SIZE) {
+    ring->head++;
+    return true;
+  }
+
+  return false;
+}
+
+static bool addBufferFullMarker(consoleBufferRing_t* ring) {
+  // The marker is written to a packet of its own, the text before it has been sent or is in closed packets
+  bool closed = consoleBufferRingClose(ring);
+  if (!hasOpenPacket(ring)) {
+    return closed;
+  }
+
+  consoleBufferPacket_t* packet = openPacket(ring);
+  memcpy(packet->data, bufferFullMsg, sizeof(bufferFullMsg) - 1);
+  packet->size = sizeof(bufferFullMsg) - 1;
+  ring->head++;
+  ring->overflow = false;
+  return true;
+}
+
+void consoleBufferRingInit(consoleBufferRing_t* ring) {
+  memset(ring, 0, sizeof(*ring));
+}
+
+bool consoleBufferRingPutchar(consoleBufferRing_t* ring, const char ch) {
+  bool closed = false;
+
+  if (ring->overflow && hasOpenPacket(ring)) {
+    closed = addBufferFullMarker(ring);
+  }
+
+  if (!hasOpenPacket(ring)) {
+    ring->overflow = true;
+    return closed;
+  }
+
+  return append(ring, ch) || closed;
+}
+
+bool consoleBufferRingClose(consoleBufferRing_t* ring) {
+  if (!hasOpenPacket(ring) || openPacket(ring)->size == 0) {
+    return false;
+  }
+
+  ring->head++;
+  return true;
+}
+
+const consoleBufferPacket_t* consoleBufferRingFront(const consoleBufferRing_t* ring) {
+  if (ring->head == ring->tail) {
+    return 0;
+  }
+
+  return &ring->packets[ring->tail % CONSOLE_BUFFER_PACKETS];
+}
+
+void consoleBufferRingPop(consoleBufferRing_t* ring) {
+  if (ring->head == ring->tail) {
+    return;
+  }
+
+  // The slot is reused as an open packet
+  ring->packets[ring->tail % CONSOLE_BUFFER_PACKETS].size = 0;
+  ring->tail++;
+}
+
+uint32_t consoleBufferRingCount(const consoleBufferRing_t* ring) {
+  return ring->head - ring->tail;
+}
+
+void consoleBufferStagingInit(consoleBufferStaging_t* staging) {
+  memset(staging, 0, sizeof(*staging));
+}
+
+bool consoleBufferStagingPut(consoleBufferStaging_t* staging, const char ch) {
+  // Reserve a cell, an interrupt with higher priority may reserve the next one before this one is written
+  uint32_t head = __atomic_load_n(&staging->head, __ATOMIC_RELAXED);
+  do {
+    const uint32_t tail = __atomic_load_n(&staging->tail, __ATOMIC_ACQUIRE);
+    if (head - tail >= CONSOLE_BUFFER_STAGING_SIZE) {
+      __atomic_fetch_add(&staging->dropped, 1, __ATOMIC_RELAXED);
+      return false;
+    }
+  } while (!__atomic_compare_exchange_n(&staging->head, &head, head + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+  const uint16_t cell = CONSOLE_BUFFER_STAGING_VALID | (uint8_t)ch;
+  __atomic_store_n(&staging->cells[head & (CONSOLE_BUFFER_STAGING_SIZE - 1)], cell, __ATOMIC_RELEASE);
+  return true;
+}
+
+bool consoleBufferStagingDrain(consoleBufferStaging_t* staging, consoleBufferRing_t* ring) {
+  bool closed = false;
+
+  // Stops at the first reserved cell that has not been written yet, the rest is moved next time
+  uint32_t tail = staging->tail;
+  while (true) {
+    uint16_t* cell = &staging->cells[tail & (CONSOLE_BUFFER_STAGING_SIZE - 1)];
+    const uint16_t value = __atomic_load_n(cell, __ATOMIC_ACQUIRE);
+    if ((value & CONSOLE_BUFFER_STAGING_VALID) == 0) {
+      break;
+    }
+
+    closed |= consoleBufferRingPutchar(ring, (char)(value & 0xff));
+
+    __atomic_store_n(cell, 0, __ATOMIC_RELAXED);
+    tail++;
+    __atomic_store_n(&staging->tail, tail, __ATOMIC_RELEASE);
+  }
+
+  if (__atomic_exchange_n(&staging->dropped, 0, __ATOMIC_RELAXED) > 0) {
+    ring->overflow = true;
+    if (hasOpenPacket(ring)) {
+      closed |= addBufferFullMarker(ring);
+    }
+  }
+
+  return closed;
+}
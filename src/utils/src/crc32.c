@@ -71,8 +71,25 @@
 #include "crc32.h"
 
 #include <stdbool.h>
+#include <string.h>
 
 #include "static_mem.h"
+#include "autoconf.h"
+
+#if defined(CONFIG_CRC32_HARDWARE) && !defined(UNIT_TEST_MODE)
+  #define CRC32_USE_HARDWARE
+  #include "stm32fxxx.h"
+  #include "FreeRTOS.h"
+  #include "task.h"
+#endif
+
+#if defined(CONFIG_CRC32_BYTEWISE) || defined(CRC32_USE_HARDWARE)
+  #define CRC32_SLICES 1
+#elif defined(CONFIG_CRC32_SLICING_BY_8)
+  #define CRC32_SLICES 8
+#else
+  #define CRC32_SLICES 4
+#endif
 
 #define POLYNOMIAL              0xEDB88320
 #define CHECK_VALUE             0xCBF43926
@@ -80,14 +97,28 @@
 #define FINAL_XOR_VALUE         0xFFFFFFFF
 #define RESIDUE                 0xDEBB20e3
 
+// Polynomial in the non reflected form used by the STM32 CRC unit
+#define POLYNOMIAL_NORMAL       0x04C11DB7
+// Max number of words fed to the CRC unit in one critical section
+#define HW_CHUNK_WORDS          64
+
 // Internal functions
 static uint32_t crcByByte(const uint8_t* message, uint32_t bytesToProcess,
               uint32_t remainder, uint32_t* crcTable);
-static uint32_t crcByByte(const uint8_t* message, uint32_t bytesToProcess,
+#if CRC32_SLICES == 4
+static uint32_t crcBySlice4(const uint8_t* message, uint32_t bytesToProcess,
+              uint32_t remainder, uint32_t (*crcTable)[256]);
+#elif CRC32_SLICES == 8
+static uint32_t crcBySlice8(const uint8_t* message, uint32_t bytesToProcess,
+              uint32_t remainder, uint32_t (*crcTable)[256]);
+#endif
+#ifdef CRC32_USE_HARDWARE
+static uint32_t crcByHardware(const uint8_t* message, uint32_t bytesToProcess,
               uint32_t remainder, uint32_t* crcTable);
-static void crcTableInit(uint32_t* crcTable);
+#endif
+static void crcTableInit(uint32_t (*crcTable)[256]);
 
-NO_DMA_CCM_SAFE_ZERO_INIT static uint32_t crcTable[256];
+NO_DMA_CCM_SAFE_ZERO_INIT static uint32_t crcTable[CRC32_SLICES][256];
 static bool crcTableInitialized = false;
 
 // *** Public API ***
@@ -98,6 +129,9 @@ void crc32ContextInit(crc32Context_t *context)
   if (crcTableInitialized == false) {
     // initialize crcTable
     crcTableInit(crcTable);
+#ifdef CRC32_USE_HARDWARE
+    RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_CRC, ENABLE);
+#endif
     crcTableInitialized = true;
   }
 
@@ -106,7 +140,15 @@ void crc32ContextInit(crc32Context_t *context)
 
 void crc32Update(crc32Context_t *context, const void* data, size_t size)
 {
-  context->remainder = crcByByte(data, size, context->remainder, crcTable);
+#if defined(CRC32_USE_HARDWARE)
+  context->remainder = crcByHardware(data, size, context->remainder, crcTable[0]);
+#elif CRC32_SLICES == 8
+  context->remainder = crcBySlice8(data, size, context->remainder, crcTable);
+#elif CRC32_SLICES == 4
+  context->remainder = crcBySlice4(data, size, context->remainder, crcTable);
+#else
+  context->remainder = crcByByte(data, size, context->remainder, crcTable[0]);
+#endif
 }
 
 uint32_t crc32Out(const crc32Context_t *context)
@@ -153,7 +195,7 @@ static uint32_t crcByByte(const uint8_t* message, uint32_t bytesToProcess,
               uint32_t remainder, uint32_t* crcTable)
 {
   uint8_t data;
-  for (int byte = 0; byte < bytesToProcess; ++byte)
+  for (uint32_t byte = 0; byte < bytesToProcess; ++byte)
     {
       data = (*(message+byte) ^ remainder);
       remainder = *(crcTable+data) ^ (remainder >> 8);
@@ -161,13 +203,131 @@ static uint32_t crcByByte(const uint8_t* message, uint32_t bytesToProcess,
   return remainder;
 }
 
-/* creates a lookup-table which is necessary for the crcByByte function */
-static void crcTableInit(uint32_t* crcTable)
+/* creates a lookup-table which is necessary for the crcByByte function.
+ * Table n (n > 0) holds the remainder of a byte followed by n zero bytes and
+ * is used by the slicing functions to process several bytes per iteration */
+static void crcTableInit(uint32_t (*crcTable)[256])
 {
   uint8_t dividend = ~0;
   /* fill the table by bit-wise calculations of checksums
    * for each possible dividend */
   do {
-      *(crcTable+dividend) = crcByBit(&dividend, 1, 0);
+      crcTable[0][dividend] = crcByBit(&dividend, 1, 0);
   } while(dividend-- > 0);
+
+  for (int slice = 1; slice < CRC32_SLICES; slice++) {
+    for (int i = 0; i < 256; i++) {
+      const uint32_t previous = crcTable[slice - 1][i];
+      crcTable[slice][i] = (previous >> 8) ^ crcTable[0][previous & 0xff];
+    }
+  }
+}
+
+/* Reads a little endian word, the compiler turns this into a single
+ * (possibly unaligned) load on the Cortex-M4 */
+static inline uint32_t readWord(const uint8_t* message)
+{
+  uint32_t word;
+  memcpy(&word, message, sizeof(word));
+  return word;
+}
+
+#if CRC32_SLICES == 4
+/* slicing-by-4 crc calculation, processes one 32 bit word per iteration
+ * using four lookup tables. Requires a little endian target */
+static uint32_t crcBySlice4(const uint8_t* message, uint32_t bytesToProcess,
+              uint32_t remainder, uint32_t (*crcTable)[256])
+{
+  while (bytesToProcess >= 4)
+    {
+      const uint32_t word = readWord(message) ^ remainder;
+      remainder = crcTable[3][word & 0xff] ^
+                  crcTable[2][(word >> 8) & 0xff] ^
+                  crcTable[1][(word >> 16) & 0xff] ^
+                  crcTable[0][word >> 24];
+      message += 4;
+      bytesToProcess -= 4;
+    }
+
+  return crcByByte(message, bytesToProcess, remainder, crcTable[0]);
+}
+#endif
+
+#if CRC32_SLICES == 8
+/* slicing-by-8 crc calculation, processes two 32 bit words per iteration
+ * using eight lookup tables. Requires a little endian target */
+static uint32_t crcBySlice8(const uint8_t* message, uint32_t bytesToProcess,
+              uint32_t remainder, uint32_t (*crcTable)[256])
+{
+  while (bytesToProcess >= 8)
+    {
+      const uint32_t one = readWord(message) ^ remainder;
+      const uint32_t two = readWord(message + 4);
+      remainder = crcTable[7][one & 0xff] ^
+                  crcTable[6][(one >> 8) & 0xff] ^
+                  crcTable[5][(one >> 16) & 0xff] ^
+                  crcTable[4][one >> 24] ^
+                  crcTable[3][two & 0xff] ^
+                  crcTable[2][(two >> 8) & 0xff] ^
+                  crcTable[1][(two >> 16) & 0xff] ^
+                  crcTable[0][two >> 24];
+      message += 8;
+      bytesToProcess -= 8;
+    }
+
+  return crcByByte(message, bytesToProcess, remainder, crcTable[0]);
+}
+#endif
+
+#ifdef CRC32_USE_HARDWARE
+/* Runs the non reflected CRC register backwards by 32 bits. Used to find the
+ * word that brings the CRC unit from its reset value to a given remainder. */
+static uint32_t crcHardwareUnshift(uint32_t value)
+{
+  for (int bit = 0; bit < 32; bit++)
+    {
+      if (value & 1)
+        value = ((value ^ POLYNOMIAL_NORMAL) >> 1) | 0x80000000;
+      else
+        value = value >> 1;
+    }
+  return value;
+}
+
+/* crc calculation using the STM32 CRC unit. The unit implements the non
+ * reflected CRC-32 (MPEG-2) on 32 bit words, the reflection of the zlib
+ * algorithm is handled by bit reversing both the words fed to the unit and
+ * the result read back. The unit can not be loaded with a start value, instead
+ * it is reset and seeded with a word that produces the current remainder.
+ * The unit is shared, words are fed in short chunks in critical sections to
+ * keep the interrupt latency low. Bytes not filling a word are handled by the
+ * table based algorithm. */
+static uint32_t crcByHardware(const uint8_t* message, uint32_t bytesToProcess,
+              uint32_t remainder, uint32_t* crcTable)
+{
+  while (bytesToProcess >= 4)
+    {
+      uint32_t words = bytesToProcess / 4;
+      if (words > HW_CHUNK_WORDS) {
+        words = HW_CHUNK_WORDS;
+      }
+
+      const uint32_t seed = crcHardwareUnshift(__RBIT(remainder)) ^ INITIAL_REMAINDER;
+
+      taskENTER_CRITICAL();
+      CRC->CR = CRC_CR_RESET;
+      CRC->DR = seed;
+      for (uint32_t i = 0; i < words; i++)
+        {
+          CRC->DR = __RBIT(readWord(message + i * 4));
+        }
+      remainder = __RBIT(CRC->DR);
+      taskEXIT_CRITICAL();
+
+      message += words * 4;
+      bytesToProcess -= words * 4;
+    }
+
+  return crcByByte(message, bytesToProcess, remainder, crcTable);
 }
+#endif
@@ -26,6 +26,7 @@
 
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "filter.h"
 #include "physicalConstants.h"
@@ -107,3 +108,176 @@ float lpf2pReset(lpf2pData* lpfData, float sample)
   lpfData->delay_element_2 = dval;
   return lpf2pApply(lpfData, sample);
 }
+
+/**
+ * sin and cos for 0 <= x <= pi, with an error below 2e-4. Much cheaper than
+ * sinf() and cosf(), to make it possible to update notch filters at the
+ * sample rate.
+ */
+static float sinHalfPi(float x)
+{
+  // Taylor series, -pi/2 <= x <= pi/2
+  float x2 = x * x;
+  return x * (1.0f - x2 / 6.0f * (1.0f - x2 / 20.0f * (1.0f - x2 / 42.0f)));
+}
+
+static void fastSinCos(float x, float* s, float* c)
+{
+  *s = sinHalfPi(x > M_PI_F / 2.0f ? M_PI_F - x : x);
+  *c = sinHalfPi(M_PI_F / 2.0f - x);
+}
+
+/**
+ * 2-Pole notch filter
+ */
+void notch2pInit(lpf2pData* notchData, float sample_freq, float center_freq, float q)
+{
+  if (notchData == NULL || center_freq <= 0.0f) {
+    return;
+  }
+
+  notch2pSetCenterFreq(notchData, sample_freq, center_freq, q);
+  notchData->delay_element_1 = 0.0f;
+  notchData->delay_element_2 = 0.0f;
+}
+
+void notch2pSetCenterFreq(lpf2pData* notchData, float sample_freq, float center_freq, float q)
+{
+  float sinOmega;
+  float cosOmega;
+  fastSinCos(2.0f * M_PI_F * center_freq / sample_freq, &sinOmega, &cosOmega);
+
+  float alpha = sinOmega / (2.0f * q);
+  float a0Inv = 1.0f / (1.0f + alpha);
+  notchData->b0 = a0Inv;
+  notchData->b1 = -2.0f * cosOmega * a0Inv;
+  notchData->b2 = a0Inv;
+  notchData->a1 = notchData->b1;
+  notchData->a2 = (1.0f - alpha) * a0Inv;
+}
+
+/**
+ * Multi channel biquad filter
+ */
+void biquadNInit(biquadNData* data, uint8_t channels)
+{
+  memset(data, 0, sizeof(biquadNData));
+  data->channels = channels < BIQUAD_N_MAX_CHANNELS ? channels : BIQUAD_N_MAX_CHANNELS;
+  for (uint8_t i = 0; i < data->channels; i++) {
+    data->b0[i] = 1.0f;
+  }
+}
+
+void biquadNInitLpf(biquadNData* data, uint8_t channels, float sample_freq, float cutoff_freq)
+{
+  lpf2pData design;
+  lpf2pSetCutoffFreq(&design, sample_freq, cutoff_freq);
+
+  biquadNInit(data, channels);
+  for (uint8_t i = 0; i < data->channels; i++) {
+    biquadNSetCoeffs(data, i, &design);
+  }
+}
+
+void biquadNSetCoeffs(biquadNData* data, uint8_t channel, const lpf2pData* design)
+{
+  if (channel >= data->channels) {
+    return;
+  }
+
+  data->b0[channel] = design->b0;
+  data->b1[channel] = design->b1;
+  data->b2[channel] = design->b2;
+  data->a1[channel] = design->a1;
+  data->a2[channel] = design->a2;
+}
+
+void biquadNReset(biquadNData* data, uint8_t channel, float value)
+{
+  if (channel >= data->channels) {
+    return;
+  }
+
+  // Constant input and output equal to value
+  data->s2[channel] = (data->b2[channel] - data->a2[channel]) * value;
+  data->s1[channel] = (data->b1[channel] - data->a1[channel]) * value + data->s2[channel];
+}
+
+void biquadNApply(biquadNData* data, float* values)
+{
+  for (uint8_t i = 0; i < data->channels; i++) {
+    const float x = values[i];
+    float y = data->b0[i] * x + data->s1[i];
+    if (!isfinite(y)) {
+      // don't allow bad values to propagate via the filter
+      biquadNReset(data, i, x);
+      y = x;
+    }
+
+    data->s1[i] = data->b1[i] * x - data->a1[i] * y + data->s2[i];
+    data->s2[i] = data->b2[i] * x - data->a2[i] * y;
+    values[i] = y;
+  }
+}
+
+/**
+ * Dynamic notch filter bank
+ */
+void dynNotchInit(dynNotchData* notchData, float sample_freq, float q, float min_freq)
+{
+  memset(notchData, 0, sizeof(dynNotchData));
+  for (int motor = 0; motor < DYN_NOTCH_MAX_MOTORS; motor++) {
+    biquadNInit(&notchData->notch[motor], DYN_NOTCH_AXES);
+  }
+  notchData->sampleFreq = sample_freq;
+  notchData->q = q;
+  notchData->minFreq = min_freq;
+}
+
+void dynNotchSetFreq(dynNotchData* notchData, uint8_t motor, float freq)
+{
+  if (motor >= DYN_NOTCH_MAX_MOTORS) {
+    return;
+  }
+
+  if (freq < notchData->minFreq) {
+    notchData->centerFreq[motor] = 0.0f;
+    notchData->isStarting[motor] = false;
+    return;
+  }
+
+  // Stay clear of the Nyquist frequency
+  const float maxFreq = 0.45f * notchData->sampleFreq;
+  if (freq > maxFreq) {
+    freq = maxFreq;
+  }
+
+  const bool wasActive = notchData->centerFreq[motor] > 0.0f;
+  notchData->centerFreq[motor] = freq;
+
+  // All axes use the same coefficients
+  lpf2pData design;
+  notch2pSetCenterFreq(&design, notchData->sampleFreq, freq, notchData->q);
+  for (uint8_t axis = 0; axis < DYN_NOTCH_AXES; axis++) {
+    biquadNSetCoeffs(&notchData->notch[motor], axis, &design);
+  }
+
+  if (!wasActive) {
+    notchData->isStarting[motor] = true;
+  }
+}
+
+void dynNotchApply(dynNotchData* notchData, float values[DYN_NOTCH_AXES])
+{
+  for (int motor = 0; motor < DYN_NOTCH_MAX_MOTORS; motor++) {
+    if (notchData->isStarting[motor]) {
+      // Start in steady state to avoid a transient
+      for (uint8_t axis = 0; axis < DYN_NOTCH_AXES; axis++) {
+        biquadNReset(&notchData->notch[motor], axis, values[axis]);
+      }
+      notchData->isStarting[motor] = false;
+    } else if (notchData->centerFreq[motor] > 0.0f) {
+      biquadNApply(&notchData->notch[motor], values);
+    }
+  }
+}
@@ -0,0 +1,96 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * spectrum.c - Helpers for analyzing magnitude spectra
+ */
+
+#include <math.h>
+
+#include "spectrum.h"
+#include "physicalConstants.h"
+
+void spectrumHannWindow(float* window, const uint16_t n) {
+  // The mean of the Hann window is 0.5, scale by 2 for unity coherent gain
+  for (uint16_t i = 0; i < n; i++) {
+    window[i] = 1.0f - cosf(2.0f * M_PI_F * i / n);
+  }
+}
+
+static float interpolatePeak(const float left, const float center, const float right) {
+  const float denominator = left - 2.0f * center + right;
+  if (denominator >= 0.0f) {
+    // Flat top, not a proper maximum
+    return 0.0f;
+  }
+
+  return 0.5f * (left - right) / denominator;
+}
+
+uint8_t spectrumFindPeaks(const float* magnitude, const uint16_t bins, const uint16_t minBin, spectrumPeak_t* peaks, const uint8_t maxPeaks) {
+  uint8_t count = 0;
+  const uint16_t first = minBin > 1 ? minBin : 1;
+
+  for (uint16_t i = first; i + 1 < bins; i++) {
+    const float mag = magnitude[i];
+    if (mag <= magnitude[i - 1] || mag < magnitude[i + 1]) {
+      continue;
+    }
+
+    // Insertion into the sorted list of peaks
+    uint8_t pos = count;
+    while (pos > 0 && peaks[pos - 1].magnitude < mag) {
+      pos--;
+    }
+    if (pos >= maxPeaks) {
+      continue;
+    }
+
+    const uint8_t last = (count < maxPeaks) ? count : maxPeaks - 1;
+    for (uint8_t j = last; j > pos; j--) {
+      peaks[j] = peaks[j - 1];
+    }
+    peaks[pos].bin = i + interpolatePeak(magnitude[i - 1], mag, magnitude[i + 1]);
+    peaks[pos].magnitude = mag;
+
+    if (count < maxPeaks) {
+      count++;
+    }
+  }
+
+  return count;
+}
+
+void spectrumDecimate(const float* magnitude, const uint16_t bins, float* out, const uint16_t outBins) {
+  const uint16_t factor = bins / outBins;
+
+  for (uint16_t i = 0; i < outBins; i++) {
+    const float* group = &magnitude[i * factor];
+    float max = group[0];
+    for (uint16_t j = 1; j < factor; j++) {
+      if (group[j] > max) {
+        max = group[j];
+      }
+    }
+    out[i] = max;
+  }
+}
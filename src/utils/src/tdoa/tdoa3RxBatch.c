@@ -0,0 +1,156 @@
+/*
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie firmware.
+ *
+ * Copyright 2026, Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tdoa3RxBatch.c is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tdoa3RxBatch.c. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+Batched processing of received TDoA3 packets
+
+The radio event path copies packets to the batch, which is processed when it
+is full, when the oldest packet reaches TDOA3_RX_BATCH_MAX_AGE_MS or when the
+caller needs the storage to be up to date (before transmitting in hybrid mode).
+*/
+
+#include <string.h>
+
+#include "tdoa3RxBatch.h"
+#include "tdoaStats.h"
+
+static bool isValidTimeStamp(const int64_t anchorRxTime) {
+  return anchorRxTime != 0;
+}
+
+static int updateRemoteData(tdoaEngineState_t* engineState, tdoaAnchorContext_t* anchorCtx, const tdoa3RxPacket_t* rxPacket) {
+  const rangePacket3_t* packet = (const rangePacket3_t*)rxPacket->payload;
+  const uint8_t* anchorDataPtr = &packet->remoteAnchorData;
+  const uint8_t* end = rxPacket->payload + rxPacket->payloadLength;
+
+  for (uint8_t i = 0; i < packet->header.remoteCount; i++) {
+    const remoteAnchorDataFull_t* anchorData = (const remoteAnchorDataFull_t*)anchorDataPtr;
+    if (anchorDataPtr + sizeof(remoteAnchorDataShort_t) > end) {
+      // Truncated packet
+      break;
+    }
+
+    bool hasDistance = ((anchorData->seq & 0x80) != 0);
+    size_t dataSize = hasDistance ? sizeof(remoteAnchorDataFull_t) : sizeof(remoteAnchorDataShort_t);
+    if (anchorDataPtr + dataSize > end) {
+      // Truncated packet
+      break;
+    }
+
+    uint8_t remoteId = anchorData->id;
+    int64_t remoteRxTime = anchorData->rxTimeStamp;
+    uint8_t remoteSeqNr = anchorData->seq & 0x7f;
+
+    if (isValidTimeStamp(remoteRxTime)) {
+      tdoaStorageSetRemoteRxTime(anchorCtx, remoteId, remoteRxTime, remoteSeqNr);
+    }
+
+    if (hasDistance) {
+      int64_t tof = anchorData->distance;
+      if (isValidTimeStamp(tof)) {
+        tdoaStorageSetRemoteTimeOfFlight(anchorCtx, remoteId, tof);
+
+        uint8_t anchorId = tdoaStorageGetId(anchorCtx);
+        tdoaStats_t* stats = &engineState->stats;
+        if (anchorId == stats->anchorId && remoteId == stats->remoteAnchorId) {
+          stats->tof = (uint16_t)tof;
+        }
+      }
+    }
+
+    anchorDataPtr += dataSize;
+  }
+
+  return anchorDataPtr - rxPacket->payload;
+}
+
+void tdoa3RxBatchInit(tdoa3RxBatch_t* batch) {
+  batch->count = 0;
+}
+
+bool tdoa3RxBatchAdd(tdoa3RxBatch_t* batch, const uint8_t anchorId, const uint8_t* payload, const int payloadLength, const int64_t rxTime, const uint32_t rxTime_ms) {
+  if (batch->count >= TDOA3_RX_BATCH_SIZE) {
+    return false;
+  }
+  if (payloadLength < (int)sizeof(rangePacketHeader3_t) || payloadLength > TDOA3_RX_MAX_PAYLOAD) {
+    return false;
+  }
+
+  tdoa3RxPacket_t* packet = &batch->packets[batch->count];
+  packet->rxTime = rxTime;
+  packet->rxTime_ms = rxTime_ms;
+  packet->anchorId = anchorId;
+  packet->payloadLength = payloadLength;
+  memcpy(packet->payload, payload, payloadLength);
+
+  batch->count++;
+  return true;
+}
+
+uint32_t tdoa3RxBatchTimeToDeadline(const tdoa3RxBatch_t* batch, const uint32_t now_ms) {
+  if (batch->count == 0) {
+    return UINT32_MAX;
+  }
+  if (batch->count >= TDOA3_RX_BATCH_SIZE) {
+    return 0;
+  }
+
+  const uint32_t age = now_ms - batch->packets[0].rxTime_ms;
+  if (age >= TDOA3_RX_BATCH_MAX_AGE_MS) {
+    return 0;
+  }
+
+  return TDOA3_RX_BATCH_MAX_AGE_MS - age;
+}
+
+int tdoa3RxProcessPacket(tdoaEngineState_t* engineState, const tdoa3RxPacket_t* packet, const bool doExcludeId, const uint8_t excludedId, tdoa3RxPacketHandler_t handler) {
+  const rangePacket3_t* rangePacket = (const rangePacket3_t*)packet->payload;
+  const int64_t txAn_in_cl_An = rangePacket->header.txTimeStamp;
+  const uint8_t seqNr = rangePacket->header.seq & 0x7f;
+
+  tdoaAnchorContext_t anchorCtx;
+  tdoaEngineGetAnchorCtxForPacketProcessing(engineState, packet->anchorId, packet->rxTime_ms, &anchorCtx);
+  int rangeDataLength = updateRemoteData(engineState, &anchorCtx, packet);
+
+  const bool timeIsGood = tdoaEngineProcessPacketFiltered(engineState, &anchorCtx, txAn_in_cl_An, packet->rxTime, doExcludeId, excludedId);
+  tdoaStorageSetRxTxData(&anchorCtx, packet->rxTime, txAn_in_cl_An, seqNr);
+
+  if (handler) {
+    handler(&anchorCtx, packet, rangeDataLength, timeIsGood);
+  }
+
+  return rangeDataLength;
+}
+
+int tdoa3RxBatchProcess(tdoa3RxBatch_t* batch, tdoaEngineState_t* engineState, const bool doExcludeId, const uint8_t excludedId, tdoa3RxPacketHandler_t handler) {
+  const int count = batch->count;
+  for (int i = 0; i < count; i++) {
+    tdoa3RxProcessPacket(engineState, &batch->packets[i], doExcludeId, excludedId, handler);
+  }
+
+  batch->count = 0;
+  return count;
+}
@@ -0,0 +1,104 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * tokenize.c - Tokenized format strings with binary arguments
+ */
+
+#include <string.h>
+
+#include "tokenize.h"
+
+static int encodeVarint(uint8_t* buffer, const int size, uint64_t value) {
+  int length = 0;
+  do {
+    if (length >= size) {
+      return 0;
+    }
+    uint8_t byte = value & 0x7f;
+    value >>= 7;
+    if (value) {
+      byte |= 0x80;
+    }
+    buffer[length++] = byte;
+  } while (value);
+
+  return length;
+}
+
+static int encodeSigned(uint8_t* buffer, const int size, const int64_t value) {
+  const uint64_t zigzag = ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+  return encodeVarint(buffer, size, zigzag);
+}
+
+int tokenizeEncode(uint8_t* buffer, const int size, const uint32_t token, const uint32_t argTypes, va_list ap) {
+  int length = encodeVarint(buffer, size, token);
+  if (length == 0) {
+    return 0;
+  }
+
+  for (uint32_t types = argTypes; types != 0; types >>= 4) {
+    uint8_t* out = &buffer[length];
+    const int available = size - length;
+    int argLength = 0;
+
+    switch (types & 0xf) {
+      case TOKENIZE_ARG_INT32:
+        argLength = encodeSigned(out, available, va_arg(ap, int32_t));
+        break;
+      case TOKENIZE_ARG_INT64:
+        argLength = encodeSigned(out, available, va_arg(ap, int64_t));
+        break;
+      case TOKENIZE_ARG_DOUBLE:
+        {
+          const float value = (float)va_arg(ap, double);
+          if (available >= (int)sizeof(value)) {
+            memcpy(out, &value, sizeof(value));
+            argLength = sizeof(value);
+          }
+        }
+        break;
+      case TOKENIZE_ARG_STRING:
+        {
+          const char* str = va_arg(ap, const char*);
+          if (available > 0) {
+            while (str && *str && argLength < available - 1) {
+              out[argLength++] = *str++;
+            }
+            out[argLength++] = 0;
+          }
+        }
+        break;
+      default:
+        // Unknown type, the remaining arguments can not be read
+        return length;
+    }
+
+    if (argLength == 0) {
+      // Out of space
+      break;
+    }
+    length += argLength;
+  }
+
+  return length;
+}
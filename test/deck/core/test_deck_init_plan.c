@@ -0,0 +1,178 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * test_deck_init_plan.c - unit tests for deck_init_plan
+ */
+
+// File under test deck_init_plan.c
+#include "deck_init_plan.h"
+
+#include "unity.h"
+
+static DeckDriver i2cDriver = { .usedPeriph = DECK_USING_I2C };
+static DeckDriver spiDriver = { .usedPeriph = DECK_USING_SPI };
+static DeckDriver uart1Driver = { .usedPeriph = DECK_USING_UART1 };
+static DeckDriver uart2Driver = { .usedPeriph = DECK_USING_UART2 };
+static DeckDriver i2cAndSpiDriver = { .usedPeriph = DECK_USING_I2C | DECK_USING_SPI };
+static DeckDriver gpioDriver = { .usedGpio = DECK_USING_IO_1 };
+static DeckDriver uart2AndGpioDriver = { .usedPeriph = DECK_USING_UART2, .usedGpio = DECK_USING_IO_1 };
+static DeckDriver undeclaredDriver = { .usedPeriph = 0, .usedGpio = 0 };
+// Resources of real deck drivers
+static DeckDriver lighthouseDriver = { .usedPeriph = DECK_USING_UART1 };
+static DeckDriver ledring12Driver = { .usedPeriph = DECK_USING_TIMER3, .usedGpio = DECK_USING_IO_2 | DECK_USING_IO_3 };
+static DeckDriver locodeckDriver = { .usedPeriph = DECK_USING_SPI, .usedGpio = DECK_USING_IO_1 | DECK_USING_IO_2 | DECK_USING_IO_3 };
+
+static DeckInfo decks[DECK_MAX_COUNT];
+static uint8_t queue[DECK_MAX_COUNT];
+
+void setUp(void) {
+  for (int i = 0; i < DECK_MAX_COUNT; i++) {
+    decks[i].driver = 0;
+    queue[i] = 0xff;
+  }
+}
+
+void tearDown(void) {}
+
+void testThatIndependentDecksAreInDifferentQueues() {
+  // Fixture
+  decks[0].driver = &i2cDriver;
+  decks[1].driver = &uart1Driver;
+
+  // Test
+  int actual = deckInitPlan(decks, 2, 2, queue);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(2, actual);
+  TEST_ASSERT_EQUAL_UINT8(0, queue[0]);
+  TEST_ASSERT_EQUAL_UINT8(1, queue[1]);
+}
+
+void testThatDecksSharingABusAreInTheSameQueue() {
+  // Fixture
+  decks[0].driver = &i2cDriver;
+  decks[1].driver = &i2cDriver;
+
+  // Test
+  int actual = deckInitPlan(decks, 2, 2, queue);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(1, actual);
+  TEST_ASSERT_EQUAL_UINT8(0, queue[0]);
+  TEST_ASSERT_EQUAL_UINT8(0, queue[1]);
+}
+
+void testThatDecksSharingAGpioAreInTheSameQueue() {
+  // Fixture
+  decks[0].driver = &gpioDriver;
+  decks[1].driver = &uart1Driver;
+  decks[2].driver = &uart2AndGpioDriver;
+
+  // Test
+  int actual = deckInitPlan(decks, 3, 3, queue);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(2, actual);
+  TEST_ASSERT_EQUAL_UINT8(0, queue[0]);
+  TEST_ASSERT_EQUAL_UINT8(1, queue[1]);
+  TEST_ASSERT_EQUAL_UINT8(0, queue[2]);
+}
+
+void testThatDeckSharingResourcesWithTwoGroupsJoinsThem() {
+  // Fixture
+  decks[0].driver = &i2cDriver;
+  decks[1].driver = &spiDriver;
+  decks[2].driver = &uart1Driver;
+  decks[3].driver = &i2cAndSpiDriver;
+
+  // Test
+  int actual = deckInitPlan(decks, 4, 4, queue);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(2, actual);
+  TEST_ASSERT_EQUAL_UINT8(0, queue[0]);
+  TEST_ASSERT_EQUAL_UINT8(0, queue[1]);
+  TEST_ASSERT_EQUAL_UINT8(1, queue[2]);
+  TEST_ASSERT_EQUAL_UINT8(0, queue[3]);
+}
+
+void testThatGroupsShareQueuesWhenThereAreMoreGroupsThanQueues() {
+  // Fixture
+  decks[0].driver = &i2cDriver;
+  decks[1].driver = &spiDriver;
+  decks[2].driver = &uart1Driver;
+  decks[3].driver = &uart2Driver;
+
+  // Test
+  int actual = deckInitPlan(decks, 4, 2, queue);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(2, actual);
+  TEST_ASSERT_EQUAL_UINT8(0, queue[0]);
+  TEST_ASSERT_EQUAL_UINT8(1, queue[1]);
+  TEST_ASSERT_EQUAL_UINT8(0, queue[2]);
+  TEST_ASSERT_EQUAL_UINT8(1, queue[3]);
+}
+
+void testThatDeckWithoutDeclaredResourcesIsInitializedWithAllDecks() {
+  // Fixture
+  decks[0].driver = &i2cDriver;
+  decks[1].driver = &uart1Driver;
+  decks[2].driver = &undeclaredDriver;
+
+  // Test
+  int actual = deckInitPlan(decks, 3, 2, queue);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(1, actual);
+  TEST_ASSERT_EQUAL_UINT8(0, queue[0]);
+  TEST_ASSERT_EQUAL_UINT8(0, queue[1]);
+  TEST_ASSERT_EQUAL_UINT8(0, queue[2]);
+}
+
+void testThatNoDecksUseNoQueues() {
+  // Fixture
+  // Test
+  int actual = deckInitPlan(decks, 0, 2, queue);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(0, actual);
+}
+
+void testThatDecksRegisteringMemoriesAreInitializedInParallel() {
+  // Fixture
+  // All three decks register memory handlers in their init, memoryRegisterHandler() must handle
+  // calls from two tasks
+  decks[0].driver = &lighthouseDriver;
+  decks[1].driver = &ledring12Driver;
+  decks[2].driver = &locodeckDriver;
+
+  // Test
+  int actual = deckInitPlan(decks, 3, 2, queue);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(2, actual);
+  TEST_ASSERT_EQUAL_UINT8(0, queue[0]);
+  TEST_ASSERT_EQUAL_UINT8(1, queue[1]);
+  TEST_ASSERT_EQUAL_UINT8(1, queue[2]);
+}
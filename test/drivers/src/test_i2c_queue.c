@@ -0,0 +1,332 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * test_i2c_queue.c - unit tests for i2c_queue
+ */
+
+// File under test i2c_queue.c
+#include "i2c_queue.h"
+
+#include <string.h>
+
+#include "unity.h"
+
+static I2cQueue queue;
+static I2cMessage messagesA[2];
+static I2cMessage messagesB[1];
+static I2cMessage messagesC[1];
+static I2cTransaction transactionA;
+static I2cTransaction transactionB;
+static I2cTransaction transactionC;
+
+static void initTransaction(I2cTransaction* transaction, I2cMessage* messages, uint8_t nbrOfMessages) {
+  memset(transaction, 0, sizeof(I2cTransaction));
+  transaction->messages = messages;
+  transaction->nbrOfMessages = nbrOfMessages;
+  transaction->state = i2cTransactionIdle;
+}
+
+// Submit a transaction to an idle bus and start it, as the driver does
+static I2cMessage* submitAndStart(I2cTransaction* transaction) {
+  bool isBusFree;
+  i2cQueueSubmit(&queue, transaction, &isBusFree);
+  TEST_ASSERT_TRUE(isBusFree);
+  return i2cQueueStart(&queue);
+}
+
+void setUp(void) {
+  memset(&queue, 0, sizeof(queue));
+  memset(messagesA, 0, sizeof(messagesA));
+  memset(messagesB, 0, sizeof(messagesB));
+  memset(messagesC, 0, sizeof(messagesC));
+  initTransaction(&transactionA, messagesA, 2);
+  initTransaction(&transactionB, messagesB, 1);
+  initTransaction(&transactionC, messagesC, 1);
+}
+
+void tearDown(void) {}
+
+void testThatSubmitToIdleBusStartsTheFirstMessage() {
+  // Fixture
+  bool isBusFree = false;
+
+  // Test
+  bool actual = i2cQueueSubmit(&queue, &transactionA, &isBusFree);
+
+  // Assert
+  TEST_ASSERT_TRUE(actual);
+  TEST_ASSERT_TRUE(isBusFree);
+  TEST_ASSERT_FALSE(i2cQueueIsTransferring(&queue));
+  TEST_ASSERT_EQUAL_PTR(&messagesA[0], i2cQueueStart(&queue));
+  TEST_ASSERT_TRUE(i2cQueueIsTransferring(&queue));
+  TEST_ASSERT_EQUAL(i2cTransactionQueued, transactionA.state);
+}
+
+void testThatSubmitToBusyBusQueuesWithoutStarting() {
+  // Fixture
+  submitAndStart(&transactionA);
+  bool isBusFree = true;
+
+  // Test
+  bool actual = i2cQueueSubmit(&queue, &transactionB, &isBusFree);
+
+  // Assert
+  TEST_ASSERT_TRUE(actual);
+  TEST_ASSERT_FALSE(isBusFree);
+  TEST_ASSERT_EQUAL_PTR(&transactionA, queue.head);
+  TEST_ASSERT_EQUAL_PTR(&transactionB, queue.tail);
+}
+
+void testThatAQueuedTransactionIsNotSubmittedAgain() {
+  // Fixture
+  submitAndStart(&transactionA);
+  bool isBusFree;
+
+  // Test
+  bool actual = i2cQueueSubmit(&queue, &transactionA, &isBusFree);
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+  TEST_ASSERT_EQUAL_PTR(&transactionA, queue.tail);
+  TEST_ASSERT_NULL(transactionA.next);
+}
+
+void testThatMessagesOfATransactionAreChained() {
+  // Fixture
+  submitAndStart(&transactionA);
+  I2cTransaction* done;
+
+  // Test
+  I2cMessage* actual = i2cQueueMessageDone(&queue, i2cAck, &done);
+
+  // Assert
+  TEST_ASSERT_EQUAL_PTR(&messagesA[1], actual);
+  TEST_ASSERT_NULL(done);
+  TEST_ASSERT_EQUAL(i2cAck, messagesA[0].status);
+  TEST_ASSERT_EQUAL(i2cTransactionQueued, transactionA.state);
+}
+
+void testThatTheNextTransactionFollowsTheLastMessage() {
+  // Fixture
+  submitAndStart(&transactionA);
+  bool isBusFree;
+  i2cQueueSubmit(&queue, &transactionB, &isBusFree);
+  I2cTransaction* done;
+  i2cQueueMessageDone(&queue, i2cAck, &done);
+
+  // Test
+  I2cMessage* actual = i2cQueueMessageDone(&queue, i2cAck, &done);
+
+  // Assert
+  TEST_ASSERT_EQUAL_PTR(&messagesB[0], actual);
+  TEST_ASSERT_EQUAL_PTR(&transactionA, done);
+  TEST_ASSERT_EQUAL(i2cTransactionDone, transactionA.state);
+  TEST_ASSERT_EQUAL_PTR(&transactionB, queue.head);
+}
+
+void testThatTheBusIsIdleWhenTheQueueIsEmpty() {
+  // Fixture
+  submitAndStart(&transactionB);
+  I2cTransaction* done;
+
+  // Test
+  I2cMessage* actual = i2cQueueMessageDone(&queue, i2cAck, &done);
+
+  // Assert
+  TEST_ASSERT_NULL(actual);
+  TEST_ASSERT_EQUAL_PTR(&transactionB, done);
+  TEST_ASSERT_FALSE(queue.isBusy);
+  TEST_ASSERT_NULL(queue.head);
+  TEST_ASSERT_NULL(queue.tail);
+}
+
+void testThatANackEndsTheChain() {
+  // Fixture
+  submitAndStart(&transactionA);
+  I2cTransaction* done;
+
+  // Test
+  I2cMessage* actual = i2cQueueMessageDone(&queue, i2cNack, &done);
+
+  // Assert
+  TEST_ASSERT_NULL(actual);
+  TEST_ASSERT_EQUAL_PTR(&transactionA, done);
+  TEST_ASSERT_EQUAL(i2cNack, messagesA[0].status);
+  TEST_ASSERT_EQUAL(i2cTransactionFailed, transactionA.state);
+}
+
+void testThatCancellingAWaitingTransactionDoesNotRestartTheBus() {
+  // Fixture
+  submitAndStart(&transactionA);
+  bool isBusFree;
+  i2cQueueSubmit(&queue, &transactionB, &isBusFree);
+  i2cQueueSubmit(&queue, &transactionC, &isBusFree);
+  bool isRestartNeeded = true;
+
+  // Test
+  bool actual = i2cQueueCancel(&queue, &transactionB, &isRestartNeeded);
+
+  // Assert
+  TEST_ASSERT_TRUE(actual);
+  TEST_ASSERT_FALSE(isRestartNeeded);
+  TEST_ASSERT_EQUAL(i2cTransactionFailed, transactionB.state);
+  TEST_ASSERT_EQUAL_PTR(&transactionC, transactionA.next);
+  TEST_ASSERT_TRUE(i2cQueueIsTransferring(&queue));
+}
+
+void testThatCancellingTheLastTransactionUpdatesTheTail() {
+  // Fixture
+  submitAndStart(&transactionA);
+  bool isBusFree;
+  i2cQueueSubmit(&queue, &transactionB, &isBusFree);
+  bool isRestartNeeded;
+
+  // Test
+  i2cQueueCancel(&queue, &transactionB, &isRestartNeeded);
+  i2cQueueSubmit(&queue, &transactionC, &isBusFree);
+
+  // Assert
+  TEST_ASSERT_EQUAL_PTR(&transactionC, transactionA.next);
+  TEST_ASSERT_EQUAL_PTR(&transactionC, queue.tail);
+}
+
+void testThatCancellingTheTransferredTransactionRestartsTheBus() {
+  // Fixture
+  submitAndStart(&transactionA);
+  bool isBusFree;
+  i2cQueueSubmit(&queue, &transactionB, &isBusFree);
+  bool isRestartNeeded = false;
+
+  // Test
+  bool actual = i2cQueueCancel(&queue, &transactionA, &isRestartNeeded);
+
+  // Assert
+  TEST_ASSERT_TRUE(actual);
+  TEST_ASSERT_TRUE(isRestartNeeded);
+  TEST_ASSERT_TRUE(queue.isBusy);
+  TEST_ASSERT_EQUAL_PTR(&transactionB, queue.head);
+  TEST_ASSERT_FALSE(i2cQueueIsTransferring(&queue));
+}
+
+void testThatInterruptsDuringTheRestartDoNotTouchTheQueue() {
+  // Fixture
+  submitAndStart(&transactionA);
+  bool isBusFree;
+  i2cQueueSubmit(&queue, &transactionB, &isBusFree);
+  bool isRestartNeeded;
+  i2cQueueCancel(&queue, &transactionA, &isRestartNeeded);
+  I2cTransaction* done;
+
+  // Test
+  I2cMessage* actual = i2cQueueMessageDone(&queue, i2cNack, &done);
+
+  // Assert
+  TEST_ASSERT_NULL(actual);
+  TEST_ASSERT_NULL(done);
+  TEST_ASSERT_EQUAL(i2cTransactionQueued, transactionB.state);
+  TEST_ASSERT_EQUAL_PTR(&transactionB, queue.head);
+}
+
+void testThatTransactionsSubmittedDuringTheRestartWaitForIt() {
+  // Fixture
+  submitAndStart(&transactionA);
+  bool isRestartNeeded;
+  i2cQueueCancel(&queue, &transactionA, &isRestartNeeded);
+  bool isBusFree = true;
+
+  // Test
+  i2cQueueSubmit(&queue, &transactionB, &isBusFree);
+  I2cMessage* actual = i2cQueueRestartDone(&queue);
+
+  // Assert
+  TEST_ASSERT_FALSE(isBusFree);
+  TEST_ASSERT_EQUAL_PTR(&messagesB[0], actual);
+  TEST_ASSERT_TRUE(i2cQueueIsTransferring(&queue));
+}
+
+void testThatTheBusIsIdleAfterARestartWithAnEmptyQueue() {
+  // Fixture
+  submitAndStart(&transactionB);
+  bool isRestartNeeded;
+  i2cQueueCancel(&queue, &transactionB, &isRestartNeeded);
+
+  // Test
+  I2cMessage* actual = i2cQueueRestartDone(&queue);
+
+  // Assert
+  TEST_ASSERT_NULL(actual);
+  TEST_ASSERT_FALSE(queue.isBusy);
+}
+
+void testThatATransactionCancelledBeforeItStartedIsNotStarted() {
+  // Fixture
+  bool isBusFree;
+  i2cQueueSubmit(&queue, &transactionA, &isBusFree);
+  bool isRestartNeeded = true;
+
+  // Test
+  i2cQueueCancel(&queue, &transactionA, &isRestartNeeded);
+  I2cMessage* actual = i2cQueueStart(&queue);
+
+  // Assert
+  TEST_ASSERT_FALSE(isRestartNeeded);
+  TEST_ASSERT_NULL(actual);
+  TEST_ASSERT_FALSE(queue.isBusy);
+}
+
+void testThatADoneTransactionIsNotCancelled() {
+  // Fixture
+  submitAndStart(&transactionB);
+  I2cTransaction* done;
+  i2cQueueMessageDone(&queue, i2cAck, &done);
+  bool isRestartNeeded;
+
+  // Test
+  bool actual = i2cQueueCancel(&queue, &transactionB, &isRestartNeeded);
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+  TEST_ASSERT_FALSE(isRestartNeeded);
+  TEST_ASSERT_EQUAL(i2cTransactionDone, transactionB.state);
+}
+
+void testThatARestartedChainStartsFromTheFirstMessage() {
+  // Fixture
+  submitAndStart(&transactionB);
+  bool isBusFree;
+  i2cQueueSubmit(&queue, &transactionA, &isBusFree);
+  I2cTransaction* done;
+  i2cQueueMessageDone(&queue, i2cAck, &done);
+  i2cQueueMessageDone(&queue, i2cAck, &done);
+  bool isRestartNeeded;
+  i2cQueueCancel(&queue, &transactionA, &isRestartNeeded);
+  i2cQueueRestartDone(&queue);
+
+  // Test
+  i2cQueueSubmit(&queue, &transactionA, &isBusFree);
+  I2cMessage* actual = i2cQueueStart(&queue);
+
+  // Assert
+  TEST_ASSERT_EQUAL_PTR(&messagesA[0], actual);
+  TEST_ASSERT_EQUAL_UINT8(0, transactionA.messageIndex);
+}
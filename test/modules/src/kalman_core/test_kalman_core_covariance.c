@@ -0,0 +1,234 @@
+// File under test kalman_core_covariance.c
+#include "kalman_core_covariance.h"
+
+#include "unity.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define N KC_COVARIANCE_DIM
+#define B KC_COVARIANCE_BLOCK
+
+static kalmanCoreJacobian_t jacobian;
+static float P[N][N];
+
+static float randomFloat(float min, float max) {
+  return min + (max - min) * ((float)rand() / (float)RAND_MAX);
+}
+
+static void randomSpd(float A[N][N], float diagonal) {
+  float M[N][N];
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < N; j++) {
+      M[i][j] = randomFloat(-1.0f, 1.0f);
+    }
+  }
+
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < N; j++) {
+      float sum = (i == j) ? diagonal : 0.0f;
+      for (int k = 0; k < N; k++) {
+        sum += M[i][k] * M[j][k];
+      }
+      A[i][j] = sum;
+    }
+  }
+}
+
+static void randomBlock(float block[B][B], float min, float max) {
+  for (int i = 0; i < B; i++) {
+    for (int j = 0; j < B; j++) {
+      block[i][j] = randomFloat(min, max);
+    }
+  }
+}
+
+static void randomJacobian(kalmanCoreJacobian_t* A) {
+  randomBlock(A->posVel, -0.01f, 0.01f);
+  randomBlock(A->posAtt, -0.01f, 0.01f);
+  randomBlock(A->velVel, -0.05f, 0.05f);
+  randomBlock(A->velAtt, -0.1f, 0.1f);
+  randomBlock(A->attAtt, -0.05f, 0.05f);
+  for (int i = 0; i < B; i++) {
+    A->velVel[i][i] += 1.0f;
+    A->attAtt[i][i] += 1.0f;
+  }
+}
+
+static void copyBlock(double A[N][N], int row, int col, const float block[B][B]) {
+  for (int i = 0; i < B; i++) {
+    for (int j = 0; j < B; j++) {
+      A[row + i][col + j] = block[i][j];
+    }
+  }
+}
+
+static void denseJacobian(double A[N][N], const kalmanCoreJacobian_t* jacobian) {
+  memset(A, 0, sizeof(double) * N * N);
+  for (int i = 0; i < B; i++) {
+    A[i][i] = 1.0;
+  }
+  copyBlock(A, 0, B, jacobian->posVel);
+  copyBlock(A, 0, 2 * B, jacobian->posAtt);
+  copyBlock(A, B, B, jacobian->velVel);
+  copyBlock(A, B, 2 * B, jacobian->velAtt);
+  copyBlock(A, 2 * B, 2 * B, jacobian->attAtt);
+}
+
+// The reference, expected = A * P * A' with dense matrices in double precision
+static void denseTransform(float expected[N][N], double A[N][N], float P[N][N]) {
+  double AP[N][N];
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < N; j++) {
+      double sum = 0.0;
+      for (int k = 0; k < N; k++) {
+        sum += A[i][k] * P[k][j];
+      }
+      AP[i][j] = sum;
+    }
+  }
+
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < N; j++) {
+      double sum = 0.0;
+      for (int k = 0; k < N; k++) {
+        sum += AP[i][k] * A[j][k];
+      }
+      expected[i][j] = (float)sum;
+    }
+  }
+}
+
+static void assertMatrixEqual(float expected[N][N], float actual[N][N], float relativeTolerance) {
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < N; j++) {
+      const float scale = sqrtf(fabsf(expected[i][i] * expected[j][j]));
+      TEST_ASSERT_FLOAT_WITHIN(relativeTolerance * scale, expected[i][j], actual[i][j]);
+    }
+  }
+}
+
+void setUp(void) {
+  srand(4711);
+  randomSpd(P, 0.1f);
+  randomJacobian(&jacobian);
+}
+
+void tearDown(void) {
+  // Empty
+}
+
+void testThatPredictMatchesDenseProductForRandomInput() {
+  for (int n = 0; n < 100; n++) {
+    // Fixture
+    randomSpd(P, randomFloat(0.001f, 1.0f));
+    randomJacobian(&jacobian);
+
+    double A[N][N];
+    denseJacobian(A, &jacobian);
+    float expected[N][N];
+    denseTransform(expected, A, P);
+
+    // Test
+    kalmanCoreCovariancePredict(P, &jacobian);
+
+    // Assert
+    assertMatrixEqual(expected, P, 1e-5f);
+  }
+}
+
+void testThatPredictMatchesDenseProductForArbitraryBlocks() {
+  for (int n = 0; n < 100; n++) {
+    // Fixture
+    randomSpd(P, 1.0f);
+    randomBlock(jacobian.posVel, -1.0f, 1.0f);
+    randomBlock(jacobian.posAtt, -1.0f, 1.0f);
+    randomBlock(jacobian.velVel, -1.0f, 1.0f);
+    randomBlock(jacobian.velAtt, -1.0f, 1.0f);
+    randomBlock(jacobian.attAtt, -1.0f, 1.0f);
+
+    double A[N][N];
+    denseJacobian(A, &jacobian);
+    float expected[N][N];
+    denseTransform(expected, A, P);
+
+    // Test
+    kalmanCoreCovariancePredict(P, &jacobian);
+
+    // Assert
+    assertMatrixEqual(expected, P, 1e-4f);
+  }
+}
+
+void testThatPredictResultIsSymmetric() {
+  // Fixture
+  // Test
+  kalmanCoreCovariancePredict(P, &jacobian);
+
+  // Assert
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < i; j++) {
+      TEST_ASSERT_EQUAL_FLOAT(P[i][j], P[j][i]);
+    }
+  }
+}
+
+void testThatRepeatedPredictionsFollowDenseProduct() {
+  // Fixture
+  float expected[N][N];
+  memcpy(expected, P, sizeof(P));
+
+  // Test
+  for (int n = 0; n < 1000; n++) {
+    randomJacobian(&jacobian);
+    double A[N][N];
+    denseJacobian(A, &jacobian);
+    denseTransform(expected, A, expected);
+
+    kalmanCoreCovariancePredict(P, &jacobian);
+  }
+
+  // Assert
+  assertMatrixEqual(expected, P, 1e-3f);
+}
+
+void testThatRotateAttitudeMatchesDenseProduct() {
+  for (int n = 0; n < 100; n++) {
+    // Fixture
+    randomSpd(P, randomFloat(0.001f, 1.0f));
+    float attAtt[B][B];
+    randomBlock(attAtt, -0.1f, 0.1f);
+    for (int i = 0; i < B; i++) {
+      attAtt[i][i] += 1.0f;
+    }
+
+    double A[N][N];
+    memset(A, 0, sizeof(A));
+    for (int i = 0; i < 2 * B; i++) {
+      A[i][i] = 1.0;
+    }
+    copyBlock(A, 2 * B, 2 * B, attAtt);
+    float expected[N][N];
+    denseTransform(expected, A, P);
+
+    // Test
+    kalmanCoreCovarianceRotateAttitude(P, attAtt);
+
+    // Assert
+    assertMatrixEqual(expected, P, 1e-5f);
+  }
+}
+
+void testThatRotateAttitudeWithIdentityKeepsCovariance() {
+  // Fixture
+  const float identity[B][B] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+  float expected[N][N];
+  memcpy(expected, P, sizeof(P));
+
+  // Test
+  kalmanCoreCovarianceRotateAttitude(P, identity);
+
+  // Assert
+  TEST_ASSERT_EQUAL_FLOAT_ARRAY((float*)expected, (float*)P, N * N);
+}
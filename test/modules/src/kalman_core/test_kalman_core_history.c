@@ -0,0 +1,176 @@
+// File under test kalman_core_history.c
+#include "kalman_core_history.h"
+
+#include <string.h>
+#include <math.h>
+
+#include "unity.h"
+
+static kalmanCoreHistory_t history;
+static kalmanCoreData_t coreData;
+static kalmanCoreHistorySample_t sample;
+
+static void setState(const float x, const float y, const float z, const float yaw) {
+  coreData.S[KC_STATE_X] = x;
+  coreData.S[KC_STATE_Y] = y;
+  coreData.S[KC_STATE_Z] = z;
+  coreData.q[0] = cosf(yaw / 2.0f);
+  coreData.q[1] = 0.0f;
+  coreData.q[2] = 0.0f;
+  coreData.q[3] = sinf(yaw / 2.0f);
+}
+
+static float yawOf(const float q[4]) {
+  return 2.0f * atan2f(q[3], q[0]);
+}
+
+static void predictTo(const uint32_t t, const float x, const float yaw) {
+  kalmanCoreHistorySample_t before;
+  kalmanCoreHistorySnapshot(&coreData, &before);
+  setState(x, 2.0f, 1.0f, yaw);
+  kalmanCoreHistoryAddPrediction(&history, &before, &coreData, t);
+}
+
+// Moves along x at 1 m/s and rotates around z at 1 rad/s, one prediction every 10 ms
+static void fillHistory(const uint32_t startMs, const int count) {
+  for (int i = 0; i < count; i++) {
+    const uint32_t t = startMs + i * 10;
+    const float s = (t - startMs) / 1000.0f;
+    predictTo(t, s, s);
+  }
+}
+
+void setUp(void) {
+  memset(&coreData, 0, sizeof(coreData));
+  memset(&sample, 0, sizeof(sample));
+  setState(0.0f, 2.0f, 1.0f, 0.0f);
+  kalmanCoreHistoryReset(&history);
+}
+
+void tearDown(void) {
+  // Empty
+}
+
+void testThatNoMotionIsReturnedForTheLatestPrediction() {
+  // Fixture
+  fillHistory(1000, 5);
+
+  // Test
+  bool actual = kalmanCoreHistoryGetMotion(&history, 1045, &sample);
+
+  // Assert
+  TEST_ASSERT_TRUE(actual);
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, sample.pos[0]);
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, sample.pos[1]);
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, yawOf(sample.q));
+}
+
+void testThatMotionOfPredictionsSinceTimestampIsSummed() {
+  // Fixture
+  fillHistory(1000, 5);
+
+  // Test
+  bool actual = kalmanCoreHistoryGetMotion(&history, 1020, &sample);
+
+  // Assert
+  TEST_ASSERT_TRUE(actual);
+  TEST_ASSERT_EQUAL_UINT32(1020, sample.timestampMs);
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.02f, sample.pos[0]);
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, sample.pos[1]);
+  TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.02f, yawOf(sample.q));
+}
+
+void testThatPartOfPredictionAfterTimestampIsCounted() {
+  // Fixture
+  fillHistory(1000, 5);
+
+  // Test
+  bool actual = kalmanCoreHistoryGetMotion(&history, 1015, &sample);
+
+  // Assert
+  TEST_ASSERT_TRUE(actual);
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.025f, sample.pos[0]);
+  TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.025f, yawOf(sample.q));
+}
+
+void testThatCorrectionsAfterTimestampAreNotCounted() {
+  // Fixture
+  fillHistory(1000, 3);
+  // A measurement update moves the estimate between two predictions
+  setState(0.52f, 2.0f, 1.0f, 0.3f);
+  predictTo(1030, 0.53f, 0.31f);
+  predictTo(1040, 0.54f, 0.32f);
+
+  // Test
+  bool actual = kalmanCoreHistoryGetMotion(&history, 1010, &sample);
+
+  // Assert
+  TEST_ASSERT_TRUE(actual);
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.03f, sample.pos[0]);
+  TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.03f, yawOf(sample.q));
+}
+
+void testThatTimestampOlderThanHistoryIsRejected() {
+  // Fixture
+  fillHistory(1000, KALMAN_CORE_HISTORY_LENGTH + 4);
+
+  // Test
+  bool actual = kalmanCoreHistoryGetMotion(&history, 1030, &sample);
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+}
+
+void testThatOldestPredictionInFullHistoryIsFound() {
+  // Fixture
+  fillHistory(1000, KALMAN_CORE_HISTORY_LENGTH + 4);
+  const uint32_t oldestMs = 1000 + 4 * 10;
+
+  // Test
+  bool actual = kalmanCoreHistoryGetMotion(&history, oldestMs, &sample);
+
+  // Assert
+  TEST_ASSERT_TRUE(actual);
+  TEST_ASSERT_FLOAT_WITHIN(1e-5f, (KALMAN_CORE_HISTORY_LENGTH - 1) * 0.01f, sample.pos[0]);
+}
+
+void testThatTickCounterWrapAroundIsHandled() {
+  // Fixture
+  const uint32_t startMs = UINT32_MAX - 25;
+  fillHistory(startMs, 6);
+
+  // Test
+  bool actual = kalmanCoreHistoryGetMotion(&history, startMs + 35, &sample);
+
+  // Assert
+  TEST_ASSERT_TRUE(actual);
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.015f, sample.pos[0]);
+}
+
+void testThatShiftedPositionIsMovedByTheMotion() {
+  // Fixture
+  kalmanCoreHistorySample_t motion = {.pos = {0.1f, -0.1f, 0.0f}, .q = {1.0f, 0.0f, 0.0f, 0.0f}};
+  float measured[3] = {0.95f, 2.0f, 3.2f};
+
+  // Test
+  kalmanCoreHistoryShiftPosition(&motion, measured);
+
+  // Assert
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 1.05f, measured[0]);
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 1.9f, measured[1]);
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 3.2f, measured[2]);
+}
+
+void testThatShiftedAttitudeIsRotatedByTheMotion() {
+  // Fixture
+  kalmanCoreHistorySample_t motion = {.q = {cosf(0.1f), 0.0f, 0.0f, sinf(0.1f)}};
+  quaternion_t measured = {.x = 0.0f, .y = 0.0f, .z = sinf(0.06f), .w = cosf(0.06f)};
+
+  // Test
+  kalmanCoreHistoryShiftAttitude(&motion, &measured);
+
+  // Assert
+  // The estimate rotated 0.2 rad in yaw, measured yaw 0.12 should become 0.32
+  const float q[4] = {measured.w, measured.x, measured.y, measured.z};
+  TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.32f, yawOf(q));
+}
@@ -0,0 +1,272 @@
+// File under test kalman_core_ud.c
+#include "kalman_core_ud.h"
+#include "kalman_core_covariance.h"
+
+#include "unity.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define N KC_COVARIANCE_DIM
+#define B KC_COVARIANCE_BLOCK
+
+static float P[N][N];
+static float U[N][N];
+static float D[N];
+
+static float randomFloat(float min, float max) {
+  return min + (max - min) * ((float)rand() / (float)RAND_MAX);
+}
+
+static void randomSpd(float A[N][N], float diagonal) {
+  float M[N][N];
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < N; j++) {
+      M[i][j] = randomFloat(-1.0f, 1.0f);
+    }
+  }
+
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < N; j++) {
+      float sum = (i == j) ? diagonal : 0.0f;
+      for (int k = 0; k < N; k++) {
+        sum += M[i][k] * M[j][k];
+      }
+      A[i][j] = sum;
+    }
+  }
+}
+
+static void randomBlock(float block[B][B], float min, float max) {
+  for (int i = 0; i < B; i++) {
+    for (int j = 0; j < B; j++) {
+      block[i][j] = randomFloat(min, max);
+    }
+  }
+}
+
+static void randomJacobian(kalmanCoreJacobian_t* A) {
+  randomBlock(A->posVel, -0.01f, 0.01f);
+  randomBlock(A->posAtt, -0.01f, 0.01f);
+  randomBlock(A->velVel, -0.05f, 0.05f);
+  randomBlock(A->velAtt, -0.1f, 0.1f);
+  randomBlock(A->attAtt, -0.05f, 0.05f);
+  for (int i = 0; i < B; i++) {
+    A->velVel[i][i] += 1.0f;
+    A->attAtt[i][i] += 1.0f;
+  }
+}
+
+static void assertMatrixEqual(float expected[N][N], float actual[N][N], float relativeTolerance) {
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < N; j++) {
+      const float scale = sqrtf(fabsf(expected[i][i] * expected[j][j]));
+      TEST_ASSERT_FLOAT_WITHIN(relativeTolerance * scale, expected[i][j], actual[i][j]);
+    }
+  }
+}
+
+// The reference, the conventional kalman update in double precision
+static void denseScalarUpdate(float P[N][N], const float h[N], const float R, float K[N]) {
+  double PHT[N];
+  double HPHR = R;
+  for (int i = 0; i < N; i++) {
+    PHT[i] = 0.0;
+    for (int k = 0; k < N; k++) {
+      PHT[i] += (double)P[i][k] * h[k];
+    }
+    HPHR += h[i] * PHT[i];
+  }
+
+  for (int i = 0; i < N; i++) {
+    K[i] = (float)(PHT[i] / HPHR);
+  }
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < N; j++) {
+      P[i][j] = (float)(P[i][j] - PHT[i] * PHT[j] / HPHR);
+    }
+  }
+}
+
+void setUp(void) {
+  srand(4711);
+  randomSpd(P, 0.1f);
+  kalmanCoreUdFactor(P, U, D);
+}
+
+void tearDown(void) {
+  // Empty
+}
+
+void testThatFactorizationReconstructsCovariance() {
+  for (int n = 0; n < 100; n++) {
+    // Fixture
+    randomSpd(P, randomFloat(0.001f, 1.0f));
+
+    // Test
+    bool actual = kalmanCoreUdFactor(P, U, D);
+
+    // Assert
+    TEST_ASSERT_TRUE(actual);
+    float reconstructed[N][N];
+    kalmanCoreUdToCovariance(U, D, reconstructed);
+    assertMatrixEqual(P, reconstructed, 1e-5f);
+    for (int i = 0; i < N; i++) {
+      TEST_ASSERT_EQUAL_FLOAT(1.0f, U[i][i]);
+      for (int j = 0; j < i; j++) {
+        TEST_ASSERT_EQUAL_FLOAT(0.0f, U[i][j]);
+      }
+    }
+  }
+}
+
+void testThatFactorizationDetectsIndefiniteMatrix() {
+  // Fixture
+  memset(P, 0, sizeof(P));
+  for (int i = 0; i < N; i++) {
+    P[i][i] = 1.0f;
+  }
+  P[2][2] = -1.0f;
+
+  // Test
+  bool actual = kalmanCoreUdFactor(P, U, D);
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, D[2]);
+}
+
+void testThatScalarUpdateMatchesConventionalUpdate() {
+  for (int n = 0; n < 100; n++) {
+    // Fixture
+    randomSpd(P, randomFloat(0.001f, 1.0f));
+    kalmanCoreUdFactor(P, U, D);
+    float h[N];
+    for (int i = 0; i < N; i++) {
+      h[i] = randomFloat(-1.0f, 1.0f);
+    }
+    const float R = randomFloat(0.01f, 1.0f);
+
+    float expectedK[N];
+    denseScalarUpdate(P, h, R, expectedK);
+
+    // Test
+    float actualK[N];
+    kalmanCoreUdScalarUpdate(U, D, h, R, actualK);
+
+    // Assert
+    for (int i = 0; i < N; i++) {
+      TEST_ASSERT_FLOAT_WITHIN(1e-4f, expectedK[i], actualK[i]);
+    }
+    float actual[N][N];
+    kalmanCoreUdToCovariance(U, D, actual);
+    assertMatrixEqual(P, actual, 1e-4f);
+  }
+}
+
+void testThatScalarUpdateKeepsVarianceNonNegativeForPreciseMeasurements() {
+  // Fixture
+  const float h[N] = {1.0f, 0, 0, 0, 0, 0, 0, 0, 0};
+
+  // Test
+  for (int n = 0; n < 1000; n++) {
+    float K[N];
+    kalmanCoreUdScalarUpdate(U, D, h, 1e-8f, K);
+  }
+
+  // Assert
+  for (int i = 0; i < N; i++) {
+    TEST_ASSERT_TRUE(D[i] >= 0.0f);
+  }
+  float actual[N][N];
+  kalmanCoreUdToCovariance(U, D, actual);
+  TEST_ASSERT_TRUE(actual[0][0] >= 0.0f);
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, actual[0][0]);
+}
+
+void testThatPredictMatchesBlockPrediction() {
+  for (int n = 0; n < 100; n++) {
+    // Fixture
+    randomSpd(P, randomFloat(0.001f, 1.0f));
+    kalmanCoreUdFactor(P, U, D);
+    kalmanCoreJacobian_t A;
+    randomJacobian(&A);
+
+    kalmanCoreCovariancePredict(P, &A);
+
+    // Test
+    kalmanCoreUdPredict(U, D, &A);
+
+    // Assert
+    float actual[N][N];
+    kalmanCoreUdToCovariance(U, D, actual);
+    assertMatrixEqual(P, actual, 1e-4f);
+  }
+}
+
+void testThatRotateAttitudeMatchesBlockRotation() {
+  for (int n = 0; n < 100; n++) {
+    // Fixture
+    randomSpd(P, randomFloat(0.001f, 1.0f));
+    kalmanCoreUdFactor(P, U, D);
+    float attAtt[B][B];
+    randomBlock(attAtt, -0.1f, 0.1f);
+    for (int i = 0; i < B; i++) {
+      attAtt[i][i] += 1.0f;
+    }
+
+    kalmanCoreCovarianceRotateAttitude(P, attAtt);
+
+    // Test
+    kalmanCoreUdRotateAttitude(U, D, attAtt);
+
+    // Assert
+    float actual[N][N];
+    kalmanCoreUdToCovariance(U, D, actual);
+    assertMatrixEqual(P, actual, 1e-4f);
+  }
+}
+
+void testThatAddDiagonalMatchesAddition() {
+  for (int n = 0; n < 100; n++) {
+    // Fixture
+    randomSpd(P, randomFloat(0.001f, 1.0f));
+    kalmanCoreUdFactor(P, U, D);
+    float q[N];
+    for (int i = 0; i < N; i++) {
+      q[i] = (i == n % N) ? 0.0f : randomFloat(0.0f, 0.1f);
+      P[i][i] += q[i];
+    }
+
+    // Test
+    kalmanCoreUdAddDiagonal(U, D, q);
+
+    // Assert
+    float actual[N][N];
+    kalmanCoreUdToCovariance(U, D, actual);
+    assertMatrixEqual(P, actual, 1e-5f);
+  }
+}
+
+void testThatAddDiagonalRestoresZeroVariance() {
+  // Fixture
+  memset(P, 0, sizeof(P));
+  kalmanCoreUdFactor(P, U, D);
+  float q[N];
+  for (int i = 0; i < N; i++) {
+    q[i] = 0.5f;
+  }
+
+  // Test
+  kalmanCoreUdAddDiagonal(U, D, q);
+
+  // Assert
+  float actual[N][N];
+  kalmanCoreUdToCovariance(U, D, actual);
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < N; j++) {
+      TEST_ASSERT_EQUAL_FLOAT((i == j) ? 0.5f : 0.0f, actual[i][j]);
+    }
+  }
+}
@@ -0,0 +1,96 @@
+// File under test mm_distance_robust.c
+#include "mm_distance_robust.h"
+#include "mm_robust_common.h"
+
+#include "unity.h"
+
+#include "mock_kalman_core.h"
+
+#include <math.h>
+#include <string.h>
+
+// The reference values were generated with the previous implementation of the robust update, that inverted the
+// Cholesky factor and refactorized the weighted covariance in each iteration.
+
+static kalmanCoreData_t this;
+static distanceMeasurement_t measurement;
+
+static float actualK[KC_STATE_DIM];
+static float actualPw[KC_STATE_DIM][KC_STATE_DIM];
+static float actualError;
+
+static void mock_kalmanCoreUpdateWithPKE_callback(kalmanCoreData_t* actualThis, arm_matrix_instance_f32* Hm, arm_matrix_instance_f32* Km, arm_matrix_instance_f32* P_w_m, float error, int cmock_num_calls) {
+  TEST_ASSERT_EQUAL_PTR(&this, actualThis);
+  TEST_ASSERT_EQUAL_UINT16(KC_STATE_DIM, Km->numRows);
+  TEST_ASSERT_EQUAL_UINT16(KC_STATE_DIM, P_w_m->numRows);
+  TEST_ASSERT_EQUAL_UINT16(KC_STATE_DIM, P_w_m->numCols);
+
+  memcpy(actualK, Km->pData, sizeof(actualK));
+  memcpy(actualPw, P_w_m->pData, sizeof(actualPw));
+  actualError = error;
+}
+
+static void assertUpdate(const float expectedError, const float expectedK[KC_STATE_DIM], const float expectedPwDiagonal[KC_STATE_DIM]) {
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, expectedError, actualError);
+  for (int i = 0; i < KC_STATE_DIM; i++) {
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f * fabsf(expectedK[i]) + 1e-8f, expectedK[i], actualK[i]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, expectedPwDiagonal[i], actualPw[i][i]);
+    for (int j = 0; j < i; j++) {
+      TEST_ASSERT_EQUAL_FLOAT(actualPw[i][j], actualPw[j][i]);
+    }
+  }
+}
+
+void setUp(void) {
+  memset(&this, 0, sizeof(this));
+  this.S[KC_STATE_X] = 0.5f;
+  this.S[KC_STATE_Y] = -0.3f;
+  this.S[KC_STATE_Z] = 1.2f;
+
+  // Positive definite covariance with correlations between all states
+  float M[KC_STATE_DIM][KC_STATE_DIM];
+  for (int i = 0; i < KC_STATE_DIM; i++) {
+    for (int j = 0; j < KC_STATE_DIM; j++) {
+      M[i][j] = 0.1f * sinf(i * KC_STATE_DIM + j + 1);
+    }
+  }
+  for (int i = 0; i < KC_STATE_DIM; i++) {
+    for (int j = 0; j < KC_STATE_DIM; j++) {
+      float sum = (i == j) ? 0.01f : 0.0f;
+      for (int k = 0; k < KC_STATE_DIM; k++) {
+        sum += M[i][k] * M[j][k];
+      }
+      this.P[i][j] = sum;
+    }
+  }
+
+  measurement = (distanceMeasurement_t){.x = 1.0f, .y = 2.0f, .z = 0.5f, .stdDev = 0.1f};
+
+  kalmanCoreUpdateWithPKE_StubWithCallback(mock_kalmanCoreUpdateWithPKE_callback);
+  kalmanCoreSyncCovariance_Ignore();
+}
+
+void tearDown(void) {
+  // Empty
+}
+
+void testThatInlierAndOutlierMatchReferenceValues() {
+  // Fixture
+  const float distance = sqrtf(0.5f * 0.5f + 2.3f * 2.3f + 0.7f * 0.7f);
+
+  const float expectedKInlier[KC_STATE_DIM] = {0.53744185f, -0.798587024f, 0.694065213f, -0.523118854f, 0.299205571f, -0.0221115351f, -0.258912534f, 0.493917674f, -0.641134143f};
+  const float expectedPwInlier[KC_STATE_DIM] = {0.0573148616f, 0.0576480851f, 0.0562297367f, 0.0541518182f, 0.0527480021f, 0.052966468f, 0.054658819f, 0.0566753261f, 0.0576460324f};
+  const float expectedKOutlier[KC_STATE_DIM] = {0.00191658025f, -0.00286881113f, 0.00249036611f, -0.00188167521f, 0.00108094374f, -8.80857406e-05f, -0.000920428487f, 0.00176534639f, -0.00229649222f};
+  const float expectedPwOutlier[KC_STATE_DIM] = {0.05731754f, 0.0576476231f, 0.0562294684f, 0.0541507602f, 0.0527470857f, 0.0529665165f, 0.0546599925f, 0.0566770062f, 0.0576472916f};
+
+  // Test
+  // Assert
+  // The error state of the previous update is used to reweight the covariance, the calls are not independent
+  measurement.distance = distance + 0.03f;
+  kalmanCoreRobustUpdateWithDistance(&this, &measurement);
+  assertUpdate(0.03f, expectedKInlier, expectedPwInlier);
+
+  measurement.distance = distance - 0.8f;
+  kalmanCoreRobustUpdateWithDistance(&this, &measurement);
+  assertUpdate(-0.8f, expectedKOutlier, expectedPwOutlier);
+}
@@ -0,0 +1,261 @@
+// File under test mm_robust_common.c
+#include "mm_robust_common.h"
+#include "kalman_core_covariance.h"
+
+#include "unity.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define N KC_COVARIANCE_DIM
+
+static float P[N][N];
+static robustCovariance_t robustCovariance;
+
+static float randomFloat(float min, float max) {
+  return min + (max - min) * ((float)rand() / (float)RAND_MAX);
+}
+
+static void randomVector(float v[N], float min, float max) {
+  for (int i = 0; i < N; i++) {
+    v[i] = randomFloat(min, max);
+  }
+}
+
+static void randomSpd(float A[N][N], float scale) {
+  float M[N][N];
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < N; j++) {
+      M[i][j] = scale * randomFloat(-1.0f, 1.0f);
+    }
+  }
+
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < N; j++) {
+      float sum = (i == j) ? scale * scale : 0.0f;
+      for (int k = 0; k < N; k++) {
+        sum += M[i][k] * M[j][k];
+      }
+      A[i][j] = sum;
+    }
+  }
+}
+
+// Dense reference of one reweighting, Lw = L * inv(W)^(1/2) with W computed from e = inv(L) * xErr
+static void referenceReweight(double L[N][N], const float xErr[N], float sigma) {
+  double e[N];
+  for (int i = 0; i < N; i++) {
+    double sum = xErr[i];
+    for (int k = 0; k < i; k++) {
+      sum -= L[i][k] * e[k];
+    }
+    e[i] = sum / L[i][i];
+  }
+
+  for (int k = 0; k < N; k++) {
+    const double dn = sigma + e[k] * e[k];
+    const double w = (sigma * sigma) / (dn * dn);
+    for (int i = 0; i < N; i++) {
+      L[i][k] /= sqrt(w);
+    }
+  }
+}
+
+static void referenceCovariance(double L[N][N], double Pref[N][N]) {
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < N; j++) {
+      double sum = 0.0;
+      for (int k = 0; k < N; k++) {
+        sum += L[i][k] * L[j][k];
+      }
+      Pref[i][j] = sum;
+    }
+  }
+}
+
+static void initReference(double L[N][N]) {
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < N; j++) {
+      L[i][j] = robustCovariance.L[i][j];
+    }
+  }
+}
+
+static void assertCovarianceEqual(double expected[N][N], float actual[N][N]) {
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < N; j++) {
+      const float tolerance = 1e-5f * (float)sqrt(expected[i][i] * expected[j][j]) + 1e-7f;
+      TEST_ASSERT_FLOAT_WITHIN(tolerance, (float)expected[i][j], actual[i][j]);
+    }
+  }
+}
+
+void setUp(void) {
+  srand(5);
+  randomSpd(P, 0.1f);
+  robustCovarianceInit(&robustCovariance, P);
+}
+
+void tearDown(void) {
+  // Empty
+}
+
+void testThatFactorizationReproducesTheCovariance() {
+  // Fixture
+  float actual[N][N];
+  double expected[N][N];
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < N; j++) {
+      expected[i][j] = P[i][j];
+    }
+  }
+
+  // Test
+  robustCovarianceGet(&robustCovariance, actual);
+
+  // Assert
+  assertCovarianceEqual(expected, actual);
+}
+
+void testThatZeroStateErrorDoesNotChangeTheCovariance() {
+  // Fixture
+  const float xErr[N] = {0};
+  float actual[N][N];
+  double expected[N][N];
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < N; j++) {
+      expected[i][j] = P[i][j];
+    }
+  }
+
+  // Test
+  robustCovarianceReweight(&robustCovariance, xErr, 1.5f);
+  robustCovarianceGet(&robustCovariance, actual);
+
+  // Assert
+  assertCovarianceEqual(expected, actual);
+}
+
+void testThatReweightedCovarianceMatchesDenseComputation() {
+  for (int n = 0; n < 20; n++) {
+    // Fixture
+    float xErr[N];
+    randomVector(xErr, -0.5f, 0.5f);
+    randomSpd(P, 0.1f);
+    robustCovarianceInit(&robustCovariance, P);
+
+    double L[N][N];
+    double expected[N][N];
+    initReference(L);
+    referenceReweight(L, xErr, 1.5f);
+    referenceCovariance(L, expected);
+
+    float actual[N][N];
+
+    // Test
+    robustCovarianceReweight(&robustCovariance, xErr, 1.5f);
+    robustCovarianceGet(&robustCovariance, actual);
+
+    // Assert
+    assertCovarianceEqual(expected, actual);
+  }
+}
+
+void testThatRepeatedReweightingMatchesFactorizationOfTheWeightedCovariance() {
+  // Fixture
+  float xErr1[N];
+  float xErr2[N];
+  randomVector(xErr1, -0.5f, 0.5f);
+  randomVector(xErr2, -0.5f, 0.5f);
+
+  double L[N][N];
+  double expected[N][N];
+  initReference(L);
+  referenceReweight(L, xErr1, 2.0f);
+  referenceReweight(L, xErr2, 2.0f);
+  referenceCovariance(L, expected);
+
+  float actual[N][N];
+
+  // Test
+  robustCovarianceReweight(&robustCovariance, xErr1, 2.0f);
+  robustCovarianceReweight(&robustCovariance, xErr2, 2.0f);
+  robustCovarianceGet(&robustCovariance, actual);
+
+  // Assert
+  assertCovarianceEqual(expected, actual);
+}
+
+void testThatGainMatchesDenseComputation() {
+  // Fixture
+  float xErr[N];
+  float h[N] = {0};
+  randomVector(xErr, -0.5f, 0.5f);
+  randomVector(h, -1.0f, 1.0f);
+  const float R = 0.15f * 0.15f;
+
+  double L[N][N];
+  double Pw[N][N];
+  initReference(L);
+  referenceReweight(L, xErr, 1.5f);
+  referenceCovariance(L, Pw);
+
+  double PHT[N];
+  double HPHR = R;
+  for (int i = 0; i < N; i++) {
+    PHT[i] = 0.0;
+    for (int j = 0; j < N; j++) {
+      PHT[i] += Pw[i][j] * h[j];
+    }
+    HPHR += h[i] * PHT[i];
+  }
+
+  float actual[N];
+
+  // Test
+  robustCovarianceReweight(&robustCovariance, xErr, 1.5f);
+  robustCovarianceGain(&robustCovariance, h, R, actual);
+
+  // Assert
+  for (int i = 0; i < N; i++) {
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, (float)(PHT[i] / HPHR), actual[i]);
+  }
+}
+
+void testThatNanInTheFactorIsBounded() {
+  // Fixture
+  P[4][4] = -1.0f;
+  float actual[N][N];
+
+  // Test
+  robustCovarianceInit(&robustCovariance, P);
+  robustCovarianceGet(&robustCovariance, actual);
+
+  // Assert
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < N; j++) {
+      TEST_ASSERT_FALSE(isnan(actual[i][j]));
+    }
+  }
+}
+
+void testThatWeightIsOneForZeroError() {
+  // Fixture
+  // Test
+  const float actual = robustWeightGM(0.0f, 1.5f);
+
+  // Assert
+  TEST_ASSERT_EQUAL_FLOAT(1.0f, actual);
+}
+
+void testThatWeightDecreasesWithTheError() {
+  // Fixture
+  // Test
+  const float small = robustWeightGM(0.5f, 2.0f);
+  const float large = robustWeightGM(-3.0f, 2.0f);
+
+  // Assert
+  TEST_ASSERT_TRUE(small < 1.0f);
+  TEST_ASSERT_TRUE(large < small);
+}
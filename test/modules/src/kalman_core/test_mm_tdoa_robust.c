@@ -0,0 +1,140 @@
+// File under test mm_tdoa_robust.c
+#include "mm_tdoa_robust.h"
+#include "mm_robust_common.h"
+
+#include "unity.h"
+
+#include "mock_kalman_core.h"
+
+#include <math.h>
+#include <string.h>
+
+// The reference values were generated with the previous implementation of the robust update, that inverted the
+// Cholesky factor and refactorized the weighted covariance in each iteration.
+
+static kalmanCoreData_t this;
+static tdoaMeasurement_t measurement;
+
+static float actualK[KC_STATE_DIM];
+static float actualPw[KC_STATE_DIM][KC_STATE_DIM];
+static float actualError;
+static const kalmanCoreData_t* actualThis;
+
+static void mock_kalmanCoreUpdateWithPKE_callback(kalmanCoreData_t* coreData, arm_matrix_instance_f32* Hm, arm_matrix_instance_f32* Km, arm_matrix_instance_f32* P_w_m, float error, int cmock_num_calls) {
+  actualThis = coreData;
+  TEST_ASSERT_EQUAL_UINT16(KC_STATE_DIM, Km->numRows);
+  TEST_ASSERT_EQUAL_UINT16(KC_STATE_DIM, P_w_m->numRows);
+  TEST_ASSERT_EQUAL_UINT16(KC_STATE_DIM, P_w_m->numCols);
+
+  memcpy(actualK, Km->pData, sizeof(actualK));
+  memcpy(actualPw, P_w_m->pData, sizeof(actualPw));
+  actualError = error;
+}
+
+static void assertUpdate(const float expectedError, const float expectedK[KC_STATE_DIM], const float expectedPwDiagonal[KC_STATE_DIM]) {
+  TEST_ASSERT_EQUAL_PTR(&this, actualThis);
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, expectedError, actualError);
+  for (int i = 0; i < KC_STATE_DIM; i++) {
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f * fabsf(expectedK[i]) + 1e-8f, expectedK[i], actualK[i]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, expectedPwDiagonal[i], actualPw[i][i]);
+    for (int j = 0; j < i; j++) {
+      TEST_ASSERT_EQUAL_FLOAT(actualPw[i][j], actualPw[j][i]);
+    }
+  }
+}
+
+void setUp(void) {
+  memset(&this, 0, sizeof(this));
+  this.S[KC_STATE_X] = 0.5f;
+  this.S[KC_STATE_Y] = -0.3f;
+  this.S[KC_STATE_Z] = 1.2f;
+
+  // Positive definite covariance with correlations between all states
+  float M[KC_STATE_DIM][KC_STATE_DIM];
+  for (int i = 0; i < KC_STATE_DIM; i++) {
+    for (int j = 0; j < KC_STATE_DIM; j++) {
+      M[i][j] = 0.1f * sinf(i * KC_STATE_DIM + j + 1);
+    }
+  }
+  for (int i = 0; i < KC_STATE_DIM; i++) {
+    for (int j = 0; j < KC_STATE_DIM; j++) {
+      float sum = (i == j) ? 0.01f : 0.0f;
+      for (int k = 0; k < KC_STATE_DIM; k++) {
+        sum += M[i][k] * M[j][k];
+      }
+      this.P[i][j] = sum;
+    }
+  }
+
+  measurement = (tdoaMeasurement_t){
+    .anchorPositions = {
+      {.x = -2.0f, .y = -2.0f, .z = 0.2f},
+      {.x = 2.0f, .y = -2.0f, .z = 2.5f},
+    },
+    .stdDev = 0.15f,
+  };
+
+  kalmanCoreUpdateWithPKE_StubWithCallback(mock_kalmanCoreUpdateWithPKE_callback);
+  kalmanCoreSyncCovariance_Ignore();
+}
+
+void tearDown(void) {
+  // Empty
+}
+
+void testThatInlierAndOutlierMatchReferenceValues() {
+  // Fixture
+  const float d0 = sqrtf(2.5f * 2.5f + 1.7f * 1.7f + 1.0f * 1.0f);
+  const float d1 = sqrtf(1.5f * 1.5f + 1.7f * 1.7f + 1.3f * 1.3f);
+
+  const float expectedKInlier[KC_STATE_DIM] = {-0.419892281f, 0.387109429f, -0.362034351f, 0.220048457f, -0.070071131f, -0.0923605934f, 0.2383762f, -0.342022955f, 0.384878755f};
+  const float expectedPwInlier[KC_STATE_DIM] = {0.0576346628f, 0.0577087067f, 0.0562691502f, 0.0541008338f, 0.0526970215f, 0.0529991202f, 0.0548019074f, 0.056880638f, 0.0578230768f};
+  const float expectedKOutlier[KC_STATE_DIM] = {-0.00179760566f, 0.00165970426f, -0.00155126024f, 0.000943619118f, -0.000301276246f, -0.000394615519f, 0.00102036854f, -0.00146476168f, 0.00164880895f};
+  const float expectedPwOutlier[KC_STATE_DIM] = {0.0576543957f, 0.0577200577f, 0.0562756732f, 0.0541023351f, 0.0526973158f, 0.0530026183f, 0.0548108555f, 0.0568935648f, 0.0578358136f};
+
+  // Test
+  // Assert
+  // The error state of the previous update is used to reweight the covariance, the calls are not independent
+  measurement.distanceDiff = d1 - d0 + 0.05f;
+  kalmanCoreRobustUpdateWithTdoa(&this, &measurement, 0);
+  assertUpdate(0.05f, expectedKInlier, expectedPwInlier);
+
+  measurement.distanceDiff = d1 - d0 + 1.5f;
+  kalmanCoreRobustUpdateWithTdoa(&this, &measurement, 0);
+  assertUpdate(1.5f, expectedKOutlier, expectedPwOutlier);
+}
+
+void testThatInstancesDoNotShareState() {
+  // Fixture
+  const float d0 = sqrtf(2.5f * 2.5f + 1.7f * 1.7f + 1.0f * 1.0f);
+  const float d1 = sqrtf(1.5f * 1.5f + 1.7f * 1.7f + 1.3f * 1.3f);
+  measurement.distanceDiff = d1 - d0 + 0.05f;
+
+  kalmanCoreData_t other;
+  memcpy(&other, &this, sizeof(other));
+  kalmanCoreRobustUpdateWithTdoa(&other, &measurement, 0);
+
+  // Test
+  kalmanCoreRobustUpdateWithTdoa(&this, &measurement, 0);
+
+  // Assert
+  // A second update of the same instance would be reweighted with the error state of the first one
+  const float expectedK[KC_STATE_DIM] = {-0.419892281f, 0.387109429f, -0.362034351f, 0.220048457f, -0.070071131f, -0.0923605934f, 0.2383762f, -0.342022955f, 0.384878755f};
+  const float expectedPw[KC_STATE_DIM] = {0.0576346628f, 0.0577087067f, 0.0562691502f, 0.0541008338f, 0.0526970215f, 0.0529991202f, 0.0548019074f, 0.056880638f, 0.0578230768f};
+  assertUpdate(0.05f, expectedK, expectedPw);
+}
+
+void testThatSampleWhereDroneIsInSamePositionAsAnchorIsIgnored() {
+  // Fixture
+  this.S[KC_STATE_X] = -2.0f;
+  this.S[KC_STATE_Y] = -2.0f;
+  this.S[KC_STATE_Z] = 0.2f;
+  measurement.distanceDiff = 1.0f;
+  actualError = 0.0f;
+
+  // Test
+  kalmanCoreRobustUpdateWithTdoa(&this, &measurement, 0);
+
+  // Assert
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, actualError);
+}
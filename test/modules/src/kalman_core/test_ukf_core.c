@@ -0,0 +1,391 @@
+// File under test ukf_core.c
+#include "ukf_core.h"
+
+#include "unity.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define N UKF_CORE_DIM
+
+static ukfCoreData_t standard;
+static ukfCoreData_t squareRoot;
+
+static const float stdDevInitial[N] = {10.0f, 10.0f, 1.0f, 0.01f, 0.01f, 0.01f, 0.1f, 0.1f, 0.1f};
+
+static float randomFloat(float min, float max) {
+  return min + (max - min) * ((float)rand() / (float)RAND_MAX);
+}
+
+static void randomSpd(float A[N][N], float diagonal) {
+  float B[N][N];
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < N; j++) {
+      B[i][j] = randomFloat(-1.0f, 1.0f);
+    }
+  }
+
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < N; j++) {
+      float sum = (i == j) ? diagonal : 0.0f;
+      for (int k = 0; k < N; k++) {
+        sum += B[i][k] * B[j][k];
+      }
+      A[i][j] = sum;
+    }
+  }
+}
+
+static void transitionMatrix(float F[N][N], float dt) {
+  memset(F, 0, sizeof(float) * N * N);
+  for (int i = 0; i < N; i++) {
+    F[i][i] = 1.0f;
+  }
+  for (int i = 0; i < 3; i++) {
+    F[i][i + 3] = dt;
+    F[i + 3][6 + ((i + 1) % 3)] = randomFloat(-0.1f, 0.1f);
+    F[6 + i][6 + ((i + 2) % 3)] = randomFloat(-0.01f, 0.01f);
+  }
+}
+
+static void processNoise(float Q[N][N], float dt) {
+  const float q = 1.0e-3f;
+  memset(Q, 0, sizeof(float) * N * N);
+  for (int i = 0; i < 3; i++) {
+    Q[i][i] = q * dt * dt * dt * 0.33f;
+    Q[i][i + 3] = q * dt * dt * 0.5f;
+    Q[i + 3][i] = q * dt * dt * 0.5f;
+    Q[i + 3][i + 3] = q * dt;
+    Q[i + 6][i + 6] = 1.0e-5f * dt;
+  }
+}
+
+static void processNoiseFactor(float Q[N][N], float sqrtQ[N][N]) {
+  ukfCoreCholesky(&Q[0][0], &sqrtQ[0][0], N);
+}
+
+static void assertMatrixEqual(float expected[N][N], float actual[N][N], float relativeTolerance) {
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < N; j++) {
+      const float scale = sqrtf(fabsf(expected[i][i] * expected[j][j]));
+      TEST_ASSERT_FLOAT_WITHIN(relativeTolerance * scale, expected[i][j], actual[i][j]);
+    }
+  }
+}
+
+void setUp(void) {
+  srand(4711);
+  ukfCoreInit(&standard, stdDevInitial, 0.6f, false);
+  ukfCoreInit(&squareRoot, stdDevInitial, 0.6f, true);
+}
+
+void tearDown(void) {
+  // Empty
+}
+
+void testThatInitialCovarianceIsDiagonal() {
+  // Fixture
+  float actual[N][N];
+
+  // Test
+  ukfCoreGetCovariance(&squareRoot, actual);
+
+  // Assert
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < N; j++) {
+      const float expected = (i == j) ? stdDevInitial[i] * stdDevInitial[i] : 0.0f;
+      TEST_ASSERT_EQUAL_FLOAT(expected, actual[i][j]);
+    }
+  }
+}
+
+void testThatSigmaPointsReproduceMeanAndCovariance() {
+  // Fixture
+  for (int i = 0; i < N; i++) {
+    standard.x[i] = randomFloat(-1.0f, 1.0f);
+  }
+  randomSpd(standard.P, 1.0f);
+
+  // Test
+  ukfCoreComputeSigmaPoints(&standard);
+
+  // Assert
+  float mean[N] = {0};
+  float covariance[N][N] = {{0}};
+  for (int j = 0; j < UKF_CORE_SIGMA_POINTS; j++) {
+    for (int i = 0; i < N; i++) {
+      mean[i] += standard.weights[j] * standard.sigmaPoints[j][i];
+    }
+  }
+  for (int j = 0; j < UKF_CORE_SIGMA_POINTS; j++) {
+    for (int i = 0; i < N; i++) {
+      for (int k = 0; k < N; k++) {
+        covariance[i][k] += standard.weights[j] * (standard.sigmaPoints[j][i] - mean[i]) * (standard.sigmaPoints[j][k] - mean[k]);
+      }
+    }
+  }
+
+  for (int i = 0; i < N; i++) {
+    TEST_ASSERT_FLOAT_WITHIN(1.0e-5f, standard.x[i], mean[i]);
+  }
+  assertMatrixEqual(standard.P, covariance, 1.0e-4f);
+}
+
+void testThatCholeskyFactorReproducesMatrix() {
+  // Fixture
+  float A[N][N];
+  float L[N][N];
+  randomSpd(A, 0.5f);
+
+  // Test
+  bool actual = ukfCoreCholesky(&A[0][0], &L[0][0], N);
+
+  // Assert
+  TEST_ASSERT_TRUE(actual);
+  float product[N][N];
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < N; j++) {
+      float sum = 0.0f;
+      for (int k = 0; k < N; k++) {
+        sum += L[i][k] * L[j][k];
+      }
+      product[i][j] = sum;
+    }
+    for (int j = i + 1; j < N; j++) {
+      TEST_ASSERT_EQUAL_FLOAT(0.0f, L[i][j]);
+    }
+  }
+  assertMatrixEqual(A, product, 1.0e-5f);
+}
+
+void testThatCholeskyOfIndefiniteMatrixFailsWithoutNaN() {
+  // Fixture
+  float A[N][N] = {{0}};
+  float L[N][N];
+  for (int i = 0; i < N; i++) {
+    A[i][i] = 1.0f;
+  }
+  A[4][4] = -1.0f;
+
+  // Test
+  bool actual = ukfCoreCholesky(&A[0][0], &L[0][0], N);
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < N; j++) {
+      TEST_ASSERT_FALSE(isnan(L[i][j]));
+    }
+  }
+}
+
+void testThatRankOneUpdateAndDowndateMatchFullFactorization() {
+  // Fixture
+  float A[N][N];
+  float L[N][N];
+  float v[N], work[N];
+  randomSpd(A, 1.0f);
+  for (int i = 0; i < N; i++) {
+    v[i] = randomFloat(-0.5f, 0.5f);
+  }
+  ukfCoreCholesky(&A[0][0], &L[0][0], N);
+
+  float updated[N][N], Lexpected[N][N];
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < N; j++) {
+      updated[i][j] = A[i][j] + v[i] * v[j];
+    }
+  }
+  ukfCoreCholesky(&updated[0][0], &Lexpected[0][0], N);
+
+  // Test
+  memcpy(work, v, sizeof(v));
+  bool actualUpdate = ukfCoreCholeskyUpdate(&L[0][0], work, N, false);
+
+  // Assert
+  TEST_ASSERT_TRUE(actualUpdate);
+  assertMatrixEqual(Lexpected, L, 1.0e-4f);
+
+  // Test
+  memcpy(work, v, sizeof(v));
+  bool actualDowndate = ukfCoreCholeskyUpdate(&L[0][0], work, N, true);
+
+  // Assert
+  float Loriginal[N][N];
+  ukfCoreCholesky(&A[0][0], &Loriginal[0][0], N);
+  TEST_ASSERT_TRUE(actualDowndate);
+  assertMatrixEqual(Loriginal, L, 1.0e-4f);
+}
+
+void testThatDowndateBelowZeroFails() {
+  // Fixture
+  float L[N][N] = {{0}};
+  float v[N] = {0};
+  for (int i = 0; i < N; i++) {
+    L[i][i] = 1.0f;
+  }
+  v[3] = 2.0f;
+
+  // Test
+  bool actual = ukfCoreCholeskyUpdate(&L[0][0], v, N, true);
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+}
+
+void testThatPredictionIsLinearCovariancePropagation() {
+  // Fixture
+  float F[N][N], Q[N][N], sqrtQ[N][N];
+  transitionMatrix(F, 0.01f);
+  processNoise(Q, 0.01f);
+  processNoiseFactor(Q, sqrtQ);
+  float P0[N][N];
+  ukfCoreGetCovariance(&standard, P0);
+
+  float expected[N][N];
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < N; j++) {
+      float sum = Q[i][j];
+      for (int k = 0; k < N; k++) {
+        for (int l = 0; l < N; l++) {
+          sum += F[i][k] * P0[k][l] * F[j][l];
+        }
+      }
+      expected[i][j] = sum;
+    }
+  }
+
+  // Test
+  ukfCorePredict(&standard, F, Q, NULL);
+  ukfCorePredict(&squareRoot, F, Q, sqrtQ);
+
+  // Assert
+  float actualStandard[N][N], actualSquareRoot[N][N];
+  ukfCoreGetCovariance(&standard, actualStandard);
+  ukfCoreGetCovariance(&squareRoot, actualSquareRoot);
+  assertMatrixEqual(expected, actualStandard, 1.0e-4f);
+  assertMatrixEqual(expected, actualSquareRoot, 1.0e-4f);
+}
+
+void testThatScalarUpdateReducesCovarianceAsKalmanUpdate() {
+  // Fixture
+  float outputs[UKF_CORE_SIGMA_POINTS];
+  for (int j = 0; j < UKF_CORE_SIGMA_POINTS; j++) {
+    outputs[j] = squareRoot.sigmaPoints[j][2] - squareRoot.sigmaPoints[j][0];
+  }
+  float mean, Pyy, Pxy[N];
+  ukfCoreOutputMoments(&squareRoot, outputs, &mean, &Pyy, Pxy);
+  Pyy += 0.1f * 0.1f;
+  const float innovation = 0.5f;
+
+  float P0[N][N];
+  ukfCoreGetCovariance(&squareRoot, P0);
+
+  // Test
+  ukfCoreScalarUpdate(&squareRoot, Pxy, Pyy, innovation);
+
+  // Assert
+  // H = [-1 0 1 0 ...], P is diagonal
+  TEST_ASSERT_FLOAT_WITHIN(1.0e-5f, 0.0f, mean);
+  TEST_ASSERT_FLOAT_WITHIN(1.0e-3f, P0[0][0] + P0[2][2] + 0.01f, Pyy);
+  TEST_ASSERT_FLOAT_WITHIN(1.0e-3f, -P0[0][0], Pxy[0]);
+  TEST_ASSERT_FLOAT_WITHIN(1.0e-4f, P0[2][2], Pxy[2]);
+
+  float expected[N][N];
+  for (int i = 0; i < N; i++) {
+    TEST_ASSERT_FLOAT_WITHIN(1.0e-5f, Pxy[i] / Pyy * innovation, squareRoot.x[i]);
+    for (int j = 0; j < N; j++) {
+      expected[i][j] = P0[i][j] - Pxy[i] * Pxy[j] / Pyy;
+    }
+  }
+  float actual[N][N];
+  ukfCoreGetCovariance(&squareRoot, actual);
+  assertMatrixEqual(expected, actual, 1.0e-4f);
+  TEST_ASSERT_EQUAL_UINT32(0, squareRoot.downdateFailures);
+}
+
+void testThatSquareRootFilterTracksDoublePrecisionKalmanFilterOverManySteps() {
+  // Fixture
+  // With a linear measurement the UKF is equivalent to a linear Kalman filter, computed in double as reference
+  float F[N][N], Q[N][N], sqrtQ[N][N];
+  float outputs[UKF_CORE_SIGMA_POINTS];
+  float mean, Pyy, Pxy[N];
+  double reference[N][N] = {{0}};
+  double tmp[N][N];
+  for (int i = 0; i < N; i++) {
+    reference[i][i] = stdDevInitial[i] * stdDevInitial[i];
+  }
+
+  // Test
+  for (int step = 0; step < 200; step++) {
+    transitionMatrix(F, 0.01f);
+    processNoise(Q, 0.01f);
+    processNoiseFactor(Q, sqrtQ);
+    ukfCorePredict(&squareRoot, F, Q, sqrtQ);
+
+    for (int i = 0; i < N; i++) {
+      for (int j = 0; j < N; j++) {
+        double sum = 0.0;
+        for (int k = 0; k < N; k++) {
+          sum += (double)F[i][k] * reference[k][j];
+        }
+        tmp[i][j] = sum;
+      }
+    }
+    for (int i = 0; i < N; i++) {
+      for (int j = 0; j < N; j++) {
+        double sum = Q[i][j];
+        for (int k = 0; k < N; k++) {
+          sum += tmp[i][k] * (double)F[j][k];
+        }
+        reference[i][j] = sum;
+      }
+    }
+
+    // Linearized range like measurement to a random anchor
+    float h[N] = {0};
+    h[0] = randomFloat(-1.0f, 1.0f);
+    h[1] = randomFloat(-1.0f, 1.0f);
+    h[2] = randomFloat(-1.0f, 1.0f);
+    const float stdDev = 0.05f;
+
+    for (int j = 0; j < UKF_CORE_SIGMA_POINTS; j++) {
+      outputs[j] = 0.0f;
+      for (int i = 0; i < N; i++) {
+        outputs[j] += h[i] * squareRoot.sigmaPoints[j][i];
+      }
+    }
+    ukfCoreOutputMoments(&squareRoot, outputs, &mean, &Pyy, Pxy);
+    Pyy += stdDev * stdDev;
+    ukfCoreScalarUpdate(&squareRoot, Pxy, Pyy, randomFloat(-0.05f, 0.05f));
+    memset(squareRoot.x, 0, sizeof(squareRoot.x));
+    ukfCoreComputeSigmaPoints(&squareRoot);
+
+    double PHt[N];
+    double HPHt = (double)stdDev * stdDev;
+    for (int i = 0; i < N; i++) {
+      PHt[i] = 0.0;
+      for (int k = 0; k < N; k++) {
+        PHt[i] += reference[i][k] * (double)h[k];
+      }
+      HPHt += (double)h[i] * PHt[i];
+    }
+    for (int i = 0; i < N; i++) {
+      for (int j = 0; j < N; j++) {
+        reference[i][j] -= PHt[i] * PHt[j] / HPHt;
+      }
+    }
+  }
+
+  // Assert
+  float expected[N][N], actual[N][N];
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < N; j++) {
+      expected[i][j] = (float)reference[i][j];
+    }
+  }
+  ukfCoreGetCovariance(&squareRoot, actual);
+  assertMatrixEqual(expected, actual, 1.0e-3f);
+  TEST_ASSERT_EQUAL_UINT32(0, squareRoot.downdateFailures);
+}
@@ -0,0 +1,81 @@
+// File under test ext_pos_packed.c
+#include "ext_pos_packed.h"
+
+#include <string.h>
+
+#include "unity.h"
+
+static extPosePackedItem items[5];
+
+static void setIds(const uint8_t* ids, const uint8_t count) {
+  memset(items, 0, sizeof(items));
+  for (int i = 0; i < count; i++) {
+    items[i].id = ids[i];
+  }
+}
+
+static uint8_t lowerBound(const uint8_t count, const uint8_t id) {
+  return extPackedLowerBound((const uint8_t*)items, count, sizeof(extPosePackedItem), id);
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+  // Empty
+}
+
+void testThatExistingIdIsFound() {
+  // Fixture
+  const uint8_t ids[] = {3, 7, 12, 40, 200};
+  setIds(ids, 5);
+
+  // Test
+  // Assert
+  TEST_ASSERT_EQUAL_UINT8(0, lowerBound(5, 3));
+  TEST_ASSERT_EQUAL_UINT8(2, lowerBound(5, 12));
+  TEST_ASSERT_EQUAL_UINT8(4, lowerBound(5, 200));
+}
+
+void testThatMissingIdGivesIndexOfNextLargerId() {
+  // Fixture
+  const uint8_t ids[] = {3, 7, 12, 40, 200};
+  setIds(ids, 5);
+
+  // Test
+  // Assert
+  TEST_ASSERT_EQUAL_UINT8(0, lowerBound(5, 0));
+  TEST_ASSERT_EQUAL_UINT8(3, lowerBound(5, 13));
+}
+
+void testThatIdLargerThanAllGivesCount() {
+  // Fixture
+  const uint8_t ids[] = {3, 7, 12};
+  setIds(ids, 3);
+
+  // Test
+  uint8_t actual = lowerBound(3, 255);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT8(3, actual);
+}
+
+void testThatNoItemsGivesZero() {
+  // Fixture
+  // Test
+  uint8_t actual = lowerBound(0, 17);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT8(0, actual);
+}
+
+void testThatPositionItemsAreSearchedWithTheirOwnSize() {
+  // Fixture
+  extPositionPackedItem positions[3] = {{.id = 5, .x = 99}, {.id = 9, .x = 99}, {.id = 11, .x = 99}};
+
+  // Test
+  uint8_t actual = extPackedLowerBound((const uint8_t*)positions, 3, sizeof(extPositionPackedItem), 9);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT8(1, actual);
+}
@@ -2,6 +2,7 @@
 #include "mem.h"
 
 #include "unity.h"
+#include "freertosMocks.h"
 
 
 // Memory handler ------------------------------------
@@ -109,6 +110,26 @@ void testThatAHandlerCanBeRegistered() {
   TEST_ASSERT_EQUAL(MEM_TYPE_APP, memGetType(index));
 }
 
+void testThatMemoriesOfDecksInitializedInParallelAreAllRegistered() {
+  // Fixture
+  // The memories of the lighthouse deck and the led ring deck, that do not share
+  // any resources and are initialized in parallel
+  const MemoryHandlerDef_t lighthouseDef = { .type = MEM_TYPE_LH, .getSize = handleMemGetSize };
+  const MemoryHandlerDef_t ledringDef = { .type = MEM_TYPE_LED12, .getSize = handleMemGetSize };
+  const MemoryHandlerDef_t ledringTimingDef = { .type = MEM_TYPE_LEDMEM, .getSize = handleMemGetSize };
+
+  // Test
+  memoryRegisterHandler(&ledringDef);
+  memoryRegisterHandler(&lighthouseDef);
+  memoryRegisterHandler(&ledringTimingDef);
+
+  // Assert
+  TEST_ASSERT_EQUAL(4, memGetNrOfMems());
+  TEST_ASSERT_EQUAL(MEM_TYPE_LED12, memGetType(1));
+  TEST_ASSERT_EQUAL(MEM_TYPE_LH, memGetType(2));
+  TEST_ASSERT_EQUAL(MEM_TYPE_LEDMEM, memGetType(3));
+}
+
 void testRead() {
   // Fixture
   uint16_t index = 1;
@@ -0,0 +1,152 @@
+// File under test state_stream.c
+#include "state_stream.h"
+
+#include <string.h>
+
+#include "unity.h"
+
+#include "mock_crtp.h"
+#include "crtp_localization_service.h"
+#include "quatcompress.h"
+
+static state_t state;
+static setpoint_t setpoint;
+static sensorData_t sensorData;
+
+void setUp(void) {
+  memset(&state, 0, sizeof(state));
+  memset(&setpoint, 0, sizeof(setpoint));
+  memset(&sensorData, 0, sizeof(sensorData));
+  state.attitudeQuaternion.w = 1.0f;
+}
+
+void tearDown(void) {
+  // Empty
+}
+
+void testThatSnapshotsFitInOneCrtpPacket() {
+  // Fixture
+  // Test
+  // Assert
+  TEST_ASSERT_LESS_OR_EQUAL(CRTP_MAX_DATA_SIZE, sizeof(stateSnapshotPacket_t));
+  TEST_ASSERT_LESS_OR_EQUAL(CRTP_MAX_DATA_SIZE, sizeof(setpointSnapshotPacket_t));
+}
+
+void testThatStateIsPackedInMillimeters() {
+  // Fixture
+  state.position.x = 1.234f;
+  state.position.y = -0.5f;
+  state.position.z = 2.0f;
+  state.velocity.x = 0.1f;
+  state.velocity.y = -0.2f;
+  state.velocity.z = 0.3f;
+  stateSnapshotPacket_t actual;
+
+  // Test
+  stateStreamPackState(&actual, 4711, &state, &sensorData);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT8(STATE_SNAPSHOT, actual.type);
+  TEST_ASSERT_EQUAL_UINT32(4711, actual.timestamp);
+  TEST_ASSERT_INT16_WITHIN(1, 1234, actual.x);
+  TEST_ASSERT_INT16_WITHIN(1, -500, actual.y);
+  TEST_ASSERT_INT16_WITHIN(1, 2000, actual.z);
+  TEST_ASSERT_INT16_WITHIN(1, 100, actual.vx);
+  TEST_ASSERT_INT16_WITHIN(1, -200, actual.vy);
+  TEST_ASSERT_INT16_WITHIN(1, 300, actual.vz);
+}
+
+void testThatAttitudeIsCompressedAndRatesAreInMilliradians() {
+  // Fixture
+  state.attitudeQuaternion.x = 0.0f;
+  state.attitudeQuaternion.y = 0.0f;
+  state.attitudeQuaternion.z = 0.70710678f;
+  state.attitudeQuaternion.w = 0.70710678f;
+  sensorData.gyro.x = 180.0f;
+  sensorData.gyro.y = 90.0f;
+  sensorData.gyro.z = -18.0f;
+  const float q[4] = {0.0f, 0.0f, 0.70710678f, 0.70710678f};
+  stateSnapshotPacket_t actual;
+
+  // Test
+  stateStreamPackState(&actual, 0, &state, &sensorData);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(quatcompress(q), actual.quat);
+  TEST_ASSERT_INT16_WITHIN(1, 3142, actual.rateRoll);
+  // Pitch is negated, as in the stateEstimateZ log group
+  TEST_ASSERT_INT16_WITHIN(1, -1571, actual.ratePitch);
+  TEST_ASSERT_INT16_WITHIN(1, -314, actual.rateYaw);
+}
+
+void testThatValuesOutOfRangeAreSaturated() {
+  // Fixture
+  state.position.x = 100.0f;
+  state.position.y = -100.0f;
+  stateSnapshotPacket_t actual;
+
+  // Test
+  stateStreamPackState(&actual, 0, &state, &sensorData);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT16(INT16_MAX, actual.x);
+  TEST_ASSERT_EQUAL_INT16(INT16_MIN, actual.y);
+}
+
+void testThatSetpointIsPacked() {
+  // Fixture
+  setpoint.position.x = 0.5f;
+  setpoint.position.y = 1.5f;
+  setpoint.position.z = 1.0f;
+  setpoint.velocity.x = -0.25f;
+  setpoint.acceleration.z = 2.0f;
+  setpoint.attitude.yaw = -45.5f;
+  setpointSnapshotPacket_t actual;
+
+  // Test
+  stateStreamPackSetpoint(&actual, 1234, &setpoint);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT8(SETPOINT_SNAPSHOT, actual.type);
+  TEST_ASSERT_EQUAL_UINT32(1234, actual.timestamp);
+  TEST_ASSERT_INT16_WITHIN(1, 500, actual.x);
+  TEST_ASSERT_INT16_WITHIN(1, 1500, actual.y);
+  TEST_ASSERT_INT16_WITHIN(1, 1000, actual.z);
+  TEST_ASSERT_INT16_WITHIN(1, -250, actual.vx);
+  TEST_ASSERT_INT16_WITHIN(1, 2000, actual.az);
+  TEST_ASSERT_INT16_WITHIN(1, -4550, actual.yaw);
+}
+
+void testThatNothingIsSentWhenTheStreamIsDisabled() {
+  // Fixture
+  // The stream is disabled by default, no calls to crtpSendPacket() are expected
+
+  // Test
+  for (stabilizerStep_t step = 0; step < 100; step++) {
+    stateStreamUpdate(&state, &setpoint, &sensorData, step);
+  }
+
+  // Assert
+  // Verified by the mock
+}
+
+void testThatRatesThatDivideTheLoopRateAreKept() {
+  // Fixture
+  // Test
+  // Assert
+  TEST_ASSERT_EQUAL_UINT16(1, stateStreamClampRate(1));
+  TEST_ASSERT_EQUAL_UINT16(100, stateStreamClampRate(100));
+  TEST_ASSERT_EQUAL_UINT16(250, stateStreamClampRate(250));
+  TEST_ASSERT_EQUAL_UINT16(1000, stateStreamClampRate(1000));
+}
+
+void testThatOtherRatesAreClampedDownToADivisor() {
+  // Fixture
+  // Test
+  // Assert
+  TEST_ASSERT_EQUAL_UINT16(2, stateStreamClampRate(3));
+  TEST_ASSERT_EQUAL_UINT16(250, stateStreamClampRate(300));
+  TEST_ASSERT_EQUAL_UINT16(500, stateStreamClampRate(999));
+  TEST_ASSERT_EQUAL_UINT16(1000, stateStreamClampRate(5000));
+  TEST_ASSERT_EQUAL_UINT16(0, stateStreamClampRate(0));
+}
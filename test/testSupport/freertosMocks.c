@@ -7,4 +7,12 @@ uint32_t xTaskGetTickCount()
 
 void vTaskDelay(uint32_t delay) {
   return;
-}
\ No newline at end of file
+}
+
+void vPortEnterCritical(void) {
+  return;
+}
+
+void vPortExitCritical(void) {
+  return;
+}
@@ -0,0 +1,254 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * test_tdoa3_rx_batch.c - Unit tests for batched processing of TDoA3 packets
+ */
+
+// File under test
+#include "tdoa3RxBatch.h"
+
+#include <string.h>
+
+#include "unity.h"
+#include "tdoaEngine.h"
+#include "tdoaStorage.h"
+#include "tdoaStats.h"
+#include "clockCorrectionEngine.h"
+#include "statsCnt.h"
+
+static tdoa3RxBatch_t batch;
+static tdoaEngineState_t engineState;
+
+static int handlerCallCount;
+static uint8_t handlerAnchorIds[TDOA3_RX_BATCH_SIZE];
+static int handlerRangeDataLengths[TDOA3_RX_BATCH_SIZE];
+
+static int fixtureCreatePacket(uint8_t* payload, const uint8_t seq, const uint32_t txTime, const uint8_t remoteId, const uint32_t remoteRxTime, const uint16_t distance);
+static void handler(tdoaAnchorContext_t* anchorCtx, const tdoa3RxPacket_t* packet, const int rangeDataLength, const bool timeIsGood);
+static void sendTdoaToEstimator(tdoaMeasurement_t* measurement) {}
+
+void setUp(void) {
+  tdoa3RxBatchInit(&batch);
+  tdoaEngineInit(&engineState, 0, sendTdoaToEstimator, 499.2e6 * 128, TdoaEngineMatchingAlgorithmRandom);
+
+  handlerCallCount = 0;
+}
+
+void testThatAPacketIsCopiedToTheBatch() {
+  // Fixture
+  uint8_t payload[TDOA3_RX_MAX_PAYLOAD];
+  int length = fixtureCreatePacket(payload, 3, 1000, 7, 500, 0);
+
+  // Test
+  bool actual = tdoa3RxBatchAdd(&batch, 5, payload, length, 123456, 17);
+
+  // Assert
+  TEST_ASSERT_TRUE(actual);
+  TEST_ASSERT_EQUAL_UINT8(1, batch.count);
+  TEST_ASSERT_EQUAL_UINT8(5, batch.packets[0].anchorId);
+  TEST_ASSERT_EQUAL_INT64(123456, batch.packets[0].rxTime);
+  TEST_ASSERT_EQUAL_UINT32(17, batch.packets[0].rxTime_ms);
+  TEST_ASSERT_EQUAL_UINT8(length, batch.packets[0].payloadLength);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(payload, batch.packets[0].payload, length);
+}
+
+void testThatAPacketIsDroppedWhenTheBatchIsFull() {
+  // Fixture
+  uint8_t payload[TDOA3_RX_MAX_PAYLOAD];
+  int length = fixtureCreatePacket(payload, 3, 1000, 7, 500, 0);
+  for (int i = 0; i < TDOA3_RX_BATCH_SIZE; i++) {
+    tdoa3RxBatchAdd(&batch, 5, payload, length, 123456, 17);
+  }
+
+  // Test
+  bool actual = tdoa3RxBatchAdd(&batch, 5, payload, length, 123456, 17);
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+  TEST_ASSERT_EQUAL_UINT8(TDOA3_RX_BATCH_SIZE, batch.count);
+}
+
+void testThatAPacketShorterThanTheHeaderIsDropped() {
+  // Fixture
+  uint8_t payload[TDOA3_RX_MAX_PAYLOAD] = {PACKET_TYPE_TDOA3};
+
+  // Test
+  bool actual = tdoa3RxBatchAdd(&batch, 5, payload, sizeof(rangePacketHeader3_t) - 1, 123456, 17);
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+  TEST_ASSERT_EQUAL_UINT8(0, batch.count);
+}
+
+void testThatAnEmptyBatchHasNoDeadline() {
+  // Fixture
+  // Test
+  uint32_t actual = tdoa3RxBatchTimeToDeadline(&batch, 100);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, actual);
+}
+
+void testThatTheDeadlineIsSetByTheOldestPacket() {
+  // Fixture
+  uint8_t payload[TDOA3_RX_MAX_PAYLOAD];
+  int length = fixtureCreatePacket(payload, 3, 1000, 7, 500, 0);
+  tdoa3RxBatchAdd(&batch, 5, payload, length, 123456, 100);
+  tdoa3RxBatchAdd(&batch, 6, payload, length, 123456, 102);
+
+  // Test
+  uint32_t actual = tdoa3RxBatchTimeToDeadline(&batch, 103);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(TDOA3_RX_BATCH_MAX_AGE_MS - 3, actual);
+}
+
+void testThatTheDeadlineHasPassedWhenTheOldestPacketHasReachedMaxAge() {
+  // Fixture
+  uint8_t payload[TDOA3_RX_MAX_PAYLOAD];
+  int length = fixtureCreatePacket(payload, 3, 1000, 7, 500, 0);
+  tdoa3RxBatchAdd(&batch, 5, payload, length, 123456, 100);
+
+  // Test
+  uint32_t actual = tdoa3RxBatchTimeToDeadline(&batch, 100 + TDOA3_RX_BATCH_MAX_AGE_MS);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(0, actual);
+}
+
+void testThatTheDeadlineHasPassedWhenTheBatchIsFull() {
+  // Fixture
+  uint8_t payload[TDOA3_RX_MAX_PAYLOAD];
+  int length = fixtureCreatePacket(payload, 3, 1000, 7, 500, 0);
+  for (int i = 0; i < TDOA3_RX_BATCH_SIZE; i++) {
+    tdoa3RxBatchAdd(&batch, 5, payload, length, 123456, 100);
+  }
+
+  // Test
+  uint32_t actual = tdoa3RxBatchTimeToDeadline(&batch, 100);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(0, actual);
+}
+
+void testThatProcessingUpdatesTheStorageAndEmptiesTheBatch() {
+  // Fixture
+  uint8_t payload[TDOA3_RX_MAX_PAYLOAD];
+  int length = fixtureCreatePacket(payload, 3, 1000, 7, 500, 1234);
+  tdoa3RxBatchAdd(&batch, 5, payload, length, 123456, 100);
+
+  // Test
+  int actual = tdoa3RxBatchProcess(&batch, &engineState, false, 0, 0);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(1, actual);
+  TEST_ASSERT_EQUAL_UINT8(0, batch.count);
+
+  tdoaAnchorContext_t anchorCtx;
+  TEST_ASSERT_TRUE(tdoaStorageGetAnchorCtx(engineState.anchorInfoArray, 5, 100, &anchorCtx));
+  TEST_ASSERT_EQUAL_INT64(123456, tdoaStorageGetRxTime(&anchorCtx));
+  TEST_ASSERT_EQUAL_INT64(1000, tdoaStorageGetTxTime(&anchorCtx));
+  TEST_ASSERT_EQUAL_UINT8(3, tdoaStorageGetSeqNr(&anchorCtx));
+  TEST_ASSERT_EQUAL_INT64(500, tdoaStorageGetRemoteRxTime(&anchorCtx, 7));
+  TEST_ASSERT_EQUAL_INT64(1234, tdoaStorageGetRemoteTimeOfFlight(&anchorCtx, 7));
+}
+
+void testThatTheHandlerIsCalledForEachPacketInOrder() {
+  // Fixture
+  uint8_t payload[TDOA3_RX_MAX_PAYLOAD];
+  int lengthWithDistance = fixtureCreatePacket(payload, 3, 1000, 7, 500, 1234);
+  tdoa3RxBatchAdd(&batch, 5, payload, lengthWithDistance, 123456, 100);
+  int lengthWithoutDistance = fixtureCreatePacket(payload, 4, 2000, 7, 600, 0);
+  tdoa3RxBatchAdd(&batch, 6, payload, lengthWithoutDistance, 123457, 101);
+
+  // Test
+  tdoa3RxBatchProcess(&batch, &engineState, false, 0, handler);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(2, handlerCallCount);
+  TEST_ASSERT_EQUAL_UINT8(5, handlerAnchorIds[0]);
+  TEST_ASSERT_EQUAL_UINT8(6, handlerAnchorIds[1]);
+  TEST_ASSERT_EQUAL_INT(sizeof(rangePacketHeader3_t) + sizeof(remoteAnchorDataFull_t), handlerRangeDataLengths[0]);
+  TEST_ASSERT_EQUAL_INT(sizeof(rangePacketHeader3_t) + sizeof(remoteAnchorDataShort_t), handlerRangeDataLengths[1]);
+}
+
+void testThatRemoteDataOutsideOfATruncatedPacketIsIgnored() {
+  // Fixture
+  uint8_t payload[TDOA3_RX_MAX_PAYLOAD];
+  int length = fixtureCreatePacket(payload, 3, 1000, 7, 500, 1234);
+  tdoa3RxBatchAdd(&batch, 5, payload, length - 1, 123456, 100);
+
+  // Test
+  tdoa3RxBatchProcess(&batch, &engineState, false, 0, handler);
+
+  // Assert
+  tdoaAnchorContext_t anchorCtx;
+  TEST_ASSERT_TRUE(tdoaStorageGetAnchorCtx(engineState.anchorInfoArray, 5, 100, &anchorCtx));
+  TEST_ASSERT_EQUAL_INT64(0, tdoaStorageGetRemoteRxTime(&anchorCtx, 7));
+  TEST_ASSERT_EQUAL_INT(sizeof(rangePacketHeader3_t), handlerRangeDataLengths[0]);
+}
+
+void testThatRemoteDataShorterThanTheShortFormatIsIgnored() {
+  // Fixture
+  uint8_t payload[TDOA3_RX_MAX_PAYLOAD];
+  fixtureCreatePacket(payload, 3, 1000, 7, 500, 0);
+  tdoa3RxBatchAdd(&batch, 5, payload, sizeof(rangePacketHeader3_t) + 1, 123456, 100);
+
+  // Test
+  tdoa3RxBatchProcess(&batch, &engineState, false, 0, handler);
+
+  // Assert
+  tdoaAnchorContext_t anchorCtx;
+  TEST_ASSERT_TRUE(tdoaStorageGetAnchorCtx(engineState.anchorInfoArray, 5, 100, &anchorCtx));
+  TEST_ASSERT_EQUAL_INT64(0, tdoaStorageGetRemoteRxTime(&anchorCtx, 7));
+  TEST_ASSERT_EQUAL_INT(sizeof(rangePacketHeader3_t), handlerRangeDataLengths[0]);
+}
+
+// Helpers ///////////////////////////////////////////////////////////////////
+
+static int fixtureCreatePacket(uint8_t* payload, const uint8_t seq, const uint32_t txTime, const uint8_t remoteId, const uint32_t remoteRxTime, const uint16_t distance) {
+  rangePacket3_t* packet = (rangePacket3_t*)payload;
+  packet->header.type = PACKET_TYPE_TDOA3;
+  packet->header.seq = seq;
+  packet->header.txTimeStamp = txTime;
+  packet->header.remoteCount = 1;
+
+  remoteAnchorDataFull_t* remoteData = (remoteAnchorDataFull_t*)&packet->remoteAnchorData;
+  remoteData->id = remoteId;
+  remoteData->seq = seq;
+  remoteData->rxTimeStamp = remoteRxTime;
+
+  if (distance != 0) {
+    remoteData->seq |= 0x80;
+    remoteData->distance = distance;
+    return sizeof(rangePacketHeader3_t) + sizeof(remoteAnchorDataFull_t);
+  }
+
+  return sizeof(rangePacketHeader3_t) + sizeof(remoteAnchorDataShort_t);
+}
+
+static void handler(tdoaAnchorContext_t* anchorCtx, const tdoa3RxPacket_t* packet, const int rangeDataLength, const bool timeIsGood) {
+  handlerAnchorIds[handlerCallCount] = tdoaStorageGetId(anchorCtx);
+  handlerRangeDataLengths[handlerCallCount] = rangeDataLength;
+  handlerCallCount++;
+}
@@ -0,0 +1,261 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * test_consoleBuffer.c - unit tests for the console buffers
+ */
+
+// File under test
+#include "consoleBuffer.h"
+
+#include <string.h>
+
+#include "unity.h"
+
+static consoleBufferRing_t ring;
+static consoleBufferStaging_t staging;
+
+// Helpers
+static bool putString(const char* str);
+static void assertFront(const char* expected);
+
+void setUp(void) {
+  consoleBufferRingInit(&ring);
+  consoleBufferStagingInit(&staging);
+}
+
+void tearDown(void) {}
+
+void testThatRingIsEmptyAfterInit() {
+  // Fixture
+  // Test
+  const consoleBufferPacket_t* actual = consoleBufferRingFront(&ring);
+
+  // Assert
+  TEST_ASSERT_NULL(actual);
+  TEST_ASSERT_EQUAL_UINT32(0, consoleBufferRingCount(&ring));
+}
+
+void testThatPacketIsNotClosedBeforeNewLine() {
+  // Fixture
+  // Test
+  const bool actual = putString("Hello");
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+  TEST_ASSERT_NULL(consoleBufferRingFront(&ring));
+}
+
+void testThatNewLineClosesPacket() {
+  // Fixture
+  // Test
+  const bool actual = putString("Hello\n");
+
+  // Assert
+  TEST_ASSERT_TRUE(actual);
+  TEST_ASSERT_EQUAL_UINT32(1, consoleBufferRingCount(&ring));
+  assertFront("Hello\n");
+}
+
+void testThatFullPacketIsClosed() {
+  // Fixture
+  const char* text = "abcdefghijklmnopqrstuvwxyz0123456789";
+
+  // Test
+  putString(text);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(1, consoleBufferRingCount(&ring));
+  const consoleBufferPacket_t* front = consoleBufferRingFront(&ring);
+  TEST_ASSERT_EQUAL_UINT8(CONSOLE_BUFFER_PAYLOAD_SIZE, front->size);
+  TEST_ASSERT_EQUAL_MEMORY(text, front->data, CONSOLE_BUFFER_PAYLOAD_SIZE);
+}
+
+void testThatPacketsArePoppedInOrder() {
+  // Fixture
+  putString("first\n");
+  putString("second\n");
+
+  // Test
+  assertFront("first\n");
+  consoleBufferRingPop(&ring);
+
+  // Assert
+  assertFront("second\n");
+  consoleBufferRingPop(&ring);
+  TEST_ASSERT_NULL(consoleBufferRingFront(&ring));
+}
+
+void testThatCloseClosesNonEmptyPacket() {
+  // Fixture
+  putString("partial");
+
+  // Test
+  const bool actual = consoleBufferRingClose(&ring);
+
+  // Assert
+  TEST_ASSERT_TRUE(actual);
+  assertFront("partial");
+}
+
+void testThatCloseDoesNothingOnEmptyPacket() {
+  // Fixture
+  // Test
+  const bool actual = consoleBufferRingClose(&ring);
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+  TEST_ASSERT_EQUAL_UINT32(0, consoleBufferRingCount(&ring));
+}
+
+void testThatCharactersAreDroppedWhenRingIsFull() {
+  // Fixture
+  for (int i = 0; i < CONSOLE_BUFFER_PACKETS; i++) {
+    putString("line\n");
+  }
+
+  // Test
+  const bool actual = putString("dropped\n");
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+  TEST_ASSERT_EQUAL_UINT32(CONSOLE_BUFFER_PACKETS, consoleBufferRingCount(&ring));
+  TEST_ASSERT_TRUE(ring.overflow);
+}
+
+void testThatMarkerIsWrittenWhenThereIsRoomAgain() {
+  // Fixture
+  for (int i = 0; i < CONSOLE_BUFFER_PACKETS; i++) {
+    putString("line\n");
+  }
+  putString("dropped\n");
+  for (int i = 0; i < CONSOLE_BUFFER_PACKETS; i++) {
+    consoleBufferRingPop(&ring);
+  }
+
+  // Test
+  putString("next\n");
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(2, consoleBufferRingCount(&ring));
+  assertFront("<F>\n");
+  consoleBufferRingPop(&ring);
+  assertFront("next\n");
+}
+
+void testThatRingWrapsAround() {
+  // Fixture
+  for (int i = 0; i < CONSOLE_BUFFER_PACKETS * 3; i++) {
+    putString("line\n");
+    consoleBufferRingPop(&ring);
+  }
+
+  // Test
+  putString("last\n");
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(1, consoleBufferRingCount(&ring));
+  assertFront("last\n");
+}
+
+void testThatStagedCharactersAreMovedToRing() {
+  // Fixture
+  consoleBufferStagingPut(&staging, 'i');
+  consoleBufferStagingPut(&staging, 's');
+  consoleBufferStagingPut(&staging, 'r');
+  consoleBufferStagingPut(&staging, '\n');
+
+  // Test
+  const bool actual = consoleBufferStagingDrain(&staging, &ring);
+
+  // Assert
+  TEST_ASSERT_TRUE(actual);
+  assertFront("isr\n");
+  TEST_ASSERT_EQUAL_UINT32(staging.head, staging.tail);
+}
+
+void testThatStagingDropsCharactersWhenFull() {
+  // Fixture
+  for (int i = 0; i < CONSOLE_BUFFER_STAGING_SIZE; i++) {
+    TEST_ASSERT_TRUE(consoleBufferStagingPut(&staging, 'a'));
+  }
+
+  // Test
+  const bool actual = consoleBufferStagingPut(&staging, 'b');
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+  TEST_ASSERT_EQUAL_UINT32(1, staging.dropped);
+}
+
+void testThatDrainWritesMarkerWhenStagedCharactersWereDropped() {
+  // Fixture
+  for (int i = 0; i < CONSOLE_BUFFER_STAGING_SIZE + 1; i++) {
+    consoleBufferStagingPut(&staging, 'a');
+  }
+
+  // Test
+  consoleBufferStagingDrain(&staging, &ring);
+
+  // Assert
+  // 64 characters fill two packets, the rest is closed before the marker
+  TEST_ASSERT_EQUAL_UINT32(4, consoleBufferRingCount(&ring));
+  for (int i = 0; i < 3; i++) {
+    consoleBufferRingPop(&ring);
+  }
+  assertFront("<F>\n");
+  TEST_ASSERT_EQUAL_UINT32(0, staging.dropped);
+}
+
+void testThatDrainStopsAtReservedCellThatIsNotWritten() {
+  // Fixture
+  consoleBufferStagingPut(&staging, 'a');
+  // Simulates an interrupt that has reserved a cell but not written it yet
+  staging.head++;
+  staging.cells[(staging.head) & (CONSOLE_BUFFER_STAGING_SIZE - 1)] = 0x100 | 'b';
+  staging.head++;
+
+  // Test
+  consoleBufferStagingDrain(&staging, &ring);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(1, staging.tail);
+  consoleBufferRingClose(&ring);
+  assertFront("a");
+}
+
+// Helpers
+
+static bool putString(const char* str) {
+  bool closed = false;
+  while (*str) {
+    closed |= consoleBufferRingPutchar(&ring, *str++);
+  }
+  return closed;
+}
+
+static void assertFront(const char* expected) {
+  const consoleBufferPacket_t* front = consoleBufferRingFront(&ring);
+  TEST_ASSERT_NOT_NULL(front);
+  TEST_ASSERT_EQUAL_UINT8(strlen(expected), front->size);
+  TEST_ASSERT_EQUAL_MEMORY(expected, front->data, front->size);
+}
@@ -0,0 +1,152 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Unit tests for crc32
+ */
+
+// Module under test
+#include "crc32.h"
+
+#include "unity.h"
+
+#include <stdlib.h>
+
+#define BUFFER_SIZE 1024
+
+static uint8_t buffer[BUFFER_SIZE + 8];
+
+// Bit by bit reference implementation, same algorithm as the original byte wise version
+static uint32_t referenceCrc(const uint8_t* data, size_t size) {
+  uint32_t remainder = 0xffffffff;
+  for (size_t i = 0; i < size; i++) {
+    remainder ^= data[i];
+    for (int bit = 0; bit < 8; bit++) {
+      if (remainder & 1) {
+        remainder = (remainder >> 1) ^ 0xEDB88320;
+      } else {
+        remainder = remainder >> 1;
+      }
+    }
+  }
+  return remainder ^ 0xffffffff;
+}
+
+void setUp(void) {
+  srand(4711);
+  for (int i = 0; i < BUFFER_SIZE + 8; i++) {
+    buffer[i] = rand() & 0xff;
+  }
+}
+
+void tearDown(void) {
+  // Empty
+}
+
+void testThatCheckValueIsCorrect() {
+  // Fixture
+  const char* data = "123456789";
+  uint32_t expected = 0xCBF43926;
+
+  // Test
+  uint32_t actual = crc32CalculateBuffer(data, 9);
+
+  // Assert
+  TEST_ASSERT_EQUAL_HEX32(expected, actual);
+}
+
+void testThatEmptyBufferGivesZero() {
+  // Fixture
+  uint32_t expected = 0;
+
+  // Test
+  uint32_t actual = crc32CalculateBuffer(buffer, 0);
+
+  // Assert
+  TEST_ASSERT_EQUAL_HEX32(expected, actual);
+}
+
+void testThatAllSizesAndAlignmentsMatchReference() {
+  for (int offset = 0; offset < 8; offset++) {
+    for (int size = 0; size <= 100; size++) {
+      // Fixture
+      uint32_t expected = referenceCrc(&buffer[offset], size);
+
+      // Test
+      uint32_t actual = crc32CalculateBuffer(&buffer[offset], size);
+
+      // Assert
+      TEST_ASSERT_EQUAL_HEX32(expected, actual);
+    }
+  }
+}
+
+void testThatLargeBufferMatchesReference() {
+  // Fixture
+  uint32_t expected = referenceCrc(buffer, BUFFER_SIZE);
+
+  // Test
+  uint32_t actual = crc32CalculateBuffer(buffer, BUFFER_SIZE);
+
+  // Assert
+  TEST_ASSERT_EQUAL_HEX32(expected, actual);
+}
+
+void testThatSplitUpdatesMatchReference() {
+  // Fixture
+  uint32_t expected = referenceCrc(buffer, BUFFER_SIZE);
+  crc32Context_t context;
+  crc32ContextInit(&context);
+
+  // Test
+  size_t position = 0;
+  size_t chunk = 1;
+  while (position < BUFFER_SIZE) {
+    size_t size = chunk;
+    if (position + size > BUFFER_SIZE) {
+      size = BUFFER_SIZE - position;
+    }
+    crc32Update(&context, &buffer[position], size);
+    position += size;
+    chunk = (chunk * 7 + 3) % 61;
+  }
+  uint32_t actual = crc32Out(&context);
+
+  // Assert
+  TEST_ASSERT_EQUAL_HEX32(expected, actual);
+}
+
+void testThatContextCanBeReset() {
+  // Fixture
+  uint32_t expected = referenceCrc(buffer, 17);
+  crc32Context_t context;
+  crc32ContextInit(&context);
+  crc32Update(&context, &buffer[100], 33);
+
+  // Test
+  crc32ContextInit(&context);
+  crc32Update(&context, buffer, 17);
+  uint32_t actual = crc32Out(&context);
+
+  // Assert
+  TEST_ASSERT_EQUAL_HEX32(expected, actual);
+}
@@ -0,0 +1,232 @@
+// File under test filter.c
+#include "filter.h"
+
+#include <math.h>
+
+#include "physicalConstants.h"
+#include "unity.h"
+
+#define SAMPLE_FREQ 1000.0f
+#define SAMPLES 4000
+// Samples to skip before measuring, to let filters settle
+#define SETTLE_SAMPLES 1000
+
+static dynNotchData notchData;
+
+// RMS of the filter output for a sine input, for samples after SETTLE_SAMPLES
+static float rmsOfFilteredSine(const float freq, const float notchFreq, lpf2pData* filter) {
+  notch2pInit(filter, SAMPLE_FREQ, notchFreq, 3.0f);
+  float sum = 0.0f;
+  for (int i = 0; i < SAMPLES; i++) {
+    const float in = sinf(2.0f * M_PI_F * freq * i / SAMPLE_FREQ);
+    const float out = lpf2pApply(filter, in);
+    if (i >= SETTLE_SAMPLES) {
+      sum += out * out;
+    }
+  }
+  return sqrtf(sum / (SAMPLES - SETTLE_SAMPLES));
+}
+
+void setUp(void) {
+  dynNotchInit(&notchData, SAMPLE_FREQ, 3.0f, 50.0f);
+}
+
+void tearDown(void) {
+  // Empty
+}
+
+void testThatNotchAttenuatesCenterFrequency() {
+  // Fixture
+  lpf2pData filter;
+  const float rmsOfSine = sqrtf(0.5f);
+
+  // Test
+  float actual = rmsOfFilteredSine(150.0f, 150.0f, &filter);
+
+  // Assert
+  // At least 40 dB
+  TEST_ASSERT_LESS_THAN_FLOAT(0.01f * rmsOfSine, actual);
+}
+
+void testThatNotchPassesLowFrequency() {
+  // Fixture
+  lpf2pData filter;
+  const float rmsOfSine = sqrtf(0.5f);
+
+  // Test
+  float actual = rmsOfFilteredSine(10.0f, 150.0f, &filter);
+
+  // Assert
+  TEST_ASSERT_FLOAT_WITHIN(0.01f * rmsOfSine, rmsOfSine, actual);
+}
+
+void testThatNotchCenterFrequencyIsAccurateCloseToNyquist() {
+  // Fixture
+  lpf2pData filter;
+  const float rmsOfSine = sqrtf(0.5f);
+
+  // Test
+  float actual = rmsOfFilteredSine(420.0f, 420.0f, &filter);
+
+  // Assert
+  // At least 26 dB, limited by the approximation of sin/cos
+  TEST_ASSERT_LESS_THAN_FLOAT(0.05f * rmsOfSine, actual);
+}
+
+void testThatInactiveDynNotchPassesSignal() {
+  // Fixture
+  dynNotchSetFreq(&notchData, 0, 20.0f);
+  float values[3] = {1.0f, -2.0f, 3.0f};
+
+  // Test
+  dynNotchApply(&notchData, values);
+
+  // Assert
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, notchData.centerFreq[0]);
+  TEST_ASSERT_EQUAL_FLOAT(1.0f, values[0]);
+  TEST_ASSERT_EQUAL_FLOAT(-2.0f, values[1]);
+  TEST_ASSERT_EQUAL_FLOAT(3.0f, values[2]);
+}
+
+void testThatActivatedDynNotchStartsWithoutTransient() {
+  // Fixture
+  dynNotchSetFreq(&notchData, 1, 200.0f);
+  float maxError = 0.0f;
+
+  // Test
+  for (int i = 0; i < 100; i++) {
+    float values[3] = {100.0f, 100.0f, 100.0f};
+    dynNotchApply(&notchData, values);
+    maxError = fmaxf(maxError, fabsf(values[0] - 100.0f));
+  }
+
+  // Assert
+  TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.0f, maxError);
+}
+
+void testThatDynNotchTracksVibrationOfFourMotors() {
+  // Fixture
+  // Motors accelerating from 120 to 220 Hz, at slightly different speeds, updated at the sample rate
+  const float startFreq[4] = {120.0f, 125.0f, 130.0f, 135.0f};
+  const float slope = 100.0f / (SAMPLES / SAMPLE_FREQ); // Hz/s
+  float phase[4] = {0};
+  float inSum = 0.0f;
+  float outSum = 0.0f;
+  float signalErrorSum = 0.0f;
+
+  // Test
+  for (int i = 0; i < SAMPLES; i++) {
+    const float t = i / SAMPLE_FREQ;
+    const float signal = 20.0f * sinf(2.0f * M_PI_F * 2.0f * t);
+    float vibration = 0.0f;
+    for (int m = 0; m < 4; m++) {
+      const float freq = startFreq[m] + slope * t;
+      dynNotchSetFreq(&notchData, m, freq);
+      phase[m] += 2.0f * M_PI_F * freq / SAMPLE_FREQ;
+      vibration += 5.0f * sinf(phase[m]);
+    }
+
+    float values[3] = {signal + vibration, signal + vibration, vibration};
+    dynNotchApply(&notchData, values);
+
+    if (i >= SETTLE_SAMPLES) {
+      inSum += vibration * vibration;
+      outSum += values[2] * values[2];
+      signalErrorSum += (values[0] - signal) * (values[0] - signal);
+    }
+  }
+
+  // Assert
+  const float attenuation = sqrtf(outSum / inSum);
+  const float signalError = sqrtf(signalErrorSum / (SAMPLES - SETTLE_SAMPLES));
+  // At least 20 dB on the vibration
+  TEST_ASSERT_LESS_THAN_FLOAT(0.1f, attenuation);
+  // The low frequency signal passes, with some phase lag
+  TEST_ASSERT_LESS_THAN_FLOAT(1.0f, signalError);
+}
+
+void testThatBiquadNMatchesLpf2pOnAllChannels() {
+  // Fixture
+  biquadNData biquad;
+  biquadNInitLpf(&biquad, 3, SAMPLE_FREQ, 80.0f);
+  lpf2pData reference[3];
+  for (int ch = 0; ch < 3; ch++) {
+    lpf2pInit(&reference[ch], SAMPLE_FREQ, 80.0f);
+  }
+  float maxError = 0.0f;
+
+  // Test
+  for (int i = 0; i < 500; i++) {
+    float values[3];
+    for (int ch = 0; ch < 3; ch++) {
+      values[ch] = (ch + 1) * sinf(2.0f * M_PI_F * (20.0f + 50.0f * ch) * i / SAMPLE_FREQ) + ch;
+    }
+    float expected[3];
+    for (int ch = 0; ch < 3; ch++) {
+      expected[ch] = lpf2pApply(&reference[ch], values[ch]);
+    }
+    biquadNApply(&biquad, values);
+    for (int ch = 0; ch < 3; ch++) {
+      maxError = fmaxf(maxError, fabsf(values[ch] - expected[ch]));
+    }
+  }
+
+  // Assert
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.0f, maxError);
+}
+
+void testThatBiquadNChannelsUseTheirOwnCoefficients() {
+  // Fixture
+  biquadNData biquad;
+  biquadNInit(&biquad, 2);
+  lpf2pData notch;
+  notch2pInit(&notch, SAMPLE_FREQ, 150.0f, 3.0f);
+  biquadNSetCoeffs(&biquad, 1, &notch);
+  float sum[2] = {0};
+
+  // Test
+  for (int i = 0; i < SAMPLES; i++) {
+    const float in = sinf(2.0f * M_PI_F * 150.0f * i / SAMPLE_FREQ);
+    float values[2] = {in, in};
+    biquadNApply(&biquad, values);
+    if (i >= SETTLE_SAMPLES) {
+      sum[0] += values[0] * values[0];
+      sum[1] += values[1] * values[1];
+    }
+  }
+
+  // Assert
+  const float rmsOfSine = sqrtf(0.5f);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, rmsOfSine, sqrtf(sum[0] / (SAMPLES - SETTLE_SAMPLES)));
+  TEST_ASSERT_LESS_THAN_FLOAT(0.01f * rmsOfSine, sqrtf(sum[1] / (SAMPLES - SETTLE_SAMPLES)));
+}
+
+void testThatBiquadNResetStartsInSteadyState() {
+  // Fixture
+  biquadNData biquad;
+  biquadNInitLpf(&biquad, 3, SAMPLE_FREQ, 30.0f);
+  biquadNReset(&biquad, 2, 9.81f);
+
+  // Test
+  float values[3] = {9.81f, 9.81f, 9.81f};
+  biquadNApply(&biquad, values);
+
+  // Assert
+  TEST_ASSERT_LESS_THAN_FLOAT(1.0f, values[0]);
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 9.81f, values[2]);
+}
+
+void testThatBiquadNRecoversFromNonFiniteState() {
+  // Fixture
+  biquadNData biquad;
+  biquadNInitLpf(&biquad, 3, SAMPLE_FREQ, 80.0f);
+  biquad.s1[1] = INFINITY;
+
+  // Test
+  float values[3] = {1.0f, 2.0f, 3.0f};
+  biquadNApply(&biquad, values);
+  biquadNApply(&biquad, values);
+
+  // Assert
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 2.0f, values[1]);
+}
@@ -0,0 +1,140 @@
+// File under test spectrum.c
+#include "spectrum.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "physicalConstants.h"
+#include "unity.h"
+
+#define N 256
+#define BINS (N / 2)
+#define SAMPLE_FREQ 1000.0f
+
+static float window[N];
+static float magnitude[BINS];
+
+// Magnitude of the windowed signal, straight forward DFT
+static void windowedDft(const float* signal) {
+  for (int k = 0; k < BINS; k++) {
+    float re = 0.0f;
+    float im = 0.0f;
+    for (int i = 0; i < N; i++) {
+      const float x = signal[i] * window[i];
+      re += x * cosf(2.0f * M_PI_F * k * i / N);
+      im -= x * sinf(2.0f * M_PI_F * k * i / N);
+    }
+    magnitude[k] = sqrtf(re * re + im * im);
+  }
+}
+
+void setUp(void) {
+  spectrumHannWindow(window, N);
+  memset(magnitude, 0, sizeof(magnitude));
+}
+
+void tearDown(void) {
+  // Empty
+}
+
+void testThatHannWindowHasUnityMean() {
+  // Fixture
+  float sum = 0.0f;
+
+  // Test
+  for (int i = 0; i < N; i++) {
+    sum += window[i];
+  }
+
+  // Assert
+  TEST_ASSERT_FLOAT_WITHIN(0.0001f, 1.0f, sum / N);
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, window[0]);
+  TEST_ASSERT_EQUAL_FLOAT(2.0f, window[N / 2]);
+}
+
+void testThatPeaksAreSortedByMagnitude() {
+  // Fixture
+  magnitude[10] = 1.0f;
+  magnitude[30] = 3.0f;
+  magnitude[50] = 2.0f;
+  spectrumPeak_t peaks[3];
+
+  // Test
+  uint8_t actual = spectrumFindPeaks(magnitude, BINS, 1, peaks, 3);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT8(3, actual);
+  TEST_ASSERT_EQUAL_FLOAT(30.0f, peaks[0].bin);
+  TEST_ASSERT_EQUAL_FLOAT(50.0f, peaks[1].bin);
+  TEST_ASSERT_EQUAL_FLOAT(10.0f, peaks[2].bin);
+  TEST_ASSERT_EQUAL_FLOAT(3.0f, peaks[0].magnitude);
+}
+
+void testThatOnlyTheLargestPeaksAreKept() {
+  // Fixture
+  magnitude[10] = 4.0f;
+  magnitude[20] = 1.0f;
+  magnitude[30] = 3.0f;
+  magnitude[40] = 2.0f;
+  spectrumPeak_t peaks[2];
+
+  // Test
+  uint8_t actual = spectrumFindPeaks(magnitude, BINS, 1, peaks, 2);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT8(2, actual);
+  TEST_ASSERT_EQUAL_FLOAT(10.0f, peaks[0].bin);
+  TEST_ASSERT_EQUAL_FLOAT(30.0f, peaks[1].bin);
+}
+
+void testThatBinsBelowMinBinAreIgnored() {
+  // Fixture
+  magnitude[2] = 10.0f;
+  magnitude[20] = 1.0f;
+  spectrumPeak_t peaks[3];
+
+  // Test
+  uint8_t actual = spectrumFindPeaks(magnitude, BINS, 5, peaks, 3);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT8(1, actual);
+  TEST_ASSERT_EQUAL_FLOAT(20.0f, peaks[0].bin);
+}
+
+void testThatPeakOfSineIsFoundBetweenBins() {
+  // Fixture
+  const float freq = 123.4f;
+  const float amplitude = 2.0f;
+  float signal[N];
+  for (int i = 0; i < N; i++) {
+    signal[i] = amplitude * sinf(2.0f * M_PI_F * freq * i / SAMPLE_FREQ) + 0.5f;
+  }
+  windowedDft(signal);
+  spectrumPeak_t peaks[1];
+
+  // Test
+  uint8_t actual = spectrumFindPeaks(magnitude, BINS, 2, peaks, 1);
+
+  // Assert
+  const float binWidth = SAMPLE_FREQ / N;
+  TEST_ASSERT_EQUAL_UINT8(1, actual);
+  TEST_ASSERT_FLOAT_WITHIN(0.15f * binWidth, freq, peaks[0].bin * binWidth);
+  // Hann scalloping loss is at most 1.42 dB
+  TEST_ASSERT_FLOAT_WITHIN(0.16f * amplitude, amplitude, peaks[0].magnitude * 2.0f / N);
+}
+
+void testThatDecimationKeepsTheMaxOfEachGroup() {
+  // Fixture
+  magnitude[1] = 5.0f;
+  magnitude[6] = 2.0f;
+  magnitude[7] = 3.0f;
+  float decimated[BINS / 4];
+
+  // Test
+  spectrumDecimate(magnitude, BINS, decimated, BINS / 4);
+
+  // Assert
+  TEST_ASSERT_EQUAL_FLOAT(5.0f, decimated[0]);
+  TEST_ASSERT_EQUAL_FLOAT(3.0f, decimated[1]);
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, decimated[2]);
+}
@@ -0,0 +1,194 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * test_tokenize.c - Unit tests for tokenized messages
+ */
+
+// File under test
+#include "tokenize.h"
+
+#include <string.h>
+
+#include "unity.h"
+
+#define BUFFER_SIZE 30
+
+static uint8_t buffer[BUFFER_SIZE + 1];
+
+static int encode(const int size, const uint32_t token, const uint32_t argTypes, ...) {
+  va_list ap;
+  va_start(ap, argTypes);
+  int length = tokenizeEncode(buffer, size, token, argTypes, ap);
+  va_end(ap);
+  return length;
+}
+
+#define ENCODE(TOKEN, ...) encode(BUFFER_SIZE, TOKEN, TOKENIZE_ARG_TYPES(__VA_ARGS__), ##__VA_ARGS__)
+
+void setUp(void) {
+  memset(buffer, 0xaa, sizeof(buffer));
+}
+
+void testThatArgumentsAreCounted() {
+  // Fixture
+  // Test
+  // Assert
+  TEST_ASSERT_EQUAL_INT(0, TOKENIZE_ARG_COUNT());
+  TEST_ASSERT_EQUAL_INT(1, TOKENIZE_ARG_COUNT(1));
+  TEST_ASSERT_EQUAL_INT(3, TOKENIZE_ARG_COUNT(1, 2.0f, "3"));
+  TEST_ASSERT_EQUAL_INT(TOKENIZE_MAX_ARGS, TOKENIZE_ARG_COUNT(1, 2, 3, 4, 5, 6, 7, 8));
+}
+
+void testThatArgumentTypesAreFoundAtCompileTime() {
+  // Fixture
+  const char* str = "abc";
+  char array[4] = "abc";
+  uint8_t u8 = 1;
+  int64_t i64 = 2;
+
+  // Test
+  const uint32_t actual = TOKENIZE_ARG_TYPES(u8, 1.0f, 2.0, str, array, i64);
+
+  // Assert
+  const uint32_t expected = TOKENIZE_ARG_INT32 | (TOKENIZE_ARG_DOUBLE << 4) | (TOKENIZE_ARG_DOUBLE << 8) |
+    (TOKENIZE_ARG_STRING << 12) | (TOKENIZE_ARG_STRING << 16) | (TOKENIZE_ARG_INT64 << 20);
+  TEST_ASSERT_EQUAL_HEX32(expected, actual);
+}
+
+void testThatNoArgumentsGiveNoTypes() {
+  // Fixture
+  // Test
+  const uint32_t actual = TOKENIZE_ARG_TYPES();
+
+  // Assert
+  TEST_ASSERT_EQUAL_HEX32(0, actual);
+}
+
+void testThatTheTokenIsEncodedAsVarint() {
+  // Fixture
+  const uint8_t expected[] = {0x96, 0x01};
+
+  // Test
+  int actual = encode(BUFFER_SIZE, 150, TOKENIZE_ARG_TYPES());
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(sizeof(expected), actual);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, buffer, sizeof(expected));
+}
+
+void testThatIntegersAreZigzagEncoded() {
+  // Fixture
+  const uint8_t expected[] = {0x01, 0x00, 0x01, 0x02, 0x7f, 0x80, 0x01};
+
+  // Test
+  int actual = ENCODE(1, 0, -1, 1, -64, 64);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(sizeof(expected), actual);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, buffer, sizeof(expected));
+}
+
+void testThatUnsignedMaxIsEncodedInOneByte() {
+  // Fixture
+  const uint8_t expected[] = {0x01, 0x01};
+
+  // Test
+  int actual = ENCODE(1, UINT32_MAX);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(sizeof(expected), actual);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, buffer, sizeof(expected));
+}
+
+void testThat64BitIntegersAreEncoded() {
+  // Fixture
+  const uint8_t expected[] = {0x01, 0x80, 0x80, 0x80, 0x80, 0x80, 0x40};
+
+  // Test
+  int actual = ENCODE(1, (int64_t)1 << 40);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(sizeof(expected), actual);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, buffer, sizeof(expected));
+}
+
+void testThatFloatsAreEncodedAs32Bits() {
+  // Fixture
+  const float value = 1.5f;
+  uint8_t expected[5] = {0x01};
+  memcpy(&expected[1], &value, sizeof(value));
+
+  // Test
+  int actual = ENCODE(1, value);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(sizeof(expected), actual);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, buffer, sizeof(expected));
+}
+
+void testThatStringsAreZeroTerminated() {
+  // Fixture
+  const uint8_t expected[] = {0x01, 'a', 'b', 0, 0x04};
+
+  // Test
+  int actual = ENCODE(1, "ab", 2);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(sizeof(expected), actual);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, buffer, sizeof(expected));
+}
+
+void testThatALongStringIsTruncatedToTheBuffer() {
+  // Fixture
+  const char* str = "0123456789012345678901234567890123456789";
+
+  // Test
+  int actual = ENCODE(1, str);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(BUFFER_SIZE, actual);
+  TEST_ASSERT_EQUAL_UINT8(0, buffer[BUFFER_SIZE - 1]);
+  TEST_ASSERT_EQUAL_UINT8(0xaa, buffer[BUFFER_SIZE]);
+}
+
+void testThatArgumentsThatDoNotFitAreLeftOut() {
+  // Fixture
+  const int size = 4;
+
+  // Test
+  int actual = encode(size, 1, TOKENIZE_ARG_TYPES(1, 2.0f), 1, 2.0f);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(2, actual);
+  TEST_ASSERT_EQUAL_UINT8(0xaa, buffer[2]);
+}
+
+void testThatDifferentStringsGetDifferentTokens() {
+  // Fixture
+  // Test
+  uint32_t first = TOKENIZE_STRING("first %d\n");
+  uint32_t second = TOKENIZE_STRING("second %d\n");
+
+  // Assert
+  TEST_ASSERT_NOT_EQUAL(first, second);
+}
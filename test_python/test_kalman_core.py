@@ -19,3 +19,54 @@ def test_kalman_core_with_tdoa3():
     # Verify that the final position is close-ish to (0, 0, 0)
     actual_final_pos = np.array(actual[-1][1])
     assert np.linalg.norm(actual_final_pos - [0.0, 0.0, 0.0]) < 0.4
+
+
+def test_kalman_core_with_ud_factorization_follows_standard_filter():
+    # Fixture
+    fixture_base = 'test_python/fixtures/kalman_core'
+    anchor_positions = read_loco_anchor_positions(fixture_base + '/anchor_positions.yaml')
+    standard = EstimatorKalmanEmulator(anchor_positions)
+    ud = EstimatorKalmanEmulator(anchor_positions, ud_factorization=True)
+
+    # Test
+    expected = SdCardFileRunner(fixture_base + '/log05').run_estimator_loop(standard)
+    actual = SdCardFileRunner(fixture_base + '/log05').run_estimator_loop(ud)
+
+    # Assert
+    # Both filters see the same measurements, the trajectories should only differ by rounding and by the covariance
+    # bounding that the standard filter does
+    expected_pos = np.array([pos for _, pos in expected])
+    actual_pos = np.array([pos for _, pos in actual])
+    assert len(actual_pos) == len(expected_pos)
+    assert np.max(np.linalg.norm(actual_pos - expected_pos, axis=1)) < 0.1
+    assert np.linalg.norm(actual_pos[-1] - [0.0, 0.0, 0.0]) < 0.4
+
+
+def test_kalman_core_instances_run_side_by_side():
+    # Fixture
+    fixture_base = 'test_python/fixtures/kalman_core'
+    anchor_positions = read_loco_anchor_positions(fixture_base + '/anchor_positions.yaml')
+
+    def create_bank():
+        # Two hypotheses on the measurement noise, the robust update keeps state between measurements
+        emulators = [EstimatorKalmanEmulator(anchor_positions, robust_tdoa=True) for _ in range(2)]
+        emulators[1].TDOA_ENGINE_MEASUREMENT_NOISE_STD = 0.5
+        return emulators
+
+    expected = [SdCardFileRunner(fixture_base + '/log05').run_estimator_loop(emulator) for emulator in create_bank()]
+
+    # Test
+    bank = create_bank()
+    samples = [SdCardFileRunner(fixture_base + '/log05').samples for _ in bank]
+    actual = [[] for _ in bank]
+    while any(len(s) for s in samples):
+        for emulator, emulator_samples, result in zip(bank, samples, actual):
+            if len(emulator_samples):
+                now_ms, state = emulator.run_one_1khz_iteration(emulator_samples)
+                result.append((now_ms, (state.position.x, state.position.y, state.position.z)))
+
+    # Assert
+    # Interleaving the filters must not change the result of any of them
+    assert actual[0] == expected[0]
+    assert actual[1] == expected[1]
+    assert actual[0] != actual[1]
@@ -0,0 +1,107 @@
+#!/usr/bin/env python
+
+import numpy as np
+import pytest
+
+import cffirmware
+
+
+def test_sitl_takes_off_and_hovers_at_setpoint():
+    # Fixture
+    sim = cffirmware.SitlBatch(8, controller=cffirmware.sitlControllerLee)
+    sim.setpoints[:, 0] = np.linspace(-0.5, 0.5, len(sim))
+    sim.setpoints[:, 2] = 1.0
+
+    # Test
+    sim.step(4000)
+
+    # Assert
+    np.testing.assert_allclose(sim.states[:, 0:3], sim.setpoints[:, 0:3], atol=0.05)
+    np.testing.assert_allclose(sim.states[:, 3:6], 0, atol=0.05)
+    assert np.all(sim.motors > 30000)
+
+
+@pytest.mark.parametrize("controller", [cffirmware.sitlControllerMellinger, cffirmware.sitlControllerLee])
+def test_sitl_controllers_reach_yaw_setpoint(controller):
+    # Fixture
+    sim = cffirmware.SitlBatch(2, controller=controller)
+    sim.setpoints[:, 2] = 1.0
+    sim.setpoints[:, 3] = 30.0
+
+    # Test
+    sim.step(5000)
+
+    # Assert
+    qz = sim.states[:, cffirmware.SITL_STATE_QUAT + 2]
+    qw = sim.states[:, cffirmware.SITL_STATE_QUAT + 3]
+    yaw = np.degrees(2 * np.arctan2(qz, qw))
+    np.testing.assert_allclose(yaw, 30.0, atol=2.0)
+    np.testing.assert_allclose(sim.states[:, 2], 1.0, atol=0.05)
+
+
+def test_sitl_with_kalman_estimator_and_noise():
+    # Fixture
+    sim = cffirmware.SitlBatch(4, controller=cffirmware.sitlControllerLee,
+                               estimator=cffirmware.sitlEstimatorKalman,
+                               gyro_noise=0.1, acc_noise=0.01, position_noise=0.01, seed=1)
+    sim.setpoints[:, 2] = 0.5
+
+    # Test
+    sim.step(4000)
+
+    # Assert
+    np.testing.assert_allclose(sim.states[:, 0:3], sim.setpoints[:, 0:3], atol=0.1)
+
+
+def test_sitl_is_deterministic():
+    # Fixture
+    def fly():
+        sim = cffirmware.SitlBatch(3, estimator=cffirmware.sitlEstimatorKalman, gyro_noise=0.1, seed=7)
+        sim.setpoints[:, 1] = 0.3
+        sim.setpoints[:, 2] = 0.5
+        sim.step(500)
+        return sim.states.copy()
+
+    # Test
+    first = fly()
+    second = fly()
+
+    # Assert
+    np.testing.assert_array_equal(first, second)
+
+
+def test_sitl_reset_restores_state():
+    # Fixture
+    sim = cffirmware.SitlBatch(1)
+    sim.setpoints[:, 2] = 1.0
+    sim.step(1000)
+
+    # Test
+    sim.reset()
+
+    # Assert
+    expected = np.zeros((1, cffirmware.SITL_STATE_SIZE), dtype=np.float32)
+    expected[0, cffirmware.SITL_STATE_QUAT + 3] = 1
+    np.testing.assert_array_equal(sim.states, expected)
+
+
+def test_sitl_rejects_arrays_of_wrong_type():
+    # Fixture
+    sim = cffirmware.SitlBatch(2)
+    states = np.zeros((2, cffirmware.SITL_STATE_SIZE), dtype=np.float64)
+
+    # Test
+    # Assert
+    with pytest.raises(TypeError):
+        cffirmware.sitlBatchResetArrays(sim._batch, states)
+
+
+def test_sitl_rejects_arrays_of_wrong_size():
+    # Fixture
+    sim = cffirmware.SitlBatch(2)
+    setpoints = np.zeros((1, cffirmware.SITL_SETPOINT_SIZE), dtype=np.float32)
+
+    # Test
+    # Assert
+    with pytest.raises(ValueError):
+        cffirmware.sitlBatchStepArrays(sim._batch, 1, sim.states, setpoints, sim.motors)
@@ -0,0 +1,193 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * bench.c - Minimal harness for host micro benchmarks
+ */
+
+#define _DEFAULT_SOURCE // clock_gettime()
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bench.h"
+
+#define MAX_REPEATS 101
+#define MAX_ITERATIONS (1u << 30)
+
+typedef struct {
+  const char* name;
+  uint32_t iterations;
+  int repeats;
+  double median;
+  double min;
+  double mad;
+} benchResult_t;
+
+volatile float benchSink;
+
+static double now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int compareDouble(const void* a, const void* b) {
+  const double da = *(const double*)a;
+  const double db = *(const double*)b;
+  return (da > db) - (da < db);
+}
+
+static double median(double* values, const int count) {
+  qsort(values, count, sizeof(double), compareDouble);
+  if (count % 2) {
+    return values[count / 2];
+  }
+  return (values[count / 2 - 1] + values[count / 2]) / 2.0;
+}
+
+static double timeSample(const benchCase_t* benchCase, const uint32_t iterations) {
+  if (benchCase->setup) {
+    benchCase->setup();
+  }
+  const double start = now();
+  benchCase->run(iterations);
+  return now() - start;
+}
+
+static void measure(const benchCase_t* benchCase, const int repeats, const double minTime, benchResult_t* result) {
+  // Double the number of iterations until one sample is long enough, this also warms up caches and branch predictors
+  uint32_t iterations = 1;
+  while (timeSample(benchCase, iterations) < minTime && iterations < MAX_ITERATIONS) {
+    iterations *= 2;
+  }
+
+  double samples[MAX_REPEATS];
+  for (int i = 0; i < repeats; i++) {
+    samples[i] = timeSample(benchCase, iterations) / iterations * 1e9;
+  }
+
+  result->name = benchCase->name;
+  result->iterations = iterations;
+  result->repeats = repeats;
+  result->median = median(samples, repeats);
+  result->min = samples[0];
+
+  for (int i = 0; i < repeats; i++) {
+    const double deviation = samples[i] - result->median;
+    samples[i] = deviation < 0.0 ? -deviation : deviation;
+  }
+  result->mad = median(samples, repeats);
+}
+
+static bool writeJson(const char* path, const char* suite, const benchResult_t* results, const int count) {
+  FILE* file = fopen(path, "w");
+  if (!file) {
+    perror(path);
+    return false;
+  }
+
+  fprintf(file, "{\n  \"suite\": \"%s\",\n  \"unit\": \"ns\",\n  \"results\": [\n", suite);
+  for (int i = 0; i < count; i++) {
+    const benchResult_t* r = &results[i];
+    fprintf(file, "    {\"name\": \"%s\", \"median\": %.3f, \"min\": %.3f, \"mad\": %.3f, \"iterations\": %u, \"repeats\": %d}%s\n",
+      r->name, r->median, r->min, r->mad, r->iterations, r->repeats, i + 1 < count ? "," : "");
+  }
+  fprintf(file, "  ]\n}\n");
+
+  return fclose(file) == 0;
+}
+
+static void usage(const char* program) {
+  fprintf(stderr, "Usage: %s [--repeats N] [--min-time MS] [--filter TEXT] [--json FILE] [--list] [--fixed N]\n", program);
+}
+
+int benchMain(int argc, char* argv[], const char* suite, const benchCase_t* cases, const int count) {
+  int repeats = 11;
+  double minTime = 0.020;
+  const char* filter = 0;
+  const char* jsonPath = 0;
+  bool list = false;
+  long fixed = -1;
+
+  for (int i = 1; i < argc; i++) {
+    const bool hasValue = i + 1 < argc;
+    if (strcmp(argv[i], "--repeats") == 0 && hasValue) {
+      repeats = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--min-time") == 0 && hasValue) {
+      minTime = atof(argv[++i]) / 1000.0;
+    } else if (strcmp(argv[i], "--filter") == 0 && hasValue) {
+      filter = argv[++i];
+    } else if (strcmp(argv[i], "--json") == 0 && hasValue) {
+      jsonPath = argv[++i];
+    } else if (strcmp(argv[i], "--fixed") == 0 && hasValue) {
+      fixed = atol(argv[++i]);
+    } else if (strcmp(argv[i], "--list") == 0) {
+      list = true;
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  if (repeats < 1 || repeats > MAX_REPEATS) {
+    fprintf(stderr, "The number of repeats must be 1 - %d\n", MAX_REPEATS);
+    return 1;
+  }
+
+  static benchResult_t results[64];
+  int resultCount = 0;
+
+  if (!list && fixed < 0) {
+    printf("%-32s %12s %12s %8s %12s\n", suite, "median ns", "min ns", "mad %", "iterations");
+  }
+
+  for (int i = 0; i < count; i++) {
+    const benchCase_t* benchCase = &cases[i];
+    if (filter && !strstr(benchCase->name, filter)) {
+      continue;
+    }
+
+    if (list) {
+      printf("%s\n", benchCase->name);
+    } else if (fixed >= 0) {
+      if (benchCase->setup) {
+        benchCase->setup();
+      }
+      benchCase->run((uint32_t)fixed);
+    } else if (resultCount < (int)(sizeof(results) / sizeof(results[0]))) {
+      benchResult_t* result = &results[resultCount++];
+      measure(benchCase, repeats, minTime, result);
+      printf("%-32s %12.2f %12.2f %8.1f %12u\n", result->name, result->median, result->min,
+        result->median > 0.0 ? result->mad / result->median * 100.0 : 0.0, result->iterations);
+    }
+  }
+
+  if (jsonPath && resultCount > 0 && !writeJson(jsonPath, suite, results, resultCount)) {
+    return 1;
+  }
+
+  return 0;
+}
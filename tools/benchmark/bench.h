@@ -0,0 +1,59 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * bench.h - Minimal harness for host micro benchmarks
+ */
+
+/**
+ * Each benchmark case is a function that runs the measured operation a given
+ * number of times. The harness calibrates the number of iterations so that
+ * one sample takes at least a minimum time, runs a warm up sample and then a
+ * number of timed samples, and reports the median, minimum and spread (median
+ * absolute deviation) in ns per operation. The results can be written as JSON
+ * and compared to a baseline with compare.py.
+ *
+ * Command line options of a benchmark built with benchMain():
+ *   --repeats N     number of timed samples (default 11)
+ *   --min-time MS   minimum duration of one sample (default 20 ms)
+ *   --filter TEXT   only run the cases with TEXT in the name
+ *   --json FILE     write the results to FILE
+ *   --list          print the names of the cases
+ *   --fixed N       run the selected cases exactly N times without timing,
+ *                   used to count instructions in an emulator (insn_count.py)
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+typedef struct {
+  const char* name;
+  // Called before each sample, not timed. May be 0.
+  void (*setup)(void);
+  void (*run)(uint32_t iterations);
+} benchCase_t;
+
+// Results that the compiler can not prove unused should be added to the sink
+extern volatile float benchSink;
+
+int benchMain(int argc, char* argv[], const char* suite, const benchCase_t* cases, const int count);
@@ -0,0 +1,110 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * bench_biquad.c - Host benchmark of per axis vs multi channel biquad filtering
+ */
+
+#define _DEFAULT_SOURCE // clock_gettime()
+
+#include <stdio.h>
+#include <time.h>
+
+#include "filter.h"
+
+#define SAMPLES 1000000
+#define SAMPLE_FREQ 1000.0f
+
+static double now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static float input(const int i, const int axis) {
+  // A cheap deterministic signal that the compiler can not precompute
+  return (float)((i * (axis + 3)) % 97) - 48.0f;
+}
+
+static void report(const char* name, const double time, const float checksum) {
+  printf("%-28s %8.2f ns per 3 axis sample  (checksum %g)\n", name, time / SAMPLES * 1e9, (double)checksum);
+}
+
+static void benchLpf2p() {
+  lpf2pData lpf[3];
+  for (int axis = 0; axis < 3; axis++) {
+    lpf2pInit(&lpf[axis], SAMPLE_FREQ, 80.0f);
+  }
+
+  float checksum = 0.0f;
+  const double start = now();
+  for (int i = 0; i < SAMPLES; i++) {
+    float values[3];
+    for (int axis = 0; axis < 3; axis++) {
+      values[axis] = lpf2pApply(&lpf[axis], input(i, axis));
+    }
+    checksum += values[0] + values[1] + values[2];
+  }
+  report("lpf2pApply x 3", now() - start, checksum);
+}
+
+static void benchBiquadN() {
+  biquadNData lpf;
+  biquadNInitLpf(&lpf, 3, SAMPLE_FREQ, 80.0f);
+
+  float checksum = 0.0f;
+  const double start = now();
+  for (int i = 0; i < SAMPLES; i++) {
+    float values[3] = {input(i, 0), input(i, 1), input(i, 2)};
+    biquadNApply(&lpf, values);
+    checksum += values[0] + values[1] + values[2];
+  }
+  report("biquadNApply, 3 channels", now() - start, checksum);
+}
+
+static void benchDynNotch() {
+  static dynNotchData notch;
+  dynNotchInit(&notch, SAMPLE_FREQ, 3.0f, 50.0f);
+
+  float checksum = 0.0f;
+  const double start = now();
+  for (int i = 0; i < SAMPLES; i++) {
+    if (i % 2 == 0) {
+      // The sensor driver updates the center frequencies at 500 Hz or more
+      for (int motor = 0; motor < DYN_NOTCH_MAX_MOTORS; motor++) {
+        dynNotchSetFreq(&notch, motor, 150.0f + motor * 10.0f + (i % 200) * 0.1f);
+      }
+    }
+    float values[3] = {input(i, 0), input(i, 1), input(i, 2)};
+    dynNotchApply(&notch, values);
+    checksum += values[0] + values[1] + values[2];
+  }
+  report("dynNotch, 4 motors", now() - start, checksum);
+}
+
+int main() {
+  benchLpf2p();
+  benchBiquadN();
+  benchDynNotch();
+
+  return 0;
+}
@@ -0,0 +1,128 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * bench_crc32.c - Host benchmark and cross check of the CRC32 implementations
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define DECLARE_VARIANT(name) \
+  uint32_t crc32CalculateBuffer_##name(const void* buffer, size_t size);
+
+DECLARE_VARIANT(BYTEWISE)
+DECLARE_VARIANT(SLICING_BY_4)
+DECLARE_VARIANT(SLICING_BY_8)
+
+typedef struct {
+  const char* name;
+  uint32_t (*calculate)(const void* buffer, size_t size);
+} variant_t;
+
+static const variant_t variants[] = {
+  {"bytewise", crc32CalculateBuffer_BYTEWISE},
+  {"slicing-by-4", crc32CalculateBuffer_SLICING_BY_4},
+  {"slicing-by-8", crc32CalculateBuffer_SLICING_BY_8},
+};
+#define VARIANT_COUNT (sizeof(variants) / sizeof(variants[0]))
+
+// Typical sizes: deck memory header, uSD log write, lighthouse bitstream read chunk
+static const size_t sizes[] = {11, 64, 512, 4096};
+#define SIZE_COUNT (sizeof(sizes) / sizeof(sizes[0]))
+
+#define BUFFER_SIZE 4100
+#define BYTES_PER_RUN (16 * 1024 * 1024)
+
+static uint8_t buffer[BUFFER_SIZE];
+
+static uint32_t referenceCrc(const uint8_t* data, size_t size) {
+  uint32_t remainder = 0xffffffff;
+  for (size_t i = 0; i < size; i++) {
+    remainder ^= data[i];
+    for (int bit = 0; bit < 8; bit++) {
+      remainder = (remainder & 1) ? (remainder >> 1) ^ 0xEDB88320 : remainder >> 1;
+    }
+  }
+  return remainder ^ 0xffffffff;
+}
+
+static double now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int crossCheck() {
+  int errors = 0;
+  for (size_t offset = 0; offset < 4; offset++) {
+    for (size_t size = 0; size < 300; size++) {
+      const uint32_t expected = referenceCrc(&buffer[offset], size);
+      for (size_t v = 0; v < VARIANT_COUNT; v++) {
+        const uint32_t actual = variants[v].calculate(&buffer[offset], size);
+        if (actual != expected) {
+          printf("MISMATCH %s offset %zu size %zu: %08x != %08x\n", variants[v].name, offset, size, actual, expected);
+          errors++;
+        }
+      }
+    }
+  }
+  return errors;
+}
+
+int main() {
+  srand(4711);
+  for (int i = 0; i < BUFFER_SIZE; i++) {
+    buffer[i] = rand() & 0xff;
+  }
+
+  const int errors = crossCheck();
+  printf("Cross check: %s\n", errors ? "FAILED" : "OK");
+
+  printf("%-14s", "size [B]");
+  for (size_t s = 0; s < SIZE_COUNT; s++) {
+    printf("%12zu", sizes[s]);
+  }
+  printf("   (MB/s)\n");
+
+  volatile uint32_t sink = 0;
+  for (size_t v = 0; v < VARIANT_COUNT; v++) {
+    printf("%-14s", variants[v].name);
+    for (size_t s = 0; s < SIZE_COUNT; s++) {
+      const size_t iterations = BYTES_PER_RUN / sizes[s];
+      const double start = now();
+      for (size_t i = 0; i < iterations; i++) {
+        sink ^= variants[v].calculate(buffer, sizes[s]);
+      }
+      const double elapsed = now() - start;
+      printf("%12.1f", (double)(iterations * sizes[s]) / elapsed / 1e6);
+    }
+    printf("\n");
+  }
+
+  return errors ? 1 : 0;
+}
@@ -0,0 +1,151 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * bench_ext_pos_packed.c - Host benchmark of packed external pose handling vs swarm size
+ *
+ * Measures the work one Crazyflie does for one mocap frame, when the poses of
+ * all Crazyflies in the swarm are broadcast in packed pose packets. The
+ * packets are handled by the firmware localization service, compiled into the
+ * benchmark, with stubs for the estimator queue and the peer localization
+ * table.
+ *
+ * With all peers retained, the default, every item is handled and v2 costs
+ * the same as v1, plus the header. The gain of v2 comes from a restricted
+ * peer id range, where only the items of interest are looked at.
+ */
+
+#define _DEFAULT_SOURCE // clock_gettime() and M_SQRT1_2 in quatcompress.h
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+// The handlers are static, the file is included to call them and to set the peer id range
+#include "crtp_localization_service.c"
+
+#define ITERATIONS 2000
+#define MAX_PACKETS 128
+#define MAX_NEIGHBORS 10 // PEER_LOCALIZATION_MAX_NEIGHBORS
+
+static CRTPPacket packetsV1[MAX_PACKETS];
+static CRTPPacket packetsV2[MAX_PACKETS];
+static int packetCount;
+
+// Stubs of the consumers, the estimator queue and the peer localization table
+static volatile measurement_t lastMeasurement;
+static struct {
+  int id;
+  float x, y, z;
+} peers[MAX_NEIGHBORS];
+
+void estimatorEnqueue(const measurement_t *measurement) {
+  lastMeasurement = *measurement;
+}
+
+bool peerLocalizationTellPosition(int id, positionMeasurement_t const *pos) {
+  for (int i = 0; i < MAX_NEIGHBORS; i++) {
+    if (peers[i].id == 0 || peers[i].id == id) {
+      peers[i].id = id;
+      peers[i].x = pos->x;
+      peers[i].y = pos->y;
+      peers[i].z = pos->z;
+      return true;
+    }
+  }
+  return false;
+}
+
+TickType_t xTaskGetTickCount(void) { return 1000; }
+void assertFail(char *exp, char *file, int line) {}
+uint64_t configblockGetRadioAddress(void) { return 0xE7E7E7E700; }
+void crtpRegisterPortCB(int port, CrtpCallback cb) {}
+int crtpSendPacket(CRTPPacket *p) { return 0; }
+int crtpSendPacketBlock(CRTPPacket *p) { return 0; }
+paramVarId_t paramGetVarId(const char* group, const char* name) { return (paramVarId_t){0}; }
+int workerSchedule(void (*function)(void*), void *arg) { return 0; }
+
+static double now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void buildPackets(const int swarmSize) {
+  const float q[4] = {0.1f, 0.2f, 0.3f, 0.927f};
+  packetCount = 0;
+  for (int id = 1; id <= swarmSize; id += 2) {
+    CRTPPacket* v1 = &packetsV1[packetCount];
+    CRTPPacket* v2 = &packetsV2[packetCount];
+    *v1 = (CRTPPacket){.port = CRTP_PORT_LOCALIZATION, .channel = GENERIC_TYPE, .size = 1};
+    v1->data[0] = EXT_POSE_PACKED;
+    *v2 = (CRTPPacket){.port = CRTP_PORT_LOCALIZATION, .channel = GENERIC_TYPE, .size = sizeof(extPackedV2Header)};
+    const extPackedV2Header header = {.type = EXT_POSE_PACKED_V2, .ageMs = 5};
+    memcpy(v2->data, &header, sizeof(header));
+
+    for (int j = id; j < id + 2 && j <= swarmSize; j++) {
+      const extPosePackedItem item = {.id = j, .x = 10 * j, .y = -20 * j, .z = 1000, .quat = quatcompress(q)};
+      memcpy(&v1->data[v1->size], &item, sizeof(item));
+      v1->size += sizeof(item);
+      memcpy(&v2->data[v2->size], &item, sizeof(item));
+      v2->size += sizeof(item);
+    }
+    packetCount++;
+  }
+}
+
+static double run(CRTPPacket* packets, const uint8_t min, const uint8_t max) {
+  memset(peers, 0, sizeof(peers));
+  peerIdMin = min;
+  peerIdMax = max;
+
+  const double start = now();
+  for (int n = 0; n < ITERATIONS; n++) {
+    for (int p = 0; p < packetCount; p++) {
+      locSrvCrtpCB(&packets[p]);
+    }
+  }
+  return (now() - start) / ITERATIONS * 1e6;
+}
+
+int main() {
+  const int swarmSizes[] = {10, 50, 100, 200, 250};
+
+  printf("Packed pose handling, one mocap frame (us per frame)\n");
+  printf("%8s %8s %10s %14s %14s %14s\n", "swarm", "packets", "v1", "v2 all peers", "v2 4 peers", "v2 no peers");
+  for (unsigned i = 0; i < sizeof(swarmSizes) / sizeof(swarmSizes[0]); i++) {
+    const int swarmSize = swarmSizes[i];
+    my_id = swarmSize / 2;
+    buildPackets(swarmSize);
+
+    const double v1 = run(packetsV1, 0, 255);
+    const double v2All = run(packetsV2, 0, 255);
+    const double v2Near = run(packetsV2, my_id - 2, my_id + 2);
+    const double v2None = run(packetsV2, 1, 0);
+
+    printf("%8d %8d %10.3f %14.3f %14.3f %14.3f\n", swarmSize, packetCount, v1, v2All, v2Near, v2None);
+  }
+
+  return 0;
+}
@@ -0,0 +1,262 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * bench_kernels.c - Host benchmark of the flight critical kernels
+ *
+ * The kernels that run in the stabilizer loop or the estimator task, where a
+ * performance regression can make the 1 kHz loop miss its deadline. Run with
+ * --json to save a baseline and compare later runs with compare.py.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "cfassert.h"
+
+#include "math3d.h"
+#include "controller_brescianini.h"
+#include "controller_lee.h"
+#include "controller_mellinger.h"
+#include "kalman_core.h"
+#include "power_distribution.h"
+#include "pptraj.h"
+
+// Inputs that vary a little per iteration, to keep the compiler from hoisting the kernels out of the loops
+static float wobble(const uint32_t i) {
+  return (float)((int)(i % 64) - 32) * 0.001f;
+}
+
+// Kalman filter, 100 Hz prediction and position updates
+
+static kalmanCoreData_t kalman;
+static kalmanCoreParams_t kalmanParams;
+static uint32_t kalmanNowMs;
+
+static void setupKalman() {
+  kalmanCoreDefaultParams(&kalmanParams);
+  kalmanParams.udFactorization = false;
+  kalmanNowMs = 1000;
+  kalmanCoreInit(&kalman, &kalmanParams, kalmanNowMs);
+}
+
+static void setupKalmanUd() {
+  kalmanCoreDefaultParams(&kalmanParams);
+  kalmanParams.udFactorization = true;
+  kalmanNowMs = 1000;
+  kalmanCoreInit(&kalman, &kalmanParams, kalmanNowMs);
+}
+
+static void runKalmanPredict(uint32_t iterations) {
+  Axis3f gyro = {.x = 0.0f, .y = 0.0f, .z = 0.0f};
+  Axis3f acc = {.x = 0.0f, .y = 0.0f, .z = 1.0f};
+  for (uint32_t i = 0; i < iterations; i++) {
+    gyro.x = wobble(i);
+    kalmanNowMs += 10;
+    kalmanCorePredict(&kalman, &kalmanParams, &acc, &gyro, kalmanNowMs, true);
+  }
+  benchSink += kalman.P[0][0];
+}
+
+static void runKalmanScalarUpdate(uint32_t iterations) {
+  float h[KC_STATE_DIM] = {0};
+  arm_matrix_instance_f32 H = {1, KC_STATE_DIM, h};
+  for (uint32_t i = 0; i < iterations; i++) {
+    h[(i % 3) + KC_STATE_X] = 1.0f;
+    kalmanCoreScalarUpdate(&kalman, &H, wobble(i), 0.01f);
+    h[(i % 3) + KC_STATE_X] = 0.0f;
+  }
+  benchSink += kalman.P[0][0];
+}
+
+// Controllers, called with the full (attitude rate) update every iteration
+
+static setpoint_t setpoint;
+static sensorData_t sensors;
+static state_t state;
+static control_t control;
+
+static controllerMellinger_t mellinger;
+static controllerLee_t lee;
+
+static void setupFlight() {
+  memset(&setpoint, 0, sizeof(setpoint));
+  setpoint.mode.x = modeAbs;
+  setpoint.mode.y = modeAbs;
+  setpoint.mode.z = modeAbs;
+  setpoint.mode.yaw = modeAbs;
+  setpoint.position.z = 1.0f;
+  setpoint.attitude.yaw = 10.0f;
+
+  memset(&state, 0, sizeof(state));
+  state.position.x = 0.1f;
+  state.position.z = 0.9f;
+  state.attitudeQuaternion.w = 1.0f;
+
+  memset(&sensors, 0, sizeof(sensors));
+}
+
+static void flightStep(const uint32_t i) {
+  state.position.y = wobble(i);
+  sensors.gyro.x = wobble(i) * 10.0f;
+}
+
+static void setupMellinger() {
+  setupFlight();
+  controllerMellingerInit(&mellinger);
+}
+
+static void runMellinger(uint32_t iterations) {
+  for (uint32_t i = 0; i < iterations; i++) {
+    flightStep(i);
+    controllerMellinger(&mellinger, &control, &setpoint, &sensors, &state, 0);
+  }
+  benchSink += control.thrust;
+}
+
+static void setupLee() {
+  setupFlight();
+  controllerLeeInit(&lee);
+}
+
+static void runLee(uint32_t iterations) {
+  for (uint32_t i = 0; i < iterations; i++) {
+    flightStep(i);
+    controllerLee(&lee, &control, &setpoint, &sensors, &state, 0);
+  }
+  benchSink += control.thrustSi;
+}
+
+static void setupBrescianini() {
+  setupFlight();
+  controllerBrescianiniInit();
+}
+
+static void runBrescianini(uint32_t iterations) {
+  for (uint32_t i = 0; i < iterations; i++) {
+    flightStep(i);
+    controllerBrescianini(&control, &setpoint, &sensors, &state, 0);
+  }
+  benchSink += control.thrustSi;
+}
+
+// Power distribution
+
+static void runPowerDistributionLegacy(uint32_t iterations) {
+  control_t legacy = {.controlMode = controlModeLegacy, .thrust = 40000.0f, .roll = 100, .pitch = -50, .yaw = 20};
+  motors_thrust_uncapped_t motors;
+  for (uint32_t i = 0; i < iterations; i++) {
+    legacy.roll = (int16_t)(i % 256);
+    powerDistribution(&legacy, &motors);
+  }
+  benchSink += motors.motors.m1;
+}
+
+static void runPowerDistributionForceTorque(uint32_t iterations) {
+  control_t forceTorque = {.controlMode = controlModeForceTorque, .thrustSi = 0.3f, .torqueX = 0.001f, .torqueY = -0.002f, .torqueZ = 0.0005f};
+  motors_thrust_uncapped_t motors;
+  for (uint32_t i = 0; i < iterations; i++) {
+    forceTorque.torqueX = wobble(i) * 0.1f;
+    powerDistribution(&forceTorque, &motors);
+  }
+  benchSink += motors.motors.m1;
+}
+
+// Trajectory evaluation, one 7th degree piece as used by the high level commander
+
+static struct poly4d piece;
+
+static void setupPoly4d() {
+  for (int dim = 0; dim < 4; dim++) {
+    for (int coef = 0; coef < PP_SIZE; coef++) {
+      piece.p[dim][coef] = (float)((dim + 1) * (coef + 1) % 7 - 3) * 0.1f;
+    }
+  }
+  piece.duration = 2.0f;
+}
+
+static void runPoly4dEval(uint32_t iterations) {
+  float sum = 0.0f;
+  for (uint32_t i = 0; i < iterations; i++) {
+    const struct traj_eval ev = poly4d_eval(&piece, (float)(i % 2000) * 0.001f);
+    sum += ev.pos.x + ev.omega.z;
+  }
+  benchSink += sum;
+}
+
+// Polytope projection, the collision avoidance buffered Voronoi cell with 6 neighbors and 6 box faces
+
+#define POLYTOPE_FACES 12
+
+static float polytopeA[3 * POLYTOPE_FACES];
+static float polytopeB[POLYTOPE_FACES];
+static float polytopeWork[7 * POLYTOPE_FACES];
+
+static void setupPolytope() {
+  for (int i = 0; i < POLYTOPE_FACES; i++) {
+    // Box faces followed by planes between the vehicle and neighbors in the diagonal directions
+    struct vec normal;
+    if (i < 6) {
+      normal = (i % 2) ? vbasis(i / 2) : vneg(vbasis(i / 2));
+    } else {
+      normal = vnormalize(mkvec((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 0.5f : -0.5f));
+    }
+    vstoref(normal, &polytopeA[3 * i]);
+    polytopeB[i] = i < 6 ? 1.0f : 0.6f;
+  }
+}
+
+static void runProjectPolytope(uint32_t iterations) {
+  float sum = 0.0f;
+  for (uint32_t i = 0; i < iterations; i++) {
+    // A point outside the cell, close to a corner where several constraints are active
+    const struct vec v = mkvec(1.2f + wobble(i), 0.9f, 0.4f);
+    const struct vec projected = vprojectpolytope(v, polytopeA, polytopeB, polytopeWork, POLYTOPE_FACES, 1e-6f, 100);
+    sum += projected.x;
+  }
+  benchSink += sum;
+}
+
+static const benchCase_t cases[] = {
+  {"kalmanCorePredict", setupKalman, runKalmanPredict},
+  {"kalmanCoreScalarUpdate", setupKalman, runKalmanScalarUpdate},
+  {"kalmanCorePredict UD", setupKalmanUd, runKalmanPredict},
+  {"kalmanCoreScalarUpdate UD", setupKalmanUd, runKalmanScalarUpdate},
+  {"controllerMellinger", setupMellinger, runMellinger},
+  {"controllerLee", setupLee, runLee},
+  {"controllerBrescianini", setupBrescianini, runBrescianini},
+  {"powerDistribution legacy", 0, runPowerDistributionLegacy},
+  {"powerDistribution forceTorque", 0, runPowerDistributionForceTorque},
+  {"poly4d_eval", setupPoly4d, runPoly4dEval},
+  {"vprojectpolytope 12 faces", setupPolytope, runProjectPolytope},
+};
+
+void assertFail(char* exp, char* file, int line) {
+  fprintf(stderr, "Assert failed: %s in %s, line %d\n", exp, file, line);
+  exit(1);
+}
+
+int main(int argc, char* argv[]) {
+  return benchMain(argc, argv, "kernels", cases, sizeof(cases) / sizeof(cases[0]));
+}
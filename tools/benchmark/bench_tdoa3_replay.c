@@ -0,0 +1,398 @@
+/**
+ * ,---------,       ____  _ __
+ * |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+ * | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * bench_tdoa3_replay.c - Replay benchmark of direct and batched TDoA3 packet processing
+ *
+ * Replays a recorded log of received TDoA3 packets through the TDoA engine,
+ * once processing each packet directly in the radio event path (the old
+ * behaviour of the tag) and once copying the packets to a batch in the radio
+ * event path and processing the batch afterwards. The time spent in the radio
+ * event path and in the processing is reported per packet, and the TDoA
+ * measurements from both modes are compared.
+ *
+ * Usage:
+ *   bench_tdoa3_replay [LOG]          replay LOG, or a generated log
+ *   bench_tdoa3_replay --generate LOG write a generated log to LOG
+ *
+ * The generated log is a system of 8 anchors transmitting at 50 Hz each
+ * (400 packets/s) with drifting clocks, and a tag moving on a circle.
+ *
+ * Log format, little endian: the magic 0x33414454 ("TDA3") as a uint32,
+ * followed by one record per received packet:
+ *   uint32 system time of reception [ms]
+ *   uint64 receive time in the tag DWM clock
+ *   uint8  anchor id
+ *   uint8  payload length
+ *   payload, starting with the TDoA3 range packet header
+ */
+
+#define _DEFAULT_SOURCE // clock_gettime()
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "tdoa3RxBatch.h"
+#include "tdoaEngine.h"
+
+#define LOG_MAGIC 0x33414454
+#define MAX_PACKETS 100000
+#define REPEATS 10
+
+#define TS_FREQ (499.2e6 * 128)
+#define SPEED_OF_LIGHT 299792458.0
+
+#define LPP_HEADER_SHORT_PACKET 0xF0
+#define LPP_SHORT_ANCHORPOS 0x01
+
+static tdoa3RxPacket_t packets[MAX_PACKETS];
+static int packetCount;
+
+static tdoaEngineState_t engineState;
+
+// Model of the estimator queue
+static tdoaMeasurement_t measurements[MAX_PACKETS];
+static int measurementCount;
+
+static double now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int compareDouble(const void* a, const void* b) {
+  const double da = *(const double*)a;
+  const double db = *(const double*)b;
+  return (da > db) - (da < db);
+}
+
+// Log generation /////////////////////////////////////////////////////////////
+
+#define ANCHOR_COUNT 8
+#define GENERATED_DURATION_S 60.0
+
+static uint32_t randomState = 1;
+
+static double randomUniform() {
+  randomState = randomState * 1664525u + 1013904223u;
+  return (randomState >> 8) / 16777216.0;
+}
+
+static double distance(const double a[3], const double b[3]) {
+  const double dx = a[0] - b[0];
+  const double dy = a[1] - b[1];
+  const double dz = a[2] - b[2];
+  return sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+static void tagPosition(const double t, double pos[3]) {
+  pos[0] = 1.5 * cos(t * 2.0 * M_PI / 10.0);
+  pos[1] = 1.5 * sin(t * 2.0 * M_PI / 10.0);
+  pos[2] = 1.0;
+}
+
+static void generateLog() {
+  double position[ANCHOR_COUNT][3];
+  double drift[ANCHOR_COUNT];
+  double offset[ANCHOR_COUNT];
+  double nextTx[ANCHOR_COUNT];
+  uint8_t seq[ANCHOR_COUNT];
+
+  // Latest reception of anchor j in anchor i, true time and sequence number
+  double remoteRx[ANCHOR_COUNT][ANCHOR_COUNT];
+  uint8_t remoteSeq[ANCHOR_COUNT][ANCHOR_COUNT];
+
+  for (int i = 0; i < ANCHOR_COUNT; i++) {
+    position[i][0] = (i & 1) ? 4.0 : -4.0;
+    position[i][1] = (i & 2) ? 4.0 : -4.0;
+    position[i][2] = (i & 4) ? 3.0 : 0.0;
+    drift[i] = (randomUniform() - 0.5) * 20e-6;
+    offset[i] = randomUniform() * 1e12;
+    nextTx[i] = randomUniform() * 0.02;
+    seq[i] = 0;
+    for (int j = 0; j < ANCHOR_COUNT; j++) {
+      remoteRx[i][j] = -1.0;
+    }
+  }
+  const double tagDrift = 5e-6;
+  const double tagOffset = 3e11;
+
+  packetCount = 0;
+  while (packetCount < MAX_PACKETS) {
+    int a = 0;
+    for (int i = 1; i < ANCHOR_COUNT; i++) {
+      if (nextTx[i] < nextTx[a]) {
+        a = i;
+      }
+    }
+    const double t = nextTx[a];
+    if (t > GENERATED_DURATION_S) {
+      break;
+    }
+
+    tdoa3RxPacket_t* packet = &packets[packetCount++];
+    rangePacket3_t* rangePacket = (rangePacket3_t*)packet->payload;
+    rangePacket->header.type = PACKET_TYPE_TDOA3;
+    rangePacket->header.seq = seq[a];
+    rangePacket->header.txTimeStamp = (uint32_t)(uint64_t)((offset[a] + t * (1.0 + drift[a]) * TS_FREQ));
+    rangePacket->header.remoteCount = 0;
+
+    uint8_t* data = &rangePacket->remoteAnchorData;
+    for (int j = 0; j < ANCHOR_COUNT; j++) {
+      if (j != a && remoteRx[a][j] >= 0.0) {
+        remoteAnchorDataFull_t* remoteData = (remoteAnchorDataFull_t*)data;
+        remoteData->id = j;
+        remoteData->seq = remoteSeq[a][j] | 0x80;
+        remoteData->rxTimeStamp = (uint32_t)(uint64_t)(offset[a] + remoteRx[a][j] * (1.0 + drift[a]) * TS_FREQ);
+        remoteData->distance = (uint16_t)(distance(position[a], position[j]) / SPEED_OF_LIGHT * TS_FREQ);
+        data += sizeof(remoteAnchorDataFull_t);
+        rangePacket->header.remoteCount++;
+      }
+    }
+
+    *data++ = LPP_HEADER_SHORT_PACKET;
+    *data++ = LPP_SHORT_ANCHORPOS;
+    float pos[3] = {position[a][0], position[a][1], position[a][2]};
+    memcpy(data, pos, sizeof(pos));
+    data += sizeof(pos);
+    packet->payloadLength = data - packet->payload;
+
+    double tag[3];
+    tagPosition(t, tag);
+    const double rx = t + distance(position[a], tag) / SPEED_OF_LIGHT;
+    packet->anchorId = a;
+    packet->rxTime = (int64_t)(tagOffset + rx * (1.0 + tagDrift) * TS_FREQ) & 0xFFFFFFFFFFll;
+    packet->rxTime_ms = (uint32_t)(rx * 1000.0);
+
+    for (int i = 0; i < ANCHOR_COUNT; i++) {
+      if (i != a) {
+        remoteRx[i][a] = t + distance(position[a], position[i]) / SPEED_OF_LIGHT;
+        remoteSeq[i][a] = seq[a];
+      }
+    }
+
+    seq[a] = (seq[a] + 1) & 0x7f;
+    nextTx[a] = t + 0.015 + randomUniform() * 0.01;
+  }
+}
+
+static bool writeLog(const char* fileName) {
+  FILE* f = fopen(fileName, "wb");
+  if (!f) {
+    return false;
+  }
+
+  const uint32_t magic = LOG_MAGIC;
+  fwrite(&magic, sizeof(magic), 1, f);
+  for (int i = 0; i < packetCount; i++) {
+    const tdoa3RxPacket_t* packet = &packets[i];
+    const uint64_t rxTime = packet->rxTime;
+    fwrite(&packet->rxTime_ms, sizeof(packet->rxTime_ms), 1, f);
+    fwrite(&rxTime, sizeof(rxTime), 1, f);
+    fwrite(&packet->anchorId, 1, 1, f);
+    fwrite(&packet->payloadLength, 1, 1, f);
+    fwrite(packet->payload, 1, packet->payloadLength, f);
+  }
+
+  return fclose(f) == 0;
+}
+
+static bool readLog(const char* fileName) {
+  FILE* f = fopen(fileName, "rb");
+  if (!f) {
+    return false;
+  }
+
+  uint32_t magic = 0;
+  if (fread(&magic, sizeof(magic), 1, f) != 1 || magic != LOG_MAGIC) {
+    fclose(f);
+    return false;
+  }
+
+  packetCount = 0;
+  while (packetCount < MAX_PACKETS) {
+    tdoa3RxPacket_t* packet = &packets[packetCount];
+    uint64_t rxTime;
+    if (fread(&packet->rxTime_ms, sizeof(packet->rxTime_ms), 1, f) != 1 ||
+        fread(&rxTime, sizeof(rxTime), 1, f) != 1 ||
+        fread(&packet->anchorId, 1, 1, f) != 1 ||
+        fread(&packet->payloadLength, 1, 1, f) != 1 ||
+        packet->payloadLength > TDOA3_RX_MAX_PAYLOAD ||
+        fread(packet->payload, 1, packet->payloadLength, f) != packet->payloadLength) {
+      break;
+    }
+    packet->rxTime = rxTime;
+    packetCount++;
+  }
+
+  fclose(f);
+  return true;
+}
+
+// Replay /////////////////////////////////////////////////////////////////////
+
+static void sendTdoaToEstimator(tdoaMeasurement_t* tdoaMeasurement) {
+  if (measurementCount < MAX_PACKETS) {
+    measurements[measurementCount++] = *tdoaMeasurement;
+  }
+}
+
+// Same as the LPP handling in the tag
+static void handlePacket(tdoaAnchorContext_t* anchorCtx, const tdoa3RxPacket_t* packet, const int rangeDataLength, const bool timeIsGood) {
+  const uint8_t* lpp = &packet->payload[rangeDataLength];
+  const int lppLength = packet->payloadLength - rangeDataLength;
+  if (lppLength >= 2 + (int)sizeof(float) * 3 && lpp[0] == LPP_HEADER_SHORT_PACKET && lpp[1] == LPP_SHORT_ANCHORPOS) {
+    float pos[3];
+    memcpy(pos, &lpp[2], sizeof(pos));
+    tdoaStorageSetAnchorPosition(anchorCtx, pos[0], pos[1], pos[2]);
+  }
+}
+
+typedef struct {
+  const char* name;
+  double radioPath[MAX_PACKETS];
+  double processing;
+  int measurementCount;
+  double checksum;
+} result_t;
+
+static double checksum() {
+  double sum = 0.0;
+  for (int i = 0; i < measurementCount; i++) {
+    sum += measurements[i].distanceDiff * (i % 7 + 1);
+  }
+  return sum;
+}
+
+static void reset() {
+  tdoaEngineInit(&engineState, 0, sendTdoaToEstimator, TS_FREQ, TdoaEngineMatchingAlgorithmRandom);
+  measurementCount = 0;
+}
+
+static void replayDirect(result_t* result) {
+  reset();
+  for (int i = 0; i < packetCount; i++) {
+    const double start = now();
+    tdoa3RxProcessPacket(&engineState, &packets[i], false, 0, handlePacket);
+    result->radioPath[i] += now() - start;
+  }
+  result->measurementCount = measurementCount;
+  result->checksum = checksum();
+}
+
+static void replayBatched(result_t* result) {
+  static tdoa3RxBatch_t batch;
+  tdoa3RxBatchInit(&batch);
+  reset();
+
+  for (int i = 0; i < packetCount; i++) {
+    const tdoa3RxPacket_t* packet = &packets[i];
+
+    // Timeout event, the deadline passed before the packet was received
+    double start = now();
+    if (tdoa3RxBatchTimeToDeadline(&batch, packet->rxTime_ms) == 0) {
+      tdoa3RxBatchProcess(&batch, &engineState, false, 0, handlePacket);
+    }
+    result->processing += now() - start;
+
+    start = now();
+    tdoa3RxBatchAdd(&batch, packet->anchorId, packet->payload, packet->payloadLength, packet->rxTime, packet->rxTime_ms);
+    result->radioPath[i] += now() - start;
+
+    start = now();
+    if (tdoa3RxBatchTimeToDeadline(&batch, packet->rxTime_ms) == 0) {
+      tdoa3RxBatchProcess(&batch, &engineState, false, 0, handlePacket);
+    }
+    result->processing += now() - start;
+  }
+  tdoa3RxBatchProcess(&batch, &engineState, false, 0, handlePacket);
+
+  result->measurementCount = measurementCount;
+  result->checksum = checksum();
+}
+
+static void report(result_t* result) {
+  static double sorted[MAX_PACKETS];
+  double total = 0.0;
+  for (int i = 0; i < packetCount; i++) {
+    sorted[i] = result->radioPath[i] / REPEATS;
+    total += sorted[i];
+  }
+  qsort(sorted, packetCount, sizeof(double), compareDouble);
+
+  const double toNs = 1e9;
+  printf("%-8s %10.0f %10.0f %10.0f %12.0f %12.0f %8d\n", result->name,
+    total / packetCount * toNs, sorted[packetCount / 2] * toNs, sorted[packetCount * 99 / 100] * toNs,
+    result->processing / REPEATS / packetCount * toNs, (total + result->processing / REPEATS) / packetCount * toNs,
+    result->measurementCount);
+}
+
+int main(int argc, char* argv[]) {
+  if (argc == 3 && strcmp(argv[1], "--generate") == 0) {
+    generateLog();
+    if (!writeLog(argv[2])) {
+      fprintf(stderr, "Could not write %s\n", argv[2]);
+      return 1;
+    }
+    printf("%d packets written to %s\n", packetCount, argv[2]);
+    return 0;
+  }
+
+  if (argc == 2) {
+    if (!readLog(argv[1])) {
+      fprintf(stderr, "Could not read %s\n", argv[1]);
+      return 1;
+    }
+  } else {
+    generateLog();
+  }
+
+  if (packetCount == 0) {
+    fprintf(stderr, "No packets in the log\n");
+    return 1;
+  }
+
+  static result_t direct = {.name = "direct"};
+  static result_t batched = {.name = "batched"};
+  for (int r = 0; r < REPEATS; r++) {
+    replayDirect(&direct);
+    replayBatched(&batched);
+  }
+
+  const double duration = (packets[packetCount - 1].rxTime_ms - packets[0].rxTime_ms) / 1000.0;
+  printf("%d packets, %.1f s, batch size %d, max age %d ms\n", packetCount, duration, TDOA3_RX_BATCH_SIZE, TDOA3_RX_BATCH_MAX_AGE_MS);
+  printf("%-8s %10s %10s %10s %12s %12s %8s\n", "", "radio", "median", "p99", "processing", "total", "tdoa");
+  report(&direct);
+  report(&batched);
+  printf("(ns per packet, radio = time in the radio event path)\n");
+
+  if (direct.measurementCount != batched.measurementCount || direct.checksum != batched.checksum) {
+    fprintf(stderr, "Direct and batched processing give different measurements\n");
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,130 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2026 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * bench_ukf_core.c - Host benchmark of the standard and square root UKF core
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ukf_core.h"
+
+#define N UKF_CORE_DIM
+#define ITERATIONS 20000
+
+// Same ratio as in the estimator: 100 Hz prediction, roughly 400 Hz updates (TDoA + flow + ToF)
+#define UPDATES_PER_PREDICTION 4
+
+static const float stdDevInitial[N] = {50.0f, 50.0f, 1.0f, 0.0001f, 0.0001f, 0.0001f, 0.01f, 0.01f, 0.01f};
+
+static float F[N][N];
+static float Q[N][N];
+static float sqrtQ[N][N];
+
+static double now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void setupModel(const float dt) {
+  memset(F, 0, sizeof(F));
+  memset(Q, 0, sizeof(Q));
+  for (int i = 0; i < N; i++) {
+    F[i][i] = 1.0f;
+  }
+  for (int i = 0; i < 3; i++) {
+    F[i][i + 3] = dt;
+    F[i + 3][6 + ((i + 1) % 3)] = 0.05f;
+    F[6 + i][6 + ((i + 2) % 3)] = 0.001f;
+
+    Q[i][i] = 4.4755e-6f * dt * dt * dt * 0.33f;
+    Q[i][i + 3] = 4.4755e-6f * dt * dt * 0.5f;
+    Q[i + 3][i] = 4.4755e-6f * dt * dt * 0.5f;
+    Q[i + 3][i + 3] = 4.4755e-6f * dt;
+    Q[i + 6][i + 6] = 9.2495e-7f * dt;
+  }
+  ukfCoreCholesky(&Q[0][0], &sqrtQ[0][0], N);
+}
+
+static void update(ukfCoreData_t* ukf, const int anchor) {
+  float outputs[UKF_CORE_SIGMA_POINTS];
+  float mean, Pyy, Pxy[N];
+  const float ax = (anchor & 1) ? 4.0f : -4.0f;
+  const float ay = (anchor & 2) ? 4.0f : -4.0f;
+
+  for (int j = 0; j < UKF_CORE_SIGMA_POINTS; j++) {
+    const float* p = ukf->sigmaPoints[j];
+    const float dx = 1.0f + p[0] - ax;
+    const float dy = 1.0f + p[1] - ay;
+    const float dz = 1.0f + p[2] - 3.0f;
+    outputs[j] = sqrtf(dx * dx + dy * dy + dz * dz);
+  }
+  ukfCoreOutputMoments(ukf, outputs, &mean, &Pyy, Pxy);
+  Pyy += 0.1f * 0.1f;
+  ukfCoreScalarUpdate(ukf, Pxy, Pyy, 0.01f);
+
+  // The estimator moves the error state into the navigation state after each update
+  memset(ukf->x, 0, sizeof(ukf->x));
+  ukfCoreComputeSigmaPoints(ukf);
+}
+
+static void run(const char* name, const bool squareRoot) {
+  static ukfCoreData_t ukf;
+  ukfCoreInit(&ukf, stdDevInitial, 0.6f, squareRoot);
+
+  double predictTime = 0.0;
+  double updateTime = 0.0;
+  for (int i = 0; i < ITERATIONS; i++) {
+    double start = now();
+    ukfCorePredict(&ukf, F, Q, sqrtQ);
+    predictTime += now() - start;
+
+    start = now();
+    for (int u = 0; u < UPDATES_PER_PREDICTION; u++) {
+      update(&ukf, i + u);
+    }
+    updateTime += now() - start;
+  }
+
+  float P[N][N];
+  ukfCoreGetCovariance(&ukf, P);
+  printf("%-12s %10.2f %10.2f   P[0][0] %.6g, downdate failures %u\n", name,
+    predictTime / ITERATIONS * 1e6, updateTime / (ITERATIONS * UPDATES_PER_PREDICTION) * 1e6,
+    (double)P[0][0], (unsigned)ukf.downdateFailures);
+}
+
+int main() {
+  setupModel(0.01f);
+
+  printf("%-12s %10s %10s   (us per call)\n", "", "predict", "update");
+  run("standard", false);
+  run("square root", true);
+
+  return 0;
+}
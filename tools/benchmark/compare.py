@@ -0,0 +1,70 @@
+#!/usr/bin/env python3
+# Compares benchmark results (bench_kernels --json, insn_count.py --json)
+# with a baseline and exits with an error if a case got slower than the
+# threshold. A change is only reported as a regression if it is also larger
+# than the measured spread (median absolute deviation) of the two runs.
+#
+#   build/benchmark/bench_kernels --json baseline.json
+#   ... change the code ...
+#   build/benchmark/bench_kernels --json current.json
+#   tools/benchmark/compare.py baseline.json current.json
+import argparse
+import json
+import sys
+
+# Number of median absolute deviations a change must exceed to be significant
+SIGNIFICANCE = 3.0
+
+
+def load(path):
+    with open(path) as f:
+        data = json.load(f)
+    return data.get('unit', 'ns'), {r['name']: r for r in data['results']}
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Compare benchmark results with a baseline')
+    parser.add_argument('baseline', help='baseline results (JSON)')
+    parser.add_argument('current', help='current results (JSON)')
+    parser.add_argument('--threshold', type=float, default=10.0,
+                        help='allowed slow down in percent, default 10')
+    args = parser.parse_args()
+
+    baseline_unit, baseline = load(args.baseline)
+    current_unit, current = load(args.current)
+    if baseline_unit != current_unit:
+        print('Can not compare {} with {}'.format(baseline_unit, current_unit), file=sys.stderr)
+        sys.exit(2)
+
+    regressions = []
+    print('{:32} {:>12} {:>12} {:>9}'.format('', 'baseline', 'current', 'change'))
+    for name, result in current.items():
+        if name not in baseline:
+            print('{:32} {:>12} {:12.2f} {:>9}'.format(name, '-', result['median'], 'new'))
+            continue
+
+        base = baseline[name]
+        delta = result['median'] - base['median']
+        change = delta / base['median'] * 100.0 if base['median'] > 0 else 0.0
+        noise = SIGNIFICANCE * max(base.get('mad', 0.0), result.get('mad', 0.0))
+
+        status = ''
+        if change > args.threshold and delta > noise:
+            status = '  SLOWER'
+            regressions.append(name)
+        elif -change > args.threshold and -delta > noise:
+            status = '  faster'
+        print('{:32} {:12.2f} {:12.2f} {:+8.1f}%{}'.format(name, base['median'], result['median'], change, status))
+
+    for name in baseline:
+        if name not in current:
+            print('{:32} {:12.2f} {:>12} {:>9}'.format(name, baseline[name]['median'], '-', 'missing'))
+
+    if regressions:
+        print('{} of {} cases are more than {}% slower ({})'.format(
+            len(regressions), len(current), args.threshold, current_unit), file=sys.stderr)
+        sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
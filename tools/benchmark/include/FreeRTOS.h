@@ -0,0 +1,10 @@
+// Minimal FreeRTOS for host benchmarks of firmware modules, only what the benchmarked files use
+#pragma once
+
+#include <stdint.h>
+
+#include "cfassert.h"
+
+typedef uint32_t TickType_t;
+
+#define T2M(X) ((unsigned int)(X))
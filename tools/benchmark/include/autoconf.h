@@ -0,0 +1 @@
+// Empty Kconfig output for host benchmarks, configuration is passed as -D flags
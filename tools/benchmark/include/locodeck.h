@@ -0,0 +1,2 @@
+// The loco deck is not part of the host benchmarks, CONFIG_DECK_LOCO is not set
+#pragma once
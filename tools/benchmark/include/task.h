@@ -0,0 +1,6 @@
+// Minimal FreeRTOS task API for host benchmarks, implemented by the benchmark
+#pragma once
+
+#include "FreeRTOS.h"
+
+TickType_t xTaskGetTickCount(void);
@@ -0,0 +1,73 @@
+#!/usr/bin/env python3
+# Counts the number of Cortex-M4 instructions per operation of each
+# benchmark case.
+#
+# The benchmark is cross compiled for Thumb-2 with the FPv4-SP FPU, the
+# instruction set of the STM32F405 (make -C tools/benchmark cm4), and run in
+# QEMU user mode with the instruction counting plugin. QEMU can not run M
+# profile code in user mode, the binary runs on an A profile CPU that
+# executes the same instructions. The counts are deterministic and
+# independent of the host, but they are instruction counts, not cycles: on
+# the Cortex-M4 most instructions take one cycle, loads, divisions, square
+# roots and taken branches take more, and flash wait states are not modeled.
+#
+# Each case is run with --fixed 0 and --fixed N, the difference divided by N
+# is the number of instructions per operation.
+import argparse
+import json
+import re
+import subprocess
+import sys
+import tempfile
+
+INSN_PATTERN = re.compile(r'insns:\s*(\d+)')
+
+
+def count_instructions(args, extra):
+    with tempfile.NamedTemporaryFile(mode='r', suffix='.log') as log:
+        command = [args.qemu, '-cpu', args.cpu, '-plugin', args.plugin + ',inline=on', '-d', 'plugin',
+                   '-D', log.name, args.benchmark] + extra
+        subprocess.run(command, check=True, stdout=subprocess.PIPE)
+        counts = INSN_PATTERN.findall(log.read())
+    if not counts:
+        raise RuntimeError('No instruction count from the QEMU plugin, check --plugin')
+    # Newer plugin versions print per vcpu counts followed by the total
+    return int(counts[-1])
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Count Cortex-M4 instructions per operation with QEMU')
+    parser.add_argument('benchmark', help='benchmark cross compiled for the Cortex-M4, for instance build/benchmark/cm4/bench_kernels')
+    parser.add_argument('--qemu', default='qemu-arm', help='QEMU user mode emulator')
+    parser.add_argument('--cpu', default='cortex-a15', help='emulated CPU, must support Thumb-2 and VFPv4')
+    parser.add_argument('--plugin', default='libinsn.so', help='path to the QEMU insn plugin (contrib/plugins or tests/plugin)')
+    parser.add_argument('--iterations', type=int, default=1000, help='operations per case')
+    parser.add_argument('--filter', help='only count the cases with this text in the name')
+    parser.add_argument('--json', help='write the results to a file, compatible with compare.py')
+    args = parser.parse_args()
+
+    listing = subprocess.run([args.qemu, '-cpu', args.cpu, args.benchmark, '--list'],
+                             check=True, stdout=subprocess.PIPE, universal_newlines=True)
+    names = [name for name in listing.stdout.splitlines() if not args.filter or args.filter in name]
+
+    results = []
+    print('{:32} {:>12}'.format('kernels', 'insn per op'))
+    for name in names:
+        base = count_instructions(args, ['--filter', name, '--fixed', '0'])
+        total = count_instructions(args, ['--filter', name, '--fixed', str(args.iterations)])
+        per_op = (total - base) / args.iterations
+        print('{:32} {:12.1f}'.format(name, per_op))
+        results.append({'name': name, 'median': per_op, 'min': per_op, 'mad': 0.0,
+                        'iterations': args.iterations, 'repeats': 1})
+
+    if args.json:
+        with open(args.json, 'w') as f:
+            json.dump({'suite': 'kernels', 'unit': 'insn', 'results': results}, f, indent=2)
+
+
+if __name__ == '__main__':
+    try:
+        main()
+    except (RuntimeError, subprocess.CalledProcessError, FileNotFoundError) as e:
+        print(e, file=sys.stderr)
+        sys.exit(1)
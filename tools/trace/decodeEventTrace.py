@@ -0,0 +1,212 @@
+#!/usr/bin/env python3
+# Decodes an event trace (CONFIG_DEBUG_EVENT_TRACE) and writes it in the
+# Chrome trace event format, that can be opened in https://ui.perfetto.dev or
+# chrome://tracing.
+#
+# The trace is either written to the uSD card (trace.usdDump parameter) or
+# read from the MEM_TYPE_EVENT_TRACE memory. Stop the recording with the
+# trace.enable parameter before reading the memory.
+import argparse
+import json
+import struct
+import sys
+
+MAGIC = 0x52544643
+HEADER_FORMAT = '<LBBBBLLL12x'
+EVENT_FORMAT = '<LBxH'
+
+TASK_SWITCHED_IN = 1
+ISR_ENTER = 2
+ISR_EXIT = 3
+QUEUE_BLOCK_RECEIVE = 4
+QUEUE_BLOCK_SEND = 5
+SPAN_BEGIN = 6
+SPAN_END = 7
+
+SPAN_NAMES = {
+    0: 'stabilizer',
+    1: 'kalman',
+}
+
+# Exception numbers of the STM32F405, IRQn + 16
+EXCEPTION_NAMES = {
+    11: 'SVCall',
+    14: 'PendSV',
+    15: 'SysTick',
+    22: 'EXTI0',
+    23: 'EXTI1',
+    24: 'EXTI2',
+    25: 'EXTI3',
+    26: 'EXTI4',
+    27: 'DMA1_Stream0',
+    29: 'DMA1_Stream2',
+    32: 'DMA1_Stream5',
+    39: 'EXTI9_5',
+    47: 'I2C1_EV',
+    48: 'I2C1_ER',
+    56: 'EXTI15_10',
+    73: 'DMA2_Stream1',
+    86: 'DMA2_Stream7',
+    87: 'USART6',
+    88: 'I2C3_EV',
+    89: 'I2C3_ER',
+}
+
+PID_TASKS = 1
+PID_INTERRUPTS = 2
+PID_SPANS = 3
+
+
+def parse(data):
+    header_size = struct.calcsize(HEADER_FORMAT)
+    magic, version, event_size, max_tasks, name_len, capacity, write_count, \
+        cpu_freq = struct.unpack_from(HEADER_FORMAT, data, 0)
+    if magic != MAGIC:
+        raise ValueError('Not an event trace')
+    if version != 1 or event_size != struct.calcsize(EVENT_FORMAT):
+        raise ValueError('Unsupported event trace version {}'.format(version))
+
+    task_names = {}
+    for i in range(max_tasks):
+        offset = header_size + i * name_len
+        name = data[offset:offset + name_len].split(b'\0')[0]
+        if name:
+            task_names[i] = name.decode('ascii', errors='replace')
+
+    events_offset = header_size + max_tasks * name_len
+    if len(data) < events_offset + capacity * event_size:
+        raise ValueError('Truncated event trace')
+
+    # Events from the oldest to the newest, the buffer has only been partly
+    # filled if less than capacity events have been recorded
+    count = min(write_count, capacity)
+    first = write_count - count
+    events = []
+    for n in range(first, write_count):
+        offset = events_offset + (n % capacity) * event_size
+        timestamp, event_type, arg = struct.unpack_from(EVENT_FORMAT, data, offset)
+        if event_type != 0:
+            events.append((timestamp, event_type, arg))
+
+    if not events:
+        return task_names, cpu_freq, []
+
+    # The time stamps are 32 bit cycle counts that wrap around, unwrap them
+    # relative to the newest event. Events recorded from interrupts may be
+    # slightly out of order in the buffer.
+    newest = events[-1][0]
+    unwrapped = []
+    for timestamp, event_type, arg in events:
+        delta = (timestamp - newest + 0x80000000) % 0x100000000 - 0x80000000
+        unwrapped.append((delta, event_type, arg))
+    unwrapped.sort(key=lambda e: e[0])
+    start = unwrapped[0][0]
+
+    return task_names, cpu_freq, [(t - start, e, a) for t, e, a in unwrapped]
+
+
+def to_chrome_trace(task_names, cpu_freq, events):
+    def us(cycles):
+        return cycles * 1e6 / cpu_freq
+
+    trace = []
+
+    def metadata(pid, tid, key, name):
+        entry = {'ph': 'M', 'pid': pid, 'name': key, 'args': {'name': name}}
+        if tid is not None:
+            entry['tid'] = tid
+        trace.append(entry)
+
+    metadata(PID_TASKS, None, 'process_name', 'Tasks')
+    metadata(PID_INTERRUPTS, None, 'process_name', 'Interrupts')
+    metadata(PID_SPANS, None, 'process_name', 'Spans')
+
+    def task_name(number):
+        return task_names.get(number, 'task {}'.format(number))
+
+    def exception_name(number):
+        return EXCEPTION_NAMES.get(number, 'IRQ {}'.format(number - 16))
+
+    def span_name(number):
+        return SPAN_NAMES.get(number, 'span {}'.format(number))
+
+    seen_tasks = set()
+    open_slices = {}
+    current_task = None
+    task_start = 0
+
+    def begin(pid, tid, name, time):
+        open_slices.setdefault((pid, tid), []).append(name)
+        trace.append({'ph': 'B', 'pid': pid, 'tid': tid, 'name': name, 'ts': us(time)})
+
+    def end(pid, tid, time):
+        # Drop ends of slices that started before the first event in the buffer
+        if open_slices.get((pid, tid)):
+            open_slices[(pid, tid)].pop()
+            trace.append({'ph': 'E', 'pid': pid, 'tid': tid, 'ts': us(time)})
+
+    for time, event_type, arg in events:
+        if event_type == TASK_SWITCHED_IN:
+            if current_task is not None:
+                trace.append({'ph': 'X', 'pid': PID_TASKS, 'tid': current_task,
+                              'name': task_name(current_task), 'ts': us(task_start),
+                              'dur': us(time - task_start)})
+            current_task = arg
+            task_start = time
+            seen_tasks.add(arg)
+        elif event_type == ISR_ENTER:
+            begin(PID_INTERRUPTS, arg, exception_name(arg), time)
+        elif event_type == ISR_EXIT:
+            end(PID_INTERRUPTS, arg, time)
+        elif event_type == SPAN_BEGIN:
+            begin(PID_SPANS, arg, span_name(arg), time)
+        elif event_type == SPAN_END:
+            end(PID_SPANS, arg, time)
+        elif event_type in (QUEUE_BLOCK_RECEIVE, QUEUE_BLOCK_SEND) and current_task is not None:
+            name = 'block on receive' if event_type == QUEUE_BLOCK_RECEIVE else 'block on send'
+            trace.append({'ph': 'i', 's': 't', 'pid': PID_TASKS, 'tid': current_task,
+                          'name': name, 'ts': us(time), 'args': {'queue': '0x{:04x}'.format(arg)}})
+
+    # Close what is still running at the end of the trace
+    last = events[-1][0] if events else 0
+    if current_task is not None:
+        trace.append({'ph': 'X', 'pid': PID_TASKS, 'tid': current_task, 'name': task_name(current_task),
+                      'ts': us(task_start), 'dur': us(last - task_start)})
+    for (pid, tid), names in open_slices.items():
+        for _ in names:
+            trace.append({'ph': 'E', 'pid': pid, 'tid': tid, 'ts': us(last)})
+
+    for number in sorted(seen_tasks):
+        metadata(PID_TASKS, number, 'thread_name', task_name(number))
+    for pid, tid in open_slices:
+        name = exception_name(tid) if pid == PID_INTERRUPTS else span_name(tid)
+        metadata(pid, tid, 'thread_name', name)
+
+    return {'traceEvents': trace, 'displayTimeUnit': 'ns'}
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Convert a Crazyflie event trace to the Chrome trace format')
+    parser.add_argument('trace', help='binary trace, for instance trace.bin from the uSD card')
+    parser.add_argument('output', nargs='?', help='output file, default is stdout')
+    args = parser.parse_args()
+
+    with open(args.trace, 'rb') as f:
+        data = f.read()
+
+    task_names, cpu_freq, events = parse(data)
+    result = to_chrome_trace(task_names, cpu_freq, events)
+
+    if args.output:
+        with open(args.output, 'w') as f:
+            json.dump(result, f)
+    else:
+        json.dump(result, sys.stdout)
+
+    if events:
+        duration = events[-1][0] / cpu_freq * 1e3
+        print('{} events, {:.2f} ms'.format(len(events), duration), file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()
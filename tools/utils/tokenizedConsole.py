@@ -0,0 +1,191 @@
+#!/usr/bin/env python3
+#
+# ,---------,       ____  _ __
+# |  ,-^-,  |      / __ )(_) /_______________ _____  ___
+# | (  O  ) |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+# | / ,--'  |    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+#    +------`   /_____/_/\__/\___/_/   \__,_/ /___/\___/
+#
+# Copyright (C) 2026 Bitcraze AB
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, in version 3.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program. If not, see <http://www.gnu.org/licenses/>.
+"""
+Console that formats tokenized messages (CONFIG_DEBUG_PRINT_TOKENIZED).
+
+The format strings are read from the .console_tokens section of the ELF file
+of the running firmware, for instance build/cf2.elf. Text messages are
+printed as they are.
+
+    tokenizedConsole.py build/cf2.elf radio://0/80/2M/E7E7E7E7E7
+
+Messages can also be decoded offline, one message per line in hex:
+
+    tokenizedConsole.py build/cf2.elf --hex < messages.txt
+"""
+import argparse
+import re
+import struct
+import sys
+
+TOKEN_SECTION = '.console_tokens'
+
+CONSOLE_CHANNEL_TEXT = 0
+CONSOLE_CHANNEL_TOKENIZED = 1
+
+# printf conversion specifications, the length modifiers are dropped since all
+# integers are sent as varints
+SPEC = re.compile(r'%([-+ 0#]*\d*(?:\.\d+)?)(hh|h|ll|l|z|j|t)?([diuoxXcsfFeEgGp%])')
+
+
+def read_token_section(elf_file):
+    with open(elf_file, 'rb') as f:
+        elf = f.read()
+
+    if elf[:4] != b'\x7fELF':
+        raise ValueError('Not an ELF file')
+    if elf[4] == 1:
+        shoff, = struct.unpack_from('<I', elf, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from('<HHH', elf, 0x2e)
+        header = '<IIIIIIIIII'
+    else:
+        shoff, = struct.unpack_from('<Q', elf, 0x28)
+        shentsize, shnum, shstrndx = struct.unpack_from('<HHH', elf, 0x3a)
+        header = '<IIQQQQIIQQ'
+
+    sections = [struct.unpack_from(header, elf, shoff + i * shentsize) for i in range(shnum)]
+    names_offset = sections[shstrndx][4]
+    for name, _, _, _, offset, size, *_ in sections:
+        end = elf.index(b'\0', names_offset + name)
+        if elf[names_offset + name:end].decode() == TOKEN_SECTION:
+            return elf[offset:offset + size]
+
+    raise ValueError('No {} section, is CONFIG_DEBUG_PRINT_TOKENIZED enabled?'.format(TOKEN_SECTION))
+
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def varint(self):
+        value = 0
+        shift = 0
+        while True:
+            byte = self.data[self.pos]
+            self.pos += 1
+            value |= (byte & 0x7f) << shift
+            shift += 7
+            if not byte & 0x80:
+                return value
+
+    def signed(self):
+        value = self.varint()
+        return (value >> 1) ^ -(value & 1)
+
+    def float(self):
+        value, = struct.unpack_from('<f', self.data, self.pos)
+        self.pos += 4
+        return value
+
+    def string(self):
+        end = self.data.index(0, self.pos)
+        value = self.data[self.pos:end].decode('utf-8', errors='replace')
+        self.pos = end + 1
+        return value
+
+
+def format_message(fmt, args):
+    reader = Reader(args)
+
+    def convert(match):
+        flags, length, conversion = match.groups()
+        if conversion == '%':
+            return '%'
+        try:
+            if conversion == 's':
+                return ('%' + flags + 's') % reader.string()
+            if conversion in 'fFeEgG':
+                return ('%' + flags + conversion) % reader.float()
+            value = reader.signed()
+            if conversion in 'di':
+                return ('%' + flags + 'd') % value
+            if conversion == 'c':
+                return chr(value & 0xff)
+            value &= 0xffffffffffffffff if length in ('ll', 'j') else 0xffffffff
+            if conversion == 'p':
+                return '0x%08x' % value
+            return ('%' + flags + ('d' if conversion == 'u' else conversion)) % value
+        except (IndexError, ValueError, struct.error):
+            # The argument did not fit in the packet
+            return '<?>'
+
+    return SPEC.sub(convert, fmt)
+
+
+def decode(tokens, message):
+    reader = Reader(message)
+    token = reader.varint()
+    if token >= len(tokens):
+        return '<unknown token {}>\n'.format(token)
+    fmt = tokens[token:tokens.index(b'\0', token)].decode('utf-8', errors='replace')
+    return format_message(fmt, message[reader.pos:])
+
+
+def run_hex(tokens):
+    for line in sys.stdin:
+        line = line.strip()
+        if line:
+            sys.stdout.write(decode(tokens, bytes.fromhex(line)))
+
+
+def run_radio(tokens, uri):
+    import time
+
+    import cflib.crtp
+    from cflib.crazyflie import Crazyflie
+    from cflib.crtp.crtpstack import CRTPPort
+
+    def received(packet):
+        if packet.channel == CONSOLE_CHANNEL_TOKENIZED:
+            sys.stdout.write(decode(tokens, bytes(packet.data)))
+        elif packet.channel == CONSOLE_CHANNEL_TEXT:
+            sys.stdout.write(bytes(packet.data).decode('utf-8', errors='replace'))
+        sys.stdout.flush()
+
+    cflib.crtp.init_drivers()
+    cf = Crazyflie(rw_cache='./cache')
+    cf.add_port_callback(CRTPPort.CONSOLE, received)
+    cf.open_link(uri)
+    try:
+        while True:
+            time.sleep(1)
+    except KeyboardInterrupt:
+        cf.close_link()
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Console for tokenized Crazyflie debug messages')
+    parser.add_argument('elf', help='ELF file of the running firmware')
+    parser.add_argument('uri', nargs='?', default='radio://0/80/2M/E7E7E7E7E7', help='Crazyflie URI')
+    parser.add_argument('--hex', action='store_true', help='decode hex messages from stdin')
+    args = parser.parse_args()
+
+    tokens = read_token_section(args.elf)
+    if args.hex:
+        run_hex(tokens)
+    else:
+        run_radio(tokens, args.uri)
+
+
+if __name__ == '__main__':
+    main()